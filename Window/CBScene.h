@@ -3,15 +3,30 @@
 
 struct GeomBuffer
 {
-    float4x4 mWorldMatrix;
-    float4x4 norm;
-    float4 shineSpeedTexIdNM; // x - specular power, y - rotation speed, z - texture id, w - normal map presence
+    float3 position;
+    float scale;
+    float4 rotation; // unit quaternion
+    uint material; // bits 0-9 - specular power, 10-17 - texture id, 18 - normal map presence
 };
 
-cbuffer GeomxBufferInst : register (b0)
-{
-    GeomBuffer geomBuffer[MAX_CUBE];
-};
+StructuredBuffer<GeomBuffer> geomBuffer : register (t2);
+
+// Function to rotate vector by unit quaternion
+float3 RotateVector(float4 q, float3 v) {
+    return v + 2.0f * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+}
+
+float GetSpecularPower(uint material) {
+    return float(material & ((1u << MATERIAL_SHINE_BITS) - 1));
+}
+
+float GetTextureId(uint material) {
+    return float((material >> MATERIAL_TEXTURE_SHIFT) & ((1u << MATERIAL_TEXTURE_BITS) - 1));
+}
+
+bool HasNormalMap(uint material) {
+    return (material >> MATERIAL_NORMAL_MAP_SHIFT) & 1u;
+}
 
 cbuffer SceneConstantBuffer : register (b1)
 {
@@ -19,7 +34,4 @@ cbuffer SceneConstantBuffer : register (b1)
     float4 planes[6];
 };
 
-cbuffer IndexBuffer : register(b2)
-{
-    uint4 objectIDs[MAX_CUBE];
-}
\ No newline at end of file
+StructuredBuffer<uint> objectIDs : register (t3);
\ No newline at end of file
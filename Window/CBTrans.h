@@ -7,10 +7,8 @@ struct GeomBuffer {
 };
 
 #ifdef USE_LIGHTS
-cbuffer WorldMatrixBuffer : register (b0)
-{
-    GeomBuffer geomBuffer;
-};
+// Transparent objects sorted back to front
+StructuredBuffer<GeomBuffer> geomBuffer : register (t0);
 #else
 cbuffer GeomxBufferInst : register (b0)
 {
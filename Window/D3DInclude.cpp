@@ -7,6 +7,7 @@ HRESULT D3DInclude::Open(D3D_INCLUDE_TYPE IncludeType, LPCSTR pFileName, LPCVOID
     if (pFile == nullptr) {
         return E_FAIL;
     }
+    m_includes.push_back(pFileName);
 
     // Get the file size
     fseek(pFile, 0, SEEK_END);
@@ -25,6 +26,6 @@ HRESULT D3DInclude::Open(D3D_INCLUDE_TYPE IncludeType, LPCSTR pFileName, LPCVOID
 }
 
 HRESULT D3DInclude::Close(LPCVOID pData) {
-    free(const_cast<void*>(pData));
+    delete[] static_cast<const char*>(pData);
     return S_OK;
 }
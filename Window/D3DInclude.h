@@ -4,6 +4,8 @@
 #include <dxgi.h>
 #include <d3d11.h>
 #include <fstream>
+#include <string>
+#include <vector>
 
 class D3DInclude : public ID3DInclude {
   public:
@@ -12,4 +14,9 @@ class D3DInclude : public ID3DInclude {
 
     HRESULT __stdcall Close(LPCVOID pData);
 
+    // Files opened by compiler, in order of opening
+    const std::vector<std::string>& GetIncludes() const { return m_includes; };
+
+  private:
+    std::vector<std::string> m_includes;
 };
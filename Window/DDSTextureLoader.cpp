@@ -127,6 +127,10 @@ namespace
 
     inline HANDLE safe_handle(HANDLE h) { return (h == INVALID_HANDLE_VALUE) ? 0 : h; }
 
+    struct view_unmapper { void operator()(const uint8_t* p) { if (p) UnmapViewOfFile(p); } };
+
+    typedef public std::unique_ptr<const uint8_t, view_unmapper> ScopedView;
+
     template<UINT TNameLength>
     inline void SetDebugObjectName(_In_ ID3D11DeviceChild* resource, _In_ const char(&name)[TNameLength])
     {
@@ -141,10 +145,11 @@ namespace
 };
 
 //--------------------------------------------------------------------------------------
+// File is mapped instead of read into heap copy, header and subresources point into mapped view
 static HRESULT LoadTextureDataFromFile(_In_z_ const wchar_t* fileName,
-    std::unique_ptr<uint8_t[]>& ddsData,
-    DDS_HEADER** header,
-    uint8_t** bitData,
+    ScopedView& ddsData,
+    const DDS_HEADER** header,
+    const uint8_t** bitData,
     size_t* bitSize
 )
 {
@@ -201,28 +206,26 @@ static HRESULT LoadTextureDataFromFile(_In_z_ const wchar_t* fileName,
         return E_FAIL;
     }
 
-    // create enough space for the file data
-    ddsData.reset(new (std::nothrow) uint8_t[FileSize.LowPart]);
-    if (!ddsData)
-    {
-        return E_OUTOFMEMORY;
-    }
-
-    // read the data in
-    DWORD BytesRead = 0;
-    if (!ReadFile(hFile.get(),
-        ddsData.get(),
-        FileSize.LowPart,
-        &BytesRead,
-        nullptr
-    ))
+    // map the file, view stays valid after mapping handle is closed
+    ScopedHandle hMapping(CreateFileMappingW(hFile.get(),
+        nullptr,
+        PAGE_READONLY,
+        0,
+        0,
+        nullptr));
+    if (!hMapping)
     {
         return HRESULT_FROM_WIN32(GetLastError());
     }
 
-    if (BytesRead < FileSize.LowPart)
+    ddsData.reset(static_cast<const uint8_t*>(MapViewOfFile(hMapping.get(),
+        FILE_MAP_READ,
+        0,
+        0,
+        0)));
+    if (!ddsData)
     {
-        return E_FAIL;
+        return HRESULT_FROM_WIN32(GetLastError());
     }
 
     // DDS files always start with the same magic number ("DDS ")
@@ -232,7 +235,7 @@ static HRESULT LoadTextureDataFromFile(_In_z_ const wchar_t* fileName,
         return E_FAIL;
     }
 
-    auto hdr = reinterpret_cast<DDS_HEADER*>(ddsData.get() + sizeof(uint32_t));
+    auto hdr = reinterpret_cast<const DDS_HEADER*>(ddsData.get() + sizeof(uint32_t));
 
     // Verify header to validate DDS file
     if (hdr->size != sizeof(DDS_HEADER) ||
@@ -1751,11 +1754,11 @@ HRESULT DirectX::CreateDDSTextureFromFileEx(ID3D11Device* d3dDevice,
         return E_INVALIDARG;
     }
 
-    DDS_HEADER* header = nullptr;
-    uint8_t* bitData = nullptr;
+    const DDS_HEADER* header = nullptr;
+    const uint8_t* bitData = nullptr;
     size_t bitSize = 0;
 
-    std::unique_ptr<uint8_t[]> ddsData;
+    ScopedView ddsData;
     HRESULT hr = LoadTextureDataFromFile(fileName,
         ddsData,
         &header,
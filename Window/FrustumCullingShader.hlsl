@@ -1,14 +1,20 @@
 #include "CBScene.h"
 
+struct CullBox
+{
+    float4 bbMin;
+    float4 bbMax;
+};
+
 cbuffer CullParams : register(b0)
 {
-    uint4 numShapes; // x - objects count;
-    float4 bbMin[MAX_CUBE];
-    float4 bbMax[MAX_CUBE];
+    uint4 numShapes; // x - objects count, y - threads count in dispatch row
 }
 
+StructuredBuffer<CullBox> cullBoxes : register(t0);
+
 RWStructuredBuffer<uint> indirectArgs : register(u0);
-RWStructuredBuffer<uint4> objectsIds : register(u1);
+RWStructuredBuffer<uint> objectsIds : register(u1);
 
 bool IsBoxInside(in float4 planes[6], in float3 bbMin, in float3 bbMax) {
     for (int i = 0; i < 6; i++) {
@@ -31,12 +37,13 @@ bool IsBoxInside(in float4 planes[6], in float3 bbMin, in float3 bbMax) {
 [numthreads(64, 1, 1)]
 void main(uint3 globalThreadId : SV_DispatchThreadID)
 {
-    if (globalThreadId.x >= numShapes.x) {
+    uint idx = globalThreadId.y * numShapes.y + globalThreadId.x;
+    if (idx >= numShapes.x) {
         return;
     }
-    if (IsBoxInside(planes, bbMin[globalThreadId.x].xyz, bbMax[globalThreadId.x].xyz)) {
+    if (IsBoxInside(planes, cullBoxes[idx].bbMin.xyz, cullBoxes[idx].bbMax.xyz)) {
         uint id = 0;
         InterlockedAdd(indirectArgs[1], 1, id);
-        objectsIds[id] = uint4(globalThreadId.x, 0, 0, 0);
+        objectsIds[id] = idx;
     }
 }
@@ -16,11 +16,12 @@ struct PS_INPUT
 };
 
 float4 main(PS_INPUT input) : SV_TARGET{
-    float3 color = cubeTexture.Sample(cubeSampler, float3(input.uv, geomBuffer[input.instanceId].shineSpeedTexIdNM.z)).xyz;
+    uint material = geomBuffer[input.instanceId].material;
+    float3 color = cubeTexture.Sample(cubeSampler, float3(input.uv, GetTextureId(material))).xyz;
     float3 finalColor = ambientColor.xyz * color;
 
     float3 norm = float3(0, 0, 0);
-    if (lightCount.y > 0 && geomBuffer[input.instanceId].shineSpeedTexIdNM.w > 0.0f) {
+    if (lightCount.y > 0 && HasNormalMap(material)) {
         float3 binorm = normalize(cross(input.normal, input.tangent));
         float3 localNorm = cubeNormal.Sample(cubeSampler, input.uv).xyz * 2.0 - 1.0;
         norm = localNorm.x * normalize(input.tangent) + localNorm.y * binorm + localNorm.z * normalize(input.normal);
@@ -29,5 +30,5 @@ float4 main(PS_INPUT input) : SV_TARGET{
         norm = input.normal;
     }
 
-    return float4(CalculateColor(finalColor, norm, input.worldPos.xyz, geomBuffer[input.instanceId].shineSpeedTexIdNM.x, false), 1.0);
+    return float4(CalculateColor(finalColor, norm, input.worldPos.xyz, GetSpecularPower(material), false), 1.0);
 }
@@ -8,7 +8,8 @@ struct PS_INPUT {
 
 float4 main(PS_INPUT input) : SV_TARGET{
 #ifdef USE_LIGHTS
-    return float4(CalculateColor(geomBuffer.color.xyz, float3(1, 0, 0), input.worldPos.xyz, 0.0, true), geomBuffer.color.w);
+    float4 color = geomBuffer[input.instanceId].color;
+    return float4(CalculateColor(color.xyz, float3(1, 0, 0), input.worldPos.xyz, 0.0, true), color.w);
 #else
     return geomBuffer[input.instanceId].color;
 #endif // !USE_LIGHTS
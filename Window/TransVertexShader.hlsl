@@ -16,13 +16,9 @@ struct PS_INPUT
 PS_INPUT main(VS_INPUT input) {
     PS_INPUT output;
 
-#ifdef USE_LIGHTS
-    output.worldPos = mul(geomBuffer.mWorldMatrix, input.position);
-#else
     unsigned int idx = input.instanceId;
     output.worldPos = mul(geomBuffer[idx].mWorldMatrix, input.position);
     output.instanceId = idx;
-#endif // !USE_LIGHTS
     output.position = mul(mViewProjectionMatrix, output.worldPos);
 
     return output;
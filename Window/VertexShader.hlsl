@@ -22,12 +22,14 @@ struct PS_INPUT
 PS_INPUT main(VS_INPUT input) {
     PS_INPUT output;
 
-    unsigned int idx = objectIDs[input.instanceId].x;
-    output.worldPos = mul(geomBuffer[idx].mWorldMatrix, float4(input.position, 1.0f));
+    unsigned int idx = objectIDs[input.instanceId];
+    GeomBuffer instance = geomBuffer[idx];
+    output.worldPos = float4(instance.position + instance.scale * RotateVector(instance.rotation, input.position), 1.0f);
     output.position = mul(mViewProjectionMatrix, output.worldPos);
     output.uv = input.uv;
-    output.normal = mul(geomBuffer[idx].norm, float4(input.normal, 0.0f)).xyz;
-    output.tangent = mul(geomBuffer[idx].norm, float4(input.tangent, 0.0f)).xyz;
+    // Scale is uniform, so normals need rotation only
+    output.normal = RotateVector(instance.rotation, input.normal);
+    output.tangent = RotateVector(instance.rotation, input.tangent);
     output.instanceId = idx;
 
     return output;
@@ -0,0 +1,59 @@
+// alignedAllocator.h - allocator for containers with cache line aligned storage
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#define CACHE_LINE_SIZE 64
+
+template <typename T, size_t Alignment = CACHE_LINE_SIZE>
+class AlignedAllocator {
+public:
+    typedef T value_type;
+
+    template <typename U>
+    struct rebind {
+        typedef AlignedAllocator<U, Alignment> other;
+    };
+
+    AlignedAllocator() = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) {};
+
+    T* allocate(size_t count) {
+        void* ptr = nullptr;
+#ifdef _WIN32
+        ptr = _aligned_malloc(count * sizeof(T), Alignment);
+#else
+        if (posix_memalign(&ptr, Alignment, count * sizeof(T)) != 0) {
+            ptr = nullptr;
+        }
+#endif
+        if (!ptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(ptr);
+    };
+
+    void deallocate(T* ptr, size_t) {
+#ifdef _WIN32
+        _aligned_free(ptr);
+#else
+        free(ptr);
+#endif
+    };
+};
+
+template <typename T, typename U, size_t Alignment>
+bool operator==(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&) { return true; }
+template <typename T, typename U, size_t Alignment>
+bool operator!=(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&) { return false; }
+
+// Vector with storage starting on cache line boundary
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
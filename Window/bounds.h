@@ -0,0 +1,62 @@
+// bounds.h - structure of arrays storage for axis aligned bounding boxes
+#pragma once
+
+#include <directxmath.h>
+#include <vector>
+#include "alignedAllocator.h"
+
+using namespace DirectX;
+
+struct AABBSoA {
+    AlignedVector<float> minX;
+    AlignedVector<float> minY;
+    AlignedVector<float> minZ;
+    AlignedVector<float> maxX;
+    AlignedVector<float> maxY;
+    AlignedVector<float> maxZ;
+
+    // Function to change boxes count
+    void Resize(size_t count) {
+        minX.resize(count);
+        minY.resize(count);
+        minZ.resize(count);
+        maxX.resize(count);
+        maxY.resize(count);
+        maxZ.resize(count);
+    };
+    // Function to copy box from one slot to another
+    void Copy(size_t from, size_t to) {
+        minX[to] = minX[from];
+        minY[to] = minY[from];
+        minZ[to] = minZ[from];
+        maxX[to] = maxX[from];
+        maxY[to] = maxY[from];
+        maxZ[to] = maxZ[from];
+    };
+    // Function to get boxes count
+    size_t Size() const { return minX.size(); };
+};
+
+// Function to calculate world space box of local box [localMin, localMax] in closed form (Arvo's method):
+// center is transformed as a point, extents are transformed by the absolute 3x3 part of the matrix
+inline void XM_CALLCONV TransformBox(FXMMATRIX world, FXMVECTOR localMin, FXMVECTOR localMax, AABBSoA& boxes, size_t index) {
+    XMVECTOR center = XMVectorScale(XMVectorAdd(localMin, localMax), 0.5f);
+    XMVECTOR extents = XMVectorScale(XMVectorSubtract(localMax, localMin), 0.5f);
+
+    XMVECTOR worldCenter = XMVectorMultiplyAdd(XMVectorSplatX(center), world.r[0],
+        XMVectorMultiplyAdd(XMVectorSplatY(center), world.r[1],
+        XMVectorMultiplyAdd(XMVectorSplatZ(center), world.r[2], world.r[3])));
+    XMVECTOR worldExtents = XMVectorMultiplyAdd(XMVectorSplatX(extents), XMVectorAbs(world.r[0]),
+        XMVectorMultiplyAdd(XMVectorSplatY(extents), XMVectorAbs(world.r[1]),
+        XMVectorMultiply(XMVectorSplatZ(extents), XMVectorAbs(world.r[2]))));
+
+    XMFLOAT4 min, max;
+    XMStoreFloat4(&min, XMVectorSubtract(worldCenter, worldExtents));
+    XMStoreFloat4(&max, XMVectorAdd(worldCenter, worldExtents));
+    boxes.minX[index] = min.x;
+    boxes.minY[index] = min.y;
+    boxes.minZ[index] = min.z;
+    boxes.maxX[index] = max.x;
+    boxes.maxY[index] = max.y;
+    boxes.maxZ[index] = max.z;
+};
@@ -0,0 +1,208 @@
+#include "bvh.h"
+
+#include <algorithm>
+#include <float.h>
+
+namespace {
+    const int BinsCount = 16;
+    const int MaxLeafSize = 4;
+
+    float HalfArea(const XMFLOAT3& bbMin, const XMFLOAT3& bbMax) {
+        float dx = bbMax.x - bbMin.x;
+        float dy = bbMax.y - bbMin.y;
+        float dz = bbMax.z - bbMin.z;
+        return dx * dy + dy * dz + dz * dx;
+    }
+
+    void Grow(XMFLOAT3& bbMin, XMFLOAT3& bbMax, const XMFLOAT3& pMin, const XMFLOAT3& pMax) {
+        bbMin.x = (std::min)(bbMin.x, pMin.x);
+        bbMin.y = (std::min)(bbMin.y, pMin.y);
+        bbMin.z = (std::min)(bbMin.z, pMin.z);
+        bbMax.x = (std::max)(bbMax.x, pMax.x);
+        bbMax.y = (std::max)(bbMax.y, pMax.y);
+        bbMax.z = (std::max)(bbMax.z, pMax.z);
+    }
+
+    float Component(const XMFLOAT3& v, int axis) {
+        return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+    }
+
+    struct Bin {
+        XMFLOAT3 bbMin = XMFLOAT3(FLT_MAX, FLT_MAX, FLT_MAX);
+        XMFLOAT3 bbMax = XMFLOAT3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+        int count = 0;
+    };
+}
+
+// Function to build hierarchy with binned surface area heuristic
+void BVH::Build(const AABBSoA& boxes) {
+    int count = (int)boxes.Size();
+
+    m_nodes.clear();
+    m_indices.resize(count);
+    m_centers.resize(count);
+    if (count == 0) {
+        return;
+    }
+
+    for (int i = 0; i < count; i++) {
+        m_indices[i] = i;
+        m_centers[i] = XMFLOAT3(
+            (boxes.minX[i] + boxes.maxX[i]) * 0.5f,
+            (boxes.minY[i] + boxes.maxY[i]) * 0.5f,
+            (boxes.minZ[i] + boxes.maxZ[i]) * 0.5f);
+    }
+
+    m_nodes.reserve(2 * count);
+    Node root;
+    root.left = -1;
+    root.first = 0;
+    root.count = count;
+    m_nodes.push_back(root);
+    UpdateNodeBounds(0, boxes);
+
+    // Children are always stored after their parent, so refit can go in reverse order
+    std::vector<int> stack = { 0 };
+    while (!stack.empty()) {
+        int nodeIdx = stack.back();
+        stack.pop_back();
+        if (Subdivide(nodeIdx, boxes)) {
+            stack.push_back(m_nodes[nodeIdx].left);
+            stack.push_back(m_nodes[nodeIdx].left + 1);
+        }
+    }
+}
+
+// Function to calculate node bounding box from its primitives
+void BVH::UpdateNodeBounds(int nodeIdx, const AABBSoA& boxes) {
+    Node& node = m_nodes[nodeIdx];
+    node.bbMin = XMFLOAT3(FLT_MAX, FLT_MAX, FLT_MAX);
+    node.bbMax = XMFLOAT3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (int i = node.first; i < node.first + node.count; i++) {
+        int idx = m_indices[i];
+        Grow(node.bbMin, node.bbMax,
+            XMFLOAT3(boxes.minX[idx], boxes.minY[idx], boxes.minZ[idx]),
+            XMFLOAT3(boxes.maxX[idx], boxes.maxY[idx], boxes.maxZ[idx]));
+    }
+}
+
+// Function to split node in two by the cheapest plane
+bool BVH::Subdivide(int nodeIdx, const AABBSoA& boxes) {
+    Node node = m_nodes[nodeIdx];
+    if (node.count <= 1) {
+        return false;
+    }
+
+    // Bounds of primitives centers
+    XMFLOAT3 cMin = XMFLOAT3(FLT_MAX, FLT_MAX, FLT_MAX);
+    XMFLOAT3 cMax = XMFLOAT3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (int i = node.first; i < node.first + node.count; i++) {
+        Grow(cMin, cMax, m_centers[m_indices[i]], m_centers[m_indices[i]]);
+    }
+
+    // Find the cheapest split among bins borders of all axes
+    int bestAxis = -1;
+    int bestSplit = 0;
+    float bestCost = FLT_MAX;
+    for (int axis = 0; axis < 3; axis++) {
+        float lo = Component(cMin, axis);
+        float hi = Component(cMax, axis);
+        if (hi <= lo) {
+            continue;
+        }
+
+        Bin bins[BinsCount];
+        float scale = BinsCount / (hi - lo);
+        for (int i = node.first; i < node.first + node.count; i++) {
+            int idx = m_indices[i];
+            int b = (std::min)(BinsCount - 1, (int)((Component(m_centers[idx], axis) - lo) * scale));
+            bins[b].count++;
+            Grow(bins[b].bbMin, bins[b].bbMax,
+                XMFLOAT3(boxes.minX[idx], boxes.minY[idx], boxes.minZ[idx]),
+                XMFLOAT3(boxes.maxX[idx], boxes.maxY[idx], boxes.maxZ[idx]));
+        }
+
+        // Sweep from both sides to get areas and counts of every split
+        float leftArea[BinsCount - 1], rightArea[BinsCount - 1];
+        int leftCount[BinsCount - 1], rightCount[BinsCount - 1];
+        Bin left, right;
+        for (int i = 0; i < BinsCount - 1; i++) {
+            left.count += bins[i].count;
+            if (bins[i].count > 0) {
+                Grow(left.bbMin, left.bbMax, bins[i].bbMin, bins[i].bbMax);
+            }
+            leftCount[i] = left.count;
+            leftArea[i] = left.count > 0 ? HalfArea(left.bbMin, left.bbMax) : 0.0f;
+
+            int j = BinsCount - 1 - i;
+            right.count += bins[j].count;
+            if (bins[j].count > 0) {
+                Grow(right.bbMin, right.bbMax, bins[j].bbMin, bins[j].bbMax);
+            }
+            rightCount[j - 1] = right.count;
+            rightArea[j - 1] = right.count > 0 ? HalfArea(right.bbMin, right.bbMax) : 0.0f;
+        }
+
+        for (int i = 0; i < BinsCount - 1; i++) {
+            float cost = leftCount[i] * leftArea[i] + rightCount[i] * rightArea[i];
+            if (leftCount[i] > 0 && rightCount[i] > 0 && cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = i;
+            }
+        }
+    }
+
+    // Keep leaf if traversing one more level is not cheaper than testing all primitives
+    float nodeArea = HalfArea(node.bbMin, node.bbMax);
+    if (bestAxis < 0 || (node.count <= MaxLeafSize && nodeArea + bestCost >= node.count * nodeArea)) {
+        return false;
+    }
+
+    // Partition primitives indices by chosen plane
+    float lo = Component(cMin, bestAxis);
+    float scale = BinsCount / (Component(cMax, bestAxis) - lo);
+    int* first = m_indices.data() + node.first;
+    int* last = first + node.count;
+    int* middle = std::partition(first, last, [&](int idx) {
+        int b = (std::min)(BinsCount - 1, (int)((Component(m_centers[idx], bestAxis) - lo) * scale));
+        return b <= bestSplit;
+    });
+    int leftCount = (int)(middle - first);
+    if (leftCount == 0 || leftCount == node.count) {
+        return false;
+    }
+
+    int leftIdx = (int)m_nodes.size();
+    Node child;
+    child.left = -1;
+    child.first = node.first;
+    child.count = leftCount;
+    m_nodes.push_back(child);
+    child.first = node.first + leftCount;
+    child.count = node.count - leftCount;
+    m_nodes.push_back(child);
+    m_nodes[nodeIdx].left = leftIdx;
+
+    UpdateNodeBounds(leftIdx, boxes);
+    UpdateNodeBounds(leftIdx + 1, boxes);
+
+    return true;
+}
+
+// Function to update nodes bounding boxes after primitives moved, tree topology is kept
+void BVH::Refit(const AABBSoA& boxes) {
+    for (int i = (int)m_nodes.size() - 1; i >= 0; i--) {
+        Node& node = m_nodes[i];
+        if (node.left < 0) {
+            UpdateNodeBounds(i, boxes);
+        }
+        else {
+            const Node& left = m_nodes[node.left];
+            const Node& right = m_nodes[node.left + 1];
+            node.bbMin = left.bbMin;
+            node.bbMax = left.bbMax;
+            Grow(node.bbMin, node.bbMax, right.bbMin, right.bbMax);
+        }
+    }
+}
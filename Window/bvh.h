@@ -0,0 +1,41 @@
+// bvh.h - bounding volume hierarchy over instances bounding boxes
+#pragma once
+
+#include <directxmath.h>
+#include <vector>
+#include "bounds.h"
+
+using namespace DirectX;
+
+class BVH {
+public:
+    struct Node {
+        XMFLOAT3 bbMin;
+        int left; // index of left child (right child is left + 1), -1 for leaves
+        XMFLOAT3 bbMax;
+        int first; // first primitive of the subtree in indices array
+        int count; // primitives count of the subtree
+    };
+
+    // Function to build hierarchy with binned surface area heuristic
+    void Build(const AABBSoA& boxes);
+    // Function to update nodes bounding boxes after primitives moved, tree topology is kept
+    void Refit(const AABBSoA& boxes);
+    // Function to clear hierarchy
+    void Release() { m_nodes.clear(); m_indices.clear(); m_centers.clear(); };
+
+    const std::vector<Node>& GetNodes() const { return m_nodes; };
+    const std::vector<int>& GetIndices() const { return m_indices; };
+    // Function to get primitives count the hierarchy was built for
+    int GetPrimitiveCount() const { return (int)m_indices.size(); };
+
+private:
+    // Function to calculate node bounding box from its primitives
+    void UpdateNodeBounds(int nodeIdx, const AABBSoA& boxes);
+    // Function to split node in two by the cheapest plane
+    bool Subdivide(int nodeIdx, const AABBSoA& boxes);
+
+    std::vector<Node> m_nodes;
+    std::vector<int> m_indices;
+    std::vector<XMFLOAT3> m_centers;
+};
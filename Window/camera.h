@@ -19,6 +19,8 @@ public:
     void GetBaseViewMatrix(XMMATRIX& viewMatrix) { viewMatrix = m_viewMatrix; };
     // Function to get camera position
     XMFLOAT3 GetCameraPosition(void);
+    // Function to set point camera orbits around
+    void SetPointOfInterest(const XMFLOAT3& point) { m_pointOfInterest = point; };
 private:
     XMMATRIX m_viewMatrix;
     XMFLOAT3 m_pointOfInterest;
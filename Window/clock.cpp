@@ -0,0 +1,8 @@
+#include "clock.h"
+#include <chrono>
+
+// Function to get current time in nanoseconds from arbitrary start point
+int64_t SystemClock::GetNanoseconds() const {
+    // steady_clock is monotonic and uses QueryPerformanceCounter on Windows and CLOCK_MONOTONIC on Linux
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,33 @@
+// clock.h - monotonic time sources for frame timing
+#pragma once
+
+#include <cstdint>
+
+// Monotonic time source, ticks are nanoseconds
+class Clock {
+public:
+    virtual ~Clock() {};
+    // Function to get current time in nanoseconds from arbitrary start point
+    virtual int64_t GetNanoseconds() const = 0;
+
+    double GetSeconds() const { return GetNanoseconds() * 1e-9; };
+};
+
+// High resolution system clock
+class SystemClock : public Clock {
+public:
+    int64_t GetNanoseconds() const override;
+};
+
+// Manually advanced clock for deterministic timing
+class FakeClock : public Clock {
+public:
+    int64_t GetNanoseconds() const override { return m_nanoseconds; };
+
+    // Function to move time forward
+    void Advance(int64_t nanoseconds) { m_nanoseconds += nanoseconds; };
+    void AdvanceSeconds(double seconds) { m_nanoseconds += (int64_t)(seconds * 1e9); };
+
+private:
+    int64_t m_nanoseconds = 0;
+};
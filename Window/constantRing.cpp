@@ -0,0 +1,138 @@
+#include "constantRing.h"
+#include <cassert>
+
+// Function to create ring buffer and fence queries, fails if driver can't bind constant buffers by offset
+HRESULT ConstantRing::Init(ID3D11Device* device, ID3D11DeviceContext* context, UINT size) {
+    HRESULT hr = S_OK;
+    m_pContext = context;
+
+    // D3D11.1 features: *SetConstantBuffers1 offsets and appending to mapped constant buffer without discard
+    D3D11_FEATURE_DATA_D3D11_OPTIONS options = {};
+    hr = device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options));
+    if (SUCCEEDED(hr) && !(options.ConstantBufferOffsetting && options.MapNoOverwriteOnDynamicConstantBuffer)) {
+        hr = E_FAIL;
+    }
+    assert(SUCCEEDED(hr));
+
+    if (SUCCEEDED(hr)) {
+        D3D11_BUFFER_DESC desc = {};
+        desc.ByteWidth = size;
+        desc.Usage = D3D11_USAGE_DYNAMIC;
+        desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        desc.MiscFlags = 0;
+        desc.StructureByteStride = 0;
+
+        hr = device->CreateBuffer(&desc, nullptr, &m_pBuffer);
+        assert(SUCCEEDED(hr));
+    }
+
+    D3D11_QUERY_DESC desc;
+    desc.Query = D3D11_QUERY_EVENT;
+    desc.MiscFlags = 0;
+    for (int i = 0; i < MaxFramesInFlight && SUCCEEDED(hr); i++) {
+        hr = device->CreateQuery(&desc, &m_fenceQueries[i]);
+        assert(SUCCEEDED(hr));
+    }
+
+    if (SUCCEEDED(hr)) {
+        m_allocator.Init(size, Alignment);
+        m_nextFence = 1;
+        m_completedFence = 0;
+        m_isDiscarded = false;
+    }
+
+    if (FAILED(hr)) {
+        Release();
+    }
+
+    return hr;
+}
+
+// Clean up all the objects we've created
+void ConstantRing::Release() {
+    Unmap();
+    SAFE_RELEASE(m_pBuffer);
+    for (int i = 0; i < MaxFramesInFlight; i++) {
+        SAFE_RELEASE(m_fenceQueries[i]);
+    }
+    m_allocator.Release();
+    m_pContext = nullptr;
+}
+
+// Function to advance completed fence by finished queries, waits until given fence completes
+void ConstantRing::UpdateCompletedFence(uint64_t waitFence) {
+    while (m_completedFence + 1 < m_nextFence) {
+        uint64_t fence = m_completedFence + 1;
+        bool wait = fence <= waitFence;
+        // Waiting needs flush so GPU gets commands before fence, polling must not cause one
+        HRESULT hr = m_pContext->GetData(m_fenceQueries[fence % MaxFramesInFlight], nullptr, 0, wait ? 0 : D3D11_ASYNC_GETDATA_DONOTFLUSH);
+        if (hr == S_OK) {
+            m_completedFence = fence;
+        }
+        else if (!wait || FAILED(hr)) {
+            break;
+        }
+    }
+    m_allocator.Retire(m_completedFence);
+}
+
+// Function to free ranges of frames finished by GPU and map ring for writing
+HRESULT ConstantRing::BeginFrame() {
+    UpdateCompletedFence();
+
+    // Live ranges are tracked by fences, so ring is appended to without discard after first map
+    D3D11_MAPPED_SUBRESOURCE subresource;
+    HRESULT hr = m_pContext->Map(m_pBuffer, 0, m_isDiscarded ? D3D11_MAP_WRITE_NO_OVERWRITE : D3D11_MAP_WRITE_DISCARD, 0, &subresource);
+    assert(SUCCEEDED(hr));
+
+    if (SUCCEEDED(hr)) {
+        m_pMapped = static_cast<BYTE*>(subresource.pData);
+        m_isDiscarded = true;
+    }
+
+    return hr;
+}
+
+// Function to sub-allocate size bytes of mapped ring, waits for GPU if ring is full
+bool ConstantRing::Allocate(UINT size, Allocation& allocation) {
+    if (!m_pMapped) {
+        return false;
+    }
+
+    uint32_t offset = 0;
+    while (!m_allocator.Allocate(size, offset)) {
+        uint64_t fence = 0;
+        // Nothing to wait for, allocation is larger than ring
+        if (!m_allocator.GetOldestFence(fence)) {
+            return false;
+        }
+        UpdateCompletedFence(fence);
+    }
+
+    allocation.pBuffer = m_pBuffer;
+    allocation.firstConstant = offset / 16;
+    allocation.numConstants = ((size + Alignment - 1) & ~(Alignment - 1)) / 16;
+    allocation.pData = m_pMapped + offset;
+    return true;
+}
+
+// Function to unmap ring, must be called before GPU uses allocations
+void ConstantRing::Unmap() {
+    if (m_pMapped) {
+        m_pContext->Unmap(m_pBuffer, 0);
+        m_pMapped = nullptr;
+    }
+}
+
+// Function to put fence after GPU work that uses allocations of this frame
+void ConstantRing::EndFrame() {
+    // Query of oldest fence is reused, so it has to be completed
+    if (m_nextFence > MaxFramesInFlight) {
+        UpdateCompletedFence(m_nextFence - MaxFramesInFlight);
+    }
+
+    m_pContext->End(m_fenceQueries[m_nextFence % MaxFramesInFlight]);
+    m_allocator.EndFrame(m_nextFence);
+    m_nextFence++;
+}
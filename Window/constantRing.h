@@ -0,0 +1,58 @@
+// constantRing.h - class for per-frame constant data sub-allocated from one dynamic constant buffer
+#pragma once
+
+#include <d3d11_1.h>
+#include <vector>
+#include "ringAllocator.h"
+#include "utility.h"
+
+class ConstantRing {
+public:
+    // Range of ring buffer bound by offset, in 16-byte constants as *SetConstantBuffers1 take it
+    struct Allocation {
+        ID3D11Buffer* pBuffer = nullptr;
+        UINT firstConstant = 0;
+        UINT numConstants = 0;
+        void* pData = nullptr;  // valid until Unmap
+    };
+
+    // Offsets and sizes of constant buffer bindings must be multiples of 16 constants
+    static const UINT Alignment = 256;
+    // Fences kept by event queries
+    static const int MaxFramesInFlight = 8;
+
+    // Function to create ring buffer and fence queries, fails if driver can't bind constant buffers by offset
+    HRESULT Init(ID3D11Device* device, ID3D11DeviceContext* context, UINT size = 64 * 1024);
+    // Clean up all the objects we've created
+    void Release();
+
+    // Function to free ranges of frames finished by GPU and map ring for writing
+    HRESULT BeginFrame();
+    // Function to sub-allocate size bytes of mapped ring, waits for GPU if ring is full
+    bool Allocate(UINT size, Allocation& allocation);
+    // Function to allocate constant buffer of given type, returns nullptr on failure
+    template <class T>
+    T* Allocate(Allocation& allocation) { return Allocate(sizeof(T), allocation) ? static_cast<T*>(allocation.pData) : nullptr; };
+    // Function to unmap ring, must be called before GPU uses allocations
+    void Unmap();
+    // Function to put fence after GPU work that uses allocations of this frame
+    void EndFrame();
+
+    const RingAllocator::Stats& GetStats() const { return m_allocator.GetStats(); };
+    UINT GetUsed() const { return m_allocator.GetUsed(); };
+
+private:
+    // Function to advance completed fence by finished queries, waits until given fence completes
+    void UpdateCompletedFence(uint64_t waitFence = 0);
+
+    ID3D11DeviceContext* m_pContext = nullptr;
+    ID3D11Buffer* m_pBuffer = nullptr;
+    ID3D11Query* m_fenceQueries[MaxFramesInFlight] = {};
+
+    RingAllocator m_allocator;
+    uint64_t m_nextFence = 1;
+    uint64_t m_completedFence = 0;
+
+    BYTE* m_pMapped = nullptr;
+    bool m_isDiscarded = false;
+};
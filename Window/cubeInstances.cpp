@@ -0,0 +1,316 @@
+#include "cubeInstances.h"
+#include <algorithm>
+
+namespace {
+    // Local bounding box of cube geometry
+    const XMFLOAT4 CubeMin = XMFLOAT4(-0.5f, -0.5f, -0.5f, 1.0f);
+    const XMFLOAT4 CubeMax = XMFLOAT4(0.5f, 0.5f, 0.5f, 1.0f);
+}
+
+// Function to initialize instances storage, per-instance loops are split across job system if it is given
+void CubeInstances::Init(int capacity, JobSystem* jobSystem) {
+    m_pJobSystem = jobSystem;
+    m_posX.reserve(capacity);
+    m_posY.reserve(capacity);
+    m_posZ.reserve(capacity);
+    m_angularSpeed.reserve(capacity);
+    m_materials.reserve(capacity);
+    m_dirty.reserve(capacity);
+    m_slots.reserve(capacity);
+    m_indexSlots.reserve(capacity);
+    m_geomBuffers.reserve(capacity);
+    m_cullBoxes.reserve(capacity);
+    m_visible.reserve(capacity);
+}
+
+// Function to clear instances storage
+void CubeInstances::Release() {
+    m_posX.clear();
+    m_posY.clear();
+    m_posZ.clear();
+    m_angularSpeed.clear();
+    m_materials.clear();
+    m_bounds.Resize(0);
+    m_dirty.clear();
+    m_slots.clear();
+    m_indexSlots.clear();
+    m_freeSlots.clear();
+    m_geomBuffers.clear();
+    m_cullBoxes.clear();
+    m_visible.clear();
+    m_rangeVisible.clear();
+    m_dirtyRanges.clear();
+    m_rangeDirty.clear();
+    m_rangeRebuilt.clear();
+    m_stats = UpdateStats();
+    m_bvh.Release();
+    m_isBVHDirty = true;
+    m_movingCount = 0;
+    m_hasDirty = false;
+    m_isAllVisible = false;
+    m_pJobSystem = nullptr;
+}
+
+// Function to add cube
+CubeInstances::Handle CubeInstances::Add(const CubeModel& cube) {
+    int index = GetCount();
+
+    // Reuse free slot or make new one
+    Handle handle;
+    if (!m_freeSlots.empty()) {
+        handle.slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+    else {
+        handle.slot = (int)m_slots.size();
+        m_slots.push_back({ -1, 0 });
+    }
+    m_slots[handle.slot].index = index;
+    handle.generation = m_slots[handle.slot].generation;
+    m_indexSlots.push_back(handle.slot);
+
+    m_posX.push_back(cube.pos.x);
+    m_posY.push_back(cube.pos.y);
+    m_posZ.push_back(cube.pos.z);
+    m_angularSpeed.push_back(cube.pos.w * cube.shineSpeedIdNM.y);
+    m_materials.push_back(cube.shineSpeedIdNM);
+    m_bounds.Resize(index + 1);
+    m_dirty.push_back(1);
+    m_hasDirty = true;
+
+    GeomBuffer geomBuffer;
+    geomBuffer.material = PackMaterial(cube.shineSpeedIdNM.x, cube.shineSpeedIdNM.z, cube.shineSpeedIdNM.w > 0.0f);
+    m_geomBuffers.push_back(geomBuffer);
+    m_cullBoxes.push_back(CullBox());
+
+    m_movingCount += m_angularSpeed[index] != 0.0f;
+    m_isBVHDirty = true;
+    return handle;
+}
+
+// Function to add count cubes from component streams, material is (specular power, rotation speed, texture id, normal map presence)
+void CubeInstances::Add(int count, const float* posX, const float* posY, const float* posZ, const float* angularSpeed, const XMFLOAT4* materials) {
+    if (count <= 0) {
+        return;
+    }
+
+    int first = GetCount();
+    m_posX.insert(m_posX.end(), posX, posX + count);
+    m_posY.insert(m_posY.end(), posY, posY + count);
+    m_posZ.insert(m_posZ.end(), posZ, posZ + count);
+    m_angularSpeed.insert(m_angularSpeed.end(), angularSpeed, angularSpeed + count);
+    m_materials.insert(m_materials.end(), materials, materials + count);
+    m_bounds.Resize(first + count);
+    m_dirty.resize(first + count, 1);
+    m_geomBuffers.resize(first + count);
+    m_cullBoxes.resize(first + count);
+    m_slots.reserve(m_slots.size() + count);
+    m_indexSlots.reserve(first + count);
+
+    for (int i = first; i < first + count; i++) {
+        int slot;
+        if (!m_freeSlots.empty()) {
+            slot = m_freeSlots.back();
+            m_freeSlots.pop_back();
+        }
+        else {
+            slot = (int)m_slots.size();
+            m_slots.push_back({ -1, 0 });
+        }
+        m_slots[slot].index = i;
+        m_indexSlots.push_back(slot);
+
+        const XMFLOAT4& material = m_materials[i];
+        m_geomBuffers[i].material = PackMaterial(material.x, material.z, material.w > 0.0f);
+        m_movingCount += m_angularSpeed[i] != 0.0f;
+    }
+
+    m_hasDirty = true;
+    m_isBVHDirty = true;
+}
+
+// Function to remove cube, last cube is moved into its place
+bool CubeInstances::Remove(Handle handle) {
+    if (!IsValid(handle)) {
+        return false;
+    }
+
+    int index = m_slots[handle.slot].index;
+    int last = GetCount() - 1;
+    m_movingCount -= m_angularSpeed[index] != 0.0f;
+
+    if (index != last) {
+        m_posX[index] = m_posX[last];
+        m_posY[index] = m_posY[last];
+        m_posZ[index] = m_posZ[last];
+        m_angularSpeed[index] = m_angularSpeed[last];
+        m_materials[index] = m_materials[last];
+        m_bounds.Copy(last, index);
+        // Moved cube is in new place of GPU buffers
+        m_dirty[index] = 1;
+        m_hasDirty = true;
+        m_geomBuffers[index] = m_geomBuffers[last];
+        m_cullBoxes[index] = m_cullBoxes[last];
+
+        m_indexSlots[index] = m_indexSlots[last];
+        m_slots[m_indexSlots[index]].index = index;
+    }
+
+    m_posX.pop_back();
+    m_posY.pop_back();
+    m_posZ.pop_back();
+    m_angularSpeed.pop_back();
+    m_materials.pop_back();
+    m_bounds.Resize(last);
+    m_dirty.pop_back();
+    m_geomBuffers.pop_back();
+    m_cullBoxes.pop_back();
+    m_indexSlots.pop_back();
+
+    // Invalidate handles of removed cube
+    m_slots[handle.slot].index = -1;
+    m_slots[handle.slot].generation++;
+    m_freeSlots.push_back(handle.slot);
+
+    m_isBVHDirty = true;
+    return true;
+}
+
+// Function to check if cube of handle exists
+bool CubeInstances::IsValid(Handle handle) const {
+    return handle.slot >= 0 && handle.slot < (int)m_slots.size() &&
+        m_slots[handle.slot].generation == handle.generation && m_slots[handle.slot].index >= 0;
+}
+
+// Function to get handle of cube with index
+CubeInstances::Handle CubeInstances::GetHandle(int index) const {
+    Handle handle;
+    if (index >= 0 && index < GetCount()) {
+        handle.slot = m_indexSlots[index];
+        handle.generation = m_slots[handle.slot].generation;
+    }
+    return handle;
+}
+
+// Function to mark all cubes changed, e.g. after GPU buffers recreation
+void CubeInstances::MarkAllDirty() {
+    std::fill(m_dirty.begin(), m_dirty.end(), (unsigned char)1);
+    m_hasDirty = !m_dirty.empty();
+}
+
+// Function to recalculate world matrices, bounding boxes and shader data of moving and changed cubes for given time
+void CubeInstances::Update(float time) {
+    int count = GetCount();
+    m_dirtyRanges.clear();
+    m_stats = UpdateStats();
+
+    // Static scene keeps cached data
+    if (m_movingCount == 0 && !m_hasDirty) {
+        return;
+    }
+
+    int rangesCount = JobSystem::GetRangesCount(0, count, UpdateGrain);
+    if ((int)m_rangeDirty.size() < rangesCount) {
+        m_rangeDirty.resize(rangesCount);
+        m_rangeRebuilt.resize(rangesCount);
+    }
+
+    // Every cube writes only its own slots, so ranges are independent.
+    // Only transform and animation streams are read, material part of shader data is already in place
+    ForEachRange(count, UpdateGrain, [this, time](int first, int last) {
+        std::vector<DirtyRange>& dirtyRanges = m_rangeDirty[first / UpdateGrain];
+        int& rebuilt = m_rangeRebuilt[first / UpdateGrain];
+        dirtyRanges.clear();
+        rebuilt = 0;
+
+        XMVECTOR localMin = XMLoadFloat4(&CubeMin);
+        XMVECTOR localMax = XMLoadFloat4(&CubeMax);
+        for (int i = first; i < last; i++) {
+            if (m_angularSpeed[i] == 0.0f && !m_dirty[i]) {
+                continue;
+            }
+            m_dirty[i] = 0;
+            rebuilt++;
+            AppendRange(dirtyRanges, i, i + 1);
+
+            XMMATRIX world = XMMatrixRotationY(m_angularSpeed[i] * time) * XMMatrixTranslation(m_posX[i], m_posY[i], m_posZ[i]);
+            EncodeInstance(world, m_geomBuffers[i].material, m_geomBuffers[i]);
+
+            TransformBox(world, localMin, localMax, m_bounds, i);
+            m_cullBoxes[i].bbMin = XMFLOAT4(m_bounds.minX[i], m_bounds.minY[i], m_bounds.minZ[i], 1.0f);
+            m_cullBoxes[i].bbMax = XMFLOAT4(m_bounds.maxX[i], m_bounds.maxY[i], m_bounds.maxZ[i], 1.0f);
+        }
+    });
+    m_hasDirty = false;
+
+    // Merge in range order, so the result doesn't depend on threads timing
+    for (int i = 0; i < rangesCount; i++) {
+        m_stats.rebuilt += m_rangeRebuilt[i];
+        for (const DirtyRange& range : m_rangeDirty[i]) {
+            AppendRange(m_dirtyRanges, range.first, range.last);
+        }
+    }
+    for (const DirtyRange& range : m_dirtyRanges) {
+        m_stats.uploaded += range.last - range.first;
+    }
+    m_stats.uploadRanges = (int)m_dirtyRanges.size();
+}
+
+// Function to append range to sorted ranges merging it with last one if they are close
+void CubeInstances::AppendRange(std::vector<DirtyRange>& ranges, int first, int last) {
+    if (!ranges.empty() && first - ranges.back().last <= DirtyRangeGap) {
+        ranges.back().last = (std::max)(ranges.back().last, last);
+    }
+    else {
+        ranges.push_back({ first, last });
+    }
+}
+
+// Function to find visible cubes, all cubes are visible if frustum is null and then visible list isn't built
+void CubeInstances::Cull(Frustum* frustum, bool useBVH) {
+    int count = GetCount();
+    m_visible.clear();
+    m_isAllVisible = frustum == nullptr;
+
+    if (m_isAllVisible) {
+        return;
+    }
+
+    if (useBVH) {
+        if (m_isBVHDirty || m_bvh.GetPrimitiveCount() != count) {
+            m_bvh.Build(m_bounds);
+            m_isBVHDirty = false;
+        }
+        else if (m_movingCount > 0) {
+            m_bvh.Refit(m_bounds);
+        }
+        frustum->CheckBVH(m_bvh, m_bounds, m_visible);
+    }
+    else {
+        // Cull ranges separately and merge them in order to keep output independent of threads timing
+        int rangesCount = JobSystem::GetRangesCount(0, count, CullGrain);
+        if ((int)m_rangeVisible.size() < rangesCount) {
+            m_rangeVisible.resize(rangesCount);
+        }
+        ForEachRange(count, CullGrain, [this, frustum](int first, int last) {
+            std::vector<int>& rangeVisible = m_rangeVisible[first / CullGrain];
+            rangeVisible.clear();
+            frustum->CheckRectangles(m_bounds, first, last, rangeVisible);
+        });
+        for (int i = 0; i < rangesCount; i++) {
+            m_visible.insert(m_visible.end(), m_rangeVisible[i].begin(), m_rangeVisible[i].end());
+        }
+    }
+}
+
+// Function to process [0, count) in ranges on job system or on calling thread
+void CubeInstances::ForEachRange(int count, int grain, const JobSystem::RangeFunc& func) {
+    if (m_pJobSystem != nullptr) {
+        m_pJobSystem->ParallelFor(0, count, grain, func);
+    }
+    else {
+        for (int first = 0; first < count; first += grain) {
+            func(first, (std::min)(first + grain, count));
+        }
+    }
+}
@@ -0,0 +1,151 @@
+// cubeInstances.h - class for cubes instances data stored as separate component streams
+#pragma once
+
+#include <directxmath.h>
+#include <vector>
+#include "alignedAllocator.h"
+#include "bounds.h"
+#include "bvh.h"
+#include "frustum.h"
+#include "instanceFormat.h"
+#include "jobSystem.h"
+
+using namespace DirectX;
+
+class CubeInstances {
+public:
+    // Description of cube to add
+    struct CubeModel {
+        XMFLOAT4 pos; // w - rotation direction
+        XMFLOAT4 shineSpeedIdNM;
+    };
+
+    // Instance data in layout of GeomBuffer shader structure
+    typedef PackedInstance GeomBuffer;
+
+    // Bounding box in layout of CullBox shader structure
+    struct CullBox {
+        XMFLOAT4 bbMin;
+        XMFLOAT4 bbMax;
+    };
+
+    // Range [first, last) of cubes with changed shader data
+    struct DirtyRange {
+        int first;
+        int last;
+    };
+
+    // Per-frame update counters
+    struct UpdateStats {
+        int rebuilt = 0;      // cubes with recalculated matrices and bounds
+        int uploaded = 0;     // cubes covered by dirty ranges
+        int uploadRanges = 0; // dirty ranges count
+    };
+
+    // Stable cube id, stays valid while cube exists regardless of removals of other cubes
+    struct Handle {
+        int slot = -1;
+        unsigned int generation = 0;
+    };
+
+    // Function to initialize instances storage, per-instance loops are split across job system if it is given
+    void Init(int capacity, JobSystem* jobSystem = nullptr);
+    // Function to clear instances storage
+    void Release();
+    // Function to add cube
+    Handle Add(const CubeModel& cube);
+    // Function to add count cubes from component streams, material is (specular power, rotation speed, texture id, normal map presence)
+    void Add(int count, const float* posX, const float* posY, const float* posZ, const float* angularSpeed, const XMFLOAT4* materials);
+    // Function to remove cube, last cube is moved into its place
+    bool Remove(Handle handle);
+    // Function to check if cube of handle exists
+    bool IsValid(Handle handle) const;
+    // Function to get current cube index of handle, -1 if cube doesn't exist
+    int GetIndex(Handle handle) const { return IsValid(handle) ? m_slots[handle.slot].index : -1; };
+    // Function to get handle of cube with index
+    Handle GetHandle(int index) const;
+    // Function to mark all cubes changed, e.g. after GPU buffers recreation
+    void MarkAllDirty();
+    // Function to recalculate world matrices, bounding boxes and shader data of moving and changed cubes for given time
+    void Update(float time);
+    // Function to find visible cubes, all cubes are visible if frustum is null and then visible list isn't built
+    void Cull(Frustum* frustum, bool useBVH);
+
+    int GetCount() const { return (int)m_indexSlots.size(); };
+    // Component streams
+    const AlignedVector<float>& GetPositionsX() const { return m_posX; };
+    const AlignedVector<float>& GetPositionsY() const { return m_posY; };
+    const AlignedVector<float>& GetPositionsZ() const { return m_posZ; };
+    const AlignedVector<float>& GetAngularSpeeds() const { return m_angularSpeed; };
+    const AlignedVector<XMFLOAT4>& GetMaterials() const { return m_materials; };
+
+    const std::vector<GeomBuffer>& GetGeomBuffers() const { return m_geomBuffers; };
+    const std::vector<CullBox>& GetCullBoxes() const { return m_cullBoxes; };
+    // Visible cubes found by last Cull, empty if all cubes are visible
+    const std::vector<int>& GetVisible() const { return m_visible; };
+    bool IsAllVisible() const { return m_isAllVisible; };
+    int GetVisibleCount() const { return m_isAllVisible ? GetCount() : (int)m_visible.size(); };
+    // Ranges changed by last Update, sorted and coalesced
+    const std::vector<DirtyRange>& GetDirtyRanges() const { return m_dirtyRanges; };
+    const UpdateStats& GetUpdateStats() const { return m_stats; };
+
+private:
+    // Instances count processed by one job
+    static const int UpdateGrain = 4096;
+    static const int CullGrain = 16384;
+    // Max count of unchanged cubes between two dirty ranges to upload them as one range
+    static const int DirtyRangeGap = 16;
+
+    // Function to process [0, count) in ranges on job system or on calling thread
+    void ForEachRange(int count, int grain, const JobSystem::RangeFunc& func);
+    // Function to append range to sorted ranges merging it with last one if they are close
+    static void AppendRange(std::vector<DirtyRange>& ranges, int first, int last);
+
+    // Handle slot, points to cube index while cube exists
+    struct Slot {
+        int index;
+        unsigned int generation;
+    };
+
+    JobSystem* m_pJobSystem = nullptr;
+
+    // Transform component
+    AlignedVector<float> m_posX;
+    AlignedVector<float> m_posY;
+    AlignedVector<float> m_posZ;
+    // Animation component: signed rotation speed around Y
+    AlignedVector<float> m_angularSpeed;
+    // Material component: x - specular power, y - rotation speed, z - texture id, w - normal map presence
+    AlignedVector<XMFLOAT4> m_materials;
+    // Bounds component
+    AABBSoA m_bounds;
+    // Changed cubes which shader data must be rebuilt even if they don't move
+    AlignedVector<unsigned char> m_dirty;
+
+    // Handles data
+    std::vector<Slot> m_slots;
+    std::vector<int> m_indexSlots;
+    std::vector<int> m_freeSlots;
+
+    // Shader data, material is packed on add
+    std::vector<GeomBuffer> m_geomBuffers;
+    std::vector<CullBox> m_cullBoxes;
+    std::vector<int> m_visible;
+    // Visible cubes of every cull range, merged in range order
+    std::vector<std::vector<int>> m_rangeVisible;
+    std::vector<DirtyRange> m_dirtyRanges;
+    // Dirty ranges and rebuilt count of every update range, merged in range order
+    std::vector<std::vector<DirtyRange>> m_rangeDirty;
+    std::vector<int> m_rangeRebuilt;
+    UpdateStats m_stats;
+    BVH m_bvh;
+
+    // flag to rebuild bounding volume hierarchy
+    bool m_isBVHDirty = true;
+    // count of rotating cubes
+    int m_movingCount = 0;
+    // flag that some cube is marked dirty
+    bool m_hasDirty = false;
+    // flag that last Cull had no frustum
+    bool m_isAllVisible = false;
+};
@@ -1,11 +1,22 @@
 #include "cubeMap.h"
 
+// Function to add tasks generating sphere and compiling shaders, they run before Init
+void CubeMap::AddLoadTasks(TaskGraph& graph, ShaderCompiler* shaderCompiler, std::vector<int>& tasks) {
+    int flags = 0;
+#ifdef _DEBUG
+    flags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#endif
+    tasks.push_back(graph.AddTask("CubeMap::GenerateSphere", [this]() { GenerateSphere(10, 10); return true; }));
+    tasks.push_back(shaderCompiler->AddCompileTask(graph, "CubeMapVertexShader.hlsl", NULL, "main", "vs_5_0", flags, &m_pVertexShaderBuffer));
+    tasks.push_back(shaderCompiler->AddCompileTask(graph, "CubeMapPixelShader.hlsl", NULL, "main", "ps_5_0", flags, &m_pPixelShaderBuffer));
+}
+
 // Initialize all needed instances
-HRESULT CubeMap::Init(ID3D11Device* device, ID3D11DeviceContext* context, int screenWidth, int screenHeight) {
+HRESULT CubeMap::Init(ID3D11Device* device, ID3D11DeviceContext* context, PipelineStateCache* stateCache, int screenWidth, int screenHeight) {
     HRESULT hr = S_OK;
 
     if (SUCCEEDED(hr)) {
-        hr = InitScene(device, context, 10, 10);
+        hr = InitScene(device, context, stateCache);
     }
 
     if (FAILED(hr)) {
@@ -33,16 +44,16 @@ void CubeMap::Release() {
     SAFE_RELEASE(m_pInputLayout);
     SAFE_RELEASE(m_pVertexShader);
     SAFE_RELEASE(m_pRasterizerState);
-    SAFE_RELEASE(m_pSceneMatrixBuffer);
-    SAFE_RELEASE(m_pWorldMatrixBuffer);
     SAFE_RELEASE(m_pPixelShader);
     SAFE_RELEASE(m_pSampler);
-    SAFE_RELEASE(m_pTexture);
+    SAFE_RELEASE(m_pVertexShaderBuffer);
+    SAFE_RELEASE(m_pPixelShaderBuffer);
+    m_vertices.clear();
+    m_indices.clear();
 }
 
-// Function to initialize scene's geometry
-HRESULT CubeMap::InitScene(ID3D11Device* device, ID3D11DeviceContext* context, UINT LatLines, UINT LongLines) {
-    HRESULT hr = S_OK;
+// Function to fill sphere vertices and indices
+void CubeMap::GenerateSphere(UINT LatLines, UINT LongLines) {
     // Create vertex array
     m_numSphereVertices = ((LatLines - 2) * LongLines) + 2;
     m_numSphereFaces = ((LatLines - 3) * (LongLines) * 2) + (LongLines * 2);
@@ -50,7 +61,8 @@ HRESULT CubeMap::InitScene(ID3D11Device* device, ID3D11DeviceContext* context, U
     float sphereYaw = 0.0f;
     float spherePitch = 0.0f;
 
-    std::vector<Vertex> vertices(m_numSphereVertices);
+    std::vector<Vertex>& vertices = m_vertices;
+    vertices.assign(m_numSphereVertices, Vertex());
 
     XMVECTOR currVertPos = XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f);
     
@@ -77,7 +89,8 @@ HRESULT CubeMap::InitScene(ID3D11Device* device, ID3D11DeviceContext* context, U
     vertices[static_cast<__int64>(m_numSphereVertices) - 1].z = -1.0f;
 
     // Create index array
-    std::vector<UINT> indices(static_cast<__int64>(m_numSphereFaces) * 3);
+    std::vector<UINT>& indices = m_indices;
+    indices.assign(static_cast<__int64>(m_numSphereFaces) * 3, 0);
 
     int k = 0;
     for (UINT i = 0; i < LongLines - 1; i++) {
@@ -125,6 +138,11 @@ HRESULT CubeMap::InitScene(ID3D11Device* device, ID3D11DeviceContext* context, U
     indices[k] = m_numSphereVertices - 1;
     indices[static_cast<__int64>(k) + 1] = (m_numSphereVertices - 1) - LongLines;
     indices[static_cast<__int64>(k) + 2] = m_numSphereVertices - 2;
+}
+
+// Function to initialize scene's geometry
+HRESULT CubeMap::InitScene(ID3D11Device* device, ID3D11DeviceContext* context, PipelineStateCache* stateCache) {
+    HRESULT hr = S_OK;
 
     static const D3D11_INPUT_ELEMENT_DESC InputDesc[] = {
         {"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
@@ -141,7 +159,7 @@ HRESULT CubeMap::InitScene(ID3D11Device* device, ID3D11DeviceContext* context, U
 
         D3D11_SUBRESOURCE_DATA data;
         ZeroMemory(&data, sizeof(data));
-        data.pSysMem = &vertices[0];
+        data.pSysMem = &m_vertices[0];
         hr = device->CreateBuffer(&desc, &data, &m_pVertexBuffer);
         assert(SUCCEEDED(hr));
     }
@@ -158,68 +176,25 @@ HRESULT CubeMap::InitScene(ID3D11Device* device, ID3D11DeviceContext* context, U
         desc.StructureByteStride = 0;
 
         D3D11_SUBRESOURCE_DATA data;
-        data.pSysMem = &indices[0];
+        data.pSysMem = &m_indices[0];
 
         hr = device->CreateBuffer(&desc, &data, &m_pIndexBuffer);
         assert(SUCCEEDED(hr));
     }
 
-    ID3D10Blob* vertexShaderBuffer = nullptr;
-    ID3D10Blob* pixelShaderBuffer = nullptr;
-    int flags = 0;
-    #ifdef _DEBUG
-    flags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
-    #endif
-
     if (SUCCEEDED(hr)) {
-        hr = D3DCompileFromFile(L"CubeMapVertexShader.hlsl", NULL, NULL, "main", "vs_5_0", flags, 0, &vertexShaderBuffer, NULL);
-        hr = device->CreateVertexShader(vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), NULL, &m_pVertexShader);
+        hr = device->CreateVertexShader(m_pVertexShaderBuffer->GetBufferPointer(), m_pVertexShaderBuffer->GetBufferSize(), NULL, &m_pVertexShader);
     }
     if (SUCCEEDED(hr)) {
-        hr = D3DCompileFromFile(L"CubeMapPixelShader.hlsl", NULL, NULL, "main", "ps_5_0", flags, 0, &pixelShaderBuffer, NULL);
-        hr = device->CreatePixelShader(pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize(), NULL, &m_pPixelShader);
+        hr = device->CreatePixelShader(m_pPixelShaderBuffer->GetBufferPointer(), m_pPixelShaderBuffer->GetBufferSize(), NULL, &m_pPixelShader);
     }
     if (SUCCEEDED(hr)) {
         int numElements = sizeof(InputDesc) / sizeof(InputDesc[0]);
-        hr = device->CreateInputLayout(InputDesc, numElements, vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), &m_pInputLayout);
-    }
-
-    SAFE_RELEASE(vertexShaderBuffer);
-    SAFE_RELEASE(pixelShaderBuffer);
-
-    // Set constant buffers
-    if (SUCCEEDED(hr)) {
-        D3D11_BUFFER_DESC desc = {};
-        desc.ByteWidth = sizeof(WorldMatrixBuffer);
-        desc.Usage = D3D11_USAGE_DEFAULT;
-        desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-        desc.CPUAccessFlags = 0;
-        desc.MiscFlags = 0;
-        desc.StructureByteStride = 0;
-
-        WorldMatrixBuffer worldMatrixBuffer;
-        worldMatrixBuffer.mWorldMatrix = DirectX::XMMatrixIdentity();
-
-        D3D11_SUBRESOURCE_DATA data;
-        data.pSysMem = &worldMatrixBuffer;
-        data.SysMemPitch = sizeof(worldMatrixBuffer);
-        data.SysMemSlicePitch = 0;
-
-        hr = device->CreateBuffer(&desc, &data, &m_pWorldMatrixBuffer);
-        assert(SUCCEEDED(hr));
+        hr = device->CreateInputLayout(InputDesc, numElements, m_pVertexShaderBuffer->GetBufferPointer(), m_pVertexShaderBuffer->GetBufferSize(), &m_pInputLayout);
     }
-    if (SUCCEEDED(hr)) {
-        D3D11_BUFFER_DESC desc = {};
-        desc.ByteWidth = sizeof(SceneMatrixBuffer);
-        desc.Usage = D3D11_USAGE_DYNAMIC;
-        desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-        desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-        desc.MiscFlags = 0;
-        desc.StructureByteStride = 0;
 
-        hr = device->CreateBuffer(&desc, nullptr, &m_pSceneMatrixBuffer);
-        assert(SUCCEEDED(hr));
-    }
+    SAFE_RELEASE(m_pVertexShaderBuffer);
+    SAFE_RELEASE(m_pPixelShaderBuffer);
 
     // Set rastrizer state
     if (SUCCEEDED(hr)) {
@@ -235,18 +210,13 @@ HRESULT CubeMap::InitScene(ID3D11Device* device, ID3D11DeviceContext* context, U
         desc.MultisampleEnable = false;
         desc.SlopeScaledDepthBias = 0.0f;
 
-        hr = device->CreateRasterizerState(&desc, &m_pRasterizerState);
+        hr = stateCache->CreateRasterizerState(&desc, &m_pRasterizerState);
         assert(SUCCEEDED(hr));
     }
 
-    // Yeah
-    // Cool architecture
-    // Have texture class but still loading by hands
-    if (SUCCEEDED(hr)) {
-        CreateDDSTextureFromFileEx(device, context, L"data/skymap.dds",
-            0, D3D11_USAGE_DEFAULT, D3D11_BIND_SHADER_RESOURCE, 0, D3D11_RESOURCE_MISC_TEXTURECUBE,
-            false, nullptr, &m_pTexture);
-    }
+    // Loaded data is in device objects now
+    m_vertices.clear();
+    m_indices.clear();
     // Set sampler state
     if (SUCCEEDED(hr)) {
         D3D11_SAMPLER_DESC desc = {};
@@ -262,55 +232,35 @@ HRESULT CubeMap::InitScene(ID3D11Device* device, ID3D11DeviceContext* context, U
         desc.ComparisonFunc = D3D11_COMPARISON_NEVER;
         desc.BorderColor[0] = desc.BorderColor[1] = desc.BorderColor[2] = desc.BorderColor[3] = 0.0f;
 
-        hr = device->CreateSamplerState(&desc, &m_pSampler);
+        hr = stateCache->CreateSamplerState(&desc, &m_pSampler);
         assert(SUCCEEDED(hr));
     }
 
     return hr;
 }
 
-bool CubeMap::Frame(ID3D11DeviceContext* context, XMMATRIX viewMatrix, XMMATRIX projectionMatrix, XMFLOAT3 cameraPos) {
-    // Update world matrix
-    WorldMatrixBuffer worldMatrixBuffer;
-
-    worldMatrixBuffer.mWorldMatrix = XMMatrixIdentity();
-    worldMatrixBuffer.size = XMFLOAT4(m_radius, 0.0f, 0.0f, 0.0f);
-
-    context->UpdateSubresource(m_pWorldMatrixBuffer, 0, nullptr, &worldMatrixBuffer, 0, 0);
-
-    // Update Scene matrix
-    D3D11_MAPPED_SUBRESOURCE subresource;
-    HRESULT hr = context->Map(m_pSceneMatrixBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &subresource);
-    assert(SUCCEEDED(hr));
-    if (SUCCEEDED(hr)) {
-        SceneMatrixBuffer& sceneBuffer = *reinterpret_cast<SceneMatrixBuffer*>(subresource.pData);
-        sceneBuffer.mViewProjectionMatrix = XMMatrixMultiply(viewMatrix, projectionMatrix);
-        sceneBuffer.cameraPos = XMFLOAT4(cameraPos.x , cameraPos.y, cameraPos.z ,1.0f);
-        context->Unmap(m_pSceneMatrixBuffer, 0);
-    }
-
-    return SUCCEEDED(hr);
-}
-
-void CubeMap::Render(ID3D11DeviceContext* context) {
-    context->RSSetState(m_pRasterizerState);
-
-    context->IASetIndexBuffer(m_pIndexBuffer, DXGI_FORMAT_R32_UINT, 0);
-    ID3D11SamplerState* samplers[] = { m_pSampler };
-    context->PSSetSamplers(0, 1, samplers);
-
-    ID3D11ShaderResourceView* resources[] = { m_pTexture };
-    context->PSSetShaderResources(0, 1, resources);
-    ID3D11Buffer* vertexBuffers[] = { m_pVertexBuffer };
-    UINT strides[] = { 12 };
-    UINT offsets[] = { 0 };
-    context->IASetVertexBuffers(0, 1, vertexBuffers, strides, offsets);
-    context->IASetInputLayout(m_pInputLayout);
-    context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    context->VSSetShader(m_pVertexShader, nullptr, 0);
-    context->VSSetConstantBuffers(0, 1, &m_pWorldMatrixBuffer);
-    context->VSSetConstantBuffers(1, 1, &m_pSceneMatrixBuffer);
-    context->PSSetShader(m_pPixelShader, nullptr, 0);
-
-    context->DrawIndexed(m_numSphereFaces * 3, 0, 0);
+// Function to register pipeline and material of sky sphere in backend, depth state is shared with scene
+void CubeMap::RegisterStates(D3D11Backend* backend, ID3D11DepthStencilState* depthState, int textureView) {
+    D3D11Backend::PipelineDesc pipeline;
+    pipeline.pVertexShader = m_pVertexShader;
+    pipeline.pPixelShader = m_pPixelShader;
+    pipeline.pInputLayout = m_pInputLayout;
+    pipeline.pRasterizerState = m_pRasterizerState;
+    pipeline.pDepthState = depthState;
+    m_ids.pipeline = backend->AddPipeline(pipeline);
+
+    // Constant ranges are allocated every frame by Frame
+    m_ids.worldConstants = backend->AddConstants();
+    m_ids.sceneConstants = backend->AddConstants();
+    D3D11Backend::MaterialDesc material;
+    material.pVertexBuffer = m_pVertexBuffer;
+    material.vertexStride = sizeof(Vertex);
+    material.pIndexBuffer = m_pIndexBuffer;
+    material.indexFormat = DXGI_FORMAT_R32_UINT;
+    material.vsConstants[0] = m_ids.worldConstants;
+    material.vsConstants[1] = m_ids.sceneConstants;
+    material.psResources[0] = textureView;
+    material.psSamplers[0] = m_pSampler;
+    m_ids.material = backend->AddMaterial(material);
+    m_ids.indexCount = m_numSphereFaces * 3;
 }
@@ -9,42 +9,46 @@
 #include <vector>
 #include "DDSTextureLoader.h"
 #include "utility.h"
+#include "renderBackend.h"
+#include "skySphere.h"
+#include "pipelineStateCache.h"
+#include "shaderCompiler.h"
 
 using namespace DirectX;
 
-class CubeMap {
+// D3D11 resources of sky sphere, its per-frame work is in SkySphere
+class CubeMap : public SkySphere {
 private:
     struct Vertex {
         float x, y, z;
     };
-    struct WorldMatrixBuffer {
-        XMMATRIX mWorldMatrix;
-        XMFLOAT4 size;
-    };
-    struct SceneMatrixBuffer {
-        XMMATRIX mViewProjectionMatrix;
-        XMFLOAT4 cameraPos;
-    };
 public:
+    // Function to add tasks generating sphere and compiling shaders, they run before Init
+    void AddLoadTasks(TaskGraph& graph, ShaderCompiler* shaderCompiler, std::vector<int>& tasks);
     // Initialize all needed instances
-    HRESULT Init(ID3D11Device* device, ID3D11DeviceContext* context, int screenWidth, int screenHeight);
+    HRESULT Init(ID3D11Device* device, ID3D11DeviceContext* context, PipelineStateCache* stateCache, int screenWidth, int screenHeight);
     // Clean up all the objects we've created
     void Release();
     // Resize function
     void Resize(int screenWidth, int screenHeight);
-    void Render(ID3D11DeviceContext* context);
-
-    // Render the frame
-    bool Frame(ID3D11DeviceContext* context, XMMATRIX viewMatrix, XMMATRIX projectionMatrix, XMFLOAT3 cameraPos);
+    // Function to register pipeline and material of sky sphere in backend, depth state is shared with scene.
+    // Sky texture is backend view updated by owner of streamed texture
+    void RegisterStates(D3D11Backend* backend, ID3D11DepthStencilState* depthState, int textureView);
 
 private:
+    // Function to fill sphere vertices and indices
+    void GenerateSphere(UINT LatLines, UINT LongLines);
     // Function to initialize scene's geometry
-    HRESULT InitScene(ID3D11Device* device, ID3D11DeviceContext* context, UINT LatLines, UINT LongLines);
+    HRESULT InitScene(ID3D11Device* device, ID3D11DeviceContext* context, PipelineStateCache* stateCache);
+
+    // Data prepared by load tasks, released by Init
+    std::vector<Vertex> m_vertices;
+    std::vector<UINT> m_indices;
+    ID3D10Blob* m_pVertexShaderBuffer = nullptr;
+    ID3D10Blob* m_pPixelShaderBuffer = nullptr;
 
     ID3D11Buffer* m_pVertexBuffer = nullptr;
     ID3D11Buffer* m_pIndexBuffer = nullptr;
-    ID3D11Buffer* m_pWorldMatrixBuffer = nullptr;
-    ID3D11Buffer* m_pSceneMatrixBuffer = nullptr;
     ID3D11RasterizerState* m_pRasterizerState = nullptr;
     ID3D11SamplerState* m_pSampler = nullptr;
 
@@ -52,9 +56,6 @@ private:
     ID3D11VertexShader* m_pVertexShader = nullptr;
     ID3D11PixelShader* m_pPixelShader = nullptr;
 
-    ID3D11ShaderResourceView* m_pTexture = nullptr;
-
     int m_numSphereVertices = 0;
     int m_numSphereFaces = 0;
-    float m_radius = 1.0f;
 };
@@ -0,0 +1,464 @@
+#include "ddsFile.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+// Function to get bits per pixel of uncompressed format or per block of compressed one, 0 for unknown format
+uint32_t DdsFile::GetBitsPerElement(Format format) {
+    switch (format) {
+    case FORMAT_R32G32B32A32_FLOAT:
+    case FORMAT_BC2_UNORM:
+    case FORMAT_BC2_UNORM_SRGB:
+    case FORMAT_BC3_UNORM:
+    case FORMAT_BC3_UNORM_SRGB:
+    case FORMAT_BC5_UNORM:
+    case FORMAT_BC5_SNORM:
+    case FORMAT_BC6H_UF16:
+    case FORMAT_BC6H_SF16:
+    case FORMAT_BC7_UNORM:
+    case FORMAT_BC7_UNORM_SRGB:
+        return 128;
+    case FORMAT_R16G16B16A16_FLOAT:
+    case FORMAT_R16G16B16A16_UNORM:
+    case FORMAT_BC1_UNORM:
+    case FORMAT_BC1_UNORM_SRGB:
+    case FORMAT_BC4_UNORM:
+    case FORMAT_BC4_SNORM:
+        return 64;
+    case FORMAT_R10G10B10A2_UNORM:
+    case FORMAT_R8G8B8A8_UNORM:
+    case FORMAT_R8G8B8A8_UNORM_SRGB:
+    case FORMAT_R16G16_UNORM:
+    case FORMAT_R32_FLOAT:
+    case FORMAT_B8G8R8A8_UNORM:
+    case FORMAT_B8G8R8X8_UNORM:
+    case FORMAT_B8G8R8A8_UNORM_SRGB:
+    case FORMAT_B8G8R8X8_UNORM_SRGB:
+        return 32;
+    case FORMAT_R8G8_UNORM:
+    case FORMAT_R16_UNORM:
+    case FORMAT_B5G6R5_UNORM:
+    case FORMAT_B5G5R5A1_UNORM:
+    case FORMAT_B4G4R4A4_UNORM:
+        return 16;
+    case FORMAT_R8_UNORM:
+    case FORMAT_A8_UNORM:
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+bool DdsFile::IsBlockCompressed(Format format) {
+    return (format >= FORMAT_BC1_UNORM && format <= FORMAT_BC5_SNORM) || (format >= FORMAT_BC6H_UF16 && format <= FORMAT_BC7_UNORM_SRGB);
+}
+
+bool DdsFile::IsSRGB(Format format) {
+    switch (format) {
+    case FORMAT_R8G8B8A8_UNORM_SRGB:
+    case FORMAT_BC1_UNORM_SRGB:
+    case FORMAT_BC2_UNORM_SRGB:
+    case FORMAT_BC3_UNORM_SRGB:
+    case FORMAT_B8G8R8A8_UNORM_SRGB:
+    case FORMAT_B8G8R8X8_UNORM_SRGB:
+    case FORMAT_BC7_UNORM_SRGB:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Function to get row and slice sizes of mip, rowsCount is rows of blocks for compressed formats, returns false for unknown format
+// or slice which doesn't fit 32 bits
+bool DdsFile::GetSurfaceInfo(Format format, uint32_t width, uint32_t height, uint32_t& rowPitch, uint32_t& slicePitch, uint32_t* rowsCount) {
+    uint32_t bits = GetBitsPerElement(format);
+    if (!bits) {
+        return false;
+    }
+
+    // Sizes are computed in 64 bits, 16384x16384 mip of 128-bit format already doesn't fit slicePitch
+    uint64_t row = 0;
+    uint64_t rows = height;
+    if (IsBlockCompressed(format)) {
+        // Blocks are 4x4 pixels, mips smaller than block still take whole one
+        row = (uint64_t)(std::max)(1u, (uint32_t)(((uint64_t)width + 3) / 4)) * (bits / 8);
+        rows = (std::max)(1u, (uint32_t)(((uint64_t)height + 3) / 4));
+    }
+    else {
+        row = ((uint64_t)width * bits + 7) / 8;
+    }
+    uint64_t slice = row * rows;
+    if (slice > UINT32_MAX) {
+        return false;
+    }
+    rowPitch = (uint32_t)row;
+    slicePitch = (uint32_t)slice;
+    if (rowsCount) {
+        *rowsCount = (uint32_t)rows;
+    }
+    return true;
+}
+
+// Function to get count of mips in full chain of texture of given size
+uint32_t DdsFile::GetMaxMipCount(uint32_t width, uint32_t height, uint32_t depth) {
+    uint32_t size = (std::max)((std::max)(width, height), depth);
+    uint32_t count = 1;
+    while (size > 1) {
+        size /= 2;
+        count++;
+    }
+    return count;
+}
+
+// Function to get format of file without DX10 header
+DdsFile::Format DdsFile::GetLegacyFormat(const PixelFormat& pixelFormat) {
+    auto isMask = [&pixelFormat](uint32_t r, uint32_t g, uint32_t b, uint32_t a) {
+        return pixelFormat.RBitMask == r && pixelFormat.GBitMask == g && pixelFormat.BBitMask == b && pixelFormat.ABitMask == a;
+    };
+
+    if (pixelFormat.flags & PIXEL_RGB) {
+        if (pixelFormat.RGBBitCount == 32) {
+            if (isMask(0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000))
+                return FORMAT_R8G8B8A8_UNORM;
+            if (isMask(0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000))
+                return FORMAT_B8G8R8A8_UNORM;
+            if (isMask(0x00ff0000, 0x0000ff00, 0x000000ff, 0x00000000))
+                return FORMAT_B8G8R8X8_UNORM;
+            // D3DX writes 10:10:10:2 with swapped red and blue masks
+            if (isMask(0x3ff00000, 0x000ffc00, 0x000003ff, 0xc0000000))
+                return FORMAT_R10G10B10A2_UNORM;
+            if (isMask(0x0000ffff, 0xffff0000, 0x00000000, 0x00000000))
+                return FORMAT_R16G16_UNORM;
+            if (isMask(0xffffffff, 0x00000000, 0x00000000, 0x00000000))
+                return FORMAT_R32_FLOAT;
+        }
+        else if (pixelFormat.RGBBitCount == 16) {
+            if (isMask(0x7c00, 0x03e0, 0x001f, 0x8000))
+                return FORMAT_B5G5R5A1_UNORM;
+            if (isMask(0xf800, 0x07e0, 0x001f, 0x0000))
+                return FORMAT_B5G6R5_UNORM;
+            if (isMask(0x0f00, 0x00f0, 0x000f, 0xf000))
+                return FORMAT_B4G4R4A4_UNORM;
+        }
+    }
+    else if (pixelFormat.flags & PIXEL_LUMINANCE) {
+        if (pixelFormat.RGBBitCount == 8 && isMask(0x000000ff, 0x00000000, 0x00000000, 0x00000000))
+            return FORMAT_R8_UNORM;
+        if (pixelFormat.RGBBitCount == 16 && isMask(0x0000ffff, 0x00000000, 0x00000000, 0x00000000))
+            return FORMAT_R16_UNORM;
+        if (pixelFormat.RGBBitCount == 16 && isMask(0x000000ff, 0x00000000, 0x00000000, 0x0000ff00))
+            return FORMAT_R8G8_UNORM;
+    }
+    else if (pixelFormat.flags & PIXEL_ALPHA) {
+        if (pixelFormat.RGBBitCount == 8)
+            return FORMAT_A8_UNORM;
+    }
+    else if (pixelFormat.flags & PIXEL_FOURCC) {
+        switch (pixelFormat.fourCC) {
+        case DDS_FILE_FOURCC('D', 'X', 'T', '1'):
+            return FORMAT_BC1_UNORM;
+        // Premultiplied alpha variants are loaded as plain ones
+        case DDS_FILE_FOURCC('D', 'X', 'T', '2'):
+        case DDS_FILE_FOURCC('D', 'X', 'T', '3'):
+            return FORMAT_BC2_UNORM;
+        case DDS_FILE_FOURCC('D', 'X', 'T', '4'):
+        case DDS_FILE_FOURCC('D', 'X', 'T', '5'):
+            return FORMAT_BC3_UNORM;
+        case DDS_FILE_FOURCC('A', 'T', 'I', '1'):
+        case DDS_FILE_FOURCC('B', 'C', '4', 'U'):
+            return FORMAT_BC4_UNORM;
+        case DDS_FILE_FOURCC('B', 'C', '4', 'S'):
+            return FORMAT_BC4_SNORM;
+        case DDS_FILE_FOURCC('A', 'T', 'I', '2'):
+        case DDS_FILE_FOURCC('B', 'C', '5', 'U'):
+            return FORMAT_BC5_UNORM;
+        case DDS_FILE_FOURCC('B', 'C', '5', 'S'):
+            return FORMAT_BC5_SNORM;
+        // D3DFMT values written by D3DX as fourCC
+        case 36:
+            return FORMAT_R16G16B16A16_UNORM;
+        case 113:
+            return FORMAT_R16G16B16A16_FLOAT;
+        case 114:
+            return FORMAT_R32_FLOAT;
+        case 116:
+            return FORMAT_R32G32B32A32_FLOAT;
+        }
+    }
+    return FORMAT_UNKNOWN;
+}
+
+// Function to check headers and compute subresources of DDS file in memory, returns false for broken or unsupported file
+bool DdsFile::Parse(const unsigned char* data, size_t size, Desc& desc) {
+    desc = Desc();
+    if (!data || size < sizeof(uint32_t) + sizeof(Header)) {
+        return false;
+    }
+
+    uint32_t magic;
+    memcpy(&magic, data, sizeof(magic));
+    Header header;
+    memcpy(&header, data + sizeof(uint32_t), sizeof(header));
+    if (magic != DDS_FILE_MAGIC || header.size != sizeof(Header) || header.ddspf.size != sizeof(PixelFormat)) {
+        return false;
+    }
+
+    desc.width = header.width;
+    desc.height = header.height;
+    desc.depth = 1;
+    desc.mipCount = header.mipMapCount ? header.mipMapCount : 1;
+    desc.arraySize = 1;
+    desc.dataOffset = sizeof(uint32_t) + sizeof(Header);
+
+    if ((header.ddspf.flags & PIXEL_FOURCC) && header.ddspf.fourCC == DDS_FILE_FOURCC('D', 'X', '1', '0')) {
+        if (size < desc.dataOffset + sizeof(HeaderDx10)) {
+            return false;
+        }
+        HeaderDx10 headerDx10;
+        memcpy(&headerDx10, data + desc.dataOffset, sizeof(headerDx10));
+        desc.dataOffset += sizeof(HeaderDx10);
+
+        desc.format = (Format)headerDx10.dxgiFormat;
+        desc.dimension = (Dimension)headerDx10.resourceDimension;
+        desc.arraySize = headerDx10.arraySize;
+        if (!desc.arraySize) {
+            return false;
+        }
+
+        switch (desc.dimension) {
+        case DIMENSION_TEXTURE1D:
+            // Some writers set height of 1D textures to 0
+            if ((header.flags & FLAG_HEIGHT) && desc.height != 1) {
+                return false;
+            }
+            desc.height = 1;
+            break;
+        case DIMENSION_TEXTURE2D:
+            if (headerDx10.miscFlag & MISC_TEXTURECUBE) {
+                desc.arraySize *= 6;
+                desc.isCubeMap = true;
+            }
+            break;
+        case DIMENSION_TEXTURE3D:
+            if (!(header.flags & FLAG_VOLUME) || desc.arraySize > 1) {
+                return false;
+            }
+            desc.depth = header.depth;
+            break;
+        default:
+            return false;
+        }
+    }
+    else {
+        desc.format = GetLegacyFormat(header.ddspf);
+        if (header.flags & FLAG_VOLUME) {
+            desc.dimension = DIMENSION_TEXTURE3D;
+            desc.depth = header.depth;
+        }
+        else {
+            desc.dimension = DIMENSION_TEXTURE2D;
+            if (header.caps2 & CAPS2_CUBEMAP) {
+                // Partial cube maps are not supported by D3D11
+                if ((header.caps2 & CAPS2_CUBEMAP_ALLFACES) != CAPS2_CUBEMAP_ALLFACES) {
+                    return false;
+                }
+                desc.arraySize = 6;
+                desc.isCubeMap = true;
+            }
+        }
+    }
+
+    if (!GetBitsPerElement(desc.format)) {
+        return false;
+    }
+    if (!desc.width || !desc.height || !desc.depth || desc.width > DDS_FILE_MAX_SIZE || desc.height > DDS_FILE_MAX_SIZE ||
+        desc.depth > DDS_FILE_MAX_SIZE || desc.mipCount > DDS_FILE_MAX_MIPS || desc.arraySize > DDS_FILE_MAX_ARRAY_SIZE) {
+        return false;
+    }
+    // Chain ends with 1x1x1 mip, longer one is rejected by device
+    if (desc.mipCount > GetMaxMipCount(desc.width, desc.height, desc.depth)) {
+        return false;
+    }
+
+    desc.subresources.resize((size_t)desc.mipCount * desc.arraySize);
+    uint64_t offset = desc.dataOffset;
+    for (uint32_t slice = 0; slice < desc.arraySize; slice++) {
+        uint32_t width = desc.width;
+        uint32_t height = desc.height;
+        uint32_t depth = desc.depth;
+        for (uint32_t mip = 0; mip < desc.mipCount; mip++) {
+            Subresource& subresource = desc.subresources[mip + (size_t)slice * desc.mipCount];
+            if (!GetSurfaceInfo(desc.format, width, height, subresource.rowPitch, subresource.slicePitch)) {
+                desc.subresources.clear();
+                return false;
+            }
+            subresource.width = width;
+            subresource.height = height;
+            subresource.depth = depth;
+            subresource.offset = offset;
+            subresource.size = (uint64_t)subresource.slicePitch * depth;
+
+            offset += subresource.size;
+            if (offset > size) {
+                desc.subresources.clear();
+                return false;
+            }
+
+            width = (std::max)(1u, width / 2);
+            height = (std::max)(1u, height / 2);
+            depth = (std::max)(1u, depth / 2);
+        }
+    }
+    return true;
+}
+
+// Function to build DDS file of 2D texture from mips in order from largest one with tightly packed rows. Formats old readers
+// know get legacy header, others get DX10 one. Returns false for unknown format or mip of wrong size
+bool DdsFile::Serialize(Format format, uint32_t width, uint32_t height, const std::vector<std::vector<unsigned char>>& mips, std::vector<unsigned char>& data) {
+    uint32_t rowPitch = 0;
+    uint32_t slicePitch = 0;
+    if (mips.empty() || !width || !height || width > DDS_FILE_MAX_SIZE || height > DDS_FILE_MAX_SIZE || mips.size() > GetMaxMipCount(width, height) ||
+        !GetSurfaceInfo(format, width, height, rowPitch, slicePitch)) {
+        return false;
+    }
+
+    Header header = {};
+    header.size = sizeof(Header);
+    header.flags = FLAG_CAPS | FLAG_HEIGHT | FLAG_WIDTH | FLAG_PIXELFORMAT | (mips.size() > 1 ? (uint32_t)FLAG_MIPMAPCOUNT : 0u);
+    header.flags |= IsBlockCompressed(format) ? (uint32_t)FLAG_LINEARSIZE : (uint32_t)FLAG_PITCH;
+    header.pitchOrLinearSize = IsBlockCompressed(format) ? slicePitch : rowPitch;
+    header.width = width;
+    header.height = height;
+    header.mipMapCount = (uint32_t)mips.size();
+    header.ddspf.size = sizeof(PixelFormat);
+    header.caps = CAPS_TEXTURE | (mips.size() > 1 ? (uint32_t)(CAPS_COMPLEX | CAPS_MIPMAP) : 0u);
+
+    bool isLegacy = true;
+    switch (format) {
+    case FORMAT_BC1_UNORM:
+        header.ddspf.flags = PIXEL_FOURCC;
+        header.ddspf.fourCC = DDS_FILE_FOURCC('D', 'X', 'T', '1');
+        break;
+    case FORMAT_BC3_UNORM:
+        header.ddspf.flags = PIXEL_FOURCC;
+        header.ddspf.fourCC = DDS_FILE_FOURCC('D', 'X', 'T', '5');
+        break;
+    case FORMAT_BC4_UNORM:
+        header.ddspf.flags = PIXEL_FOURCC;
+        header.ddspf.fourCC = DDS_FILE_FOURCC('A', 'T', 'I', '1');
+        break;
+    case FORMAT_BC5_UNORM:
+        header.ddspf.flags = PIXEL_FOURCC;
+        header.ddspf.fourCC = DDS_FILE_FOURCC('A', 'T', 'I', '2');
+        break;
+    case FORMAT_R8G8B8A8_UNORM:
+        header.ddspf.flags = PIXEL_RGB | PIXEL_ALPHAPIXELS;
+        header.ddspf.RGBBitCount = 32;
+        header.ddspf.RBitMask = 0x000000ff;
+        header.ddspf.GBitMask = 0x0000ff00;
+        header.ddspf.BBitMask = 0x00ff0000;
+        header.ddspf.ABitMask = 0xff000000;
+        break;
+    default:
+        isLegacy = false;
+        header.ddspf.flags = PIXEL_FOURCC;
+        header.ddspf.fourCC = DDS_FILE_FOURCC('D', 'X', '1', '0');
+        break;
+    }
+
+    size_t size = sizeof(uint32_t) + sizeof(Header) + (isLegacy ? 0 : sizeof(HeaderDx10));
+    uint32_t mipWidth = width;
+    uint32_t mipHeight = height;
+    for (const std::vector<unsigned char>& mip : mips) {
+        GetSurfaceInfo(format, mipWidth, mipHeight, rowPitch, slicePitch);
+        if (mip.size() != slicePitch) {
+            return false;
+        }
+        size += slicePitch;
+        mipWidth = (std::max)(1u, mipWidth / 2);
+        mipHeight = (std::max)(1u, mipHeight / 2);
+    }
+
+    data.resize(size);
+    unsigned char* dst = data.data();
+    uint32_t magic = DDS_FILE_MAGIC;
+    memcpy(dst, &magic, sizeof(magic));
+    dst += sizeof(magic);
+    memcpy(dst, &header, sizeof(header));
+    dst += sizeof(header);
+    if (!isLegacy) {
+        HeaderDx10 headerDx10 = {};
+        headerDx10.dxgiFormat = format;
+        headerDx10.resourceDimension = DIMENSION_TEXTURE2D;
+        headerDx10.arraySize = 1;
+        memcpy(dst, &headerDx10, sizeof(headerDx10));
+        dst += sizeof(headerDx10);
+    }
+    for (const std::vector<unsigned char>& mip : mips) {
+        memcpy(dst, mip.data(), mip.size());
+        dst += mip.size();
+    }
+    return true;
+}
+
+// Function to write DDS file built by Serialize
+bool DdsFile::Write(const char* path, Format format, uint32_t width, uint32_t height, const std::vector<std::vector<unsigned char>>& mips) {
+    std::vector<unsigned char> data;
+    if (!Serialize(format, width, height, mips, data)) {
+        return false;
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(data.data()), (std::streamsize)data.size());
+    file.close();
+    return !file.fail();
+}
+
+// Function to map and parse file, data is read in on worker calling it when prefetch is set
+bool DdsFile::Open(const char* path, bool prefetch) {
+    Release();
+    return m_file.Open(path) && ParseFile(prefetch);
+}
+
+bool DdsFile::Open(const wchar_t* path, bool prefetch) {
+    Release();
+    return m_file.Open(path) && ParseFile(prefetch);
+}
+
+// Function to parse file built in memory, as by Serialize, data is kept by object
+bool DdsFile::Load(std::vector<unsigned char>&& data) {
+    Release();
+    m_data = std::move(data);
+    return ParseFile(false);
+}
+
+// Function to parse mapped file or loaded data
+bool DdsFile::ParseFile(bool prefetch) {
+    if (!Parse(GetData(), GetSize(), m_desc)) {
+        Release();
+        return false;
+    }
+    if (prefetch) {
+        m_file.Prefetch();
+    }
+    return true;
+}
+
+// Function to read data of mip of all array slices in from disk
+void DdsFile::PrefetchMip(uint32_t mip) const {
+    for (uint32_t slice = 0; slice < m_desc.arraySize; slice++) {
+        const Subresource& subresource = m_desc.subresources[mip + (size_t)slice * m_desc.mipCount];
+        m_file.Prefetch((size_t)subresource.offset, (size_t)subresource.size);
+    }
+}
+
+// Function to unmap file or free loaded data, desc becomes empty
+void DdsFile::Release() {
+    m_file.Release();
+    std::vector<unsigned char>().swap(m_data);
+    m_desc = Desc();
+}
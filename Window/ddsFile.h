@@ -0,0 +1,199 @@
+// ddsFile.h - class for parsing DDS texture files in place without device
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "mappedFile.h"
+
+#define DDS_FILE_MAGIC 0x20534444 // "DDS "
+#define DDS_FILE_FOURCC(a, b, c, d) ((uint32_t)(uint8_t)(a) | ((uint32_t)(uint8_t)(b) << 8) | ((uint32_t)(uint8_t)(c) << 16) | ((uint32_t)(uint8_t)(d) << 24))
+// Limits of D3D11 resources, larger sizes in file are treated as broken
+#define DDS_FILE_MAX_SIZE 16384
+#define DDS_FILE_MAX_MIPS 15
+#define DDS_FILE_MAX_ARRAY_SIZE 2048
+
+// File layout (little-endian): magic, Header, optional HeaderDx10 when pixel format fourCC is "DX10",
+// then for every array slice its mip chain from largest mip, depth slices of mip one after another.
+// Parsing only checks headers and computes where subresources are, data stays in caller's memory
+class DdsFile {
+public:
+    // Values are equal to DXGI_FORMAT ones, only formats without planes and padding are listed
+    enum Format : uint32_t {
+        FORMAT_UNKNOWN = 0,
+        FORMAT_R32G32B32A32_FLOAT = 2,
+        FORMAT_R16G16B16A16_FLOAT = 10,
+        FORMAT_R16G16B16A16_UNORM = 11,
+        FORMAT_R10G10B10A2_UNORM = 24,
+        FORMAT_R8G8B8A8_UNORM = 28,
+        FORMAT_R8G8B8A8_UNORM_SRGB = 29,
+        FORMAT_R16G16_UNORM = 35,
+        FORMAT_R32_FLOAT = 41,
+        FORMAT_R8G8_UNORM = 49,
+        FORMAT_R16_UNORM = 56,
+        FORMAT_R8_UNORM = 61,
+        FORMAT_A8_UNORM = 65,
+        FORMAT_BC1_UNORM = 71,
+        FORMAT_BC1_UNORM_SRGB = 72,
+        FORMAT_BC2_UNORM = 74,
+        FORMAT_BC2_UNORM_SRGB = 75,
+        FORMAT_BC3_UNORM = 77,
+        FORMAT_BC3_UNORM_SRGB = 78,
+        FORMAT_BC4_UNORM = 80,
+        FORMAT_BC4_SNORM = 81,
+        FORMAT_BC5_UNORM = 83,
+        FORMAT_BC5_SNORM = 84,
+        FORMAT_B5G6R5_UNORM = 85,
+        FORMAT_B5G5R5A1_UNORM = 86,
+        FORMAT_B8G8R8A8_UNORM = 87,
+        FORMAT_B8G8R8X8_UNORM = 88,
+        FORMAT_B8G8R8A8_UNORM_SRGB = 91,
+        FORMAT_B8G8R8X8_UNORM_SRGB = 93,
+        FORMAT_BC6H_UF16 = 95,
+        FORMAT_BC6H_SF16 = 96,
+        FORMAT_BC7_UNORM = 98,
+        FORMAT_BC7_UNORM_SRGB = 99,
+        FORMAT_B4G4R4A4_UNORM = 115
+    };
+
+    // Values are equal to D3D11_RESOURCE_DIMENSION ones
+    enum Dimension : uint32_t {
+        DIMENSION_UNKNOWN = 0,
+        DIMENSION_TEXTURE1D = 2,
+        DIMENSION_TEXTURE2D = 3,
+        DIMENSION_TEXTURE3D = 4
+    };
+
+    // Flags of header and pixel format used by parser and writers
+    enum Flags : uint32_t {
+        FLAG_CAPS = 0x1,
+        FLAG_HEIGHT = 0x2,
+        FLAG_WIDTH = 0x4,
+        FLAG_PITCH = 0x8,
+        FLAG_PIXELFORMAT = 0x1000,
+        FLAG_MIPMAPCOUNT = 0x20000,
+        FLAG_LINEARSIZE = 0x80000,
+        FLAG_VOLUME = 0x800000,
+
+        PIXEL_ALPHAPIXELS = 0x1,
+        PIXEL_ALPHA = 0x2,
+        PIXEL_FOURCC = 0x4,
+        PIXEL_RGB = 0x40,
+        PIXEL_LUMINANCE = 0x20000,
+
+        CAPS_COMPLEX = 0x8,
+        CAPS_TEXTURE = 0x1000,
+        CAPS_MIPMAP = 0x400000,
+        CAPS2_CUBEMAP = 0x200,
+        CAPS2_CUBEMAP_ALLFACES = 0xfc00,
+        CAPS2_VOLUME = 0x200000,
+
+        MISC_TEXTURECUBE = 0x4
+    };
+
+#pragma pack(push, 1)
+    struct PixelFormat {
+        uint32_t size;
+        uint32_t flags;
+        uint32_t fourCC;
+        uint32_t RGBBitCount;
+        uint32_t RBitMask;
+        uint32_t GBitMask;
+        uint32_t BBitMask;
+        uint32_t ABitMask;
+    };
+
+    struct Header {
+        uint32_t size;
+        uint32_t flags;
+        uint32_t height;
+        uint32_t width;
+        uint32_t pitchOrLinearSize;
+        uint32_t depth;
+        uint32_t mipMapCount;
+        uint32_t reserved1[11];
+        PixelFormat ddspf;
+        uint32_t caps;
+        uint32_t caps2;
+        uint32_t caps3;
+        uint32_t caps4;
+        uint32_t reserved2;
+    };
+
+    struct HeaderDx10 {
+        uint32_t dxgiFormat;
+        uint32_t resourceDimension;
+        uint32_t miscFlag;
+        uint32_t arraySize;
+        uint32_t miscFlags2;
+    };
+#pragma pack(pop)
+
+    // Subresource in D3D11 order, index is mip + slice * mipCount
+    struct Subresource {
+        uint64_t offset = 0;        // from file start
+        uint64_t size = 0;          // slicePitch * depth
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t depth = 0;
+        uint32_t rowPitch = 0;      // bytes of row of pixels or blocks
+        uint32_t slicePitch = 0;    // bytes of one depth slice
+    };
+
+    struct Desc {
+        Dimension dimension = DIMENSION_UNKNOWN;
+        Format format = FORMAT_UNKNOWN;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t depth = 0;
+        uint32_t mipCount = 0;
+        uint32_t arraySize = 0;     // six per cube for cube maps
+        bool isCubeMap = false;
+        uint64_t dataOffset = 0;    // offset of first subresource
+        std::vector<Subresource> subresources;
+    };
+
+    // Function to check headers and compute subresources of DDS file in memory, returns false for broken or unsupported file
+    static bool Parse(const unsigned char* data, size_t size, Desc& desc);
+
+    // Function to get row and slice sizes of mip, rowsCount is rows of blocks for compressed formats, returns false for unknown format
+    // or slice which doesn't fit 32 bits
+    static bool GetSurfaceInfo(Format format, uint32_t width, uint32_t height, uint32_t& rowPitch, uint32_t& slicePitch, uint32_t* rowsCount = nullptr);
+    // Function to get bits per pixel of uncompressed format or per block of compressed one, 0 for unknown format
+    static uint32_t GetBitsPerElement(Format format);
+    // Function to get count of mips in full chain of texture of given size
+    static uint32_t GetMaxMipCount(uint32_t width, uint32_t height, uint32_t depth = 1);
+    static bool IsBlockCompressed(Format format);
+    static bool IsSRGB(Format format);
+
+    // Function to build DDS file of 2D texture from mips in order from largest one with tightly packed rows. Formats old readers
+    // know get legacy header, others get DX10 one. Returns false for unknown format or mip of wrong size
+    static bool Serialize(Format format, uint32_t width, uint32_t height, const std::vector<std::vector<unsigned char>>& mips, std::vector<unsigned char>& data);
+    // Function to write DDS file built by Serialize
+    static bool Write(const char* path, Format format, uint32_t width, uint32_t height, const std::vector<std::vector<unsigned char>>& mips);
+
+    // Function to map and parse file, data is read in on worker calling it when prefetch is set
+    bool Open(const char* path, bool prefetch = false);
+    bool Open(const wchar_t* path, bool prefetch = false);
+    // Function to parse file built in memory, as by Serialize, data is kept by object
+    bool Load(std::vector<unsigned char>&& data);
+    // Function to unmap file or free loaded data, desc becomes empty
+    void Release();
+
+    const Desc& GetDesc() const { return m_desc; };
+    const unsigned char* GetData() const { return m_file.IsOpen() ? m_file.GetData() : m_data.data(); };
+    size_t GetSize() const { return m_file.IsOpen() ? m_file.GetSize() : m_data.size(); };
+    const unsigned char* GetSubresourceData(int subresource) const { return GetData() + m_desc.subresources[subresource].offset; };
+    // Function to read data of mip of all array slices in from disk
+    void PrefetchMip(uint32_t mip) const;
+    bool IsOpen() const { return m_file.IsOpen() || !m_data.empty(); };
+
+private:
+    // Function to get format of file without DX10 header
+    static Format GetLegacyFormat(const PixelFormat& pixelFormat);
+    // Function to parse mapped file or loaded data
+    bool ParseFile(bool prefetch);
+
+    MappedFile m_file;
+    std::vector<unsigned char> m_data;
+    Desc m_desc;
+};
@@ -1,5 +1,17 @@
 #define SCREEN_NEAR 0.1f
 #define SCREEN_FAR 100.0f
-#define MAX_CUBE 50
+#define START_CUBE 50
+#define STRESS_CUBE 1000000
+#define SCENE_FILE "scene.bin"
+#define SHADER_CACHE_FILE "shaders.bin"
+#define STARTUP_TRACE_FILE "startup.json"
+#define STREAMING_BUDGET_MB 64
+#define STREAMING_DISTANCE_SAMPLES 1024
 #define MAX_LIGHT 50
 #define MAX_QUERY 10
+#define MAX_COMMAND_LISTS 8
+#define SIMULATION_STEP (1.0 / 120.0)
+#define MATERIAL_SHINE_BITS 10
+#define MATERIAL_TEXTURE_BITS 8
+#define MATERIAL_TEXTURE_SHIFT MATERIAL_SHINE_BITS
+#define MATERIAL_NORMAL_MAP_SHIFT (MATERIAL_SHINE_BITS + MATERIAL_TEXTURE_BITS)
@@ -0,0 +1,28 @@
+#include "fixedTimestep.h"
+#include <algorithm>
+
+// Function to start stepping with given step duration, frame time is clamped to maxSteps steps to avoid spiral of death
+void FixedTimestep::Init(const Clock* clock, double step, int maxSteps) {
+    m_pClock = clock;
+    // Accumulate in integer nanoseconds so long sessions don't lose precision, step is rounded to them so simulation keeps up with clock
+    m_stepNanoseconds = (std::max)((int64_t)(step * 1e9 + 0.5), (int64_t)1);
+    m_step = m_stepNanoseconds * 1e-9;
+    m_maxSteps = (std::max)(maxSteps, 1);
+    m_lastTime = m_pClock->GetNanoseconds();
+    m_accumulator = 0;
+    m_frameNanoseconds = 0;
+    m_stepsCount = 0;
+}
+
+// Function to accumulate time since previous call, returns count of simulation steps to run this frame
+int FixedTimestep::Advance() {
+    int64_t time = m_pClock->GetNanoseconds();
+    m_frameNanoseconds = time - m_lastTime;
+    m_lastTime = time;
+
+    m_accumulator += (std::min)(m_frameNanoseconds, m_stepNanoseconds * m_maxSteps);
+    int steps = (int)(m_accumulator / m_stepNanoseconds);
+    m_accumulator -= steps * m_stepNanoseconds;
+    m_stepsCount += steps;
+    return steps;
+}
@@ -0,0 +1,35 @@
+// fixedTimestep.h - class for fixed rate simulation steps with render interpolation factor
+#pragma once
+
+#include <cstdint>
+#include "clock.h"
+
+class FixedTimestep {
+public:
+    // Function to start stepping with given step duration, frame time is clamped to maxSteps steps to avoid spiral of death
+    void Init(const Clock* clock, double step, int maxSteps = 8);
+    // Function to accumulate time since previous call, returns count of simulation steps to run this frame
+    int Advance();
+
+    // Step duration in seconds
+    double GetStep() const { return m_step; };
+    // Time of last simulated step in seconds
+    double GetSimulationTime() const { return m_stepsCount * m_step; };
+    // Part of step passed after last simulated step, in [0, 1), used to interpolate between previous and current states
+    double GetAlpha() const { return (double)m_accumulator / m_stepNanoseconds; };
+    // Interpolated time for rendering in seconds
+    double GetRenderTime() const { return GetSimulationTime() + GetAlpha() * m_step; };
+    // Real duration of last frame in seconds
+    double GetFrameTime() const { return m_frameNanoseconds * 1e-9; };
+
+private:
+    const Clock* m_pClock = nullptr;
+    double m_step = 1.0 / 120.0;
+    int64_t m_stepNanoseconds = 0;
+    int m_maxSteps = 8;
+
+    int64_t m_lastTime = 0;
+    int64_t m_accumulator = 0;
+    int64_t m_frameNanoseconds = 0;
+    int64_t m_stepsCount = 0;
+};
@@ -0,0 +1,266 @@
+#include "frameGraph.h"
+#include <algorithm>
+#include <cassert>
+
+// Function to remove all passes and resources, graph is built again every frame
+void FrameGraph::Reset() {
+    m_passes.clear();
+    m_resources.clear();
+    m_order.clear();
+    m_finalBarriers.clear();
+    m_physicalDescs.clear();
+    m_stats = Stats();
+}
+
+// Function to declare texture which lives only inside graph, returns resource id
+int FrameGraph::CreateTexture(const std::string& name, const TextureDesc& desc) {
+    Resource resource;
+    resource.name = name;
+    resource.desc = desc;
+    m_resources.push_back(resource);
+    return (int)m_resources.size() - 1;
+}
+
+// Function to declare texture owned outside of graph, it has given access before and after graph, returns resource id
+int FrameGraph::ImportTexture(const std::string& name, Access access) {
+    Resource resource;
+    resource.name = name;
+    resource.isImported = true;
+    resource.importAccess = access;
+    m_resources.push_back(resource);
+    return (int)m_resources.size() - 1;
+}
+
+// Function to add pass executed by given function, returns pass id
+int FrameGraph::AddPass(const std::string& name, const ExecuteFunc& execute) {
+    Pass pass;
+    pass.name = name;
+    pass.execute = execute;
+    m_passes.push_back(pass);
+    return (int)m_passes.size() - 1;
+}
+
+void FrameGraph::Read(int pass, int resource, Access access) {
+    assert(access == ACCESS_SHADER_READ || access == ACCESS_DEPTH_READ);
+    // Transient must be written by earlier pass, otherwise its contents are undefined
+    assert(m_resources[resource].isImported || !m_resources[resource].writers.empty());
+    m_passes[pass].uses.push_back({ resource, access, false });
+    m_resources[resource].refCount++;
+}
+
+void FrameGraph::Write(int pass, int resource, Access access) {
+    assert(access == ACCESS_RENDER_TARGET || access == ACCESS_DEPTH_WRITE || access == ACCESS_UNORDERED);
+    m_passes[pass].uses.push_back({ resource, access, true });
+    m_passes[pass].refCount++;
+    m_resources[resource].writers.push_back(pass);
+    if (m_resources[resource].isImported) {
+        m_passes[pass].hasSideEffects = true;
+    }
+}
+
+// Function to cull passes with unused results, plan transitions and place transients by lifetimes.
+// Passes run in declaration order, so pass must be added after passes writing resources it reads
+void FrameGraph::Compile() {
+    CullPasses();
+
+    m_order.clear();
+    for (int i = 0; i < (int)m_passes.size(); i++) {
+        if (!m_passes[i].isCulled) {
+            m_order.push_back(i);
+        }
+    }
+
+    PlanBarriers();
+    ComputeLifetimes();
+    PlaceInPool();
+    AssignPhysical();
+
+    m_stats.passes = (int)m_passes.size();
+    m_stats.culledPasses = m_stats.passes - (int)m_order.size();
+}
+
+// Function to run not culled passes in order
+void FrameGraph::Execute() {
+    for (int pass : m_order) {
+        if (m_passes[pass].execute) {
+            m_passes[pass].execute();
+        }
+    }
+}
+
+// Passes are culled back from unread transients: pass without used outputs and side effects drops its reads too
+void FrameGraph::CullPasses() {
+    std::vector<int> unused;
+    for (int i = 0; i < (int)m_resources.size(); i++) {
+        if (!m_resources[i].isImported && m_resources[i].refCount == 0) {
+            unused.push_back(i);
+        }
+    }
+
+    // Pass writing nothing is never reached from its outputs
+    for (Pass& pass : m_passes) {
+        if (pass.refCount == 0 && !pass.hasSideEffects) {
+            CullPass(pass, unused);
+        }
+    }
+
+    while (!unused.empty()) {
+        int resource = unused.back();
+        unused.pop_back();
+
+        for (int writer : m_resources[resource].writers) {
+            Pass& pass = m_passes[writer];
+            if (pass.isCulled || --pass.refCount > 0 || pass.hasSideEffects)
+                continue;
+
+            CullPass(pass, unused);
+        }
+    }
+}
+
+// Function to mark pass culled and collect transients which lose their last reader
+void FrameGraph::CullPass(Pass& pass, std::vector<int>& unused) {
+    pass.isCulled = true;
+    for (const Use& use : pass.uses) {
+        Resource& read = m_resources[use.resource];
+        if (!use.isWrite && --read.refCount == 0 && !read.isImported) {
+            unused.push_back(use.resource);
+        }
+    }
+}
+
+// Transition is needed whenever access differs from previous one, imported resources return to their access after graph
+void FrameGraph::PlanBarriers() {
+    std::vector<Access> accesses(m_resources.size());
+    for (int i = 0; i < (int)m_resources.size(); i++) {
+        accesses[i] = m_resources[i].importAccess;
+    }
+
+    for (int pass : m_order) {
+        std::vector<Barrier>& barriers = m_passes[pass].barriers;
+        barriers.clear();
+        for (const Use& use : m_passes[pass].uses) {
+            if (accesses[use.resource] != use.access) {
+                barriers.push_back({ use.resource, accesses[use.resource], use.access });
+                accesses[use.resource] = use.access;
+            }
+        }
+    }
+
+    m_finalBarriers.clear();
+    for (int i = 0; i < (int)m_resources.size(); i++) {
+        if (m_resources[i].isImported && accesses[i] != m_resources[i].importAccess) {
+            m_finalBarriers.push_back({ i, accesses[i], m_resources[i].importAccess });
+        }
+    }
+}
+
+void FrameGraph::ComputeLifetimes() {
+    for (Resource& resource : m_resources) {
+        resource.firstUse = (int)m_order.size();
+        resource.lastUse = -1;
+    }
+
+    for (int i = 0; i < (int)m_order.size(); i++) {
+        for (const Use& use : m_passes[m_order[i]].uses) {
+            Resource& resource = m_resources[use.resource];
+            resource.firstUse = (std::min)(resource.firstUse, i);
+            resource.lastUse = (std::max)(resource.lastUse, i);
+        }
+    }
+}
+
+// Transients are placed from largest to smallest at lowest offset free during their whole lifetime
+void FrameGraph::PlaceInPool() {
+    struct Placed {
+        uint64_t offset;
+        uint64_t end;
+        int firstUse;
+        int lastUse;
+    };
+
+    std::vector<int> transients;
+    m_stats.transientBytes = 0;
+    for (int i = 0; i < (int)m_resources.size(); i++) {
+        Resource& resource = m_resources[i];
+        resource.offset = 0;
+        if (!resource.isImported && resource.firstUse <= resource.lastUse) {
+            transients.push_back(i);
+            m_stats.transientBytes += GetTextureSize(resource.desc);
+        }
+    }
+    m_stats.transients = (int)transients.size();
+
+    std::stable_sort(transients.begin(), transients.end(), [&](int a, int b) {
+        return GetTextureSize(m_resources[a].desc) > GetTextureSize(m_resources[b].desc);
+    });
+
+    std::vector<Placed> placed;
+    std::vector<Placed> overlapping;
+    m_stats.aliasedBytes = 0;
+    for (int index : transients) {
+        Resource& resource = m_resources[index];
+        uint64_t size = GetTextureSize(resource.desc);
+
+        overlapping.clear();
+        for (const Placed& other : placed) {
+            if (other.firstUse <= resource.lastUse && resource.firstUse <= other.lastUse) {
+                overlapping.push_back(other);
+            }
+        }
+        std::sort(overlapping.begin(), overlapping.end(), [](const Placed& a, const Placed& b) { return a.offset < b.offset; });
+
+        uint64_t offset = 0;
+        for (const Placed& other : overlapping) {
+            if (offset + size <= other.offset)
+                break;
+            offset = (std::max)(offset, other.end);
+        }
+
+        resource.offset = offset;
+        placed.push_back({ offset, offset + size, resource.firstUse, resource.lastUse });
+        m_stats.aliasedBytes = (std::max)(m_stats.aliasedBytes, offset + size);
+    }
+}
+
+// Transients reuse physical texture of equal desc whose previous user finished before them
+void FrameGraph::AssignPhysical() {
+    std::vector<int> transients;
+    for (int i = 0; i < (int)m_resources.size(); i++) {
+        m_resources[i].physical = -1;
+        if (!m_resources[i].isImported && m_resources[i].firstUse <= m_resources[i].lastUse) {
+            transients.push_back(i);
+        }
+    }
+    std::stable_sort(transients.begin(), transients.end(), [&](int a, int b) {
+        return m_resources[a].firstUse < m_resources[b].firstUse;
+    });
+
+    std::vector<int> physicalLastUse;
+    m_physicalDescs.clear();
+    for (int index : transients) {
+        Resource& resource = m_resources[index];
+        for (int i = 0; i < (int)m_physicalDescs.size(); i++) {
+            if (physicalLastUse[i] < resource.firstUse && IsEqual(m_physicalDescs[i], resource.desc)) {
+                resource.physical = i;
+                break;
+            }
+        }
+        if (resource.physical < 0) {
+            resource.physical = (int)m_physicalDescs.size();
+            m_physicalDescs.push_back(resource.desc);
+            physicalLastUse.push_back(0);
+        }
+        physicalLastUse[resource.physical] = resource.lastUse;
+    }
+    m_stats.physicalTextures = (int)m_physicalDescs.size();
+}
+
+uint64_t FrameGraph::GetTextureSize(const TextureDesc& desc) {
+    uint64_t size = (uint64_t)desc.width * desc.height * desc.bytesPerPixel;
+    return (size + PoolAlignment - 1) & ~(PoolAlignment - 1);
+}
+
+bool FrameGraph::IsEqual(const TextureDesc& a, const TextureDesc& b) {
+    return a.width == b.width && a.height == b.height && a.format == b.format && a.bytesPerPixel == b.bytesPerPixel;
+}
@@ -0,0 +1,137 @@
+// frameGraph.h - class for ordering render passes by their reads and writes, culling unused passes and aliasing transient textures
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+class FrameGraph {
+public:
+    // How pass uses resource, change of access between passes needs transition
+    enum Access {
+        ACCESS_NONE = 0,        // contents undefined, state of transient before first use
+        ACCESS_SHADER_READ,
+        ACCESS_DEPTH_READ,
+        ACCESS_RENDER_TARGET,
+        ACCESS_DEPTH_WRITE,
+        ACCESS_UNORDERED
+    };
+
+    struct TextureDesc {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t format = 0;        // graphics API format, only textures with equal descs share physical texture
+        uint32_t bytesPerPixel = 4;
+    };
+
+    struct Barrier {
+        int resource;
+        Access before;
+        Access after;
+    };
+
+    struct Stats {
+        int passes = 0;
+        int culledPasses = 0;
+        int transients = 0;
+        int physicalTextures = 0;
+        uint64_t transientBytes = 0;    // all transients in own memory
+        uint64_t aliasedBytes = 0;      // peak of shared pool where transients with disjoint lifetimes overlap
+    };
+
+    // Placement alignment of textures in shared pool
+    static const uint64_t PoolAlignment = 64 * 1024;
+
+    typedef std::function<void()> ExecuteFunc;
+
+    // Function to remove all passes and resources, graph is built again every frame
+    void Reset();
+    // Function to release graph
+    void Release() { Reset(); };
+
+    // Function to declare texture which lives only inside graph, returns resource id
+    int CreateTexture(const std::string& name, const TextureDesc& desc);
+    // Function to declare texture owned outside of graph, it has given access before and after graph, returns resource id
+    int ImportTexture(const std::string& name, Access access);
+    // Function to add pass executed by given function, returns pass id
+    int AddPass(const std::string& name, const ExecuteFunc& execute);
+    // Functions to declare pass uses of resources, pass writing imported resource is never culled
+    void Read(int pass, int resource, Access access = ACCESS_SHADER_READ);
+    void Write(int pass, int resource, Access access = ACCESS_RENDER_TARGET);
+
+    // Function to cull passes with unused results, plan transitions and place transients by lifetimes.
+    // Passes run in declaration order, so pass must be added after passes writing resources it reads
+    void Compile();
+    // Function to run not culled passes in order
+    void Execute();
+
+    // Not culled passes in execution order
+    const std::vector<int>& GetOrder() const { return m_order; };
+    bool IsCulled(int pass) const { return m_passes[pass].isCulled; };
+    const std::string& GetPassName(int pass) const { return m_passes[pass].name; };
+    const std::string& GetResourceName(int resource) const { return m_resources[resource].name; };
+    // Transitions needed before pass runs
+    const std::vector<Barrier>& GetBarriers(int pass) const { return m_passes[pass].barriers; };
+    // Transitions of imported resources back to their access after last pass
+    const std::vector<Barrier>& GetFinalBarriers() const { return m_finalBarriers; };
+    // Range of executed passes using resource, first > last if unused
+    int GetFirstUse(int resource) const { return m_resources[resource].firstUse; };
+    int GetLastUse(int resource) const { return m_resources[resource].lastUse; };
+    // Placement of transient in shared pool, for APIs with placed resources
+    uint64_t GetPoolOffset(int resource) const { return m_resources[resource].offset; };
+    // Physical texture of transient, for APIs without placed resources; -1 for imported or unused resources
+    int GetPhysical(int resource) const { return m_resources[resource].physical; };
+    int GetPhysicalCount() const { return (int)m_physicalDescs.size(); };
+    const TextureDesc& GetPhysicalDesc(int physical) const { return m_physicalDescs[physical]; };
+    const Stats& GetStats() const { return m_stats; };
+
+    static bool IsEqual(const TextureDesc& a, const TextureDesc& b);
+
+private:
+    struct Use {
+        int resource;
+        Access access;
+        bool isWrite;
+    };
+
+    struct Pass {
+        std::string name;
+        ExecuteFunc execute;
+        std::vector<Use> uses;
+        std::vector<Barrier> barriers;
+        bool hasSideEffects = false;
+        bool isCulled = false;
+        int refCount = 0;
+    };
+
+    struct Resource {
+        std::string name;
+        TextureDesc desc;
+        bool isImported = false;
+        Access importAccess = ACCESS_NONE;
+        std::vector<int> writers;
+        int refCount = 0;
+        int firstUse = 0;
+        int lastUse = -1;
+        uint64_t offset = 0;
+        int physical = -1;
+    };
+
+    // Compile steps
+    void CullPasses();
+    void CullPass(Pass& pass, std::vector<int>& unused);
+    void PlanBarriers();
+    void ComputeLifetimes();
+    void PlaceInPool();
+    void AssignPhysical();
+
+    static uint64_t GetTextureSize(const TextureDesc& desc);
+
+    std::vector<Pass> m_passes;
+    std::vector<Resource> m_resources;
+    std::vector<int> m_order;
+    std::vector<Barrier> m_finalBarriers;
+    std::vector<TextureDesc> m_physicalDescs;
+    Stats m_stats;
+};
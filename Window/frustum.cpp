@@ -1,5 +1,13 @@
 #include "frustum.h"
 
+#if defined(__AVX__)
+#include <immintrin.h>
+#define FRUSTUM_CULL_AVX
+#elif defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define FRUSTUM_CULL_SSE
+#endif
+
 // Function to build frustum
 void Frustum::ConstructFrustum(XMMATRIX viewMatrix, XMMATRIX projectionMatrix) {
     // Convert the projection matrix into a 4x4 float type.
@@ -119,3 +127,139 @@ bool Frustum::CheckRectangle(XMFLOAT4 bbMin, XMFLOAT4 bbMax) {
 
     return true;
 }
+
+// Function to check boxes [first, last) in batch, indices of visible ones are appended to visible
+void Frustum::CheckRectangles(const AABBSoA& boxes, int first, int last, std::vector<int>& visible) {
+    if (last <= first) {
+        return;
+    }
+
+    // Plane normal signs are the same for every box, so the positive vertex stream is chosen once per plane
+    const float* px[6];
+    const float* py[6];
+    const float* pz[6];
+    for (int i = 0; i < 6; i++) {
+        px[i] = m_planes[i].x < 0 ? boxes.minX.data() : boxes.maxX.data();
+        py[i] = m_planes[i].y < 0 ? boxes.minY.data() : boxes.maxY.data();
+        pz[i] = m_planes[i].z < 0 ? boxes.minZ.data() : boxes.maxZ.data();
+    }
+
+    // Reserve space for the worst case and compact visible indices without branches
+    size_t count = visible.size();
+    visible.resize(count + (last - first));
+    int* out = visible.data();
+
+    int j = first;
+#if defined(FRUSTUM_CULL_AVX)
+    for (; j + 8 <= last; j += 8) {
+        __m256 mask = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int i = 0; i < 6; i++) {
+            __m256 s = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(m_planes[i].x), _mm256_loadu_ps(px[i] + j)),
+                              _mm256_mul_ps(_mm256_set1_ps(m_planes[i].y), _mm256_loadu_ps(py[i] + j))),
+                _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(m_planes[i].z), _mm256_loadu_ps(pz[i] + j)),
+                              _mm256_set1_ps(m_planes[i].w)));
+            mask = _mm256_and_ps(mask, _mm256_cmp_ps(s, _mm256_setzero_ps(), _CMP_NLT_UQ));
+        }
+        int bits = _mm256_movemask_ps(mask);
+        for (int k = 0; k < 8; k++) {
+            out[count] = j + k;
+            count += (bits >> k) & 1;
+        }
+    }
+#endif
+#if defined(FRUSTUM_CULL_AVX) || defined(FRUSTUM_CULL_SSE)
+    for (; j + 4 <= last; j += 4) {
+        __m128 mask = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int i = 0; i < 6; i++) {
+            __m128 s = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(_mm_set1_ps(m_planes[i].x), _mm_loadu_ps(px[i] + j)),
+                           _mm_mul_ps(_mm_set1_ps(m_planes[i].y), _mm_loadu_ps(py[i] + j))),
+                _mm_add_ps(_mm_mul_ps(_mm_set1_ps(m_planes[i].z), _mm_loadu_ps(pz[i] + j)),
+                           _mm_set1_ps(m_planes[i].w)));
+            mask = _mm_and_ps(mask, _mm_cmpnlt_ps(s, _mm_setzero_ps()));
+        }
+        int bits = _mm_movemask_ps(mask);
+        for (int k = 0; k < 4; k++) {
+            out[count] = j + k;
+            count += (bits >> k) & 1;
+        }
+    }
+#endif
+    // Scalar tail, the same test as CheckRectangle
+    for (; j < last; j++) {
+        bool inside = true;
+        for (int i = 0; i < 6; i++) {
+            float s = m_planes[i].x * px[i][j] + m_planes[i].y * py[i][j] + m_planes[i].z * pz[i][j] + m_planes[i].w;
+            inside = inside && !(s < 0.0f);
+        }
+        out[count] = j;
+        count += inside ? 1 : 0;
+    }
+
+    visible.resize(count);
+}
+
+// Function to test box against planes from mask, planes the box is fully inside of are removed from mask
+bool Frustum::ClassifyBox(const XMFLOAT3& bbMin, const XMFLOAT3& bbMax, int& planeMask) {
+    for (int i = 0; i < 6; i++) {
+        if (!(planeMask & (1 << i))) {
+            continue;
+        }
+        const XMFLOAT4& plane = m_planes[i];
+        // Farthest vertex along plane normal
+        float s = plane.x * (plane.x < 0 ? bbMin.x : bbMax.x) + plane.y * (plane.y < 0 ? bbMin.y : bbMax.y) +
+            plane.z * (plane.z < 0 ? bbMin.z : bbMax.z) + plane.w;
+        if (s < 0.0f) {
+            return false;
+        }
+        // Nearest vertex along plane normal
+        s = plane.x * (plane.x < 0 ? bbMax.x : bbMin.x) + plane.y * (plane.y < 0 ? bbMax.y : bbMin.y) +
+            plane.z * (plane.z < 0 ? bbMax.z : bbMin.z) + plane.w;
+        if (s >= 0.0f) {
+            planeMask &= ~(1 << i);
+        }
+    }
+
+    return true;
+}
+
+// Function to traverse hierarchy, subtrees inside frustum are accepted and outside are rejected without leaf tests
+void Frustum::CheckBVH(const BVH& bvh, const AABBSoA& boxes, std::vector<int>& visible) {
+    const std::vector<BVH::Node>& nodes = bvh.GetNodes();
+    const std::vector<int>& indices = bvh.GetIndices();
+    if (nodes.empty()) {
+        return;
+    }
+
+    m_bvhStack.clear();
+    m_bvhStack.push_back(std::make_pair(0, (1 << 6) - 1));
+    while (!m_bvhStack.empty()) {
+        const BVH::Node& node = nodes[m_bvhStack.back().first];
+        int planeMask = m_bvhStack.back().second;
+        m_bvhStack.pop_back();
+
+        if (!ClassifyBox(node.bbMin, node.bbMax, planeMask)) {
+            continue;
+        }
+
+        if (planeMask == 0) {
+            // Whole subtree is inside
+            visible.insert(visible.end(), indices.begin() + node.first, indices.begin() + node.first + node.count);
+        }
+        else if (node.left < 0) {
+            for (int i = node.first; i < node.first + node.count; i++) {
+                int idx = indices[i];
+                int primMask = planeMask;
+                if (ClassifyBox(XMFLOAT3(boxes.minX[idx], boxes.minY[idx], boxes.minZ[idx]),
+                    XMFLOAT3(boxes.maxX[idx], boxes.maxY[idx], boxes.maxZ[idx]), primMask)) {
+                    visible.push_back(idx);
+                }
+            }
+        }
+        else {
+            m_bvhStack.push_back(std::make_pair(node.left + 1, planeMask));
+            m_bvhStack.push_back(std::make_pair(node.left, planeMask));
+        }
+    }
+}
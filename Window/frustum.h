@@ -2,6 +2,11 @@
 #pragma once
 
 #include <directxmath.h>
+#include <utility>
+#include <vector>
+#include "bounds.h"
+#include "bvh.h"
+
 using namespace DirectX;
 
 class Frustum {
@@ -15,8 +20,16 @@ public:
 
     // Functions to check if rectengle is in frustum
     bool CheckRectangle(XMFLOAT4 bbMin, XMFLOAT4 bbMax);
+    // Function to check boxes [first, last) in batch, indices of visible ones are appended to visible
+    void CheckRectangles(const AABBSoA& boxes, int first, int last, std::vector<int>& visible);
+    // Function to traverse hierarchy, subtrees inside frustum are accepted and outside are rejected without leaf tests
+    void CheckBVH(const BVH& bvh, const AABBSoA& boxes, std::vector<int>& visible);
     XMFLOAT4* GetPlanes() { return m_planes; };
 private:
+    // Function to test box against planes from mask, planes the box is fully inside of are removed from mask
+    bool ClassifyBox(const XMFLOAT3& bbMin, const XMFLOAT3& bbMax, int& planeMask);
+
+    std::vector<std::pair<int, int>> m_bvhStack;
     float m_screenDepth;
     XMFLOAT4 m_planes[6];
 };
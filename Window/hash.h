@@ -0,0 +1,17 @@
+// hash.h - functions for hashing bytes of keys
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#define HASH_SEED 14695981039346656037ull
+
+// FNV-1a, hash of previous bytes is passed as seed to continue hashing
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed = HASH_SEED) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
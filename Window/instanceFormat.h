@@ -0,0 +1,60 @@
+// instanceFormat.h - compact instance format for shaders and its CPU encoder and decoder
+#pragma once
+
+#include <directxmath.h>
+#include <algorithm>
+#include "defines.h"
+
+using namespace DirectX;
+
+// Instance data in layout of GeomBuffer shader structure: uniformly scaled rigid transform and packed material, 36 bytes
+struct PackedInstance {
+    XMFLOAT3 position;
+    float scale;
+    XMFLOAT4 rotation;     // unit quaternion
+    unsigned int material; // bits 0-9 - specular power, 10-17 - texture id, 18 - normal map presence
+};
+
+// Function to pack material, specular power is rounded to integer in [0, 1023], texture id to [0, 255]
+inline unsigned int PackMaterial(float specularPower, float textureId, bool hasNormalMap) {
+    unsigned int shine = (unsigned int)((std::min)((std::max)(specularPower, 0.0f), float((1 << MATERIAL_SHINE_BITS) - 1)) + 0.5f);
+    unsigned int texture = (unsigned int)((std::min)((std::max)(textureId, 0.0f), float((1 << MATERIAL_TEXTURE_BITS) - 1)) + 0.5f);
+    return shine | (texture << MATERIAL_TEXTURE_SHIFT) | ((hasNormalMap ? 1u : 0u) << MATERIAL_NORMAL_MAP_SHIFT);
+};
+
+// Function to unpack material to (specular power, 0, texture id, normal map presence)
+inline XMFLOAT4 UnpackMaterial(unsigned int material) {
+    return XMFLOAT4(
+        float(material & ((1u << MATERIAL_SHINE_BITS) - 1)),
+        0.0f,
+        float((material >> MATERIAL_TEXTURE_SHIFT) & ((1u << MATERIAL_TEXTURE_BITS) - 1)),
+        float((material >> MATERIAL_NORMAL_MAP_SHIFT) & 1u)
+    );
+};
+
+// Function to encode world matrix of rotation, uniform scale and translation
+inline void XM_CALLCONV EncodeInstance(FXMMATRIX world, unsigned int material, PackedInstance& instance) {
+    float scale = XMVectorGetX(XMVector3Length(world.r[0]));
+    float invScale = scale > 0.0f ? 1.0f / scale : 0.0f;
+
+    XMMATRIX rotation = world;
+    rotation.r[0] = XMVectorScale(world.r[0], invScale);
+    rotation.r[1] = XMVectorScale(world.r[1], invScale);
+    rotation.r[2] = XMVectorScale(world.r[2], invScale);
+    rotation.r[3] = XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f);
+
+    XMStoreFloat3(&instance.position, world.r[3]);
+    instance.scale = scale;
+    XMStoreFloat4(&instance.rotation, XMQuaternionNormalize(XMQuaternionRotationMatrix(rotation)));
+    instance.material = material;
+};
+
+// Function to decode world matrix, inverse of EncodeInstance
+inline XMMATRIX XM_CALLCONV DecodeInstance(const PackedInstance& instance) {
+    XMMATRIX world = XMMatrixRotationQuaternion(XMLoadFloat4(&instance.rotation));
+    world.r[0] = XMVectorScale(world.r[0], instance.scale);
+    world.r[1] = XMVectorScale(world.r[1], instance.scale);
+    world.r[2] = XMVectorScale(world.r[2], instance.scale);
+    world.r[3] = XMVectorSetW(XMLoadFloat3(&instance.position), 1.0f);
+    return world;
+};
@@ -0,0 +1,138 @@
+#include "jobSystem.h"
+#include <algorithm>
+
+namespace {
+    // Job system and queue owned by current worker thread
+    thread_local const JobSystem* t_pOwner = nullptr;
+    thread_local int t_queueIndex = -1;
+}
+
+// Function to start workers, 0 means one worker per hardware thread except caller's one
+void JobSystem::Init(int workersCount) {
+    if (workersCount <= 0) {
+        workersCount = (std::max)((int)std::thread::hardware_concurrency() - 1, 0);
+    }
+
+    m_isStopping = false;
+    m_queues.clear();
+    for (int i = 0; i <= workersCount; i++) {
+        m_queues.push_back(std::unique_ptr<WorkQueue>(new WorkQueue));
+    }
+    m_workers.reserve(workersCount);
+    for (int i = 0; i < workersCount; i++) {
+        m_workers.push_back(std::thread(&JobSystem::WorkerLoop, this, i));
+    }
+}
+
+// Function to stop and join workers
+void JobSystem::Release() {
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_isStopping = true;
+    }
+    m_wakeCondition.notify_all();
+
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+    m_queues.clear();
+    m_queuedJobs = 0;
+}
+
+// Function to split [begin, end) into ranges of grain size and process them in parallel, returns when all ranges are done
+void JobSystem::ParallelFor(int begin, int end, int grain, const RangeFunc& func) {
+    grain = (std::max)(grain, 1);
+    int rangesCount = GetRangesCount(begin, end, grain);
+    if (rangesCount == 0) {
+        return;
+    }
+    // Nothing to share, run on calling thread
+    if (m_workers.empty() || rangesCount == 1) {
+        func(begin, end);
+        return;
+    }
+
+    // Deal ranges to all queues, idle workers will steal the rest
+    std::atomic<int> pending{ rangesCount };
+    int queueIndex = GetQueueIndex();
+    int queuesCount = (int)m_queues.size();
+    for (int i = 0; i < rangesCount; i++) {
+        int first = begin + i * grain;
+        Job job = { &func, first, (std::min)(first + grain, end), &pending };
+
+        WorkQueue& queue = *m_queues[(queueIndex + i) % queuesCount];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(job);
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_queuedJobs += rangesCount;
+    }
+    m_wakeCondition.notify_all();
+
+    // Help workers until own ranges are done
+    while (pending.load(std::memory_order_acquire) > 0) {
+        if (!TryRunJob(queueIndex)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+// Worker thread main loop
+void JobSystem::WorkerLoop(int queueIndex) {
+    t_pOwner = this;
+    t_queueIndex = queueIndex;
+
+    for (;;) {
+        if (TryRunJob(queueIndex)) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        m_wakeCondition.wait(lock, [this]() { return m_isStopping || m_queuedJobs > 0; });
+        if (m_isStopping) {
+            return;
+        }
+    }
+}
+
+// Function to take job from own queue or steal it from others, returns false if all queues are empty
+bool JobSystem::TryRunJob(int queueIndex) {
+    Job job;
+    bool isFound = false;
+    int queuesCount = (int)m_queues.size();
+
+    for (int i = 0; i < queuesCount && !isFound; i++) {
+        WorkQueue& queue = *m_queues[(queueIndex + i) % queuesCount];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.jobs.empty()) {
+            continue;
+        }
+        if (i == 0) {
+            job = queue.jobs.back();
+            queue.jobs.pop_back();
+        }
+        else {
+            job = queue.jobs.front();
+            queue.jobs.pop_front();
+        }
+        isFound = true;
+    }
+    if (!isFound) {
+        return false;
+    }
+
+    m_queuedJobs--;
+    (*job.func)(job.first, job.last);
+    job.pending->fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+// Function to get queue index of calling thread
+int JobSystem::GetQueueIndex() const {
+    if (t_pOwner == this) {
+        return t_queueIndex;
+    }
+    return (int)m_queues.size() - 1;
+}
@@ -0,0 +1,58 @@
+// jobSystem.h - class for work-stealing thread pool with parallel-for over index ranges
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobSystem {
+public:
+    // Function to process [first, last) range of indices
+    typedef std::function<void(int first, int last)> RangeFunc;
+
+    // Function to start workers, 0 means one worker per hardware thread except caller's one
+    void Init(int workersCount = 0);
+    // Function to stop and join workers
+    void Release();
+    // Function to split [begin, end) into ranges of grain size and process them in parallel, returns when all ranges are done
+    void ParallelFor(int begin, int end, int grain, const RangeFunc& func);
+    // Function to get ranges count ParallelFor will split [begin, end) into
+    static int GetRangesCount(int begin, int end, int grain) { return end > begin ? (end - begin + grain - 1) / grain : 0; };
+
+    int GetWorkersCount() const { return (int)m_workers.size(); };
+
+private:
+    struct Job {
+        const RangeFunc* func;
+        int first;
+        int last;
+        std::atomic<int>* pending;
+    };
+
+    // Job deque: owner takes from back, thieves take from front
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    // Worker thread main loop
+    void WorkerLoop(int queueIndex);
+    // Function to take job from own queue or steal it from others, returns false if all queues are empty
+    bool TryRunJob(int queueIndex);
+    // Function to get queue index of calling thread
+    int GetQueueIndex() const;
+
+    std::vector<std::thread> m_workers;
+    // One queue per worker plus last one shared by outside threads
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;
+
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wakeCondition;
+    std::atomic<int> m_queuedJobs{ 0 };
+    bool m_isStopping = false;
+};
@@ -1,16 +1,18 @@
 #include "light.h"
 
-// Initialize all needed instances
-HRESULT Light::Init(ID3D11Device* device, ID3D11DeviceContext* context) {
-    HRESULT hr = S_OK;
-
-    // Set up lights
-    for (int i = 0; i < MAX_LIGHT; i++) {
-        m_posColorVector.push_back(std::pair<XMFLOAT3, XMFLOAT3>(
-            XMFLOAT3((float)(rand() % 10 - 5), (float)(rand() % 10 - 5), (float)(rand() % 10 - 5)),
-            XMFLOAT3(1.0f, (rand() % 255) / 255.0f, (rand() % 255) / 255.0f)));
-    }
+// Function to add tasks generating sphere and compiling shaders, they run before Init
+void Light::AddLoadTasks(TaskGraph& graph, ShaderCompiler* shaderCompiler, std::vector<int>& tasks) {
+    int flags = 0;
+#ifdef _DEBUG
+    flags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#endif
+    tasks.push_back(graph.AddTask("Light::GenerateSphere", [this]() { GenerateSphere(); return true; }));
+    tasks.push_back(shaderCompiler->AddCompileTask(graph, "TransVertexShader.hlsl", NULL, "main", "vs_5_0", flags, &m_pVertexShaderBuffer));
+    tasks.push_back(shaderCompiler->AddCompileTask(graph, "TransPixelShader.hlsl", NULL, "main", "ps_5_0", flags, &m_pPixelShaderBuffer));
+}
 
+// Function to fill sphere vertices and indices
+void Light::GenerateSphere() {
     UINT LatLines = 10;
     UINT LongLines = 10;
     // Create vertex array
@@ -20,7 +22,8 @@ HRESULT Light::Init(ID3D11Device* device, ID3D11DeviceContext* context) {
     float sphereYaw = 0.0f;
     float spherePitch = 0.0f;
 
-    std::vector<Vertex> vertices(m_numSphereVertices);
+    std::vector<Vertex>& vertices = m_vertices;
+    vertices.assign(m_numSphereVertices, Vertex());
 
     XMVECTOR currVertPos = XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f);
 
@@ -47,7 +50,8 @@ HRESULT Light::Init(ID3D11Device* device, ID3D11DeviceContext* context) {
     vertices[static_cast<__int64>(m_numSphereVertices) - 1].z = -1.0f;
 
     // Create index array
-    std::vector<UINT> indices(static_cast<__int64>(m_numSphereFaces) * 3);
+    std::vector<UINT>& indices = m_indices;
+    indices.assign(static_cast<__int64>(m_numSphereFaces) * 3, 0);
 
     int k = 0;
     for (UINT i = 0; i < LongLines - 1; i++) {
@@ -95,6 +99,11 @@ HRESULT Light::Init(ID3D11Device* device, ID3D11DeviceContext* context) {
     indices[k] = m_numSphereVertices - 1;
     indices[static_cast<__int64>(k) + 1] = (m_numSphereVertices - 1) - LongLines;
     indices[static_cast<__int64>(k) + 2] = m_numSphereVertices - 2;
+}
+
+// Initialize all needed instances
+HRESULT Light::Init(ID3D11Device* device, ID3D11DeviceContext* context, PipelineStateCache* stateCache) {
+    HRESULT hr = S_OK;
 
     static const D3D11_INPUT_ELEMENT_DESC InputDesc[] = {
         {"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
@@ -111,7 +120,7 @@ HRESULT Light::Init(ID3D11Device* device, ID3D11DeviceContext* context) {
 
         D3D11_SUBRESOURCE_DATA data;
         ZeroMemory(&data, sizeof(data));
-        data.pSysMem = &vertices[0];
+        data.pSysMem = &m_vertices[0];
         hr = device->CreateBuffer(&desc, &data, &m_pVertexBuffer);
         assert(SUCCEEDED(hr));
     }
@@ -128,73 +137,28 @@ HRESULT Light::Init(ID3D11Device* device, ID3D11DeviceContext* context) {
         desc.StructureByteStride = 0;
 
         D3D11_SUBRESOURCE_DATA data;
-        data.pSysMem = &indices[0];
+        data.pSysMem = &m_indices[0];
 
         hr = device->CreateBuffer(&desc, &data, &m_pIndexBuffer);
         assert(SUCCEEDED(hr));
     }
 
-    ID3D10Blob* vertexShaderBuffer = nullptr;
-    ID3D10Blob* pixelShaderBuffer = nullptr;
-    int flags = 0;
-#ifdef _DEBUG
-    flags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
-#endif
-
-    D3DInclude includeObj;
-
     if (SUCCEEDED(hr)) {
-        hr = D3DCompileFromFile(L"TransVertexShader.hlsl", NULL, &includeObj, "main", "vs_5_0", flags, 0, &vertexShaderBuffer, NULL);
-        hr = device->CreateVertexShader(vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), NULL, &m_pVertexShader);
+        hr = device->CreateVertexShader(m_pVertexShaderBuffer->GetBufferPointer(), m_pVertexShaderBuffer->GetBufferSize(), NULL, &m_pVertexShader);
     }
     if (SUCCEEDED(hr)) {
-        hr = D3DCompileFromFile(L"TransPixelShader.hlsl", NULL, &includeObj, "main", "ps_5_0", flags, 0, &pixelShaderBuffer, NULL);
-        hr = device->CreatePixelShader(pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize(), NULL, &m_pPixelShader);
+        hr = device->CreatePixelShader(m_pPixelShaderBuffer->GetBufferPointer(), m_pPixelShaderBuffer->GetBufferSize(), NULL, &m_pPixelShader);
     }
     if (SUCCEEDED(hr)) {
         int numElements = sizeof(InputDesc) / sizeof(InputDesc[0]);
-        hr = device->CreateInputLayout(InputDesc, numElements, vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), &m_pInputLayout);
+        hr = device->CreateInputLayout(InputDesc, numElements, m_pVertexShaderBuffer->GetBufferPointer(), m_pVertexShaderBuffer->GetBufferSize(), &m_pInputLayout);
     }
 
-    SAFE_RELEASE(vertexShaderBuffer);
-    SAFE_RELEASE(pixelShaderBuffer);
-
-    // Set constant buffers
-    if (SUCCEEDED(hr)) {
-        D3D11_BUFFER_DESC desc = {};
-        desc.ByteWidth = sizeof(GeomBuffer) * MAX_LIGHT;
-        desc.Usage = D3D11_USAGE_DEFAULT;
-        desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-        desc.CPUAccessFlags = 0;
-        desc.MiscFlags = 0;
-        desc.StructureByteStride = 0;
-
-        GeomBuffer geomBufferInst[MAX_LIGHT];
-        for (int i = 0; i < MAX_LIGHT; i++) {
-            geomBufferInst[i].mWorldMatrix = DirectX::XMMatrixScaling(0.1f, 0.1f, 0.1f) * XMMatrixTranslation(m_posColorVector[i].first.x, m_posColorVector[i].first.y, m_posColorVector[i].first.z);
-            geomBufferInst[i].color = XMFLOAT4(m_posColorVector[i].second.x, m_posColorVector[i].second.y, m_posColorVector[i].second.z, 1.0f);
-        }
-
-        D3D11_SUBRESOURCE_DATA data;
-        data.pSysMem = &geomBufferInst;
-        data.SysMemPitch = sizeof(geomBufferInst);
-        data.SysMemSlicePitch = 0;
-
-        hr = device->CreateBuffer(&desc, &data, &m_pWorldMatrixBuffer);
-        assert(SUCCEEDED(hr));
-    }
-    if (SUCCEEDED(hr)) {
-        D3D11_BUFFER_DESC desc = {};
-        desc.ByteWidth = sizeof(SceneMatrixBuffer);
-        desc.Usage = D3D11_USAGE_DYNAMIC;
-        desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-        desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-        desc.MiscFlags = 0;
-        desc.StructureByteStride = 0;
-
-        hr = device->CreateBuffer(&desc, nullptr, &m_pSceneMatrixBuffer);
-        assert(SUCCEEDED(hr));
-    }
+    // Loaded data is in device objects now
+    SAFE_RELEASE(m_pVertexShaderBuffer);
+    SAFE_RELEASE(m_pPixelShaderBuffer);
+    m_vertices.clear();
+    m_indices.clear();
 
     // Set rastrizer state
     if (SUCCEEDED(hr)) {
@@ -210,7 +174,7 @@ HRESULT Light::Init(ID3D11Device* device, ID3D11DeviceContext* context) {
         desc.MultisampleEnable = false;
         desc.SlopeScaledDepthBias = 0.0f;
 
-        hr = device->CreateRasterizerState(&desc, &m_pRasterizerState);
+        hr = stateCache->CreateRasterizerState(&desc, &m_pRasterizerState);
         assert(SUCCEEDED(hr));
     }
 
@@ -228,49 +192,35 @@ void Light::Release() {
     SAFE_RELEASE(m_pInputLayout);
     SAFE_RELEASE(m_pVertexShader);
     SAFE_RELEASE(m_pRasterizerState);
-    SAFE_RELEASE(m_pSceneMatrixBuffer);
-    SAFE_RELEASE(m_pWorldMatrixBuffer);
     SAFE_RELEASE(m_pPixelShader);
+    SAFE_RELEASE(m_pVertexShaderBuffer);
+    SAFE_RELEASE(m_pPixelShaderBuffer);
+    m_vertices.clear();
+    m_indices.clear();
     m_posColorVector.clear();
 }
 
-bool Light::Frame(ID3D11DeviceContext* context, XMMATRIX viewMatrix, XMMATRIX projectionMatrix) {
-    GeomBuffer geomBufferInst[MAX_LIGHT];
-    for (int i = 0; i < m_posColorVector.size(); i++) {
-        geomBufferInst[i].mWorldMatrix = DirectX::XMMatrixScaling(0.1f, 0.1f, 0.1f) * XMMatrixTranslation(m_posColorVector[i].first.x, m_posColorVector[i].first.y, m_posColorVector[i].first.z);
-        geomBufferInst[i].color = XMFLOAT4(m_posColorVector[i].second.x, m_posColorVector[i].second.y, m_posColorVector[i].second.z, 1.0f);
-    }
-
-    context->UpdateSubresource(m_pWorldMatrixBuffer, 0, nullptr, &geomBufferInst, 0, 0);
-
-    // Update Scene matrix
-    D3D11_MAPPED_SUBRESOURCE subresource;
-    HRESULT hr = context->Map(m_pSceneMatrixBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &subresource);
-    assert(SUCCEEDED(hr));
-    if (SUCCEEDED(hr)) {
-        SceneMatrixBuffer& sceneBuffer = *reinterpret_cast<SceneMatrixBuffer*>(subresource.pData);
-        sceneBuffer.mViewProjectionMatrix = XMMatrixMultiply(viewMatrix, projectionMatrix);
-        context->Unmap(m_pSceneMatrixBuffer, 0);
-    }
-
-    return SUCCEEDED(hr);
-}
-
-void Light::Render(ID3D11DeviceContext* context) {
-    context->RSSetState(m_pRasterizerState);
-
-    context->IASetIndexBuffer(m_pIndexBuffer, DXGI_FORMAT_R32_UINT, 0);
-    ID3D11Buffer* vertexBuffers[] = { m_pVertexBuffer };
-    UINT strides[] = { 12 };
-    UINT offsets[] = { 0 };
-    context->IASetVertexBuffers(0, 1, vertexBuffers, strides, offsets);
-    context->IASetInputLayout(m_pInputLayout);
-    context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    context->VSSetShader(m_pVertexShader, nullptr, 0);
-    context->VSSetConstantBuffers(0, 1, &m_pWorldMatrixBuffer);
-    context->VSSetConstantBuffers(1, 1, &m_pSceneMatrixBuffer);
-    context->PSSetConstantBuffers(0, 1, &m_pWorldMatrixBuffer);
-    context->PSSetShader(m_pPixelShader, nullptr, 0);
-
-    context->DrawIndexedInstanced(m_numSphereFaces * 3, (UINT)m_posColorVector.size(), 0 ,0, 0);
+// Function to register pipeline and material of spheres in backend, depth state is shared with scene
+void Light::RegisterStates(D3D11Backend* backend, ID3D11DepthStencilState* depthState) {
+    D3D11Backend::PipelineDesc pipeline;
+    pipeline.pVertexShader = m_pVertexShader;
+    pipeline.pPixelShader = m_pPixelShader;
+    pipeline.pInputLayout = m_pInputLayout;
+    pipeline.pRasterizerState = m_pRasterizerState;
+    pipeline.pDepthState = depthState;
+    m_ids.pipeline = backend->AddPipeline(pipeline);
+
+    // Constant ranges are allocated every frame by Frame
+    m_ids.worldConstants = backend->AddConstants();
+    m_ids.sceneConstants = backend->AddConstants();
+    D3D11Backend::MaterialDesc material;
+    material.pVertexBuffer = m_pVertexBuffer;
+    material.vertexStride = sizeof(Vertex);
+    material.pIndexBuffer = m_pIndexBuffer;
+    material.indexFormat = DXGI_FORMAT_R32_UINT;
+    material.vsConstants[0] = m_ids.worldConstants;
+    material.vsConstants[1] = m_ids.sceneConstants;
+    material.psConstants[0] = m_ids.worldConstants;
+    m_ids.material = backend->AddMaterial(material);
+    m_ids.indexCount = m_numSphereFaces * 3;
 }
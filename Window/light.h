@@ -9,38 +9,41 @@
 #include "D3DInclude.h"
 #include "utility.h"
 #include "defines.h"
+#include "lightSpheres.h"
+#include "renderBackend.h"
+#include "pipelineStateCache.h"
+#include "shaderCompiler.h"
 
 using namespace DirectX;
 
-class Light {
+// D3D11 resources of light spheres, their per-frame work is in LightSpheres
+class Light : public LightSpheres {
 private:
     struct Vertex {
         float x, y, z;
     };
-    struct GeomBuffer {
-        XMMATRIX mWorldMatrix;
-        XMFLOAT4 color;
-    };
-    struct SceneMatrixBuffer {
-        XMMATRIX mViewProjectionMatrix;
-    };
 public:
+    // Function to add tasks generating sphere and compiling shaders, they run before Init
+    void AddLoadTasks(TaskGraph& graph, ShaderCompiler* shaderCompiler, std::vector<int>& tasks);
     // Initialize all needed instances
-    HRESULT Init(ID3D11Device* device, ID3D11DeviceContext* context);
+    HRESULT Init(ID3D11Device* device, ID3D11DeviceContext* context, PipelineStateCache* stateCache);
     // Clean up all the objects we've created
     void Release();
-    // Render the frame
-    void Render(ID3D11DeviceContext* context);
-    bool Frame(ID3D11DeviceContext* context, XMMATRIX viewMatrix, XMMATRIX projectionMatrix);
+    // Function to register pipeline and material of spheres in backend, depth state is shared with scene
+    void RegisterStates(D3D11Backend* backend, ID3D11DepthStencilState* depthState);
 
-    // Get light info vector
-   std::vector<std::pair<XMFLOAT3, XMFLOAT3>>& GetLightVector() { return  m_posColorVector; };
   private:
-    std::vector<std::pair<XMFLOAT3, XMFLOAT3>> m_posColorVector;
+    // Function to fill sphere vertices and indices
+    void GenerateSphere();
+
+    // Data prepared by load tasks, released by Init
+    std::vector<Vertex> m_vertices;
+    std::vector<UINT> m_indices;
+    ID3D10Blob* m_pVertexShaderBuffer = nullptr;
+    ID3D10Blob* m_pPixelShaderBuffer = nullptr;
+
     ID3D11Buffer* m_pVertexBuffer = nullptr;
     ID3D11Buffer* m_pIndexBuffer = nullptr;
-    ID3D11Buffer* m_pWorldMatrixBuffer = nullptr;
-    ID3D11Buffer* m_pSceneMatrixBuffer = nullptr;
     ID3D11RasterizerState* m_pRasterizerState = nullptr;
 
     ID3D11InputLayout* m_pInputLayout = nullptr;
@@ -0,0 +1,31 @@
+#include "lightSpheres.h"
+
+// Function to write spheres constants of this frame through backend
+bool LightSpheres::Frame(RenderBackend* backend, XMMATRIX viewMatrix, XMMATRIX projectionMatrix) {
+    GeomBuffer* geomBufferInst = static_cast<GeomBuffer*>(backend->AllocateConstants(m_ids.worldConstants, sizeof(GeomBuffer) * MAX_LIGHT));
+    SceneMatrixBuffer* sceneBuffer = static_cast<SceneMatrixBuffer*>(backend->AllocateConstants(m_ids.sceneConstants, sizeof(SceneMatrixBuffer)));
+    if (!geomBufferInst || !sceneBuffer) {
+        return false;
+    }
+
+    for (size_t i = 0; i < m_posColorVector.size(); i++) {
+        geomBufferInst[i].mWorldMatrix = DirectX::XMMatrixScaling(0.1f, 0.1f, 0.1f) * XMMatrixTranslation(m_posColorVector[i].first.x, m_posColorVector[i].first.y, m_posColorVector[i].first.z);
+        geomBufferInst[i].color = XMFLOAT4(m_posColorVector[i].second.x, m_posColorVector[i].second.y, m_posColorVector[i].second.z, 1.0f);
+    }
+
+    // Update Scene matrix
+    sceneBuffer->mViewProjectionMatrix = XMMatrixMultiply(viewMatrix, projectionMatrix);
+
+    return true;
+}
+
+// Function to add spheres draw to render queue
+void LightSpheres::Render(RenderQueue* queue) {
+    DrawPacket packet;
+    packet.key = RenderQueue::MakeKey(RenderQueue::PASS_OPAQUE, false, m_ids.pipeline, m_ids.material, 0.0f);
+    packet.pipeline = m_ids.pipeline;
+    packet.material = m_ids.material;
+    packet.indexCount = m_ids.indexCount;
+    packet.instanceCount = (int)m_posColorVector.size();
+    queue->Push(packet);
+}
@@ -0,0 +1,44 @@
+// lightSpheres.h - class for light sources of scene drawn as small spheres by render queue
+#pragma once
+
+#include <directxmath.h>
+#include <utility>
+#include <vector>
+#include "defines.h"
+#include "renderQueue.h"
+
+using namespace DirectX;
+
+class LightSpheres {
+public:
+    struct GeomBuffer {
+        XMMATRIX mWorldMatrix;
+        XMFLOAT4 color;
+    };
+    struct SceneMatrixBuffer {
+        XMMATRIX mViewProjectionMatrix;
+    };
+
+    // Render backend ids of spheres draw
+    struct Ids {
+        int pipeline = 0;
+        int material = 0;
+        int worldConstants = 0;
+        int sceneConstants = 0;
+        int indexCount = 0;
+    };
+
+    // Function to set ids spheres are drawn with
+    void SetIds(const Ids& ids) { m_ids = ids; };
+    // Function to write spheres constants of this frame through backend
+    bool Frame(RenderBackend* backend, XMMATRIX viewMatrix, XMMATRIX projectionMatrix);
+    // Function to add spheres draw to render queue
+    void Render(RenderQueue* queue);
+
+    // Get light info vector
+    std::vector<std::pair<XMFLOAT3, XMFLOAT3>>& GetLightVector() { return m_posColorVector; };
+
+protected:
+    std::vector<std::pair<XMFLOAT3, XMFLOAT3>> m_posColorVector;
+    Ids m_ids;
+};
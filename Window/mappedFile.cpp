@@ -0,0 +1,142 @@
+#include "mappedFile.h"
+#include <algorithm>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cstdlib>
+#include <cwchar>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Function to map whole file, returns false if file can't be opened or is empty
+bool MappedFile::Open(const char* path) {
+    Release();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    m_file = file;
+#else
+    m_file = open(path, O_RDONLY);
+    if (m_file < 0) {
+        return false;
+    }
+#endif
+
+    return Map();
+}
+
+// Function to map whole file with wide path
+bool MappedFile::Open(const wchar_t* path) {
+#ifdef _WIN32
+    Release();
+
+    HANDLE file = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    m_file = file;
+    return Map();
+#else
+    std::string narrowPath(wcslen(path) * MB_CUR_MAX + 1, '\0');
+    size_t length = wcstombs(&narrowPath[0], path, narrowPath.size());
+    if (length == (size_t)-1) {
+        return false;
+    }
+    narrowPath.resize(length);
+    return Open(narrowPath.c_str());
+#endif
+}
+
+// Function to map opened file
+bool MappedFile::Map() {
+#ifdef _WIN32
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0) {
+        Release();
+        return false;
+    }
+
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_mapping) {
+        Release();
+        return false;
+    }
+
+    m_pData = static_cast<const unsigned char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!m_pData) {
+        Release();
+        return false;
+    }
+    m_size = (size_t)size.QuadPart;
+#else
+    struct stat info;
+    if (fstat(m_file, &info) != 0 || info.st_size == 0) {
+        Release();
+        return false;
+    }
+
+    void* data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+    if (data == MAP_FAILED) {
+        Release();
+        return false;
+    }
+    m_pData = static_cast<const unsigned char*>(data);
+    m_size = (size_t)info.st_size;
+#endif
+
+    return true;
+}
+
+// Function to read range of file in now, so first access to data doesn't wait for disk
+void MappedFile::Prefetch(size_t offset, size_t size) const {
+    if (!m_pData || offset >= m_size || size == 0) {
+        return;
+    }
+    size = (std::min)(size, m_size - offset);
+#ifndef _WIN32
+    // Advice range has to start at page boundary
+    size_t pageOffset = offset / MAPPED_FILE_PAGE_SIZE * MAPPED_FILE_PAGE_SIZE;
+    madvise(const_cast<unsigned char*>(m_pData) + pageOffset, size + offset - pageOffset, MADV_WILLNEED);
+#endif
+    // Touching one byte per page faults every page in
+    volatile unsigned char sum = 0;
+    for (size_t i = offset; i < offset + size; i += MAPPED_FILE_PAGE_SIZE) {
+        sum += m_pData[i];
+    }
+    sum += m_pData[offset + size - 1];
+}
+
+// Function to unmap file
+void MappedFile::Release() {
+#ifdef _WIN32
+    if (m_pData) {
+        UnmapViewOfFile(m_pData);
+    }
+    if (m_mapping) {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+    if (m_file) {
+        CloseHandle(m_file);
+        m_file = nullptr;
+    }
+#else
+    if (m_pData) {
+        munmap(const_cast<unsigned char*>(m_pData), m_size);
+    }
+    if (m_file >= 0) {
+        close(m_file);
+        m_file = -1;
+    }
+#endif
+    m_pData = nullptr;
+    m_size = 0;
+}
@@ -0,0 +1,41 @@
+// mappedFile.h - class for read-only file mapped into memory
+#pragma once
+
+#include <cstddef>
+
+// Stride of touching pages on prefetch, smallest page size of supported platforms
+#define MAPPED_FILE_PAGE_SIZE 4096
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { Release(); };
+
+    // Function to map whole file, returns false if file can't be opened or is empty
+    bool Open(const char* path);
+    bool Open(const wchar_t* path);
+    // Functions to read whole file or its range in now, so first access to data doesn't wait for disk
+    void Prefetch() const { Prefetch(0, m_size); };
+    void Prefetch(size_t offset, size_t size) const;
+    // Function to unmap file
+    void Release();
+
+    const unsigned char* GetData() const { return m_pData; };
+    size_t GetSize() const { return m_size; };
+    bool IsOpen() const { return m_pData != nullptr; };
+
+private:
+    // Function to map opened file
+    bool Map();
+
+    const unsigned char* m_pData = nullptr;
+    size_t m_size = 0;
+#ifdef _WIN32
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#else
+    int m_file = -1;
+#endif
+};
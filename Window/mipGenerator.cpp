@@ -0,0 +1,387 @@
+#include "mipGenerator.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define MIP_GENERATOR_SSE
+#endif
+
+namespace {
+    const float Pi = 3.14159265358979f;
+    // Entries of table converting linear values to 8-bit sRGB, fine enough to round dark values to nearest level
+    const int LinearToSRGBSize = 16384;
+    const int BesselTerms = 16;
+
+    float SRGBToLinear(float value) {
+        return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+    }
+
+    float LinearToSRGB(float value) {
+        return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+    }
+
+    // Function to get table of linear values of 8-bit sRGB ones, static local is built once even with concurrent callers
+    const float* GetSRGBToLinearTable() {
+        static const std::vector<float> table = []() {
+            std::vector<float> values(256);
+            for (int i = 0; i < 256; i++) {
+                values[i] = SRGBToLinear((float)i / 255.0f);
+            }
+            return values;
+        }();
+        return table.data();
+    }
+
+    // Function to get table of 8-bit sRGB values of linear ones in [0, 1]
+    const unsigned char* GetLinearToSRGBTable() {
+        static const std::vector<unsigned char> table = []() {
+            std::vector<unsigned char> values(LinearToSRGBSize);
+            for (int i = 0; i < LinearToSRGBSize; i++) {
+                values[i] = (unsigned char)(LinearToSRGB((float)i / (LinearToSRGBSize - 1)) * 255.0f + 0.5f);
+            }
+            return values;
+        }();
+        return table.data();
+    }
+
+    // Function to convert row of RGBA8 pixels to floats in [0, 1], color of sRGB pixels to linear space
+    void LoadRow(const unsigned char* src, float* dst, uint32_t width, bool isSRGB) {
+        if (isSRGB) {
+            const float* toLinear = GetSRGBToLinearTable();
+            for (uint32_t x = 0; x < width; x++) {
+                dst[x * 4 + 0] = toLinear[src[x * 4 + 0]];
+                dst[x * 4 + 1] = toLinear[src[x * 4 + 1]];
+                dst[x * 4 + 2] = toLinear[src[x * 4 + 2]];
+                dst[x * 4 + 3] = (float)src[x * 4 + 3] * (1.0f / 255.0f);
+            }
+            return;
+        }
+
+        uint32_t i = 0;
+#ifdef MIP_GENERATOR_SSE
+        __m128i zero = _mm_setzero_si128();
+        __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+        for (; i + 16 <= width * 4; i += 16) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+            __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+            _mm_store_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), scale));
+            _mm_store_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), scale));
+            _mm_store_ps(dst + i + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), scale));
+            _mm_store_ps(dst + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), scale));
+        }
+#endif
+        for (; i < width * 4; i++) {
+            dst[i] = (float)src[i] * (1.0f / 255.0f);
+        }
+    }
+
+    // Function to convert row of floats in [0, 1] to RGBA8 pixels rounded to nearest, color of sRGB pixels from linear space
+    void StoreRow(const float* src, unsigned char* dst, uint32_t width, bool isSRGB) {
+        if (isSRGB) {
+            const unsigned char* toSRGB = GetLinearToSRGBTable();
+            for (uint32_t x = 0; x < width; x++) {
+                dst[x * 4 + 0] = toSRGB[(int)(src[x * 4 + 0] * (LinearToSRGBSize - 1) + 0.5f)];
+                dst[x * 4 + 1] = toSRGB[(int)(src[x * 4 + 1] * (LinearToSRGBSize - 1) + 0.5f)];
+                dst[x * 4 + 2] = toSRGB[(int)(src[x * 4 + 2] * (LinearToSRGBSize - 1) + 0.5f)];
+                dst[x * 4 + 3] = (unsigned char)(src[x * 4 + 3] * 255.0f + 0.5f);
+            }
+            return;
+        }
+
+        uint32_t i = 0;
+#ifdef MIP_GENERATOR_SSE
+        __m128 scale = _mm_set1_ps(255.0f);
+        __m128 half = _mm_set1_ps(0.5f);
+        for (; i + 16 <= width * 4; i += 16) {
+            // Truncation after adding half rounds as scalar path does
+            __m128i a = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_load_ps(src + i), scale), half));
+            __m128i b = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_load_ps(src + i + 4), scale), half));
+            __m128i c = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_load_ps(src + i + 8), scale), half));
+            __m128i d = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_load_ps(src + i + 12), scale), half));
+            __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), bytes);
+        }
+#endif
+        for (; i < width * 4; i++) {
+            dst[i] = (unsigned char)(src[i] * 255.0f + 0.5f);
+        }
+    }
+
+    float Sinc(float x) {
+        if (x == 0.0f) {
+            return 1.0f;
+        }
+        x *= Pi;
+        return std::sin(x) / x;
+    }
+
+    // Function to get zero order modified Bessel function of first kind by its power series
+    float BesselI0(float x) {
+        float sum = 1.0f;
+        float term = 1.0f;
+        float halfX = 0.5f * x;
+        for (int k = 1; k < BesselTerms; k++) {
+            float factor = halfX / (float)k;
+            term *= factor * factor;
+            sum += term;
+        }
+        return sum;
+    }
+
+    // Function to get filter weight at distance x in pixels of smaller mip
+    float GetFilterWeight(MipGenerator::Filter filter, float x) {
+        x = std::fabs(x);
+        switch (filter) {
+        case MipGenerator::FILTER_BOX:
+            return x <= 0.5f ? 1.0f : 0.0f;
+        case MipGenerator::FILTER_KAISER: {
+            if (x >= MIP_GENERATOR_RADIUS) {
+                return 0.0f;
+            }
+            float t = x / MIP_GENERATOR_RADIUS;
+            return Sinc(x) * BesselI0(MIP_GENERATOR_KAISER_ALPHA * std::sqrt(1.0f - t * t)) / BesselI0(MIP_GENERATOR_KAISER_ALPHA);
+        }
+        case MipGenerator::FILTER_LANCZOS:
+            return x < MIP_GENERATOR_RADIUS ? Sinc(x) * Sinc(x / MIP_GENERATOR_RADIUS) : 0.0f;
+        default:
+            return 0.0f;
+        }
+    }
+
+    float GetFilterRadius(MipGenerator::Filter filter) {
+        return filter == MipGenerator::FILTER_BOX ? 0.5f : MIP_GENERATOR_RADIUS;
+    }
+
+    // Function to clamp pixels of row to [0, 1] and renormalize normals of normal maps
+    void FinishRow(float* row, uint32_t width, bool isNormalMap) {
+#ifdef MIP_GENERATOR_SSE
+        __m128 zero = _mm_setzero_ps();
+        __m128 one = _mm_set1_ps(1.0f);
+        for (uint32_t x = 0; x < width; x++) {
+            _mm_store_ps(row + x * 4, _mm_min_ps(_mm_max_ps(_mm_load_ps(row + x * 4), zero), one));
+        }
+#else
+        for (uint32_t i = 0; i < width * 4; i++) {
+            row[i] = (std::min)((std::max)(row[i], 0.0f), 1.0f);
+        }
+#endif
+        if (!isNormalMap) {
+            return;
+        }
+        // Averaged normals get shorter, so they are scaled back to unit length, alpha is kept
+        for (uint32_t x = 0; x < width; x++) {
+            float* pixel = row + x * 4;
+            float n[3] = { pixel[0] * 2.0f - 1.0f, pixel[1] * 2.0f - 1.0f, pixel[2] * 2.0f - 1.0f };
+            float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            if (length > 1e-6f) {
+                for (int c = 0; c < 3; c++) {
+                    pixel[c] = n[c] / length * 0.5f + 0.5f;
+                }
+            }
+        }
+    }
+}
+
+// Function to build mips of image, first mip is image itself, returns false for empty image
+bool MipGenerator::Generate(const TextureCompressor::Image& image, const Options& options, std::vector<TextureCompressor::Image>& mips) const {
+    if (image.width == 0 || image.height == 0 || image.pixels.size() != (size_t)image.width * image.height * 4) {
+        return false;
+    }
+
+    uint32_t mipsCount = GetMipsCount(image.width, image.height);
+    if (options.mipsCount) {
+        mipsCount = (std::min)(mipsCount, options.mipsCount);
+    }
+    mips.resize(mipsCount);
+    mips[0] = image;
+    if (mipsCount == 1) {
+        return true;
+    }
+
+    // Image is converted to floats once, every next mip is filtered from float previous one so rounding doesn't add up
+    Plane level;
+    level.width = image.width;
+    level.height = image.height;
+    level.pixels.resize((size_t)image.width * image.height * 4);
+    RunRows((int)image.height, [&](int first, int last) {
+        for (int y = first; y < last; y++) {
+            size_t offset = (size_t)y * image.width * 4;
+            LoadRow(image.pixels.data() + offset, level.pixels.data() + offset, image.width, options.isSRGB);
+        }
+    });
+
+    Plane next;
+    Plane temp;
+    for (uint32_t mip = 1; mip < mipsCount; mip++) {
+        next.width = (std::max)(1u, level.width / 2);
+        next.height = (std::max)(1u, level.height / 2);
+        Downsample(level, options, next, temp);
+
+        TextureCompressor::Image& result = mips[mip];
+        result.width = next.width;
+        result.height = next.height;
+        result.pixels.resize((size_t)next.width * next.height * 4);
+        RunRows((int)next.height, [&](int first, int last) {
+            for (int y = first; y < last; y++) {
+                size_t offset = (size_t)y * next.width * 4;
+                StoreRow(next.pixels.data() + offset, result.pixels.data() + offset, next.width, options.isSRGB);
+            }
+        });
+        std::swap(level, next);
+    }
+    return true;
+}
+
+// Function to build mips of first mip of DDS file and write them into new DDS file, BC formats are compressed on the same jobs
+bool MipGenerator::Convert(const DdsFile& file, const Options& options, DdsFile::Format format, const char* path) const {
+    TextureCompressor::Image image;
+    std::vector<TextureCompressor::Image> mips;
+    if (!TextureCompressor::ReadImage(file, 0, image) || !Generate(image, options, mips)) {
+        return false;
+    }
+
+    std::vector<std::vector<unsigned char>> data(mips.size());
+    if (format == DdsFile::FORMAT_R8G8B8A8_UNORM || format == DdsFile::FORMAT_R8G8B8A8_UNORM_SRGB) {
+        for (size_t i = 0; i < mips.size(); i++) {
+            data[i] = std::move(mips[i].pixels);
+        }
+    }
+    else {
+        TextureCompressor compressor;
+        compressor.Init(m_pJobSystem);
+        for (size_t i = 0; i < mips.size(); i++) {
+            if (!compressor.Compress(mips[i], format, data[i])) {
+                return false;
+            }
+        }
+    }
+    return DdsFile::Write(path, format, image.width, image.height, data);
+}
+
+// Function to get count of mips down to 1x1
+uint32_t MipGenerator::GetMipsCount(uint32_t width, uint32_t height) {
+    uint32_t count = 1;
+    for (uint32_t size = (std::max)(width, height); size > 1; size /= 2) {
+        count++;
+    }
+    return count;
+}
+
+// Function to compute taps resampling srcSize pixels to dstSize ones
+void MipGenerator::BuildKernel(Filter filter, uint32_t srcSize, uint32_t dstSize, Kernel& kernel) {
+    kernel.offsets.assign(1, 0);
+    kernel.sources.clear();
+    kernel.weights.clear();
+
+    // Filter is stretched over source pixels, so it keeps its shape in pixels of smaller mip
+    float scale = (float)srcSize / (float)dstSize;
+    float radius = GetFilterRadius(filter) * scale;
+    for (uint32_t x = 0; x < dstSize; x++) {
+        float center = ((float)x + 0.5f) * scale;
+        int first = (int)std::floor(center - radius);
+        int last = (int)std::ceil(center + radius);
+        size_t offset = kernel.weights.size();
+        float sum = 0.0f;
+        for (int i = first; i <= last; i++) {
+            float weight = GetFilterWeight(filter, ((float)i + 0.5f - center) / scale);
+            if (weight == 0.0f) {
+                continue;
+            }
+            kernel.sources.push_back((uint32_t)(std::min)((std::max)(i, 0), (int)srcSize - 1));
+            kernel.weights.push_back(weight);
+            sum += weight;
+        }
+
+        if (sum == 0.0f) {
+            kernel.sources.resize(offset);
+            kernel.weights.resize(offset);
+            kernel.sources.push_back((std::min)((uint32_t)center, srcSize - 1));
+            kernel.weights.push_back(1.0f);
+        }
+        else {
+            for (size_t i = offset; i < kernel.weights.size(); i++) {
+                kernel.weights[i] /= sum;
+            }
+        }
+        kernel.offsets.push_back((uint32_t)kernel.weights.size());
+    }
+}
+
+// Function to filter src to size of dst, temp keeps result of rows pass
+void MipGenerator::Downsample(const Plane& src, const Options& options, Plane& dst, Plane& temp) const {
+    Kernel horizontal;
+    Kernel vertical;
+    BuildKernel(options.filter, src.width, dst.width, horizontal);
+    BuildKernel(options.filter, src.height, dst.height, vertical);
+
+    temp.width = dst.width;
+    temp.height = src.height;
+    temp.pixels.resize((size_t)temp.width * temp.height * 4);
+    dst.pixels.resize((size_t)dst.width * dst.height * 4);
+
+    // Rows pass, every source row is resampled to destination width
+    RunRows((int)src.height, [&](int first, int last) {
+        for (int y = first; y < last; y++) {
+            const float* srcRow = src.pixels.data() + (size_t)y * src.width * 4;
+            float* tempRow = temp.pixels.data() + (size_t)y * temp.width * 4;
+            for (uint32_t x = 0; x < temp.width; x++) {
+#ifdef MIP_GENERATOR_SSE
+                __m128 sum = _mm_setzero_ps();
+                for (uint32_t tap = horizontal.offsets[x]; tap < horizontal.offsets[x + 1]; tap++) {
+                    __m128 pixel = _mm_load_ps(srcRow + horizontal.sources[tap] * 4);
+                    sum = _mm_add_ps(sum, _mm_mul_ps(pixel, _mm_set1_ps(horizontal.weights[tap])));
+                }
+                _mm_store_ps(tempRow + x * 4, sum);
+#else
+                float sum[4] = {};
+                for (uint32_t tap = horizontal.offsets[x]; tap < horizontal.offsets[x + 1]; tap++) {
+                    const float* pixel = srcRow + horizontal.sources[tap] * 4;
+                    for (int c = 0; c < 4; c++) {
+                        sum[c] += pixel[c] * horizontal.weights[tap];
+                    }
+                }
+                for (int c = 0; c < 4; c++) {
+                    tempRow[x * 4 + c] = sum[c];
+                }
+#endif
+            }
+        }
+    });
+
+    // Columns pass, every destination row is weighted sum of whole rows, so it reads memory in order
+    RunRows((int)dst.height, [&](int first, int last) {
+        uint32_t rowSize = dst.width * 4;
+        for (int y = first; y < last; y++) {
+            float* dstRow = dst.pixels.data() + (size_t)y * rowSize;
+            std::fill(dstRow, dstRow + rowSize, 0.0f);
+            for (uint32_t tap = vertical.offsets[y]; tap < vertical.offsets[y + 1]; tap++) {
+                const float* tempRow = temp.pixels.data() + (size_t)vertical.sources[tap] * rowSize;
+#ifdef MIP_GENERATOR_SSE
+                __m128 weight = _mm_set1_ps(vertical.weights[tap]);
+                for (uint32_t i = 0; i < rowSize; i += 4) {
+                    _mm_store_ps(dstRow + i, _mm_add_ps(_mm_load_ps(dstRow + i), _mm_mul_ps(_mm_load_ps(tempRow + i), weight)));
+                }
+#else
+                float weight = vertical.weights[tap];
+                for (uint32_t i = 0; i < rowSize; i++) {
+                    dstRow[i] += tempRow[i] * weight;
+                }
+#endif
+            }
+            FinishRow(dstRow, dst.width, options.isNormalMap);
+        }
+    });
+}
+
+// Function to run func over [0, count) rows on job system or on caller
+void MipGenerator::RunRows(int count, const JobSystem::RangeFunc& func) const {
+    if (m_pJobSystem) {
+        m_pJobSystem->ParallelFor(0, count, MIP_GENERATOR_GRAIN, func);
+    }
+    else {
+        func(0, count);
+    }
+}
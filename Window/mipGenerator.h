@@ -0,0 +1,69 @@
+// mipGenerator.h - class for building filtered mip chains of images on CPU
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "alignedAllocator.h"
+#include "ddsFile.h"
+#include "jobSystem.h"
+#include "textureCompressor.h"
+
+// Rows of mip filtered by one job
+#define MIP_GENERATOR_GRAIN 16
+// Radius of Kaiser and Lanczos kernels in pixels of smaller mip
+#define MIP_GENERATOR_RADIUS 3.0f
+#define MIP_GENERATOR_KAISER_ALPHA 4.0f
+
+// Every mip is filtered from previous one kept in floats, by rows and then by columns with clamped edges.
+// Color of sRGB images is filtered in linear space, normals of normal maps are renormalized in every mip
+class MipGenerator {
+public:
+    enum Filter {
+        FILTER_BOX = 0,     // average of 2x2 pixels for even sizes
+        FILTER_KAISER,      // Kaiser windowed sinc, sharper than box with little ringing
+        FILTER_LANCZOS      // Lanczos-3, sharpest with most ringing
+    };
+
+    struct Options {
+        Filter filter = FILTER_KAISER;
+        bool isSRGB = false;
+        bool isNormalMap = false;   // xyz of pixels are unit normals mapped to [0, 255]
+        uint32_t mipsCount = 0;     // 0 for full chain down to 1x1
+    };
+
+    // Function to set job system filtering rows in parallel, without it mips are built on caller
+    void Init(JobSystem* jobSystem = nullptr) { m_pJobSystem = jobSystem; };
+    void Release() { m_pJobSystem = nullptr; };
+
+    // Function to build mips of image, first mip is image itself, returns false for empty image
+    bool Generate(const TextureCompressor::Image& image, const Options& options, std::vector<TextureCompressor::Image>& mips) const;
+    // Function to build mips of first mip of DDS file and write them into new DDS file, BC formats are compressed on the same jobs
+    bool Convert(const DdsFile& file, const Options& options, DdsFile::Format format, const char* path) const;
+
+    // Function to get count of mips down to 1x1
+    static uint32_t GetMipsCount(uint32_t width, uint32_t height);
+
+private:
+    // RGBA float image, pixel is 16 aligned bytes so SSE filters all its channels at once
+    struct Plane {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        AlignedVector<float> pixels;
+    };
+
+    // Taps of destination pixels along one axis, taps of pixel i are [offsets[i], offsets[i + 1])
+    struct Kernel {
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> sources;  // source pixel of tap, clamped to edges
+        std::vector<float> weights;     // normalized to sum 1 for every destination pixel
+    };
+
+    // Function to compute taps resampling srcSize pixels to dstSize ones
+    static void BuildKernel(Filter filter, uint32_t srcSize, uint32_t dstSize, Kernel& kernel);
+    // Function to filter src to size of dst, temp keeps result of rows pass
+    void Downsample(const Plane& src, const Options& options, Plane& dst, Plane& temp) const;
+    // Function to run func over [0, count) rows on job system or on caller
+    void RunRows(int count, const JobSystem::RangeFunc& func) const;
+
+    JobSystem* m_pJobSystem = nullptr;
+};
@@ -0,0 +1,34 @@
+#include "movement.h"
+#include <algorithm>
+
+// Function to place at position with zero speeds
+void Movement::Reset(const XMFLOAT3& position) {
+    m_position = position;
+    m_prevPosition = position;
+    for (float& speed : m_speeds) {
+        speed = 0.0f;
+    }
+}
+
+// Function to advance by one step of given seconds, held directions speed up and released ones slow down
+void Movement::Step(const bool isPressed[DIRECTION_COUNT], float step) {
+    for (int i = 0; i < DIRECTION_COUNT; i++) {
+        if (isPressed[i]) {
+            m_speeds[i] = (std::min)(m_speeds[i] + MOVEMENT_ACCELERATION * step, MOVEMENT_MAX_SPEED);
+        }
+        else {
+            m_speeds[i] = (std::max)(m_speeds[i] - MOVEMENT_DECELERATION * step, 0.0f);
+        }
+    }
+
+    m_prevPosition = m_position;
+    m_position.x += (m_speeds[DIRECTION_FORWARD] - m_speeds[DIRECTION_BACKWARD]) * step;
+    m_position.z += (m_speeds[DIRECTION_LEFT] - m_speeds[DIRECTION_RIGHT]) * step;
+}
+
+// Function to get position between previous and last steps, alpha in [0, 1] is part of step passed since last one
+XMFLOAT3 Movement::GetPosition(float alpha) const {
+    XMFLOAT3 position;
+    XMStoreFloat3(&position, XMVectorLerp(XMLoadFloat3(&m_prevPosition), XMLoadFloat3(&m_position), alpha));
+    return position;
+}
@@ -0,0 +1,39 @@
+// movement.h - class for keyboard movement with acceleration, advanced by fixed simulation steps
+#pragma once
+
+#include <directxmath.h>
+
+using namespace DirectX;
+
+// Speed in units per second, it is reached after MOVEMENT_MAX_SPEED / MOVEMENT_ACCELERATION seconds of holding key
+#define MOVEMENT_MAX_SPEED 2.0f
+// Accelerations in units per second squared
+#define MOVEMENT_ACCELERATION 5.0f
+#define MOVEMENT_DECELERATION 2.5f
+
+class Movement {
+public:
+    enum Direction {
+        DIRECTION_FORWARD = 0,  // +x
+        DIRECTION_BACKWARD,     // -x
+        DIRECTION_LEFT,         // +z
+        DIRECTION_RIGHT,        // -z
+        DIRECTION_COUNT
+    };
+
+    // Function to place at position with zero speeds
+    void Reset(const XMFLOAT3& position);
+    // Function to advance by one step of given seconds, held directions speed up and released ones slow down
+    void Step(const bool isPressed[DIRECTION_COUNT], float step);
+
+    // Position after last step
+    const XMFLOAT3& GetPosition() const { return m_position; };
+    // Function to get position between previous and last steps, alpha in [0, 1] is part of step passed since last one
+    XMFLOAT3 GetPosition(float alpha) const;
+    float GetSpeed(Direction direction) const { return m_speeds[direction]; };
+
+private:
+    XMFLOAT3 m_position = XMFLOAT3(0.0f, 0.0f, 0.0f);
+    XMFLOAT3 m_prevPosition = XMFLOAT3(0.0f, 0.0f, 0.0f);
+    float m_speeds[DIRECTION_COUNT] = {};
+};
@@ -0,0 +1,74 @@
+#include "pipelineStateCache.h"
+
+// Function to drop cache references to states
+void PipelineStateCache::Release() {
+    m_rasterizerStates.Release();
+    m_blendStates.Release();
+    m_depthStates.Release();
+    m_samplerStates.Release();
+    m_pDevice = nullptr;
+}
+
+HRESULT PipelineStateCache::CreateRasterizerState(const D3D11_RASTERIZER_DESC* desc, ID3D11RasterizerState** state) {
+    return m_rasterizerStates.Get(*desc, state, [this](const D3D11_RASTERIZER_DESC* desc, ID3D11RasterizerState** state) {
+        return m_pDevice->CreateRasterizerState(desc, state);
+    });
+}
+
+HRESULT PipelineStateCache::CreateBlendState(const D3D11_BLEND_DESC* desc, ID3D11BlendState** state) {
+    // Render target descs end with byte write mask, key is rebuilt field by field so padding is zeroed
+    D3D11_BLEND_DESC key;
+    memset(&key, 0, sizeof(key));
+    key.AlphaToCoverageEnable = desc->AlphaToCoverageEnable;
+    key.IndependentBlendEnable = desc->IndependentBlendEnable;
+    for (int i = 0; i < D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT; i++) {
+        const D3D11_RENDER_TARGET_BLEND_DESC& target = desc->RenderTarget[i];
+        key.RenderTarget[i].BlendEnable = target.BlendEnable;
+        key.RenderTarget[i].SrcBlend = target.SrcBlend;
+        key.RenderTarget[i].DestBlend = target.DestBlend;
+        key.RenderTarget[i].BlendOp = target.BlendOp;
+        key.RenderTarget[i].SrcBlendAlpha = target.SrcBlendAlpha;
+        key.RenderTarget[i].DestBlendAlpha = target.DestBlendAlpha;
+        key.RenderTarget[i].BlendOpAlpha = target.BlendOpAlpha;
+        key.RenderTarget[i].RenderTargetWriteMask = target.RenderTargetWriteMask;
+    }
+
+    return m_blendStates.Get(key, state, [this](const D3D11_BLEND_DESC* desc, ID3D11BlendState** state) {
+        return m_pDevice->CreateBlendState(desc, state);
+    });
+}
+
+HRESULT PipelineStateCache::CreateDepthStencilState(const D3D11_DEPTH_STENCIL_DESC* desc, ID3D11DepthStencilState** state) {
+    // Byte stencil masks are followed by padding, key is rebuilt field by field so padding is zeroed
+    D3D11_DEPTH_STENCIL_DESC key;
+    memset(&key, 0, sizeof(key));
+    key.DepthEnable = desc->DepthEnable;
+    key.DepthWriteMask = desc->DepthWriteMask;
+    key.DepthFunc = desc->DepthFunc;
+    key.StencilEnable = desc->StencilEnable;
+    key.StencilReadMask = desc->StencilReadMask;
+    key.StencilWriteMask = desc->StencilWriteMask;
+    key.FrontFace = desc->FrontFace;
+    key.BackFace = desc->BackFace;
+
+    return m_depthStates.Get(key, state, [this](const D3D11_DEPTH_STENCIL_DESC* desc, ID3D11DepthStencilState** state) {
+        return m_pDevice->CreateDepthStencilState(desc, state);
+    });
+}
+
+HRESULT PipelineStateCache::CreateSamplerState(const D3D11_SAMPLER_DESC* desc, ID3D11SamplerState** state) {
+    return m_samplerStates.Get(*desc, state, [this](const D3D11_SAMPLER_DESC* desc, ID3D11SamplerState** state) {
+        return m_pDevice->CreateSamplerState(desc, state);
+    });
+}
+
+// Hits and misses summed over all state types
+PipelineStateCache::Stats PipelineStateCache::GetStats() const {
+    Stats stats;
+    stats.hits = m_rasterizerStates.GetStats().hits + m_blendStates.GetStats().hits +
+        m_depthStates.GetStats().hits + m_samplerStates.GetStats().hits;
+    stats.misses = m_rasterizerStates.GetStats().misses + m_blendStates.GetStats().misses +
+        m_depthStates.GetStats().misses + m_samplerStates.GetStats().misses;
+    stats.objects = m_rasterizerStates.GetSize() + m_blendStates.GetSize() + m_depthStates.GetSize() + m_samplerStates.GetSize();
+    return stats;
+}
@@ -0,0 +1,37 @@
+// pipelineStateCache.h - class for sharing rasterizer, blend, depth and sampler states between objects of scene
+#pragma once
+
+#include <d3d11.h>
+#include "stateObjectCache.h"
+
+class PipelineStateCache {
+public:
+    struct Stats {
+        int hits = 0;
+        int misses = 0;
+        int objects = 0;
+    };
+
+    // Function to set device creating states
+    void Init(ID3D11Device* device) { m_pDevice = device; };
+    // Function to drop cache references to states
+    void Release();
+
+    // Functions to get state for descriptor as device functions do, state is shared by all equal descriptors
+    // and must be released by caller
+    HRESULT CreateRasterizerState(const D3D11_RASTERIZER_DESC* desc, ID3D11RasterizerState** state);
+    HRESULT CreateBlendState(const D3D11_BLEND_DESC* desc, ID3D11BlendState** state);
+    HRESULT CreateDepthStencilState(const D3D11_DEPTH_STENCIL_DESC* desc, ID3D11DepthStencilState** state);
+    HRESULT CreateSamplerState(const D3D11_SAMPLER_DESC* desc, ID3D11SamplerState** state);
+
+    // Hits and misses summed over all state types
+    Stats GetStats() const;
+
+private:
+    ID3D11Device* m_pDevice = nullptr;
+
+    StateObjectCache<D3D11_RASTERIZER_DESC, ID3D11RasterizerState> m_rasterizerStates;
+    StateObjectCache<D3D11_BLEND_DESC, ID3D11BlendState> m_blendStates;
+    StateObjectCache<D3D11_DEPTH_STENCIL_DESC, ID3D11DepthStencilState> m_depthStates;
+    StateObjectCache<D3D11_SAMPLER_DESC, ID3D11SamplerState> m_samplerStates;
+};
@@ -1,28 +1,30 @@
 #include "postEffect.h"
 
-// Function to initialize
-HRESULT PostEffect::Init(ID3D11Device* device, HWND hwnd) {
-    HRESULT hr = S_OK;
-
-    ID3D10Blob* vertexShaderBuffer = nullptr;
-    ID3D10Blob* pixelShaderBuffer = nullptr;
+// Function to add tasks compiling shaders, they run before Init
+void PostEffect::AddLoadTasks(TaskGraph& graph, ShaderCompiler* shaderCompiler, std::vector<int>& tasks) {
     int flags = 0;
 #ifdef _DEBUG
     flags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
 #endif
-    // Compile the vertex shader code.
-    hr = D3DCompileFromFile(L"PostEffectVertexShader.hlsl", NULL, NULL, "main", "vs_5_0", flags, 0, &vertexShaderBuffer, NULL);
-    hr = device->CreateVertexShader(vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), NULL, &m_pVertexShader);
+    tasks.push_back(shaderCompiler->AddCompileTask(graph, "PostEffectVertexShader.hlsl", NULL, "main", "vs_5_0", flags, &m_pVertexShaderBuffer));
+    tasks.push_back(shaderCompiler->AddCompileTask(graph, "PostEffectPixelShader.hlsl", NULL, "main", "ps_5_0", flags, &m_pPixelShaderBuffer));
+}
+
+// Function to initialize
+HRESULT PostEffect::Init(ID3D11Device* device, PipelineStateCache* stateCache, HWND hwnd) {
+    HRESULT hr = S_OK;
+
+    // Create the vertex shader.
+    hr = device->CreateVertexShader(m_pVertexShaderBuffer->GetBufferPointer(), m_pVertexShaderBuffer->GetBufferSize(), NULL, &m_pVertexShader);
 
-    // Compile the pixel shader code.
+    // Create the pixel shader.
     if (SUCCEEDED(hr)) {
-        hr = D3DCompileFromFile(L"PostEffectPixelShader.hlsl", NULL, NULL, "main", "ps_5_0", flags, 0, &pixelShaderBuffer, NULL);
-        hr = device->CreatePixelShader(pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize(), NULL, &m_pPixelShader);
+        hr = device->CreatePixelShader(m_pPixelShaderBuffer->GetBufferPointer(), m_pPixelShaderBuffer->GetBufferSize(), NULL, &m_pPixelShader);
     }
 
     // Release the vertex shader buffer and pixel shader buffer since they are no longer needed.
-    SAFE_RELEASE(vertexShaderBuffer);
-    SAFE_RELEASE(pixelShaderBuffer);
+    SAFE_RELEASE(m_pVertexShaderBuffer);
+    SAFE_RELEASE(m_pPixelShaderBuffer);
 
     if (SUCCEEDED(hr)) {
         // Create the sampler state
@@ -38,7 +40,7 @@ HRESULT PostEffect::Init(ID3D11Device* device, HWND hwnd) {
         samplerDesc.MaxAnisotropy = D3D11_MAX_MAXANISOTROPY;
 
         // Create the texture sampler state.
-        hr = device->CreateSamplerState(&samplerDesc, &m_pSamplerState);
+        hr = stateCache->CreateSamplerState(&samplerDesc, &m_pSamplerState);
         assert(SUCCEEDED(hr));
     }
 
@@ -92,6 +94,8 @@ void PostEffect::Release() {
     SAFE_RELEASE(m_pPixelShader);
     SAFE_RELEASE(m_pVertexShader);
     SAFE_RELEASE(m_pPostEffectConstantBuffer);
+    SAFE_RELEASE(m_pVertexShaderBuffer);
+    SAFE_RELEASE(m_pPixelShaderBuffer);
 }
 
 // Switch flags functions
@@ -4,6 +4,8 @@
 #include <d3d11.h>
 #include <d3dcompiler.h>
 #include "utility.h"
+#include "pipelineStateCache.h"
+#include "shaderCompiler.h"
 #include <directxmath.h>
 
 using namespace DirectX;
@@ -14,8 +16,10 @@ private:
         XMINT4 params;
     };
 public:
+    // Function to add tasks compiling shaders, they run before Init
+    void AddLoadTasks(TaskGraph& graph, ShaderCompiler* shaderCompiler, std::vector<int>& tasks);
     // Function to initialize
-    HRESULT Init(ID3D11Device* device, HWND hwnd);
+    HRESULT Init(ID3D11Device* device, PipelineStateCache* stateCache, HWND hwnd);
     // Function to realese
     void Release();
     // Render function
@@ -23,6 +27,10 @@ public:
     // Switch flags functions
     void ToggleGrayScale(ID3D11DeviceContext* deviceContext);
 private:
+    // Bytecode compiled by load tasks, released by Init
+    ID3D10Blob* m_pVertexShaderBuffer = nullptr;
+    ID3D10Blob* m_pPixelShaderBuffer = nullptr;
+
     ID3D11VertexShader* m_pVertexShader = nullptr;
     ID3D11PixelShader* m_pPixelShader = nullptr;
     ID3D11SamplerState* m_pSamplerState = nullptr;
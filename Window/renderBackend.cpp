@@ -0,0 +1,292 @@
+#include "renderBackend.h"
+#include <assert.h>
+
+// Function to set context for submission and ring for constants
+void D3D11Backend::Init(ID3D11DeviceContext1* context, ConstantRing* constantRing) {
+    m_pContext = context;
+    m_pContext->GetDevice(&m_pDevice);
+    m_pConstantRing = constantRing;
+    m_pRegistry = this;
+    m_stateCache.Init(context);
+}
+
+// Function to set deferred context for recording, states are looked up in registry of other backend
+void D3D11Backend::InitDeferred(ID3D11DeviceContext1* context, const D3D11Backend* registry) {
+    m_pContext = context;
+    m_pRegistry = registry;
+    m_stateCache.Init(context);
+}
+
+// Function to set render targets, viewports and scissor rects of given context, deferred context starts without them
+void D3D11Backend::CopyTargets(ID3D11DeviceContext* source) {
+    ID3D11RenderTargetView* views[D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT] = {};
+    ID3D11DepthStencilView* depthView = nullptr;
+    source->OMGetRenderTargets(D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT, views, &depthView);
+    m_pContext->OMSetRenderTargets(D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT, views, depthView);
+    for (ID3D11RenderTargetView*& view : views) {
+        SAFE_RELEASE(view);
+    }
+    SAFE_RELEASE(depthView);
+
+    D3D11_VIEWPORT viewports[D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE];
+    UINT viewportsCount = D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE;
+    source->RSGetViewports(&viewportsCount, viewports);
+    m_pContext->RSSetViewports(viewportsCount, viewports);
+
+    D3D11_RECT rects[D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE];
+    UINT rectsCount = D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE;
+    source->RSGetScissorRects(&rectsCount, rects);
+    m_pContext->RSSetScissorRects(rectsCount, rects);
+}
+
+// Function to release owned buffers and forget all registered states
+void D3D11Backend::Release() {
+    for (Buffer& buffer : m_buffers) {
+        SAFE_RELEASE(buffer.pBuffer);
+        if (buffer.view >= 0) {
+            SAFE_RELEASE(m_views[buffer.view]);
+        }
+        if (buffer.unorderedView >= 0) {
+            SAFE_RELEASE(m_unorderedViews[buffer.unorderedView]);
+        }
+    }
+    SAFE_RELEASE(m_pDevice);
+    m_pContext = nullptr;
+    m_pConstantRing = nullptr;
+    m_pRegistry = nullptr;
+    m_pipelines.clear();
+    m_materials.clear();
+    m_buffers.clear();
+    m_queries.clear();
+    m_computes.clear();
+    m_views.clear();
+    m_unorderedViews.clear();
+    m_constants.clear();
+}
+
+int D3D11Backend::AddPipeline(const PipelineDesc& desc) {
+    m_pipelines.push_back(desc);
+    return (int)m_pipelines.size() - 1;
+}
+
+int D3D11Backend::AddMaterial(const MaterialDesc& desc) {
+    m_materials.push_back(desc);
+    return (int)m_materials.size() - 1;
+}
+
+int D3D11Backend::AddQuery(ID3D11Query* query) {
+    m_queries.push_back(query);
+    return (int)m_queries.size() - 1;
+}
+
+int D3D11Backend::AddCompute(const ComputeDesc& desc) {
+    m_computes.push_back(desc);
+    return (int)m_computes.size() - 1;
+}
+
+// Function to create buffer, returns -1 on failure
+int D3D11Backend::AddBuffer(const BufferDesc& desc) {
+    Buffer buffer;
+    buffer.desc = desc;
+    if (FAILED(CreateBuffer(buffer))) {
+        return -1;
+    }
+
+    m_buffers.push_back(buffer);
+    return (int)m_buffers.size() - 1;
+}
+
+int D3D11Backend::AddView(ID3D11ShaderResourceView* view) {
+    m_views.push_back(view);
+    return (int)m_views.size() - 1;
+}
+
+int D3D11Backend::AddConstants() {
+    m_constants.push_back(ConstantRing::Allocation());
+    return (int)m_constants.size() - 1;
+}
+
+// Function to (re)create buffer and its views, view ids are kept
+HRESULT D3D11Backend::CreateBuffer(Buffer& buffer) {
+    HRESULT hr = S_OK;
+
+    SAFE_RELEASE(buffer.pBuffer);
+    if (buffer.view >= 0) {
+        SAFE_RELEASE(m_views[buffer.view]);
+    }
+    if (buffer.unorderedView >= 0) {
+        SAFE_RELEASE(m_unorderedViews[buffer.unorderedView]);
+    }
+
+    D3D11_BUFFER_DESC desc = {};
+    desc.ByteWidth = buffer.desc.size;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = buffer.desc.bindFlags;
+    desc.CPUAccessFlags = 0;
+    desc.MiscFlags = buffer.desc.miscFlags;
+    desc.StructureByteStride = buffer.desc.stride;
+
+    hr = m_pDevice->CreateBuffer(&desc, nullptr, &buffer.pBuffer);
+
+    if (SUCCEEDED(hr) && (desc.BindFlags & D3D11_BIND_SHADER_RESOURCE)) {
+        if (buffer.view < 0) {
+            buffer.view = AddView(nullptr);
+        }
+        hr = m_pDevice->CreateShaderResourceView(buffer.pBuffer, nullptr, &m_views[buffer.view]);
+    }
+
+    if (SUCCEEDED(hr) && (desc.BindFlags & D3D11_BIND_UNORDERED_ACCESS)) {
+        if (buffer.unorderedView < 0) {
+            m_unorderedViews.push_back(nullptr);
+            buffer.unorderedView = (int)m_unorderedViews.size() - 1;
+        }
+        hr = m_pDevice->CreateUnorderedAccessView(buffer.pBuffer, nullptr, &m_unorderedViews[buffer.unorderedView]);
+    }
+    assert(SUCCEEDED(hr));
+
+    return hr;
+}
+
+void D3D11Backend::SetPipeline(int pipeline) {
+    const PipelineDesc& desc = m_pRegistry->m_pipelines[pipeline];
+    m_stateCache.IASetInputLayout(desc.pInputLayout);
+    m_stateCache.IASetPrimitiveTopology(desc.topology);
+    m_stateCache.VSSetShader(desc.pVertexShader, nullptr, 0);
+    m_stateCache.PSSetShader(desc.pPixelShader, nullptr, 0);
+    m_stateCache.RSSetState(desc.pRasterizerState);
+    m_stateCache.OMSetBlendState(desc.pBlendState, nullptr, 0xFFFFFFFF);
+    m_stateCache.OMSetDepthStencilState(desc.pDepthState, 0);
+}
+
+void D3D11Backend::SetMaterial(int material) {
+    const MaterialDesc& desc = m_pRegistry->m_materials[material];
+    UINT offset = 0;
+    m_stateCache.IASetVertexBuffers(0, 1, &desc.pVertexBuffer, &desc.vertexStride, &offset);
+    m_stateCache.IASetIndexBuffer(desc.pIndexBuffer, desc.indexFormat, 0);
+    SetConstants(desc.vsConstants, STAGE_VERTEX);
+    SetConstants(desc.psConstants, STAGE_PIXEL);
+    ID3D11ShaderResourceView* views[MaxResources];
+    GetViews(desc.vsResources, MaxResources, views);
+    m_stateCache.VSSetShaderResources(0, MaxResources, views);
+    GetViews(desc.psResources, MaxResources, views);
+    m_stateCache.PSSetShaderResources(0, MaxResources, views);
+    m_stateCache.PSSetSamplers(0, MaxSamplers, desc.psSamplers);
+}
+
+// Function to look up views by ids
+void D3D11Backend::GetViews(const int* views, int count, ID3D11ShaderResourceView** pViews) const {
+    for (int i = 0; i < count; i++) {
+        pViews[i] = views[i] >= 0 ? m_pRegistry->m_views[views[i]] : nullptr;
+    }
+}
+
+// Function to bind constant ranges of shader stage
+void D3D11Backend::SetConstants(const int* constants, Stage stage) {
+    ID3D11Buffer* buffers[MaxConstantBuffers];
+    UINT firstConstants[MaxConstantBuffers];
+    UINT numConstants[MaxConstantBuffers];
+    for (int i = 0; i < MaxConstantBuffers; i++) {
+        ConstantRing::Allocation allocation;
+        if (constants[i] >= 0) {
+            allocation = m_pRegistry->m_constants[constants[i]];
+        }
+        buffers[i] = allocation.pBuffer;
+        firstConstants[i] = allocation.firstConstant;
+        numConstants[i] = allocation.numConstants;
+    }
+
+    switch (stage) {
+    case STAGE_VERTEX:
+        m_stateCache.VSSetConstantBuffers1(0, MaxConstantBuffers, buffers, firstConstants, numConstants);
+        break;
+    case STAGE_PIXEL:
+        m_stateCache.PSSetConstantBuffers1(0, MaxConstantBuffers, buffers, firstConstants, numConstants);
+        break;
+    case STAGE_COMPUTE:
+        // Compute stage is not shadowed, dispatches are few
+        m_pContext->CSSetConstantBuffers1(0, MaxConstantBuffers, buffers, firstConstants, numConstants);
+        break;
+    }
+}
+
+void D3D11Backend::Draw(const DrawPacket& packet) {
+    ID3D11Query* query = packet.query >= 0 ? m_pRegistry->m_queries[packet.query] : nullptr;
+    if (query) {
+        m_pContext->Begin(query);
+    }
+
+    if (packet.indirectArgs >= 0) {
+        m_pContext->DrawIndexedInstancedIndirect(m_pRegistry->m_buffers[packet.indirectArgs].pBuffer, 0);
+    }
+    else {
+        m_pContext->DrawIndexedInstanced(packet.indexCount, packet.instanceCount, packet.startIndex, 0, 0);
+    }
+
+    if (query) {
+        m_pContext->End(query);
+    }
+}
+
+void D3D11Backend::UploadBuffer(int buffer, uint32_t offset, const void* data, uint32_t size) {
+    D3D11_BOX box = { offset, 0, 0, offset + size, 1, 1 };
+    m_pContext->UpdateSubresource(m_pRegistry->m_buffers[buffer].pBuffer, 0, &box, data, 0, 0);
+}
+
+void D3D11Backend::CopyBuffer(int dstBuffer, int srcBuffer) {
+    m_pContext->CopyResource(m_pRegistry->m_buffers[dstBuffer].pBuffer, m_pRegistry->m_buffers[srcBuffer].pBuffer);
+}
+
+void D3D11Backend::Dispatch(int compute, uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ) {
+    const ComputeDesc& desc = m_pRegistry->m_computes[compute];
+
+    // Written views may still be bound for drawing from the previous frame.
+    // Context is used directly as shadow state is invalidated before drawing anyway
+    ID3D11ShaderResourceView* nullResources[MaxResources] = {};
+    m_pContext->VSSetShaderResources(0, MaxResources, nullResources);
+    m_pContext->PSSetShaderResources(0, MaxResources, nullResources);
+
+    SetConstants(desc.constants, STAGE_COMPUTE);
+    ID3D11ShaderResourceView* resources[MaxResources];
+    GetViews(desc.resources, MaxResources, resources);
+    m_pContext->CSSetShaderResources(0, MaxResources, resources);
+    ID3D11UnorderedAccessView* unorderedViews[MaxUnorderedViews];
+    for (int i = 0; i < MaxUnorderedViews; i++) {
+        unorderedViews[i] = desc.unorderedViews[i] >= 0 ? m_pRegistry->m_unorderedViews[desc.unorderedViews[i]] : nullptr;
+    }
+    m_pContext->CSSetUnorderedAccessViews(0, MaxUnorderedViews, unorderedViews, nullptr);
+    m_pContext->CSSetShader(desc.pComputeShader, nullptr, 0);
+    if (groupsX > 0 && groupsY > 0 && groupsZ > 0) {
+        m_pContext->Dispatch(groupsX, groupsY, groupsZ);
+    }
+
+    // Written views are read by following draws
+    ID3D11UnorderedAccessView* nullViews[MaxUnorderedViews] = {};
+    m_pContext->CSSetUnorderedAccessViews(0, MaxUnorderedViews, nullViews, nullptr);
+}
+
+bool D3D11Backend::ResizeBuffer(int buffer, uint32_t size) {
+    Buffer& target = m_buffers[buffer];
+    target.desc.size = size;
+    HRESULT hr = CreateBuffer(target);
+
+    // New buffer or view may reuse address of released one still in shadow state
+    m_stateCache.Invalidate();
+    return SUCCEEDED(hr);
+}
+
+bool D3D11Backend::MapConstants() {
+    return SUCCEEDED(m_pConstantRing->BeginFrame());
+}
+
+void* D3D11Backend::AllocateConstants(int constants, uint32_t size) {
+    ConstantRing::Allocation& allocation = m_constants[constants];
+    return m_pConstantRing->Allocate(size, allocation) ? allocation.pData : nullptr;
+}
+
+void D3D11Backend::UnmapConstants() {
+    m_pConstantRing->Unmap();
+}
+
+void D3D11Backend::EndFrame() {
+    m_pConstantRing->EndFrame();
+}
@@ -0,0 +1,143 @@
+// renderBackend.h - class for submitting render queue packets to D3D11 context
+#pragma once
+
+#include <d3d11_1.h>
+#include <vector>
+#include "renderQueue.h"
+#include "stateCache.h"
+#include "constantRing.h"
+
+class D3D11Backend : public RenderBackend {
+public:
+    // Binding slots set by material, unused ones are set to null
+    static const int MaxConstantBuffers = 4;
+    static const int MaxResources = 4;
+    static const int MaxSamplers = 1;
+    static const int MaxUnorderedViews = 2;
+
+    // States are not referenced, their owners keep them alive while backend uses them
+    struct PipelineDesc {
+        ID3D11VertexShader* pVertexShader = nullptr;
+        ID3D11PixelShader* pPixelShader = nullptr;
+        ID3D11InputLayout* pInputLayout = nullptr;
+        D3D11_PRIMITIVE_TOPOLOGY topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+        ID3D11RasterizerState* pRasterizerState = nullptr;
+        ID3D11BlendState* pBlendState = nullptr;
+        ID3D11DepthStencilState* pDepthState = nullptr;
+    };
+
+    // Constants and views are backend ids, -1 binds null. Constants are per-frame ranges of constant ring
+    struct MaterialDesc {
+        ID3D11Buffer* pVertexBuffer = nullptr;
+        UINT vertexStride = 0;
+        ID3D11Buffer* pIndexBuffer = nullptr;
+        DXGI_FORMAT indexFormat = DXGI_FORMAT_R16_UINT;
+        int vsConstants[MaxConstantBuffers] = { -1, -1, -1, -1 };
+        int psConstants[MaxConstantBuffers] = { -1, -1, -1, -1 };
+        int vsResources[MaxResources] = { -1, -1, -1, -1 };
+        int psResources[MaxResources] = { -1, -1, -1, -1 };
+        ID3D11SamplerState* psSamplers[MaxSamplers] = {};
+    };
+
+    // Compute shader with its bindings, views written by it are unbound from graphics stages before dispatch
+    struct ComputeDesc {
+        ID3D11ComputeShader* pComputeShader = nullptr;
+        int constants[MaxConstantBuffers] = { -1, -1, -1, -1 };
+        int resources[MaxResources] = { -1, -1, -1, -1 };
+        int unorderedViews[MaxUnorderedViews] = { -1, -1 };
+    };
+
+    // Default usage buffer owned by backend, shader resource and unordered access bind flags get views of whole buffer
+    struct BufferDesc {
+        UINT size = 0;
+        UINT bindFlags = 0;
+        UINT miscFlags = 0;
+        UINT stride = 0;
+    };
+
+    typedef StateCache<ID3D11DeviceContext1>::Stats StateStats;
+
+    // Function to set context for submission and ring for constants, D3D11.1 context is needed to bind constant buffer ranges
+    void Init(ID3D11DeviceContext1* context, ConstantRing* constantRing);
+    // Function to set deferred context for recording, states are looked up in registry of other backend
+    void InitDeferred(ID3D11DeviceContext1* context, const D3D11Backend* registry);
+    // Function to set render targets, viewports and scissor rects of given context, deferred context starts without them
+    void CopyTargets(ID3D11DeviceContext* source);
+    // Function to release owned buffers and forget all registered states
+    void Release();
+    // Function to forget bound states, needed after context was used outside of backend
+    void Invalidate() { m_stateCache.Invalidate(); };
+    // Function to start counting binds of new frame
+    void ResetStats() { m_stateCache.ResetStats(); };
+    // Binds issued to context and elided by state cache
+    const StateStats& GetStateStats() const { return m_stateCache.GetStats(); };
+
+    // Functions to register states, return ids for draw packets
+    int AddPipeline(const PipelineDesc& desc);
+    int AddMaterial(const MaterialDesc& desc);
+    int AddQuery(ID3D11Query* query);
+    int AddCompute(const ComputeDesc& desc);
+    // Function to create buffer, returns -1 on failure
+    int AddBuffer(const BufferDesc& desc);
+    // Function to register view of resource owned by caller, it may be null until set by UpdateView
+    int AddView(ID3D11ShaderResourceView* view);
+    // Function to register constants id, its range is allocated every frame by AllocateConstants
+    int AddConstants();
+    // Function to replace view, used when streamed texture is recreated
+    void UpdateView(int view, ID3D11ShaderResourceView* pView) { m_views[view] = pView; };
+    // Views of whole buffer, -1 if buffer has no such bind flag
+    int GetBufferView(int buffer) const { return m_buffers[buffer].view; };
+    int GetBufferUnorderedView(int buffer) const { return m_buffers[buffer].unorderedView; };
+
+    void SetPipeline(int pipeline) override;
+    void SetMaterial(int material) override;
+    void Draw(const DrawPacket& packet) override;
+    void UploadBuffer(int buffer, uint32_t offset, const void* data, uint32_t size) override;
+    void CopyBuffer(int dstBuffer, int srcBuffer) override;
+    void Dispatch(int compute, uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ) override;
+    bool ResizeBuffer(int buffer, uint32_t size) override;
+    bool MapConstants() override;
+    void* AllocateConstants(int constants, uint32_t size) override;
+    void UnmapConstants() override;
+    void EndFrame() override;
+
+private:
+    enum Stage {
+        STAGE_VERTEX = 0,
+        STAGE_PIXEL,
+        STAGE_COMPUTE
+    };
+
+    struct Buffer {
+        BufferDesc desc;
+        ID3D11Buffer* pBuffer = nullptr;
+        int view = -1;
+        int unorderedView = -1;
+    };
+
+    // Function to (re)create buffer and its views, view ids are kept
+    HRESULT CreateBuffer(Buffer& buffer);
+    // Function to bind constant ranges of shader stage
+    void SetConstants(const int* constants, Stage stage);
+    // Function to look up views by ids
+    void GetViews(const int* views, int count, ID3D11ShaderResourceView** pViews) const;
+
+    ID3D11DeviceContext1* m_pContext = nullptr;
+    ID3D11Device* m_pDevice = nullptr;
+    ConstantRing* m_pConstantRing = nullptr;
+    // Backend with registered states, itself unless recording for other backend
+    const D3D11Backend* m_pRegistry = nullptr;
+    // Filters binds equal to already bound ones
+    StateCache<ID3D11DeviceContext1> m_stateCache;
+
+    std::vector<PipelineDesc> m_pipelines;
+    std::vector<MaterialDesc> m_materials;
+    std::vector<Buffer> m_buffers;
+    std::vector<ID3D11Query*> m_queries;
+    std::vector<ComputeDesc> m_computes;
+    // Views of own buffers are released with them, other views are owned by callers
+    std::vector<ID3D11ShaderResourceView*> m_views;
+    std::vector<ID3D11UnorderedAccessView*> m_unorderedViews;
+    // Constant ranges of current frame
+    std::vector<ConstantRing::Allocation> m_constants;
+};
@@ -0,0 +1,357 @@
+#include "renderQueue.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+// Function to start counting, commands are stored only if record is true.
+// Next backend gets all commands, nullptr runs without graphics API
+void RecordingBackend::Init(bool record, RenderBackend* next) {
+    m_isRecording = record;
+    m_pNext = next;
+    Reset();
+}
+
+// Function to forget counted commands
+void RecordingBackend::Reset() {
+    m_commands.clear();
+    m_pipelineChanges = 0;
+    m_materialChanges = 0;
+    m_drawsCount = 0;
+    m_uploadsCount = 0;
+    m_uploadBytes = 0;
+    m_copiesCount = 0;
+    m_dispatchesCount = 0;
+    m_resizesCount = 0;
+    m_constantBytes = 0;
+}
+
+// Release function
+void RecordingBackend::Release() {
+    m_pNext = nullptr;
+    m_constantData.clear();
+    Reset();
+}
+
+// Function to add commands and counters of other backend after own ones, merges parts recorded in parallel
+void RecordingBackend::Append(const RecordingBackend& other) {
+    if (m_isRecording) {
+        for (const Command& command : other.m_commands) {
+            m_commands.push_back(command);
+            // Draws are numbered in submission order
+            if (command.type == COMMAND_DRAW) {
+                m_commands.back().id += m_drawsCount;
+            }
+        }
+    }
+    m_pipelineChanges += other.m_pipelineChanges;
+    m_materialChanges += other.m_materialChanges;
+    m_drawsCount += other.m_drawsCount;
+    m_uploadsCount += other.m_uploadsCount;
+    m_uploadBytes += other.m_uploadBytes;
+    m_copiesCount += other.m_copiesCount;
+    m_dispatchesCount += other.m_dispatchesCount;
+    m_resizesCount += other.m_resizesCount;
+    m_constantBytes += other.m_constantBytes;
+}
+
+void RecordingBackend::SetPipeline(int pipeline) {
+    m_pipelineChanges++;
+    if (m_isRecording) {
+        m_commands.push_back({ COMMAND_SET_PIPELINE, pipeline, 0 });
+    }
+    if (m_pNext) {
+        m_pNext->SetPipeline(pipeline);
+    }
+}
+
+void RecordingBackend::SetMaterial(int material) {
+    m_materialChanges++;
+    if (m_isRecording) {
+        m_commands.push_back({ COMMAND_SET_MATERIAL, material, 0 });
+    }
+    if (m_pNext) {
+        m_pNext->SetMaterial(material);
+    }
+}
+
+void RecordingBackend::Draw(const DrawPacket& packet) {
+    if (m_isRecording) {
+        m_commands.push_back({ COMMAND_DRAW, m_drawsCount, 0 });
+    }
+    m_drawsCount++;
+    if (m_pNext) {
+        m_pNext->Draw(packet);
+    }
+}
+
+void RecordingBackend::UploadBuffer(int buffer, uint32_t offset, const void* data, uint32_t size) {
+    m_uploadsCount++;
+    m_uploadBytes += size;
+    if (m_isRecording) {
+        m_commands.push_back({ COMMAND_UPLOAD, buffer, size });
+    }
+    if (m_pNext) {
+        m_pNext->UploadBuffer(buffer, offset, data, size);
+    }
+}
+
+void RecordingBackend::CopyBuffer(int dstBuffer, int srcBuffer) {
+    m_copiesCount++;
+    if (m_isRecording) {
+        m_commands.push_back({ COMMAND_COPY, dstBuffer, 0 });
+    }
+    if (m_pNext) {
+        m_pNext->CopyBuffer(dstBuffer, srcBuffer);
+    }
+}
+
+void RecordingBackend::Dispatch(int compute, uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ) {
+    m_dispatchesCount++;
+    if (m_isRecording) {
+        m_commands.push_back({ COMMAND_DISPATCH, compute, 0 });
+    }
+    if (m_pNext) {
+        m_pNext->Dispatch(compute, groupsX, groupsY, groupsZ);
+    }
+}
+
+bool RecordingBackend::ResizeBuffer(int buffer, uint32_t size) {
+    m_resizesCount++;
+    if (m_isRecording) {
+        m_commands.push_back({ COMMAND_RESIZE, buffer, size });
+    }
+    return m_pNext ? m_pNext->ResizeBuffer(buffer, size) : true;
+}
+
+bool RecordingBackend::MapConstants() {
+    return m_pNext ? m_pNext->MapConstants() : true;
+}
+
+void* RecordingBackend::AllocateConstants(int constants, uint32_t size) {
+    m_constantBytes += size;
+    if (m_isRecording) {
+        m_commands.push_back({ COMMAND_CONSTANTS, constants, size });
+    }
+    if (m_pNext) {
+        return m_pNext->AllocateConstants(constants, size);
+    }
+
+    // Without graphics API constants are written to own memory, so their values can be checked
+    if (constants >= (int)m_constantData.size()) {
+        m_constantData.resize(constants + 1);
+    }
+    m_constantData[constants].assign(size, 0);
+    return m_constantData[constants].data();
+}
+
+void RecordingBackend::UnmapConstants() {
+    if (m_pNext) {
+        m_pNext->UnmapConstants();
+    }
+}
+
+void RecordingBackend::EndFrame() {
+    if (m_isRecording) {
+        m_commands.push_back({ COMMAND_END_FRAME, 0, 0 });
+    }
+    if (m_pNext) {
+        m_pNext->EndFrame();
+    }
+}
+
+// Constants written last time under given id when there is no next backend, nullptr if they never were
+const void* RecordingBackend::GetConstants(int constants) const {
+    if (constants < 0 || constants >= (int)m_constantData.size() || m_constantData[constants].empty()) {
+        return nullptr;
+    }
+    return m_constantData[constants].data();
+}
+
+// Function to set job system used by sort, nullptr sorts on calling thread
+void RenderQueue::Init(JobSystem* jobSystem) {
+    m_pJobSystem = jobSystem;
+    Clear();
+}
+
+// Release function
+void RenderQueue::Release() {
+    m_pJobSystem = nullptr;
+    m_packets.clear();
+    m_items.clear();
+    m_tempItems.clear();
+    m_rangeCounts.clear();
+    m_partStats.clear();
+}
+
+// Function to build sort key, opaque packets go front to back and transparent ones back to front by view depth
+uint64_t RenderQueue::MakeKey(Pass pass, bool transparent, int pipeline, int material, float depth) {
+    assert(pipeline >= 0 && pipeline < (1 << PipelineBits));
+    assert(material >= 0 && material < (1 << MaterialBits));
+
+    // Float to sortable uint flip: negative floats invert all bits, positive ones only the sign
+    uint32_t depthBits;
+    memcpy(&depthBits, &depth, sizeof(depthBits));
+    depthBits ^= (depthBits & 0x80000000u) ? 0xFFFFFFFFu : 0x80000000u;
+
+    uint64_t key = (uint64_t)pass << (64 - PassBits);
+    if (transparent) {
+        key |= 1ull << (63 - PassBits);
+        key |= (uint64_t)(~depthBits) << (MaterialBits + PipelineBits);
+        key |= (uint64_t)pipeline << MaterialBits;
+        key |= (uint64_t)material;
+    }
+    else {
+        key |= (uint64_t)pipeline << (32 + MaterialBits);
+        key |= (uint64_t)material << 32;
+        key |= (uint64_t)depthBits;
+    }
+    return key;
+}
+
+// Function to remove all packets
+void RenderQueue::Clear() {
+    m_packets.clear();
+    m_items.clear();
+}
+
+// Function to add packet, its key should be filled by MakeKey
+void RenderQueue::Push(const DrawPacket& packet) {
+    m_packets.push_back(packet);
+}
+
+// Function to sort packets by keys, order of packets with equal keys is kept
+void RenderQueue::Sort() {
+    int count = GetCount();
+    m_items.resize(count);
+
+    // Bits that differ between keys, passes over digits equal for all keys are skipped
+    uint64_t keysOr = 0;
+    uint64_t keysAnd = ~0ull;
+    for (int i = 0; i < count; i++) {
+        uint64_t key = m_packets[i].key;
+        m_items[i] = { key, i };
+        keysOr |= key;
+        keysAnd &= key;
+    }
+    uint64_t changingBits = keysOr ^ keysAnd;
+    if (count < 2 || changingBits == 0)
+        return;
+
+    m_tempItems.resize(count);
+    int rangesCount = JobSystem::GetRangesCount(0, count, SortGrain);
+    m_rangeCounts.resize(rangesCount * RadixSize);
+
+    // Ranges run on job system if there is one, stable order inside ranges keeps whole sort stable.
+    // Job system may merge ranges when it has no workers, so they are split back to keep range index first / SortGrain
+    auto forRanges = [&](const JobSystem::RangeFunc& func) {
+        JobSystem::RangeFunc split = [&](int first, int last) {
+            for (int rangeFirst = first; rangeFirst < last; rangeFirst += SortGrain) {
+                func(rangeFirst, (std::min)(rangeFirst + SortGrain, last));
+            }
+        };
+        if (m_pJobSystem) {
+            m_pJobSystem->ParallelFor(0, count, SortGrain, split);
+        }
+        else {
+            split(0, count);
+        }
+    };
+
+    for (int pass = 0; pass < RadixPasses; pass++) {
+        int shift = pass * RadixBits;
+        if (((changingBits >> shift) & (RadixSize - 1)) == 0)
+            continue;
+
+        // Digit counts of each range
+        forRanges([&](int first, int last) {
+            int* counts = m_rangeCounts.data() + (first / SortGrain) * RadixSize;
+            std::fill(counts, counts + RadixSize, 0);
+            for (int i = first; i < last; i++) {
+                counts[(m_items[i].key >> shift) & (RadixSize - 1)]++;
+            }
+        });
+
+        // Offsets go digit by digit and inside digit range by range
+        int offset = 0;
+        for (int digit = 0; digit < RadixSize; digit++) {
+            for (int range = 0; range < rangesCount; range++) {
+                int& digitCount = m_rangeCounts[range * RadixSize + digit];
+                int rangeCount = digitCount;
+                digitCount = offset;
+                offset += rangeCount;
+            }
+        }
+
+        forRanges([&](int first, int last) {
+            int* offsets = m_rangeCounts.data() + (first / SortGrain) * RadixSize;
+            for (int i = first; i < last; i++) {
+                const SortItem& item = m_items[i];
+                m_tempItems[offsets[(item.key >> shift) & (RadixSize - 1)]++] = item;
+            }
+        });
+
+        m_items.swap(m_tempItems);
+    }
+}
+
+// Function to send sorted packets to backend, pipeline and material are set only when they change
+void RenderQueue::Submit(RenderBackend* backend) {
+    m_stats = SubmitStats();
+    SubmitRange(backend, 0, (int)m_items.size(), m_stats);
+}
+
+// Function to get count of parts for SubmitParallel, each part gets at least SubmitGrain packets
+int RenderQueue::GetSubmitParts(int maxParts) const {
+    int parts = JobSystem::GetRangesCount(0, (int)m_items.size(), SubmitGrain);
+    return (std::max)(1, (std::min)(parts, maxParts));
+}
+
+// Function to send sorted packets split in contiguous parts to own backend each, parts are submitted in parallel.
+// Executing backends in part order gives sort order, each part starts with its own pipeline and material binds
+void RenderQueue::SubmitParallel(RenderBackend* const* backends, int partsCount) {
+    int count = (int)m_items.size();
+    m_partStats.assign(partsCount, SubmitStats());
+
+    // Parts are split evenly, so they depend only on packets count and not on scheduling
+    JobSystem::RangeFunc submitParts = [&](int first, int last) {
+        for (int part = first; part < last; part++) {
+            int partFirst = int((int64_t)count * part / partsCount);
+            int partLast = int((int64_t)count * (part + 1) / partsCount);
+            SubmitRange(backends[part], partFirst, partLast, m_partStats[part]);
+        }
+    };
+    if (m_pJobSystem && partsCount > 1) {
+        m_pJobSystem->ParallelFor(0, partsCount, 1, submitParts);
+    }
+    else {
+        submitParts(0, partsCount);
+    }
+
+    m_stats = SubmitStats();
+    for (const SubmitStats& stats : m_partStats) {
+        m_stats.packets += stats.packets;
+        m_stats.pipelineChanges += stats.pipelineChanges;
+        m_stats.materialChanges += stats.materialChanges;
+    }
+}
+
+// Function to send sorted packets of [first, last) range to backend
+void RenderQueue::SubmitRange(RenderBackend* backend, int first, int last, SubmitStats& stats) const {
+    int pipeline = -1;
+    int material = -1;
+    for (int i = first; i < last; i++) {
+        const DrawPacket& packet = m_packets[m_items[i].packet];
+        if (packet.pipeline != pipeline) {
+            pipeline = packet.pipeline;
+            backend->SetPipeline(pipeline);
+            stats.pipelineChanges++;
+        }
+        if (packet.material != material) {
+            material = packet.material;
+            backend->SetMaterial(material);
+            stats.materialChanges++;
+        }
+        backend->Draw(packet);
+        stats.packets++;
+    }
+}
@@ -0,0 +1,202 @@
+// renderQueue.h - classes for sorting draw packets by 64-bit keys and submitting them with minimal state changes
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "alignedAllocator.h"
+#include "jobSystem.h"
+
+// Draw call with ids of states it needs
+struct DrawPacket {
+    uint64_t key = 0;
+    int pipeline = 0;       // shaders, input layout and fixed function states
+    int material = 0;       // buffers, textures and samplers
+    int indexCount = 0;
+    int instanceCount = 1;
+    int startIndex = 0;
+    int indirectArgs = -1;  // backend buffer with draw arguments, -1 for direct draw
+    int query = -1;         // backend query wrapped around draw, -1 for none
+};
+
+// Interface of graphics API side of frame: draws of render queue, buffer uploads, per-frame constants and compute dispatches.
+// States and resources are referenced by ids registered in implementation
+class RenderBackend {
+public:
+    virtual ~RenderBackend() {};
+    // Function to bind shaders, input layout and fixed function states of pipeline
+    virtual void SetPipeline(int pipeline) = 0;
+    // Function to bind buffers, textures and samplers of material
+    virtual void SetMaterial(int material) = 0;
+    // Function to issue draw call
+    virtual void Draw(const DrawPacket& packet) = 0;
+    // Function to write size bytes of data to buffer at offset
+    virtual void UploadBuffer(int buffer, uint32_t offset, const void* data, uint32_t size) = 0;
+    // Function to copy whole buffer to other one of same size
+    virtual void CopyBuffer(int dstBuffer, int srcBuffer) = 0;
+    // Function to run compute shader with its bindings
+    virtual void Dispatch(int compute, uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ) = 0;
+    // Function to recreate buffer with new size in bytes, its contents are lost
+    virtual bool ResizeBuffer(int buffer, uint32_t size) = 0;
+    // Function to start writing constants of frame
+    virtual bool MapConstants() = 0;
+    // Function to get memory for size bytes of constants bound by their id, valid until UnmapConstants, nullptr on failure
+    virtual void* AllocateConstants(int constants, uint32_t size) = 0;
+    // Function to finish writing constants, must be called before draws and dispatches use them
+    virtual void UnmapConstants() = 0;
+    // Function to mark end of frame, constants of frame are kept until GPU finishes it
+    virtual void EndFrame() = 0;
+};
+
+// Backend without graphics API, counts and optionally records commands, then passes them to next backend if there is one
+class RecordingBackend : public RenderBackend {
+public:
+    enum CommandType {
+        COMMAND_SET_PIPELINE = 0,
+        COMMAND_SET_MATERIAL,
+        COMMAND_DRAW,
+        COMMAND_UPLOAD,
+        COMMAND_COPY,
+        COMMAND_DISPATCH,
+        COMMAND_RESIZE,
+        COMMAND_CONSTANTS,
+        COMMAND_END_FRAME
+    };
+
+    struct Command {
+        CommandType type;
+        int id;             // pipeline, material, compute, buffer or constants id, packet index in submission for draws
+        uint32_t bytes;     // size of uploaded data, constants or resized buffer
+    };
+
+    // Function to start counting, commands are stored only if record is true.
+    // Next backend gets all commands, nullptr runs without graphics API
+    void Init(bool record = true, RenderBackend* next = nullptr);
+    // Function to forget counted commands
+    void Reset();
+    // Release function
+    void Release();
+    // Function to add commands and counters of other backend after own ones, merges parts recorded in parallel
+    void Append(const RecordingBackend& other);
+
+    void SetPipeline(int pipeline) override;
+    void SetMaterial(int material) override;
+    void Draw(const DrawPacket& packet) override;
+    void UploadBuffer(int buffer, uint32_t offset, const void* data, uint32_t size) override;
+    void CopyBuffer(int dstBuffer, int srcBuffer) override;
+    void Dispatch(int compute, uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ) override;
+    bool ResizeBuffer(int buffer, uint32_t size) override;
+    bool MapConstants() override;
+    void* AllocateConstants(int constants, uint32_t size) override;
+    void UnmapConstants() override;
+    void EndFrame() override;
+
+    // Constants written last time under given id when there is no next backend, nullptr if they never were
+    const void* GetConstants(int constants) const;
+
+    const std::vector<Command>& GetCommands() const { return m_commands; };
+    int GetPipelineChanges() const { return m_pipelineChanges; };
+    int GetMaterialChanges() const { return m_materialChanges; };
+    int GetDrawsCount() const { return m_drawsCount; };
+    int GetUploadsCount() const { return m_uploadsCount; };
+    uint64_t GetUploadBytes() const { return m_uploadBytes; };
+    int GetCopiesCount() const { return m_copiesCount; };
+    int GetDispatchesCount() const { return m_dispatchesCount; };
+    int GetResizesCount() const { return m_resizesCount; };
+    uint64_t GetConstantBytes() const { return m_constantBytes; };
+
+private:
+    RenderBackend* m_pNext = nullptr;
+    bool m_isRecording = true;
+    std::vector<Command> m_commands;
+    int m_pipelineChanges = 0;
+    int m_materialChanges = 0;
+    int m_drawsCount = 0;
+    int m_uploadsCount = 0;
+    uint64_t m_uploadBytes = 0;
+    int m_copiesCount = 0;
+    int m_dispatchesCount = 0;
+    int m_resizesCount = 0;
+    uint64_t m_constantBytes = 0;
+    // Memory for constants written without next backend, indexed by constants id
+    std::vector<AlignedVector<unsigned char>> m_constantData;
+};
+
+class RenderQueue {
+public:
+    // Passes are submitted in this order
+    enum Pass {
+        PASS_OPAQUE = 0,
+        PASS_SKY,
+        PASS_TRANSPARENT,
+        PASS_COUNT
+    };
+
+    // Key bits from highest: pass 4, transparent 1, then for opaque packets pipeline 11, material 16, depth 32
+    // and for transparent ones depth 32, pipeline 11, material 16 so they keep back to front order
+    static const int PassBits = 4;
+    static const int PipelineBits = 11;
+    static const int MaterialBits = 16;
+
+    struct SubmitStats {
+        int packets = 0;
+        int pipelineChanges = 0;
+        int materialChanges = 0;
+    };
+
+    // Function to set job system used by sort, nullptr sorts on calling thread
+    void Init(JobSystem* jobSystem = nullptr);
+    // Release function
+    void Release();
+
+    // Function to build sort key, opaque packets go front to back and transparent ones back to front by view depth
+    static uint64_t MakeKey(Pass pass, bool transparent, int pipeline, int material, float depth);
+
+    // Function to remove all packets
+    void Clear();
+    // Function to add packet, its key should be filled by MakeKey
+    void Push(const DrawPacket& packet);
+    // Function to sort packets by keys, order of packets with equal keys is kept
+    void Sort();
+    // Function to send sorted packets to backend, pipeline and material are set only when they change
+    void Submit(RenderBackend* backend);
+    // Function to get count of parts for SubmitParallel, each part gets at least SubmitGrain packets
+    int GetSubmitParts(int maxParts) const;
+    // Function to send sorted packets split in contiguous parts to own backend each, parts are submitted in parallel.
+    // Executing backends in part order gives sort order, each part starts with its own pipeline and material binds
+    void SubmitParallel(RenderBackend* const* backends, int partsCount);
+
+    int GetCount() const { return (int)m_packets.size(); };
+    const std::vector<DrawPacket>& GetPackets() const { return m_packets; };
+    // Packet index at given position of sorted order
+    int GetSortedIndex(int position) const { return m_items[position].packet; };
+    const SubmitStats& GetSubmitStats() const { return m_stats; };
+
+private:
+    struct SortItem {
+        uint64_t key;
+        int packet;
+    };
+
+    // Radix sort digits
+    static const int RadixBits = 8;
+    static const int RadixSize = 1 << RadixBits;
+    static const int RadixPasses = 64 / RadixBits;
+    // Items per parallel sort range
+    static const int SortGrain = 16384;
+    // Minimal packets per part of parallel submission, smaller parts cost more in binds and command lists than they save
+    static const int SubmitGrain = 256;
+
+    // Function to send sorted packets of [first, last) range to backend
+    void SubmitRange(RenderBackend* backend, int first, int last, SubmitStats& stats) const;
+
+    JobSystem* m_pJobSystem = nullptr;
+
+    std::vector<DrawPacket> m_packets;
+    std::vector<SortItem> m_items;
+    std::vector<SortItem> m_tempItems;
+    // Digit counts of each sort range, turned into scatter offsets
+    std::vector<int> m_rangeCounts;
+
+    SubmitStats m_stats;
+    std::vector<SubmitStats> m_partStats;
+};
@@ -1,7 +1,7 @@
 #include "renderTexture.h"
 
 // Function to initialize render texture class
-HRESULT RenderTexture::Init(ID3D11Device* device, int textureWidth, int textureHeight) {
+HRESULT RenderTexture::Init(ID3D11Device* device, int textureWidth, int textureHeight, DXGI_FORMAT format) {
     // Initialize the render target texture description.
     D3D11_TEXTURE2D_DESC textureDesc;
     ZeroMemory(&textureDesc, sizeof(textureDesc));
@@ -11,7 +11,7 @@ HRESULT RenderTexture::Init(ID3D11Device* device, int textureWidth, int textureH
     textureDesc.Height = textureHeight;
     textureDesc.MipLevels = 1;
     textureDesc.ArraySize = 1;
-    textureDesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+    textureDesc.Format = format;
     textureDesc.SampleDesc.Count = 1;
     textureDesc.Usage = D3D11_USAGE_DEFAULT;
     textureDesc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
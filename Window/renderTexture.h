@@ -6,7 +6,7 @@
 class RenderTexture {
 public:
     // Function to initialize render texture class
-    HRESULT Init(ID3D11Device* device, int textureWidth, int textureHeight);
+    HRESULT Init(ID3D11Device* device, int textureWidth, int textureHeight, DXGI_FORMAT format = DXGI_FORMAT_R32G32B32A32_FLOAT);
     // Function to realese render texture class
     void Release();
     // Resize Function
@@ -98,6 +98,43 @@ bool Renderer::Init(HINSTANCE hInstance, HWND hWnd) {
     }
 
     if (SUCCEEDED(hr)) {
+        m_pStateCache = new PipelineStateCache;
+        if (!m_pStateCache) {
+            hr = S_FALSE;
+        }
+    }
+
+    if (SUCCEEDED(hr)) {
+        m_pShaderCompiler = new ShaderCompiler;
+        if (!m_pShaderCompiler) {
+            hr = S_FALSE;
+        }
+    }
+
+    if (SUCCEEDED(hr)) {
+        hr = m_pShaderCompiler->Init(SHADER_CACHE_FILE);
+    }
+
+    if (SUCCEEDED(hr)) {
+        hr = m_pContext->QueryInterface(__uuidof(ID3D11DeviceContext1), reinterpret_cast<void**>(&m_pContext1));
+        assert(SUCCEEDED(hr));
+    }
+
+    if (SUCCEEDED(hr)) {
+        m_pConstantRing = new ConstantRing;
+        m_pRenderBackend = new D3D11Backend;
+        if (!m_pConstantRing || !m_pRenderBackend) {
+            hr = S_FALSE;
+        }
+    }
+
+    if (SUCCEEDED(hr)) {
+        hr = m_pConstantRing->Init(m_pDevice, m_pContext);
+    }
+
+    if (SUCCEEDED(hr)) {
+        m_pRenderBackend->Init(m_pContext1, m_pConstantRing);
+        m_pStateCache->Init(m_pDevice);
         m_pScene = new Scene;
         if (!m_pScene) {
             hr = S_FALSE;
@@ -105,8 +142,8 @@ bool Renderer::Init(HINSTANCE hInstance, HWND hWnd) {
     }
 
     if (SUCCEEDED(hr)) {
-        m_pRenderTexture = new RenderTexture;
-        if (!m_pRenderTexture) {
+        m_pFrameGraph = new FrameGraph;
+        if (!m_pFrameGraph) {
             hr = S_FALSE;
         }
     }
@@ -127,15 +164,16 @@ bool Renderer::Init(HINSTANCE hInstance, HWND hWnd) {
     }
 
     if (SUCCEEDED(hr)) {
-        hr = m_pScene->Init(m_pDevice, m_pContext, m_width, m_height);
+        hr = InitStartupTasks(hWnd);
     }
 
+    // All shaders are compiled by now, keep them for next launch
     if (SUCCEEDED(hr)) {
-        hr = m_pRenderTexture->Init(m_pDevice, m_width, m_height);
+        m_pShaderCompiler->Save();
     }
 
     if (SUCCEEDED(hr)) {
-        hr = m_pPostEffect->Init(m_pDevice, hWnd);
+        m_timestep.Init(&m_clock, SIMULATION_STEP);
     }
 
     // Setup Platform/Renderer backends
@@ -153,98 +191,61 @@ bool Renderer::Init(HINSTANCE hInstance, HWND hWnd) {
     return SUCCEEDED(hr);
 }
 
-// Function to handle user input from keyboard/mouse
-void Renderer::HandleMovementInput() {
-    bool keyDown;
-    XMFLOAT3 mouseMove = m_pInput->IsMouseUsed();
-    m_pCamera->MouseMoved(mouseMove.x, mouseMove.y, mouseMove.z);
-    keyDown = m_pInput->IsLeftPressed();
-    MoveLeft(keyDown);
-    keyDown = m_pInput->IsRightPressed();
-    MoveRight(keyDown);
-    keyDown = m_pInput->IsUpPressed();
-    MoveForward(keyDown);
-    keyDown = m_pInput->IsDownPressed();
-    MoveBackward(keyDown);
-}
-
-// Function to calculate forward speed and movement
-void Renderer::MoveForward(bool keydown) {
-    // Update the forward speed movement based on the frame time and whether the user is holding the key down or not.
-    if (keydown) {
-        m_forwardSpeed += m_frameMove * 1.0f;
-        if (m_forwardSpeed > m_frameMove * 50.0f) {
-            m_forwardSpeed = m_frameMove * 50.0f;
-        }
+// Function to load scene and post effect: file reads, shader compiles and geometry run in parallel on startup workers,
+// then device objects are created on this thread. Timeline is written to STARTUP_TRACE_FILE
+HRESULT Renderer::InitStartupTasks(HWND hWnd) {
+    JobSystem jobSystem;
+    jobSystem.Init();
+
+    TaskGraph graph;
+    graph.Init(&jobSystem, &m_clock);
+
+    std::vector<int> sceneTasks;
+    std::vector<int> postEffectTasks;
+    m_pScene->AddLoadTasks(graph, m_pShaderCompiler, sceneTasks);
+    m_pPostEffect->AddLoadTasks(graph, m_pShaderCompiler, postEffectTasks);
+
+    // Device is used by one thread, so objects are created in order after everything is loaded
+    HRESULT sceneHr = E_FAIL;
+    HRESULT postEffectHr = E_FAIL;
+    int sceneInit = graph.AddTask("Scene::Init", [&]() {
+        sceneHr = m_pScene->Init(m_pDevice, m_pContext, m_pStateCache, m_pRenderBackend, m_width, m_height);
+        return SUCCEEDED(sceneHr);
+    }, TaskGraph::QUEUE_MAIN);
+    for (int task : sceneTasks) {
+        graph.AddDependency(sceneInit, task);
     }
-    else {
-        m_forwardSpeed -= m_frameMove * 0.5f;
-        if (m_forwardSpeed < 0.0f) {
-            m_forwardSpeed = 0.0f;
-        }
+    int postEffectInit = graph.AddTask("PostEffect::Init", [&]() {
+        postEffectHr = m_pPostEffect->Init(m_pDevice, m_pStateCache, hWnd);
+        return SUCCEEDED(postEffectHr);
+    }, TaskGraph::QUEUE_MAIN);
+    for (int task : postEffectTasks) {
+        graph.AddDependency(postEffectInit, task);
     }
 
-    m_cubePos.x +=  m_forwardSpeed;
+    bool isLoaded = graph.Run();
+    jobSystem.Release();
 
-}
+    m_startupWallTime = graph.GetWallTime();
+    m_startupSerialTime = graph.GetSerialTime();
+    graph.WriteTrace(STARTUP_TRACE_FILE);
 
-// Function to calculate backward speed and movement
-void Renderer::MoveBackward(bool keydown) {
-    // Update the backward speed movement based on the frame time and whether the user is holding the key down or not.
-    if (keydown) {
-        m_backwardSpeed += m_frameMove * 1.0f;
-        if (m_backwardSpeed > (m_frameMove * 50.0f)) {
-            m_backwardSpeed = m_frameMove * 50.0f;
-        }
-    }
-    else {
-        m_backwardSpeed -= m_frameMove * 0.5f;
-        if (m_backwardSpeed < 0.0f) {
-            m_backwardSpeed = 0.0f;
-        }
+    if (!isLoaded) {
+        return FAILED(sceneHr) ? sceneHr : FAILED(postEffectHr) ? postEffectHr : E_FAIL;
     }
-
-    m_cubePos.x -= m_backwardSpeed;
+    return S_OK;
 }
 
-// Function to calculate left move speed and movement
-void Renderer::MoveLeft(bool keydown) {
-    // Update the upward speed movement based on the frame time and whether the user is holding the key down or not.
-    if (keydown) {
-        m_leftSpeed += m_frameMove * 1.0f;
-        if (m_leftSpeed > (m_frameMove * 50.0f)) {
-            m_leftSpeed = m_frameMove * 50.0f;
-        }
-    }
-    else {
-        m_leftSpeed -= m_frameMove * 0.5f;
-        if (m_leftSpeed < 0.0f) {
-            m_leftSpeed = 0.0f;
-        }
-    }
-
-    m_cubePos.z += m_leftSpeed;
+// Function to handle user input from keyboard for one simulation step
+void Renderer::HandleMovementInput() {
+    bool isPressed[Movement::DIRECTION_COUNT];
+    isPressed[Movement::DIRECTION_FORWARD] = m_pInput->IsUpPressed();
+    isPressed[Movement::DIRECTION_BACKWARD] = m_pInput->IsDownPressed();
+    isPressed[Movement::DIRECTION_LEFT] = m_pInput->IsLeftPressed();
+    isPressed[Movement::DIRECTION_RIGHT] = m_pInput->IsRightPressed();
+    m_movement.Step(isPressed, (float)m_timestep.GetStep());
 }
 
-// Function to calculate right move speed and movement
-void Renderer::MoveRight(bool keydown) {
-    // Update the upward speed movement based on the frame time and whether the user is holding the key down or not.
-    if (keydown) {
-        m_rightSpeed += m_frameMove * 1.0f;
-        if (m_rightSpeed > (m_frameMove * 50.0f)) {
-            m_rightSpeed = m_frameMove * 50.0f;
-        }
-    }
-    else {
-        m_rightSpeed -= m_frameMove * 0.5f;
-        if (m_rightSpeed < 0.0f) {
-            m_rightSpeed = 0.0f;
-        }
-    }
-
-    m_cubePos.z -= m_rightSpeed;
-};
-
 // Update the frame
 bool Renderer::Frame() {
     HRESULT hr = S_OK;
@@ -261,6 +262,8 @@ bool Renderer::Frame() {
     static bool isGrayScale = true;
     static bool isCullingOn = true;
     static bool gpuCulling = true;
+    static bool useBVH = false;
+    static bool useCommandLists = false;
 
     if (myWindow) {
         ImGui::Begin("Lights", &myWindow);
@@ -325,9 +328,41 @@ bool Renderer::Frame() {
         if (ImGui::Button("-")) {
             m_pScene->DeleteCube();
         }
+        ImGui::SameLine();
+        if (ImGui::Button("Stress: 1M cubes")) {
+            m_pScene->SpawnCubes(STRESS_CUBE - m_pScene->GetCubeCount());
+        }
 
         std::string str = "Count: " + std::to_string(m_pScene->GetCubeCount());
         ImGui::Text(str.c_str());
+        const CubeInstances::UpdateStats& updateStats = m_pScene->GetCubeUpdateStats();
+        str = "Rebuilt: " + std::to_string(updateStats.rebuilt);
+        ImGui::Text(str.c_str());
+        str = "Uploaded: " + std::to_string(updateStats.uploaded) + " in " + std::to_string(updateStats.uploadRanges) + " ranges";
+        ImGui::Text(str.c_str());
+        const D3D11Backend::StateStats& stateStats = m_pScene->GetStateStats();
+        str = "Binds: " + std::to_string(stateStats.issued) + " issued, " + std::to_string(stateStats.elided) + " elided";
+        ImGui::Text(str.c_str());
+        const RecordingBackend& frameCounters = m_pScene->GetFrameCounters();
+        str = "Draws: " + std::to_string(frameCounters.GetDrawsCount()) + ", dispatches: " + std::to_string(frameCounters.GetDispatchesCount());
+        ImGui::Text(str.c_str());
+        str = "Uploads: " + std::to_string(frameCounters.GetUploadsCount()) + ", " + std::to_string(frameCounters.GetUploadBytes() / 1024) + " KB";
+        ImGui::Text(str.c_str());
+        PipelineStateCache::Stats pipelineStats = m_pStateCache->GetStats();
+        str = "States: " + std::to_string(pipelineStats.objects) + " objects, " + std::to_string(pipelineStats.hits) + " hits, " + std::to_string(pipelineStats.misses) + " misses";
+        ImGui::Text(str.c_str());
+        ShaderCache::Stats shaderStats = m_pShaderCompiler->GetStats();
+        str = "Shaders: " + std::to_string(shaderStats.hits) + " cached, " + std::to_string(shaderStats.misses) + " compiled";
+        ImGui::Text(str.c_str());
+        str = "Startup: " + std::to_string(m_startupWallTime / 1000000) + " ms, tasks " + std::to_string(m_startupSerialTime / 1000000) + " ms";
+        ImGui::Text(str.c_str());
+        TextureStreamer::Stats streamingStats = m_pScene->GetStreamingStats();
+        str = "Streaming: " + std::to_string(streamingStats.residentBytes >> 20) + " / " + std::to_string(streamingStats.budgetBytes >> 20) + " MB, pending " +
+            std::to_string(streamingStats.pendingLoads) + ", evicted " + std::to_string(streamingStats.evictedMips);
+        ImGui::Text(str.c_str());
+        const FrameGraph::Stats& graphStats = m_pFrameGraph->GetStats();
+        str = "Passes: " + std::to_string(graphStats.passes - graphStats.culledPasses) + ", transients: " + std::to_string(graphStats.transientBytes / 1024) + " KB, aliased " + std::to_string(graphStats.aliasedBytes / 1024) + " KB";
+        ImGui::Text(str.c_str());
 
         if (!gpuCulling) {
             str = "Rendered: " + std::to_string(m_pScene->GetCubeRendered());
@@ -348,18 +383,56 @@ bool Renderer::Frame() {
             if (ImGui::Checkbox("Cull on GPU", &gpuCulling)) {
                 m_pScene->ToggleGPUCulling();
             }
+            if (!gpuCulling && ImGui::Checkbox("Use BVH", &useBVH)) {
+                m_pScene->ToggleBVH();
+            }
         }
         else {
             m_pScene->GPUCullingOFF();
             gpuCulling = false;
         }
+        if (ImGui::Checkbox("Record in parallel", &useCommandLists)) {
+            m_pScene->ToggleCommandLists();
+        }
+
+        // Reproducible scene generation
+        static const char* distributions[] = { "Uniform", "Clustered", "Grid", "City" };
+        static SceneGenerator::SceneDesc sceneDesc = m_pScene->GetSceneDesc();
+        static int seed = (int)sceneDesc.seed;
+        static int distribution = sceneDesc.distribution;
+        ImGui::Combo("Distribution", &distribution, distributions, SceneGenerator::DISTRIBUTION_COUNT);
+        ImGui::InputInt("Seed", &seed);
+        ImGui::InputInt("Cubes", &sceneDesc.cubesCount);
+        ImGui::InputInt("Lights", &sceneDesc.lightsCount);
+        if (ImGui::Button("Generate")) {
+            sceneDesc.seed = (uint64_t)(unsigned int)seed;
+            sceneDesc.distribution = (SceneGenerator::Distribution)distribution;
+            sceneDesc.cubesCount = (std::max)(sceneDesc.cubesCount, 0);
+            m_pScene->GenerateScene(sceneDesc);
+        }
+        if (ImGui::Button("Save scene")) {
+            m_pScene->SaveScene(SCENE_FILE);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Load scene")) {
+            m_pScene->LoadScene(SCENE_FILE);
+        }
         ImGui::End();
     }
 
-    m_pCamera->Frame();
     m_pInput->Frame();
 
-    HandleMovementInput();
+    // Camera follows mouse every frame
+    XMFLOAT3 mouseMove = m_pInput->IsMouseUsed();
+    m_pCamera->MouseMoved(mouseMove.x, mouseMove.y, mouseMove.z);
+
+    // Simulate movement with fixed steps and interpolate between last two steps for rendering
+    int steps = m_timestep.Advance();
+    for (int i = 0; i < steps; i++) {
+        HandleMovementInput();
+    }
+    m_pCamera->SetPointOfInterest(m_movement.GetPosition((float)m_timestep.GetAlpha()));
+    m_pCamera->Frame();
     
     // Get the world matrix
     XMMATRIX mWorld = XMMatrixIdentity();
@@ -373,7 +446,8 @@ bool Renderer::Frame() {
 
     ImGui::Render();
 
-    m_pScene->Frame(m_pContext, mWorld, mView, mProjection, m_pCamera->GetCameraPosition());
+    // Scene that failed to prepare frame, e.g. when constant ring is full, is not drawn until next one
+    m_isSceneReady = m_pScene->Frame(m_pRenderBackend, mWorld, mView, mProjection, m_pCamera->GetCameraPosition(), (float)m_timestep.GetRenderTime());
 
     return SUCCEEDED(hr);
 }
@@ -398,26 +472,88 @@ bool Renderer::Render() {
     rect.bottom = m_height;
     m_pContext->RSSetScissorRects(1, &rect);
 
-    // Render scene to texture
-    m_pRenderTexture->SetRenderTarget(m_pContext, m_pDepthBufferDSV);
-    m_pRenderTexture->ClearRenderTarget(m_pContext, m_pDepthBufferDSV, 0.0f, 0.0f, 0.0f, 1.0f);
-    m_pScene->Render(m_pContext);
+    // Passes are declared every frame, graph orders them and provides transient textures
+    BuildFrameGraph(viewport);
+    m_pFrameGraph->Compile();
 
-    ID3D11RenderTargetView* views[] = { m_pBackBufferRTV };
-    m_pContext->OMSetRenderTargets(1, views, m_pDepthBufferDSV);
+    HRESULT hr = UpdateTransientTextures();
+    if (SUCCEEDED(hr)) {
+        m_pFrameGraph->Execute();
+
+        hr = m_pSwapChain->Present(0, 0);
+        assert(SUCCEEDED(hr));
+    }
+
+    return SUCCEEDED(hr);
+}
+
+// Function to declare passes of frame and resources they use
+void Renderer::BuildFrameGraph(const D3D11_VIEWPORT& viewport) {
+    m_pFrameGraph->Reset();
+
+    FrameGraph::TextureDesc colorDesc;
+    colorDesc.width = m_width;
+    colorDesc.height = m_height;
+    colorDesc.format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+    colorDesc.bytesPerPixel = 16;
+    int sceneColor = m_pFrameGraph->CreateTexture("SceneColor", colorDesc);
+    int depth = m_pFrameGraph->ImportTexture("Depth", FrameGraph::ACCESS_DEPTH_WRITE);
+    int backBuffer = m_pFrameGraph->ImportTexture("BackBuffer", FrameGraph::ACCESS_RENDER_TARGET);
 
-    static const FLOAT BackColor[4] = { 0.1f, 0.1f, 0.1f, 1.0f };
-    m_pContext->ClearRenderTargetView(m_pBackBufferRTV, BackColor);
-    m_pContext->ClearDepthStencilView(m_pDepthBufferDSV, D3D11_CLEAR_DEPTH, 0.0f, 0);
+    // Render scene to texture
+    int scenePass = m_pFrameGraph->AddPass("Scene", [this, sceneColor]() {
+        RenderTexture& target = GetTransientTexture(sceneColor);
+        target.SetRenderTarget(m_pContext, m_pDepthBufferDSV);
+        target.ClearRenderTarget(m_pContext, m_pDepthBufferDSV, 0.0f, 0.0f, 0.0f, 1.0f);
+        if (m_isSceneReady) {
+            m_pScene->Render(m_pContext);
+        }
+    });
+    m_pFrameGraph->Write(scenePass, sceneColor);
+    m_pFrameGraph->Write(scenePass, depth, FrameGraph::ACCESS_DEPTH_WRITE);
 
     // Render texture to screen
-    m_pPostEffect->Process(m_pContext, m_pRenderTexture->GetShaderResourceView(), m_pBackBufferRTV, viewport);
+    int postEffectPass = m_pFrameGraph->AddPass("PostEffect", [this, sceneColor, viewport]() {
+        ID3D11RenderTargetView* views[] = { m_pBackBufferRTV };
+        m_pContext->OMSetRenderTargets(1, views, m_pDepthBufferDSV);
+
+        static const FLOAT BackColor[4] = { 0.1f, 0.1f, 0.1f, 1.0f };
+        m_pContext->ClearRenderTargetView(m_pBackBufferRTV, BackColor);
+        m_pContext->ClearDepthStencilView(m_pDepthBufferDSV, D3D11_CLEAR_DEPTH, 0.0f, 0);
+
+        m_pPostEffect->Process(m_pContext, GetTransientTexture(sceneColor).GetShaderResourceView(), m_pBackBufferRTV, viewport);
+    });
+    m_pFrameGraph->Read(postEffectPass, sceneColor);
+    m_pFrameGraph->Write(postEffectPass, backBuffer);
+    m_pFrameGraph->Write(postEffectPass, depth, FrameGraph::ACCESS_DEPTH_WRITE);
+}
 
+// Function to create physical textures of compiled frame graph, textures are kept while their descs don't change
+HRESULT Renderer::UpdateTransientTextures() {
+    HRESULT hr = S_OK;
 
-    HRESULT hr = m_pSwapChain->Present(0, 0);
-    assert(SUCCEEDED(hr));
+    int count = m_pFrameGraph->GetPhysicalCount();
+    for (int i = count; i < (int)m_transientTextures.size(); i++) {
+        m_transientTextures[i].Release();
+    }
+    m_transientTextures.resize(count);
+    m_transientDescs.resize(count);
 
-    return SUCCEEDED(hr);
+    for (int i = 0; i < count && SUCCEEDED(hr); i++) {
+        const FrameGraph::TextureDesc& desc = m_pFrameGraph->GetPhysicalDesc(i);
+        if (FrameGraph::IsEqual(m_transientDescs[i], desc))
+            continue;
+
+        m_transientTextures[i].Release();
+        m_transientDescs[i] = FrameGraph::TextureDesc();
+        hr = m_transientTextures[i].Init(m_pDevice, desc.width, desc.height, (DXGI_FORMAT)desc.format);
+        assert(SUCCEEDED(hr));
+        if (SUCCEEDED(hr)) {
+            m_transientDescs[i] = desc;
+        }
+    }
+
+    return hr;
 }
 
 // Clean up all the objects we've created
@@ -433,9 +569,19 @@ void Renderer::Cleanup() {
     SAFE_RELEASE(m_pDepthBufferDSV);
     SAFE_RELEASE(m_pCamera);
     SAFE_RELEASE(m_pScene);
+    SAFE_RELEASE(m_pRenderBackend);
+    SAFE_RELEASE(m_pConstantRing);
+    SAFE_RELEASE(m_pContext1);
     SAFE_RELEASE(m_pInput);
-    SAFE_RELEASE(m_pRenderTexture);
     SAFE_RELEASE(m_pPostEffect);
+    SAFE_RELEASE(m_pStateCache);
+    SAFE_RELEASE(m_pShaderCompiler);
+    SAFE_RELEASE(m_pFrameGraph);
+    for (RenderTexture& texture : m_transientTextures) {
+        texture.Release();
+    }
+    m_transientTextures.clear();
+    m_transientDescs.clear();
 
     #ifdef _DEBUG
     if (m_pDevice != nullptr) {
@@ -469,7 +615,6 @@ bool Renderer::Resize(UINT width, UINT height) {
             hr = SetupBackBuffer();
             m_pInput->Resize(width, height);
             m_pScene->Resize(width, height);
-            m_pRenderTexture->Resize(m_pDevice, width, height);
         }
         return SUCCEEDED(hr);
     }
@@ -6,8 +6,15 @@
 #include "scene.h"
 #include "renderTexture.h"
 #include "postEffect.h"
+#include "frameGraph.h"
+#include "pipelineStateCache.h"
+#include "shaderCompiler.h"
 #include "defines.h"
+#include "clock.h"
+#include "fixedTimestep.h"
+#include "movement.h"
 #include <string>
+#include <vector>
 
 using namespace DirectX;
 
@@ -25,18 +32,17 @@ class Renderer {
     bool Resize(UINT width, UINT height);
 
   private:
-    // Function to calculate forward speed and movement
-    void MoveForward(bool keydown);
-    // Function to calculate backward speed and movement
-    void MoveBackward(bool keydown);
-    // Function to calculate left move speed and movement
-    void MoveLeft(bool keydown);
-    // Function to calculate right move speed and movement
-    void MoveRight(bool keydown);
-
-    // Function to handle user input from keyboard/mouse
+    // Function to handle user input from keyboard for one simulation step
     void HandleMovementInput();
     HRESULT SetupBackBuffer();
+    // Function to load scene and post effect with startup task graph
+    HRESULT InitStartupTasks(HWND hWnd);
+    // Function to declare passes of frame and resources they use
+    void BuildFrameGraph(const D3D11_VIEWPORT& viewport);
+    // Function to create physical textures of compiled frame graph, textures are kept while their descs don't change
+    HRESULT UpdateTransientTextures();
+    // Function to get texture backing transient resource of frame graph
+    RenderTexture& GetTransientTexture(int resource) { return m_transientTextures[m_pFrameGraph->GetPhysical(resource)]; };
 
     ID3D11Device* m_pDevice = nullptr;
     ID3D11DeviceContext* m_pContext = nullptr;
@@ -48,16 +54,30 @@ class Renderer {
     Camera* m_pCamera = nullptr;
     Input* m_pInput = nullptr;
     Scene* m_pScene = nullptr;
-    RenderTexture* m_pRenderTexture = nullptr;
     PostEffect* m_pPostEffect = nullptr;
+    FrameGraph* m_pFrameGraph = nullptr;
+    PipelineStateCache* m_pStateCache = nullptr;
+    // Per-frame constants are bound by offsets into one ring buffer, which needs D3D11.1 context
+    ID3D11DeviceContext1* m_pContext1 = nullptr;
+    ConstantRing* m_pConstantRing = nullptr;
+    // Buffers, states and constants of scene frame, scene submits its work through it
+    D3D11Backend* m_pRenderBackend = nullptr;
+    ShaderCompiler* m_pShaderCompiler = nullptr;
+
+    // Physical textures of frame graph transients with their descs
+    std::vector<RenderTexture> m_transientTextures;
+    std::vector<FrameGraph::TextureDesc> m_transientDescs;
+
+    SystemClock m_clock;
+    // Startup task graph wall time and sum of its task times, nanoseconds
+    int64_t m_startupWallTime = 0;
+    int64_t m_startupSerialTime = 0;
+    FixedTimestep m_timestep;
+    // False if scene failed to prepare this frame, its draws are skipped
+    bool m_isSceneReady = false;
 
-    XMFLOAT3 m_cubePos = XMFLOAT3(0.0f, 0.0f, 0.0f);
-    float m_forwardSpeed = 0.0f;
-    float m_backwardSpeed = 0.0f;
-    float m_leftSpeed = 0.0f;
-    float m_rightSpeed = 0.0f;
-    // constant for good movement
-    float m_frameMove = 0.00001f;
+    // Keyboard moves point camera looks at
+    Movement m_movement;
 
     UINT m_width = 0;
     UINT m_height = 0;
@@ -0,0 +1,86 @@
+#include "ringAllocator.h"
+#include <algorithm>
+#include <cassert>
+
+// Function to set ring size and alignment of offsets and sizes, alignment must be power of two
+void RingAllocator::Init(uint32_t size, uint32_t alignment) {
+    assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+    m_alignment = alignment;
+    m_size = size & ~(alignment - 1);
+    m_tail = 0;
+    m_allocatedTotal = 0;
+    m_freedTotal = 0;
+    m_frames.clear();
+    ResetStats();
+}
+
+// Release function
+void RingAllocator::Release() {
+    m_size = 0;
+    m_tail = 0;
+    m_allocatedTotal = 0;
+    m_freedTotal = 0;
+    m_frames.clear();
+}
+
+// Function to allocate size bytes, returns false if ring has no space until older frames retire
+bool RingAllocator::Allocate(uint32_t size, uint32_t& offset) {
+    // Empty ring restarts from beginning so large allocations don't wrap
+    if (GetUsed() == 0) {
+        m_tail = 0;
+    }
+
+    uint32_t alignedSize = (size + m_alignment - 1) & ~(m_alignment - 1);
+    uint32_t start = (m_tail + m_alignment - 1) & ~(m_alignment - 1);
+    uint32_t padding = start - m_tail;
+    uint32_t wrap = 0;
+
+    // Allocations are contiguous, so rest of ring is skipped if allocation doesn't fit there
+    if (alignedSize > m_size - (std::min)(start, m_size)) {
+        wrap = m_size - m_tail;
+        padding = 0;
+        start = 0;
+    }
+
+    uint64_t consumed = (uint64_t)wrap + padding + alignedSize;
+    if (size == 0 || alignedSize > m_size || GetUsed() + consumed > m_size) {
+        m_stats.failed++;
+        return false;
+    }
+
+    offset = start;
+    m_tail = start + alignedSize;
+    if (m_tail == m_size) {
+        m_tail = 0;
+    }
+    m_allocatedTotal += consumed;
+
+    m_stats.allocations++;
+    m_stats.requestedBytes += size;
+    m_stats.alignmentBytes += padding + (alignedSize - size);
+    m_stats.wrapBytes += wrap;
+    m_stats.peakUsed = (std::max)(m_stats.peakUsed, GetUsed());
+    return true;
+}
+
+// Function to close current frame, its allocations are freed when fence is completed
+void RingAllocator::EndFrame(uint64_t fence) {
+    m_frames.push_back({ fence, m_allocatedTotal });
+}
+
+// Function to free allocations of frames with fences up to completed one
+void RingAllocator::Retire(uint64_t completedFence) {
+    while (!m_frames.empty() && m_frames.front().fence <= completedFence) {
+        m_freedTotal = m_frames.front().allocatedTotal;
+        m_frames.pop_front();
+    }
+}
+
+// Function to get fence of oldest frame still in use, returns false if there is none
+bool RingAllocator::GetOldestFence(uint64_t& fence) const {
+    if (m_frames.empty()) {
+        return false;
+    }
+    fence = m_frames.front().fence;
+    return true;
+}
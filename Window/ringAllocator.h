@@ -0,0 +1,55 @@
+// ringAllocator.h - class for linear sub-allocation from ring buffer recycled by frame fences
+#pragma once
+
+#include <cstdint>
+#include <deque>
+
+class RingAllocator {
+public:
+    struct Stats {
+        int allocations = 0;
+        int failed = 0;             // allocations that didn't fit until older frames retire
+        uint64_t requestedBytes = 0;
+        uint64_t alignmentBytes = 0; // lost to rounding sizes and offsets up to alignment
+        uint64_t wrapBytes = 0;      // lost at ring end when allocation didn't fit there
+        uint32_t peakUsed = 0;
+    };
+
+    // Function to set ring size and alignment of offsets and sizes, alignment must be power of two
+    void Init(uint32_t size, uint32_t alignment = 256);
+    // Release function
+    void Release();
+
+    // Function to allocate size bytes, returns false if ring has no space until older frames retire
+    bool Allocate(uint32_t size, uint32_t& offset);
+    // Function to close current frame, its allocations are freed when fence is completed
+    void EndFrame(uint64_t fence);
+    // Function to free allocations of frames with fences up to completed one
+    void Retire(uint64_t completedFence);
+    // Function to get fence of oldest frame still in use, returns false if there is none
+    bool GetOldestFence(uint64_t& fence) const;
+
+    uint32_t GetSize() const { return m_size; };
+    // Bytes in use by current and not retired frames, including alignment and wrap losses
+    uint32_t GetUsed() const { return (uint32_t)(m_allocatedTotal - m_freedTotal); };
+    int GetFramesInFlight() const { return (int)m_frames.size(); };
+    const Stats& GetStats() const { return m_stats; };
+    void ResetStats() { m_stats = Stats(); };
+
+private:
+    struct Frame {
+        uint64_t fence;
+        uint64_t allocatedTotal;    // value of m_allocatedTotal at end of frame
+    };
+
+    uint32_t m_size = 0;
+    uint32_t m_alignment = 256;
+    // Next free offset
+    uint32_t m_tail = 0;
+    // Monotonic byte counters, used space is their difference
+    uint64_t m_allocatedTotal = 0;
+    uint64_t m_freedTotal = 0;
+    std::deque<Frame> m_frames;
+
+    Stats m_stats;
+};
@@ -4,9 +4,34 @@
 #include "imgui_impl_dx11.h"
 #include "imgui_impl_win32.h"
 
+// Function to add tasks compiling shaders and preparing cube map and lights, they run before Init
+void Scene::AddLoadTasks(TaskGraph& graph, ShaderCompiler* shaderCompiler, std::vector<int>& tasks) {
+    int flags = 0;
+#ifdef _DEBUG
+    flags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#endif
+    // Defines must live until graph is run
+    static const D3D_SHADER_MACRO Shader_Macros[] = { {"USE_LIGHTS"}, {NULL, NULL} };
+
+    tasks.push_back(shaderCompiler->AddCompileTask(graph, "VertexShader.hlsl", NULL, "main", "vs_5_0", flags, &m_loadedData.pVertexShaderBuffer));
+    tasks.push_back(shaderCompiler->AddCompileTask(graph, "PixelShader.hlsl", NULL, "main", "ps_5_0", flags, &m_loadedData.pPixelShaderBuffer));
+    tasks.push_back(shaderCompiler->AddCompileTask(graph, "FrustumCullingShader.hlsl", NULL, "main", "cs_5_0", flags, &m_loadedData.pComputeShaderBuffer));
+    tasks.push_back(shaderCompiler->AddCompileTask(graph, "TransVertexShader.hlsl", Shader_Macros, "main", "vs_5_0", flags, &m_loadedData.pTransVertexShaderBuffer));
+    tasks.push_back(shaderCompiler->AddCompileTask(graph, "TransPixelShader.hlsl", Shader_Macros, "main", "ps_5_0", flags, &m_loadedData.pTransPixelShaderBuffer));
+
+    m_pCubeMap = new CubeMap;
+    m_pLight = new Light;
+    if (m_pCubeMap && m_pLight) {
+        m_pCubeMap->AddLoadTasks(graph, shaderCompiler, tasks);
+        m_pLight->AddLoadTasks(graph, shaderCompiler, tasks);
+    }
+}
+
 // Initialize all needed instances
-HRESULT Scene::Init(ID3D11Device* device, ID3D11DeviceContext* context, int screenWidth, int screenHeight) {
+HRESULT Scene::Init(ID3D11Device* device, ID3D11DeviceContext* context, PipelineStateCache* stateCache, D3D11Backend* backend, int screenWidth, int screenHeight) {
     HRESULT hr = S_OK;
+    m_screenHeight = screenHeight;
+    m_pRenderBackend = backend;
 
     D3D11_QUERY_DESC desc;
     desc.Query = D3D11_QUERY_PIPELINE_STATISTICS;
@@ -15,45 +40,68 @@ HRESULT Scene::Init(ID3D11Device* device, ID3D11DeviceContext* context, int scre
         hr = device->CreateQuery(&desc, &m_queries[i]);
     }
 
+    // Scene frame keeps transparent objects added while scene is created
     if (SUCCEEDED(hr)) {
-        hr = InitScene(device, context);
+        m_pSceneFrame = new SceneFrame;
+        if (!m_pSceneFrame) {
+            hr = S_FALSE;
+        }
     }
 
     if (SUCCEEDED(hr)) {
-        hr = InitSceneTransparent(device, context);
+        hr = InitScene(device, context, stateCache);
     }
 
     if (SUCCEEDED(hr)) {
-        m_pCubeMap = new CubeMap;
-        if (!m_pCubeMap) {
-            hr = S_FALSE;
-        }
+        hr = InitSceneTransparent(device, context, stateCache);
+    }
+
+    // Cube map and lights are created with their load tasks
+    if (SUCCEEDED(hr) && (!m_pCubeMap || !m_pLight)) {
+        hr = S_FALSE;
     }
 
     if (SUCCEEDED(hr)) {
-        hr = m_pCubeMap->Init(device, context, screenWidth, screenHeight);
+        hr = m_pCubeMap->Init(device, context, stateCache, screenWidth, screenHeight);
     }
 
     if (SUCCEEDED(hr)) {
-        m_pLight = new Light;
-        if (!m_pLight) {
-            hr = S_FALSE;
-        }
+        hr = m_pLight->Init(device, context, stateCache);
+    }
+
+    // Loaded data is in device objects now
+    m_loadedData.Release();
+
+    if (SUCCEEDED(hr)) {
+        m_pSceneGenerator->GenerateLights(m_pLight->GetLightVector());
+        // Saved scene replaces generated one
+        LoadScene(SCENE_FILE);
     }
 
+    // Set up render queue
     if (SUCCEEDED(hr)) {
-        hr = m_pLight->Init(device, context);
+        m_pRenderQueue = new RenderQueue;
+        if (!m_pRenderQueue) {
+            hr = S_FALSE;
+        }
     }
 
     if (SUCCEEDED(hr)) {
-        m_pFrustum = new Frustum;
-        if (!m_pFrustum) {
+        m_pFrameRecorder = new RecordingBackend;
+        if (!m_pFrameRecorder) {
             hr = S_FALSE;
         }
     }
 
     if (SUCCEEDED(hr)) {
-        m_pFrustum->Init(SCREEN_NEAR);
+        m_pRenderQueue->Init(m_pJobSystem);
+        // Only counters are needed, commands are not stored
+        m_pFrameRecorder->Init(false, m_pRenderBackend);
+        RegisterStates();
+    }
+
+    if (SUCCEEDED(hr)) {
+        hr = InitCommandLists(device);
     }
 
     if (FAILED(hr)) {
@@ -63,16 +111,42 @@ HRESULT Scene::Init(ID3D11Device* device, ID3D11DeviceContext* context, int scre
     return hr;
 }
 
-HRESULT Scene::InitScene(ID3D11Device* device, ID3D11DeviceContext* context) {
+HRESULT Scene::InitScene(ID3D11Device* device, ID3D11DeviceContext* context, PipelineStateCache* stateCache) {
     HRESULT hr = S_OK;
 
+    // Set up workers for per-instance loops
+    m_pJobSystem = new JobSystem;
+    if (!m_pJobSystem) {
+        hr = S_FALSE;
+    }
+
+    if (SUCCEEDED(hr)) {
+        m_pJobSystem->Init();
+    }
+
+    // Set up scene generator with default seed
+    if (SUCCEEDED(hr)) {
+        m_pSceneGenerator = new SceneGenerator;
+        if (!m_pSceneGenerator) {
+            hr = S_FALSE;
+        }
+    }
+
+    if (SUCCEEDED(hr)) {
+        m_pSceneGenerator->Init(SceneGenerator::SceneDesc(), m_pJobSystem);
+    }
+
     // Set up cubes
-    for (int i = 0; i < MAX_CUBE; i++) {
-        CubeModel tmp;
-        float textureIndex = (float)(rand() % 2);
-        tmp.pos = XMFLOAT4((float)(rand() % 10 - 5), (float)(rand() % 10 - 5), (float)(rand() % 10 - 5), (float)(rand() % 6 - 3));
-        tmp.shineSpeedIdNM = XMFLOAT4(300.0f, (float)(rand() % 5), textureIndex, textureIndex > 0.0f ? 0.0f : 1.0f);
-        m_cubeModelVector.push_back(tmp);
+    if (SUCCEEDED(hr)) {
+        m_pCubeInstances = new CubeInstances;
+        if (!m_pCubeInstances) {
+            hr = S_FALSE;
+        }
+    }
+
+    if (SUCCEEDED(hr)) {
+        m_pCubeInstances->Init(START_CUBE, m_pJobSystem);
+        SpawnCubes(m_pSceneGenerator->GetDesc().cubesCount);
     }
 
     static const Vertex Vertices[] = {
@@ -158,84 +232,40 @@ HRESULT Scene::InitScene(ID3D11Device* device, ID3D11DeviceContext* context) {
         assert(SUCCEEDED(hr));
     }
 
+    // Culling compute shader writes instance count to source buffer, it is copied to arguments of indirect draw
+    static_assert(sizeof(SceneFrame::IndirectArgs) == sizeof(D3D11_DRAW_INDEXED_INSTANCED_INDIRECT_ARGS), "Indirect args layout mismatch");
     if (SUCCEEDED(hr)) {
-        D3D11_BUFFER_DESC desc = {};
-        desc.ByteWidth = sizeof(D3D11_DRAW_INDEXED_INSTANCED_INDIRECT_ARGS);
-        desc.Usage = D3D11_USAGE_DEFAULT;
-        desc.BindFlags = D3D11_BIND_UNORDERED_ACCESS;
-        desc.CPUAccessFlags = 0;
-        desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
-        desc.StructureByteStride = sizeof(UINT);
+        D3D11Backend::BufferDesc desc;
+        desc.size = sizeof(SceneFrame::IndirectArgs);
+        desc.bindFlags = D3D11_BIND_UNORDERED_ACCESS;
+        desc.miscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+        desc.stride = sizeof(UINT);
+        m_ids.indirectArgsSrcBuffer = m_pRenderBackend->AddBuffer(desc);
 
-        hr = device->CreateBuffer(&desc, nullptr, &m_pInderectArgsSrc);
-        if (SUCCEEDED(hr)) {
-            hr = device->CreateUnorderedAccessView(m_pInderectArgsSrc, nullptr, &m_pInderectArgsUAV);
+        desc.bindFlags = 0;
+        desc.miscFlags = D3D11_RESOURCE_MISC_DRAWINDIRECT_ARGS;
+        desc.stride = 0;
+        m_ids.indirectArgsBuffer = m_pRenderBackend->AddBuffer(desc);
+        if (m_ids.indirectArgsSrcBuffer < 0 || m_ids.indirectArgsBuffer < 0) {
+            hr = E_FAIL;
         }
-        assert(SUCCEEDED(hr));
     }
 
     if (SUCCEEDED(hr)) {
-        D3D11_BUFFER_DESC desc = {};
-        desc.ByteWidth = sizeof(D3D11_DRAW_INDEXED_INSTANCED_INDIRECT_ARGS);
-        desc.Usage = D3D11_USAGE_DEFAULT;
-        desc.BindFlags = 0;
-        desc.CPUAccessFlags = 0;
-        desc.MiscFlags = D3D11_RESOURCE_MISC_DRAWINDIRECT_ARGS;
-        desc.StructureByteStride = 0;
-
-        hr = device->CreateBuffer(&desc, nullptr, &m_pInderectArgs);
-        assert(SUCCEEDED(hr));
+        hr = CreateInstanceBuffers(START_CUBE);
     }
 
-    if (SUCCEEDED(hr)) {
-        D3D11_BUFFER_DESC desc = {};
-        desc.ByteWidth = sizeof(XMINT4) * MAX_CUBE;
-        desc.Usage = D3D11_USAGE_DEFAULT;
-        desc.BindFlags = D3D11_BIND_UNORDERED_ACCESS;
-        desc.CPUAccessFlags = 0;
-        desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
-        desc.StructureByteStride = sizeof(XMINT4);
-
-        hr = device->CreateBuffer(&desc, nullptr, &m_pGeomBufferInstVisGpu);
-        if (SUCCEEDED(hr)) {
-            hr = device->CreateUnorderedAccessView(m_pGeomBufferInstVisGpu, nullptr, &m_pGeomBufferInstVisGpu_UAV);
-        }
-        assert(SUCCEEDED(hr));
-    }
+    ID3D10Blob* vertexShaderBuffer = m_loadedData.pVertexShaderBuffer;
+    ID3D10Blob* pixelShaderBuffer = m_loadedData.pPixelShaderBuffer;
+    ID3D10Blob* computeShaderBuffer = m_loadedData.pComputeShaderBuffer;
 
     if (SUCCEEDED(hr)) {
-        D3D11_BUFFER_DESC desc = {};
-        desc.ByteWidth = sizeof(XMINT4) * MAX_CUBE;
-        desc.Usage = D3D11_USAGE_DEFAULT;
-        desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-        desc.CPUAccessFlags = 0;
-        desc.MiscFlags = 0;
-        desc.StructureByteStride = 0;
-
-        hr = device->CreateBuffer(&desc, nullptr, &m_pGeomBufferInstVis);
-        assert(SUCCEEDED(hr));
-    }
-
-    ID3D10Blob* vertexShaderBuffer = nullptr;
-    ID3D10Blob* pixelShaderBuffer = nullptr;
-    ID3D10Blob* computeShaderBuffer = nullptr;
-    int flags = 0;
-#ifdef _DEBUG
-    flags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
-#endif
-
-    D3DInclude includeObj;
-
-    if (SUCCEEDED(hr)) {
-        hr = D3DCompileFromFile(L"VertexShader.hlsl", NULL, &includeObj, "main", "vs_5_0", flags, 0, &vertexShaderBuffer, NULL);
         hr = device->CreateVertexShader(vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), NULL, &m_pVertexShader);
     }
     if (SUCCEEDED(hr)) {
-        hr = D3DCompileFromFile(L"PixelShader.hlsl", NULL, &includeObj, "main", "ps_5_0", flags, 0, &pixelShaderBuffer, NULL);
         hr = device->CreatePixelShader(pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize(), NULL, &m_pPixelShader);
     }
     if (SUCCEEDED(hr)) {
-        hr = D3DCompileFromFile(L"FrustumCullingShader.hlsl", NULL, &includeObj, "main", "cs_5_0", flags, 0, &computeShaderBuffer, NULL);
         hr = device->CreateComputeShader(computeShaderBuffer->GetBufferPointer(), computeShaderBuffer->GetBufferSize(), NULL, &m_pCullShader);
     }
     if (SUCCEEDED(hr)) {
@@ -243,76 +273,6 @@ HRESULT Scene::InitScene(ID3D11Device* device, ID3D11DeviceContext* context) {
         hr = device->CreateInputLayout(InputDesc, numElements, vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), &m_pInputLayout);
     }
 
-    SAFE_RELEASE(vertexShaderBuffer);
-    SAFE_RELEASE(pixelShaderBuffer);
-    SAFE_RELEASE(computeShaderBuffer);
-
-    // Set constant buffers
-    if (SUCCEEDED(hr)) {
-        D3D11_BUFFER_DESC desc = {};
-        desc.ByteWidth = sizeof(GeomBuffer) * MAX_CUBE;
-        desc.Usage = D3D11_USAGE_DEFAULT;
-        desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-        desc.CPUAccessFlags = 0;
-        desc.MiscFlags = 0;
-        desc.StructureByteStride = 0;
-
-        GeomBuffer geomBufferInst[MAX_CUBE];
-        CullParams cullParams;
-        for (int i = 0; i < m_cubeModelVector.size(); i++) {
-            geomBufferInst[i].mWorldMatrix = XMMatrixTranslation(m_cubeModelVector[i].pos.x, m_cubeModelVector[i].pos.y, m_cubeModelVector[i].pos.z);
-            geomBufferInst[i].norm = geomBufferInst[i].mWorldMatrix;
-            geomBufferInst[i].shineSpeedTexIdNM = m_cubeModelVector[i].shineSpeedIdNM;
-
-            XMFLOAT4 min, max;
-            XMStoreFloat4(&min, XMVector4Transform(XMLoadFloat4(&AABB[0]), geomBufferInst[i].mWorldMatrix));
-            XMStoreFloat4(&max, XMVector4Transform(XMLoadFloat4(&AABB[7]), geomBufferInst[i].mWorldMatrix));
-            cullParams.bbMin[i] = min;
-            cullParams.bbMax[i] = max;
-        }
-        cullParams.numShapes = XMINT4(int(m_cubeModelVector.size()), 0, 0, 0);
-
-        D3D11_SUBRESOURCE_DATA data;
-        data.pSysMem = &geomBufferInst;
-        data.SysMemPitch = sizeof(geomBufferInst);
-        data.SysMemSlicePitch = 0;
-
-        hr = device->CreateBuffer(&desc, &data, &m_pGeomBufferInst);
-        assert(SUCCEEDED(hr));
-
-        data.pSysMem = &cullParams;
-        data.SysMemPitch = sizeof(cullParams);
-        data.SysMemSlicePitch = 0;
-        hr = device->CreateBuffer(&desc, &data, &m_pCullParams);
-        assert(SUCCEEDED(hr));
-    }
-
-    if (SUCCEEDED(hr)) {
-        D3D11_BUFFER_DESC desc = {};
-        desc.ByteWidth = sizeof(SceneConstantBuffer);
-        desc.Usage = D3D11_USAGE_DYNAMIC;
-        desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-        desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-        desc.MiscFlags = 0;
-        desc.StructureByteStride = 0;
-
-        hr = device->CreateBuffer(&desc, nullptr, &m_pSceneConstantBuffer);
-        assert(SUCCEEDED(hr));
-    }
-
-    if (SUCCEEDED(hr)) {
-        D3D11_BUFFER_DESC desc = {};
-        desc.ByteWidth = sizeof(LightConstantBuffer);
-        desc.Usage = D3D11_USAGE_DYNAMIC;
-        desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-        desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-        desc.MiscFlags = 0;
-        desc.StructureByteStride = 0;
-
-        hr = device->CreateBuffer(&desc, nullptr, &m_pLightConstantBuffer);
-        assert(SUCCEEDED(hr));
-    }
-
     // Set rastrizer state
     if (SUCCEEDED(hr)) {
         D3D11_RASTERIZER_DESC desc = {};
@@ -327,20 +287,29 @@ HRESULT Scene::InitScene(ID3D11Device* device, ID3D11DeviceContext* context) {
         desc.MultisampleEnable = false;
         desc.SlopeScaledDepthBias = 0.0f;
 
-        hr = device->CreateRasterizerState(&desc, &m_pRasterizerState);
+        hr = stateCache->CreateRasterizerState(&desc, &m_pRasterizerState);
         assert(SUCCEEDED(hr));
     }
 
+    // Textures start with mip tails only, finer mips are streamed in by screen size
     if (SUCCEEDED(hr)) {
-        Texture tmp;
-        hr = tmp.InitArray(device, context, { L"data/brick_diffuse.dds", L"data/morgana.dds" });
-        m_textureArray.push_back(tmp);
+        m_pTextureSink = new D3D11TextureSink;
+        m_pTextureStreamer = new TextureStreamer;
+        if (!m_pTextureSink || !m_pTextureStreamer) {
+            hr = S_FALSE;
+        }
     }
 
     if (SUCCEEDED(hr)) {
-        Texture tmp;
-        hr = tmp.Init(device, context, L"data/brick_normal.dds");
-        m_textureArray.push_back(tmp);
+        m_pTextureSink->Init(device);
+        m_pTextureStreamer->Init(m_pTextureSink, (uint64_t)STREAMING_BUDGET_MB << 20);
+        m_diffuseTexture = m_pTextureStreamer->AddTexture(m_diffuseTextureNames);
+        m_normalTexture = m_pTextureStreamer->AddTexture({ "data/brick_normal.dds" }, true);
+        // Sky is optional, without its file cube map is drawn with null view
+        m_skyTexture = m_pTextureStreamer->AddTexture({ "data/skymap.dds" });
+        if (m_diffuseTexture < 0 || m_normalTexture < 0) {
+            hr = E_FAIL;
+        }
     }
 
     // Set sampler state
@@ -358,7 +327,7 @@ HRESULT Scene::InitScene(ID3D11Device* device, ID3D11DeviceContext* context) {
         desc.ComparisonFunc = D3D11_COMPARISON_NEVER;
         desc.BorderColor[0] = desc.BorderColor[1] = desc.BorderColor[2] = desc.BorderColor[3] = 1.0f;
 
-        hr = device->CreateSamplerState(&desc, &m_pSampler);
+        hr = stateCache->CreateSamplerState(&desc, &m_pSampler);
         assert(SUCCEEDED(hr));
     }
 
@@ -370,16 +339,76 @@ HRESULT Scene::InitScene(ID3D11Device* device, ID3D11DeviceContext* context) {
         dsDesc.DepthFunc = D3D11_COMPARISON_GREATER_EQUAL;
         dsDesc.StencilEnable = FALSE;
 
-        hr = device->CreateDepthStencilState(&dsDesc, &m_pDepthState);
+        hr = stateCache->CreateDepthStencilState(&dsDesc, &m_pDepthState);
         assert(SUCCEEDED(hr));
     }
 
     return hr;
 }
 
-HRESULT Scene::InitSceneTransparent(ID3D11Device* device, ID3D11DeviceContext* context) {
+// Function to create instances buffers in backend for given cubes count, scene frame grows them
+HRESULT Scene::CreateInstanceBuffers(int capacity) {
+    HRESULT hr = S_OK;
+
+    D3D11Backend::BufferDesc desc;
+    desc.size = sizeof(CubeInstances::GeomBuffer) * capacity;
+    desc.bindFlags = D3D11_BIND_SHADER_RESOURCE;
+    desc.miscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+    desc.stride = sizeof(CubeInstances::GeomBuffer);
+    m_ids.geomBuffer = m_pRenderBackend->AddBuffer(desc);
+
+    desc.size = sizeof(CubeInstances::CullBox) * capacity;
+    desc.stride = sizeof(CubeInstances::CullBox);
+    m_ids.cullBoxesBuffer = m_pRenderBackend->AddBuffer(desc);
+
+    desc.size = sizeof(UINT) * capacity;
+    desc.stride = sizeof(UINT);
+    m_ids.visibleBuffer = m_pRenderBackend->AddBuffer(desc);
+
+    // Compute shader writes its visible list here
+    desc.bindFlags = D3D11_BIND_UNORDERED_ACCESS | D3D11_BIND_SHADER_RESOURCE;
+    m_ids.visibleGpuBuffer = m_pRenderBackend->AddBuffer(desc);
+
+    if (m_ids.geomBuffer < 0 || m_ids.cullBoxesBuffer < 0 || m_ids.visibleBuffer < 0 || m_ids.visibleGpuBuffer < 0) {
+        hr = E_FAIL;
+    }
+
+    if (SUCCEEDED(hr)) {
+        m_ids.instanceCapacity = capacity;
+    }
+
+    return hr;
+}
+
+// Function to create transparent objects buffer in backend for given objects count, scene frame grows it
+HRESULT Scene::CreateTransparentBuffers(int capacity) {
+    HRESULT hr = S_OK;
+
+    capacity = (std::max)(capacity, 1);
+
+    D3D11Backend::BufferDesc desc;
+    desc.size = sizeof(SceneFrame::WorldMatrixBuffer) * capacity;
+    desc.bindFlags = D3D11_BIND_SHADER_RESOURCE;
+    desc.miscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+    desc.stride = sizeof(SceneFrame::WorldMatrixBuffer);
+    m_ids.transGeomBuffer = m_pRenderBackend->AddBuffer(desc);
+    if (m_ids.transGeomBuffer < 0) {
+        hr = E_FAIL;
+    }
+
+    if (SUCCEEDED(hr)) {
+        m_ids.transparentCapacity = capacity;
+    }
+
+    return hr;
+}
+
+HRESULT Scene::InitSceneTransparent(ID3D11Device* device, ID3D11DeviceContext* context, PipelineStateCache* stateCache) {
     HRESULT hr = S_OK;
 
+    AddTransparentQuad(XMFLOAT3(0.8f, 0.3f, 1.1f), XMFLOAT4(0.6f, 0.0f, 1.0f, 0.5f)); // purple
+    AddTransparentQuad(XMFLOAT3(1.1f, 0.0f, 1.3f), XMFLOAT4(1.0f, 1.0f, 0.0f, 0.5f)); // yellow
+
     static const USHORT Indices[] = {
         0, 2, 1, 0, 3, 2
     };
@@ -423,22 +452,13 @@ HRESULT Scene::InitSceneTransparent(ID3D11Device* device, ID3D11DeviceContext* c
         assert(SUCCEEDED(hr));
     }
 
-    ID3D10Blob* vertexShaderBuffer = nullptr;
-    ID3D10Blob* pixelShaderBuffer = nullptr;
-    int flags = 0;
-#ifdef _DEBUG
-    flags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
-#endif
-
-    D3DInclude includeObj;
-    D3D_SHADER_MACRO Shader_Macros[] = { {"USE_LIGHTS"}, {NULL, NULL} };
+    ID3D10Blob* vertexShaderBuffer = m_loadedData.pTransVertexShaderBuffer;
+    ID3D10Blob* pixelShaderBuffer = m_loadedData.pTransPixelShaderBuffer;
 
     if (SUCCEEDED(hr)) {
-        hr = D3DCompileFromFile(L"TransVertexShader.hlsl", Shader_Macros, &includeObj, "main", "vs_5_0", flags, 0, &vertexShaderBuffer, NULL);
         hr = device->CreateVertexShader(vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), NULL, &m_pTransVertexShader);
     }
     if (SUCCEEDED(hr)) {
-        hr = D3DCompileFromFile(L"TransPixelShader.hlsl", Shader_Macros, &includeObj, "main", "ps_5_0", flags, 0, &pixelShaderBuffer, NULL);
         hr = device->CreatePixelShader(pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize(), NULL, &m_pTransPixelShader);
     }
     if (SUCCEEDED(hr)) {
@@ -446,32 +466,9 @@ HRESULT Scene::InitSceneTransparent(ID3D11Device* device, ID3D11DeviceContext* c
         hr = device->CreateInputLayout(InputDesc, numElements, vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), &m_pTransInputLayout);
     }
 
-    SAFE_RELEASE(vertexShaderBuffer);
-    SAFE_RELEASE(pixelShaderBuffer);
-
-    // Set constant buffers
+    // Set transparent objects buffer
     if (SUCCEEDED(hr)) {
-        D3D11_BUFFER_DESC desc = {};
-        desc.ByteWidth = sizeof(WorldMatrixBuffer);
-        desc.Usage = D3D11_USAGE_DEFAULT;
-        desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-        desc.CPUAccessFlags = 0;
-        desc.MiscFlags = 0;
-        desc.StructureByteStride = 0;
-
-        WorldMatrixBuffer worldMatrixBuffer;
-        worldMatrixBuffer.mWorldMatrix = DirectX::XMMatrixIdentity();
-
-        D3D11_SUBRESOURCE_DATA data;
-        data.pSysMem = &worldMatrixBuffer;
-        data.SysMemPitch = sizeof(worldMatrixBuffer);
-        data.SysMemSlicePitch = 0;
-
-        hr = device->CreateBuffer(&desc, &data, &m_pTransWorldMatrixBuffer);
-        if (SUCCEEDED(hr)) {
-            hr = device->CreateBuffer(&desc, &data, &m_pTransWorldMatrixBuffer2);
-        }
-        assert(SUCCEEDED(hr));
+        hr = CreateTransparentBuffers(m_pSceneFrame->GetTransparentCount());
     }
 
     // Create rasterizer state
@@ -488,7 +485,7 @@ HRESULT Scene::InitSceneTransparent(ID3D11Device* device, ID3D11DeviceContext* c
         desc.MultisampleEnable = false;
         desc.AntialiasedLineEnable = false;
 
-        hr = device->CreateRasterizerState(&desc, &m_pTransRasterizerState);
+        hr = stateCache->CreateRasterizerState(&desc, &m_pTransRasterizerState);
         assert(SUCCEEDED(hr));
     }
 
@@ -507,7 +504,7 @@ HRESULT Scene::InitSceneTransparent(ID3D11Device* device, ID3D11DeviceContext* c
         desc.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_ONE;
         desc.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_ZERO;
 
-        hr = device->CreateBlendState(&desc, &m_pTransBlendState);
+        hr = stateCache->CreateBlendState(&desc, &m_pTransBlendState);
         assert(SUCCEEDED(hr));
     }
 
@@ -519,7 +516,7 @@ HRESULT Scene::InitSceneTransparent(ID3D11Device* device, ID3D11DeviceContext* c
         desc.DepthFunc = D3D11_COMPARISON_GREATER;
         desc.StencilEnable = FALSE;
 
-        hr = device->CreateDepthStencilState(&desc, &m_pTransDepthState);
+        hr = stateCache->CreateDepthStencilState(&desc, &m_pTransDepthState);
         assert(SUCCEEDED(hr));
     }
 
@@ -533,10 +530,6 @@ void Scene::Release() {
     SAFE_RELEASE(m_pInputLayout);
     SAFE_RELEASE(m_pVertexShader);
     SAFE_RELEASE(m_pRasterizerState);
-    SAFE_RELEASE(m_pSceneConstantBuffer);
-    SAFE_RELEASE(m_pCullParams);
-    SAFE_RELEASE(m_pLightConstantBuffer);
-    SAFE_RELEASE(m_pGeomBufferInst);
     SAFE_RELEASE(m_pPixelShader);
     SAFE_RELEASE(m_pCullShader);
     SAFE_RELEASE(m_pSampler);
@@ -547,174 +540,58 @@ void Scene::Release() {
     SAFE_RELEASE(m_pTransVertexShader);
     SAFE_RELEASE(m_pTransPixelShader);
     SAFE_RELEASE(m_pTransRasterizerState);
-    SAFE_RELEASE(m_pTransWorldMatrixBuffer);
-    SAFE_RELEASE(m_pTransWorldMatrixBuffer2);
     SAFE_RELEASE(m_pTransDepthState);
     SAFE_RELEASE(m_pTransBlendState);
-    SAFE_RELEASE(m_pInderectArgsSrc);
-    SAFE_RELEASE(m_pInderectArgs);
-    SAFE_RELEASE(m_pGeomBufferInstVisGpu)
-    SAFE_RELEASE(m_pGeomBufferInstVisGpu_UAV)
-    SAFE_RELEASE(m_pGeomBufferInstVis)
-    SAFE_RELEASE(m_pInderectArgsUAV);
-    SAFE_RELEASE(m_pCubeMap);
-    SAFE_RELEASE(m_pLight);
-    SAFE_RELEASE(m_pFrustum);
-
+    // Streamer removes its textures from sink
+    SAFE_RELEASE(m_pTextureStreamer);
+    SAFE_RELEASE(m_pTextureSink);
+    m_diffuseTexture = -1;
+    m_normalTexture = -1;
+    m_skyTexture = -1;
+    // Cube map, lights and loaded data come from AddLoadTasks, so they are freed even if Init never ran
+    if (m_pCubeMap) {
+        m_pCubeMap->Release();
+        delete m_pCubeMap;
+        m_pCubeMap = nullptr;
+    }
+    if (m_pLight) {
+        m_pLight->Release();
+        delete m_pLight;
+        m_pLight = nullptr;
+    }
+    m_loadedData.Release();
+    SAFE_RELEASE(m_pSceneFrame);
+    SAFE_RELEASE(m_pRenderQueue);
+    // Buffers of scene are released with backend by renderer
+    m_pRenderBackend = nullptr;
+    SAFE_RELEASE(m_pFrameRecorder);
+    for (CommandList& list : m_commandLists) {
+        SAFE_RELEASE(list.pCounter);
+        SAFE_RELEASE(list.pBackend);
+        SAFE_RELEASE(list.pContext);
+    }
+    SAFE_RELEASE(m_pCubeInstances);
+    SAFE_RELEASE(m_pSceneGenerator);
+    m_nextCubeIndex = 0;
+    SAFE_RELEASE(m_pJobSystem);
+    m_ids = SceneFrame::Ids();
+
+    // Queries are not created if Init failed or never ran
     for (auto& q : m_queries) {
-        q->Release();
+        SAFE_RELEASE(q);
     }
-
-    for (auto& t : m_textureArray) {
-        t.Shutdown();
-    }
-    m_textureArray.clear();
 }
 
-bool Scene::Frame(ID3D11DeviceContext* context, XMMATRIX worldMatrix, XMMATRIX viewMatrix, XMMATRIX projectionMatrix, XMFLOAT3 cameraPos) {
-    // Update our time
-    static float t = 0.0f;
-    static ULONGLONG timeStart = 0;
-    ULONGLONG timeCur = GetTickCount64();
-    if (timeStart == 0) {
-        timeStart = timeCur;
-    }
-    t = (timeCur - timeStart) / 1000.0f;
-
-    GeomBuffer geomBufferInst[MAX_CUBE];
-    for (int i = 0; i < m_cubesCount; i++) {
-        geomBufferInst[i].mWorldMatrix = XMMatrixRotationY(m_cubeModelVector[i].pos.w * t * m_cubeModelVector[i].shineSpeedIdNM.y) * XMMatrixTranslation(m_cubeModelVector[i].pos.x, m_cubeModelVector[i].pos.y, m_cubeModelVector[i].pos.z);
-        geomBufferInst[i].norm = geomBufferInst[i].mWorldMatrix;
-        geomBufferInst[i].shineSpeedTexIdNM = m_cubeModelVector[i].shineSpeedIdNM;
-    }
-
-    context->UpdateSubresource(m_pGeomBufferInst, 0, nullptr, &geomBufferInst, 0, 0);
-
-    CullParams cullParams;
-    // Calculate frustum
-    m_pFrustum->ConstructFrustum(viewMatrix, projectionMatrix);
-    // Find cubes in frustum
-    m_cubeIndexies.clear();
-    for (int i = 0; i < m_cubesCount; i++) {
-        XMFLOAT4 min, max, tmp;
-        XMStoreFloat4(&min, XMVector4Transform(XMLoadFloat4(&AABB[0]), geomBufferInst[i].mWorldMatrix));
-        max = min;
-
-        for (int j = 1; j < 8; j++) {
-            XMStoreFloat4(&tmp, XMVector4Transform(XMLoadFloat4(&AABB[j]), geomBufferInst[i].mWorldMatrix));
-            max.x = (std::max)(max.x, tmp.x);
-            max.y = (std::max)(max.y, tmp.y);
-            max.z = (std::max)(max.z, tmp.z);
-            min.x = (std::min)(min.x, tmp.x);
-            min.y = (std::min)(min.y, tmp.y);
-            min.z = (std::min)(min.z, tmp.z);
-        }
-        if (!m_isCullingOn || m_computeCull || m_pFrustum->CheckRectangle(min, max)) {
-            m_cubeIndexies.push_back(i);
-        }
-
-        cullParams.bbMin[i] = min;
-        cullParams.bbMax[i] = max;
-    }
-    cullParams.numShapes = XMINT4(m_cubesCount, 0, 0, 0);
-
-    context->UpdateSubresource(m_pCullParams, 0, nullptr, &cullParams, 0, 0);
-
-    // Update transparent world matrix
-    WorldMatrixBuffer worldMatrixBuffer;
-    worldMatrixBuffer.mWorldMatrix = XMMatrixTranslation(0.8f, 0.3f, 1.1f);
-    worldMatrixBuffer.color = XMFLOAT4(0.6f, 0.0f, 1.0f, 0.5f); // purple
-    context->UpdateSubresource(m_pTransWorldMatrixBuffer, 0, nullptr, &worldMatrixBuffer, 0, 0);
-
-    // Calculate distance between rectangle points and camera
-    XMFLOAT4 rectVert[4];
-    float maxDist = -D3D11_FLOAT32_MAX;
-    std::copy(Vertices, Vertices + 4, rectVert);
-    for (int i = 0; i < 4; i++) {
-        XMStoreFloat4(&rectVert[i], XMVector4Transform(XMLoadFloat4(&rectVert[i]), worldMatrixBuffer.mWorldMatrix));
-        float dist = (rectVert[i].x * cameraPos.x) + (rectVert[i].y * cameraPos.y) + (rectVert[i].z * cameraPos.z);
-        maxDist = max(maxDist, dist);
-    }
+// Function to send uploads, constants and culling of frame to backend, Render submits draws to the same backend
+bool Scene::Frame(RenderBackend* backend, XMMATRIX worldMatrix, XMMATRIX viewMatrix, XMMATRIX projectionMatrix, XMFLOAT3 cameraPos, float time) {
+    // All uploads, dispatches and draws of frame are counted on their way to backend
+    m_pFrameRecorder->Init(false, backend);
+    bool isReady = m_pSceneFrame->Frame(m_pFrameRecorder, viewMatrix, projectionMatrix, cameraPos, time);
 
-    // Update transparent world matrix
-    worldMatrixBuffer.mWorldMatrix = XMMatrixTranslation(1.1f, 0.0f, 1.3f);
-    worldMatrixBuffer.color = XMFLOAT4(1.0f, 1.0f, 0.0f, 0.5f); // yellow
-    context->UpdateSubresource(m_pTransWorldMatrixBuffer2, 0, nullptr, &worldMatrixBuffer, 0, 0);
+    // Views of streamed textures change here, materials reference them by ids
+    UpdateStreaming(projectionMatrix, cameraPos);
 
-    // Calculate distance between second rectangle points and camera
-    float maxDist2 = -D3D11_FLOAT32_MAX;
-    std::copy(Vertices, Vertices + 4, rectVert);
-    for (int i = 0; i < 4; i++) {
-        XMStoreFloat4(&rectVert[i], XMVector4Transform(XMLoadFloat4(&rectVert[i]), worldMatrixBuffer.mWorldMatrix));
-        float dist = (rectVert[i].x * cameraPos.x) + (rectVert[i].y * cameraPos.y) + (rectVert[i].z * cameraPos.z);
-        maxDist2 = max(maxDist2, dist);
-    }
-
-    m_yellowRect = maxDist2 < maxDist;
-
-    // Update Scene matrix
-    D3D11_MAPPED_SUBRESOURCE subresource;
-    HRESULT hr = context->Map(m_pSceneConstantBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &subresource);
-    assert(SUCCEEDED(hr));
-
-    if (SUCCEEDED(hr)) {
-        SceneConstantBuffer& sceneBuffer = *reinterpret_cast<SceneConstantBuffer*>(subresource.pData);
-        sceneBuffer.mViewProjectionMatrix = XMMatrixMultiply(viewMatrix, projectionMatrix);
-        XMFLOAT4* planes = m_pFrustum->GetPlanes();
-        for (int i = 0; i < 6; i++) {
-            sceneBuffer.planes[i] = planes[i];
-        }
-        context->Unmap(m_pSceneConstantBuffer, 0);
-    }
-
-    if (!m_computeCull) {
-        XMINT4 indexBuffer[MAX_CUBE];
-        for (int i = 0; i < m_cubeIndexies.size(); i++) {
-            indexBuffer[i] = XMINT4(m_cubeIndexies[i], 0, 0, 0);
-        }
-        context->UpdateSubresource(m_pGeomBufferInstVis, 0, nullptr, &indexBuffer, 0, 0);
-    }
-
-    // Update Light buffer
-    hr = context->Map(m_pLightConstantBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &subresource);
-    assert(SUCCEEDED(hr));
-
-    if (SUCCEEDED(hr)) {
-        LightConstantBuffer& lightBuffer = *reinterpret_cast<LightConstantBuffer*>(subresource.pData);
-        lightBuffer.cameraPos = XMFLOAT4(cameraPos.x, cameraPos.y, cameraPos.z, 1.0f);
-        lightBuffer.ambientColor = XMFLOAT4(0.9f, 0.9f, 0.9f, 1.0f);
-        auto& lightPosColorVector = m_pLight->GetLightVector();
-        lightBuffer.lightCount = XMINT4(int(lightPosColorVector.size()), m_useNormalMap ? 1 : 0, m_showNormals ? 1 : 0, 0);
-        for (int i = 0; i < lightPosColorVector.size(); i++) {
-            lightBuffer.lightPos[i] = XMFLOAT4(lightPosColorVector[i].first.x, lightPosColorVector[i].first.y, lightPosColorVector[i].first.z, 1.0f);
-            lightBuffer.lightColor[i] = XMFLOAT4(lightPosColorVector[i].second.x, lightPosColorVector[i].second.y, lightPosColorVector[i].second.z, 1.0f);
-        }
-        context->Unmap(m_pLightConstantBuffer, 0);
-    }
-
-    // GPU Culling
-    D3D11_DRAW_INDEXED_INSTANCED_INDIRECT_ARGS args;
-    args.IndexCountPerInstance = 36;
-    args.InstanceCount = 0;
-    args.StartInstanceLocation = 0;
-    args.BaseVertexLocation = 0;
-    args.StartIndexLocation = 0;
-    context->UpdateSubresource(m_pInderectArgsSrc, 0, nullptr, &args, 0, 0);
-    UINT groupNumber = m_cubesCount / 64u + !!(m_cubesCount % 64u);
-    context->CSSetConstantBuffers(0, 1, &m_pCullParams);
-    context->CSSetConstantBuffers(1, 1, &m_pSceneConstantBuffer);
-    context->CSSetUnorderedAccessViews(0, 1, &m_pInderectArgsUAV, nullptr);
-    context->CSSetUnorderedAccessViews(1, 1, &m_pGeomBufferInstVisGpu_UAV, nullptr);
-    context->CSSetShader(m_pCullShader, nullptr, 0);
-    context->Dispatch(groupNumber, 1, 1);
-
-    context->CopyResource(m_pGeomBufferInstVis, m_pGeomBufferInstVisGpu);
-    context->CopyResource(m_pInderectArgs, m_pInderectArgsSrc);
-
-    m_pLight->Frame(context, viewMatrix, projectionMatrix);
-    m_pCubeMap->Frame(context, viewMatrix, projectionMatrix, cameraPos);
-
-    return SUCCEEDED(hr);
+    return isReady;
 }
 
 void Scene::CreateNewLight() {
@@ -734,21 +611,86 @@ void Scene::DeleteLight() {
 };
 
 void Scene::CreateNewCube() {
-    if (m_cubesCount < MAX_CUBE) {
-        m_cubesCount++;
-    }
+    m_pCubeInstances->Add(m_pSceneGenerator->GenerateCube(m_nextCubeIndex++));
 }
 
 void Scene::DeleteCube() {
-    if (m_cubesCount > 0) {
-        m_cubesCount--;
+    m_pCubeInstances->Remove(m_pCubeInstances->GetHandle(m_pCubeInstances->GetCount() - 1));
+}
+
+// Function to add count generated cubes
+void Scene::SpawnCubes(int count) {
+    if (count <= 0) {
+        return;
     }
+
+    SceneGenerator::CubeStreams cubes;
+    m_pSceneGenerator->GenerateCubes(m_nextCubeIndex, count, cubes);
+    m_nextCubeIndex += count;
+    m_pCubeInstances->Add(count, cubes.posX.data(), cubes.posY.data(), cubes.posZ.data(), cubes.angularSpeed.data(), cubes.materials.data());
+}
+
+// Function to replace cubes and lights with generated ones
+void Scene::GenerateScene(const SceneGenerator::SceneDesc& desc) {
+    m_pSceneGenerator->Init(desc, m_pJobSystem);
+
+    m_pCubeInstances->Release();
+    m_pCubeInstances->Init(desc.cubesCount, m_pJobSystem);
+    m_nextCubeIndex = 0;
+    SpawnCubes(desc.cubesCount);
+
+    m_pSceneGenerator->GenerateLights(m_pLight->GetLightVector());
+}
+
+// Function to save cubes, lights and texture names to binary scene file
+bool Scene::SaveScene(const char* path) {
+    // Texture ids of cubes refer to this texture array
+    return SceneFile::Write(path, *m_pCubeInstances, m_pLight->GetLightVector(), m_diffuseTextureNames);
+}
+
+// Function to replace cubes and lights with ones from binary scene file
+bool Scene::LoadScene(const char* path) {
+    SceneFile file;
+    if (!file.Open(path)) {
+        return false;
+    }
+
+    // Component blocks are copied as is, no per-cube parsing. Streams aren't aliased to the mapping on purpose:
+    // it is read-only and closed on return, while cubes are added, removed and moved in place after load
+    const SceneFile::View& view = file.GetView();
+    m_pCubeInstances->Release();
+    m_pCubeInstances->Init(view.cubesCount, m_pJobSystem);
+    m_pCubeInstances->Add(view.cubesCount, view.posX, view.posY, view.posZ, view.angularSpeed, view.materials);
+    m_nextCubeIndex = view.cubesCount;
+
+    auto& lightPosColorVector = m_pLight->GetLightVector();
+    lightPosColorVector.clear();
+    for (int i = 0; i < view.lightsCount && i < MAX_LIGHT; i++) {
+        lightPosColorVector.push_back(std::pair<XMFLOAT3, XMFLOAT3>(view.lightPositions[i], view.lightColors[i]));
+    }
+
+    // Texture ids of cubes refer to texture array of file, current one is kept if file has none or it can't be opened
+    std::vector<std::string> textureNames;
+    for (int i = 0; i < view.texturesCount; i++) {
+        const char* name = view.textureNames + (size_t)i * SCENE_TEXTURE_NAME_SIZE;
+        textureNames.push_back(std::string(name, std::find(name, name + SCENE_TEXTURE_NAME_SIZE, '\0')));
+    }
+    if (!textureNames.empty() && textureNames != m_diffuseTextureNames && m_pTextureStreamer) {
+        int texture = m_pTextureStreamer->AddTexture(textureNames);
+        if (texture >= 0) {
+            // Previous array is not drawn anymore, so only its mip tail stays resident
+            m_diffuseTexture = texture;
+            m_diffuseTextureNames = textureNames;
+        }
+    }
+
+    return true;
 }
 
 // Function to get info from Queries
 void Scene::ReadQueries(ID3D11DeviceContext* context) {
     D3D11_QUERY_DATA_PIPELINE_STATISTICS stats;
-    while (m_lastCompletedFrame < m_curFrame) {
+    while (m_lastCompletedFrame < m_pSceneFrame->GetQueriesIssued()) {
         HRESULT hr = context->GetData(m_queries[m_lastCompletedFrame % MAX_QUERY], &stats, sizeof(D3D11_QUERY_DATA_PIPELINE_STATISTICS), 0);
         if (hr == S_OK) {
             m_cubesCountGPU = int(stats.IAPrimitives / 12);
@@ -760,106 +702,202 @@ void Scene::ReadQueries(ID3D11DeviceContext* context) {
     }
 }
 
-void Scene::Render(ID3D11DeviceContext* context) {
-    context->OMSetDepthStencilState(m_pDepthState, 0);
-
-    context->RSSetState(m_pRasterizerState);
-
-    ID3D11SamplerState* samplers[] = { m_pSampler };
-    context->PSSetSamplers(0, 1, samplers);
-
-    ID3D11ShaderResourceView* resources[] = { m_textureArray[0].GetTexture(), m_textureArray[1].GetTexture() };
-    context->PSSetShaderResources(0, 2, resources);
-
-    context->IASetIndexBuffer(m_pIndexBuffer, DXGI_FORMAT_R16_UINT, 0);
-    ID3D11Buffer* vertexBuffers[] = { m_pVertexBuffer };
-    UINT strides[] = { sizeof(Vertex) };
-    UINT offsets[] = { 0 };
-    context->IASetVertexBuffers(0, 1, vertexBuffers, strides, offsets);
-    context->IASetInputLayout(m_pInputLayout);
-    context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    context->VSSetShader(m_pVertexShader, nullptr, 0);
-    context->VSSetConstantBuffers(0, 1, &m_pGeomBufferInst);
-    context->VSSetConstantBuffers(1, 1, &m_pSceneConstantBuffer);
-    context->VSSetConstantBuffers(2, 1, &m_pGeomBufferInstVis);
-    context->PSSetShader(m_pPixelShader, nullptr, 0);
-    context->PSSetConstantBuffers(0, 1, &m_pGeomBufferInst);
-    context->PSSetConstantBuffers(1, 1, &m_pSceneConstantBuffer);
-    context->PSSetConstantBuffers(2, 1, &m_pLightConstantBuffer);
-
-    if (m_isCullingOn) {
-        if (m_computeCull) {
-            context->Begin(m_queries[m_curFrame % MAX_QUERY]);
-            context->DrawIndexedInstancedIndirect(m_pInderectArgs, 0);
-            context->End(m_queries[m_curFrame % MAX_QUERY]);
-            m_curFrame++;
-        }
-        else {
-            context->DrawIndexedInstanced(36, (UINT)m_cubeIndexies.size(), 0, 0, 0);
+// Function to register pipelines, materials and draw resources of scene parts in render backend
+void Scene::RegisterStates() {
+    D3D11Backend::PipelineDesc pipeline;
+    pipeline.pVertexShader = m_pVertexShader;
+    pipeline.pPixelShader = m_pPixelShader;
+    pipeline.pInputLayout = m_pInputLayout;
+    pipeline.pRasterizerState = m_pRasterizerState;
+    pipeline.pDepthState = m_pDepthState;
+    m_ids.cubesPipeline = m_pRenderBackend->AddPipeline(pipeline);
+
+    pipeline.pVertexShader = m_pTransVertexShader;
+    pipeline.pPixelShader = m_pTransPixelShader;
+    pipeline.pInputLayout = m_pTransInputLayout;
+    pipeline.pRasterizerState = m_pTransRasterizerState;
+    pipeline.pBlendState = m_pTransBlendState;
+    pipeline.pDepthState = m_pTransDepthState;
+    m_ids.transPipeline = m_pRenderBackend->AddPipeline(pipeline);
+
+    // Constant ranges are allocated every frame by scene frame, streamed views are updated by UpdateStreaming
+    m_ids.cullParams = m_pRenderBackend->AddConstants();
+    m_ids.sceneConstants = m_pRenderBackend->AddConstants();
+    m_ids.lightConstants = m_pRenderBackend->AddConstants();
+    m_diffuseView = m_pRenderBackend->AddView(nullptr);
+    m_normalView = m_pRenderBackend->AddView(nullptr);
+    m_skyView = m_pRenderBackend->AddView(nullptr);
+
+    D3D11Backend::MaterialDesc material;
+    material.pVertexBuffer = m_pVertexBuffer;
+    material.vertexStride = sizeof(Vertex);
+    material.pIndexBuffer = m_pIndexBuffer;
+    material.indexFormat = DXGI_FORMAT_R16_UINT;
+    material.vsConstants[1] = m_ids.sceneConstants;
+    material.psConstants[1] = m_ids.sceneConstants;
+    material.psConstants[2] = m_ids.lightConstants;
+    material.vsResources[2] = m_pRenderBackend->GetBufferView(m_ids.geomBuffer);
+    material.vsResources[3] = m_pRenderBackend->GetBufferView(m_ids.visibleBuffer);
+    material.psResources[0] = m_diffuseView;
+    material.psResources[1] = m_normalView;
+    material.psResources[2] = m_pRenderBackend->GetBufferView(m_ids.geomBuffer);
+    material.psSamplers[0] = m_pSampler;
+    m_ids.cubesMaterial = m_pRenderBackend->AddMaterial(material);
+    material.vsResources[3] = m_pRenderBackend->GetBufferView(m_ids.visibleGpuBuffer);
+    m_ids.cubesGpuMaterial = m_pRenderBackend->AddMaterial(material);
+
+    material = D3D11Backend::MaterialDesc();
+    material.pVertexBuffer = m_pTransVertexBuffer;
+    material.vertexStride = sizeof(XMFLOAT4);
+    material.pIndexBuffer = m_pTransIndexBuffer;
+    material.indexFormat = DXGI_FORMAT_R16_UINT;
+    material.vsConstants[1] = m_ids.sceneConstants;
+    material.psConstants[2] = m_ids.lightConstants;
+    material.vsResources[0] = m_pRenderBackend->GetBufferView(m_ids.transGeomBuffer);
+    material.psResources[0] = m_pRenderBackend->GetBufferView(m_ids.transGeomBuffer);
+    m_ids.transMaterial = m_pRenderBackend->AddMaterial(material);
+
+    D3D11Backend::ComputeDesc compute;
+    compute.pComputeShader = m_pCullShader;
+    compute.constants[0] = m_ids.cullParams;
+    compute.constants[1] = m_ids.sceneConstants;
+    compute.resources[0] = m_pRenderBackend->GetBufferView(m_ids.cullBoxesBuffer);
+    compute.unorderedViews[0] = m_pRenderBackend->GetBufferUnorderedView(m_ids.indirectArgsSrcBuffer);
+    compute.unorderedViews[1] = m_pRenderBackend->GetBufferUnorderedView(m_ids.visibleGpuBuffer);
+    m_ids.cullCompute = m_pRenderBackend->AddCompute(compute);
+
+    m_ids.firstQuery = m_pRenderBackend->AddQuery(m_queries[0]);
+    for (int i = 1; i < MAX_QUERY; i++) {
+        m_pRenderBackend->AddQuery(m_queries[i]);
+    }
+
+    m_pLight->RegisterStates(m_pRenderBackend, m_pDepthState);
+    m_pCubeMap->RegisterStates(m_pRenderBackend, m_pDepthState, m_skyView);
+    m_pSceneFrame->Init(m_pCubeInstances, m_pLight, m_pCubeMap, m_ids);
+}
+
+// Function to report screen sizes of streamed textures and apply their loaded mips
+void Scene::UpdateStreaming(XMMATRIX projectionMatrix, XMFLOAT3 cameraPos) {
+    // Nearest cube gives largest face on screen, sparse sample is enough for mip choice
+    const std::vector<CubeInstances::CullBox>& cullBoxes = m_pCubeInstances->GetCullBoxes();
+    int stride = (std::max)(1, (int)cullBoxes.size() / STREAMING_DISTANCE_SAMPLES);
+    float nearestDistance = SCREEN_FAR;
+    float cubeSize = 1.0f;
+    for (int i = 0; i < (int)cullBoxes.size(); i += stride) {
+        const CubeInstances::CullBox& box = cullBoxes[i];
+        float dx = (std::max)((std::max)(box.bbMin.x - cameraPos.x, cameraPos.x - box.bbMax.x), 0.0f);
+        float dy = (std::max)((std::max)(box.bbMin.y - cameraPos.y, cameraPos.y - box.bbMax.y), 0.0f);
+        float dz = (std::max)((std::max)(box.bbMin.z - cameraPos.z, cameraPos.z - box.bbMax.z), 0.0f);
+        float distance = sqrtf(dx * dx + dy * dy + dz * dz);
+        if (distance < nearestDistance) {
+            nearestDistance = distance;
+            cubeSize = box.bbMax.x - box.bbMin.x;
         }
     }
-    else {
-        context->DrawIndexedInstanced(36, MAX_CUBE, 0, 0, 0);
-    }
-    ReadQueries(context);
 
-    // Render Spheres
-    if (m_isSpheresOn) {
-        m_pLight->Render(context);
+    // Object of size s at distance d covers s / d * proj._22 * height / 2 pixels
+    float pixelsPerUnit = XMVectorGetY(projectionMatrix.r[1]) * m_screenHeight * 0.5f;
+    float cubeScreenSize = cubeSize * pixelsPerUnit / (std::max)(nearestDistance, SCREEN_NEAR);
+    if (!cullBoxes.empty()) {
+        m_pTextureStreamer->UseTexture(m_diffuseTexture, cubeScreenSize, nearestDistance);
+        if (m_pSceneFrame->GetSettings().useNormalMap) {
+            m_pTextureStreamer->UseTexture(m_normalTexture, cubeScreenSize, nearestDistance);
+        }
     }
-    m_pCubeMap->Render(context);
-
-    RenderTransparent(context);
+    // Sky face spans 2 units at distance 1 around camera
+    if (m_skyTexture >= 0) {
+        m_pTextureStreamer->UseTexture(m_skyTexture, 2.0f * pixelsPerUnit, 0.0f);
+    }
+    m_pTextureStreamer->Update();
 
-    ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
+    m_pRenderBackend->UpdateView(m_diffuseView, m_pTextureSink->GetView(m_diffuseTexture));
+    m_pRenderBackend->UpdateView(m_normalView, m_pTextureSink->GetView(m_normalTexture));
+    m_pRenderBackend->UpdateView(m_skyView, m_pTextureSink->GetView(m_skyTexture));
 }
 
-void Scene::RenderTransparent(ID3D11DeviceContext* context) {
-    context->IASetIndexBuffer(m_pTransIndexBuffer, DXGI_FORMAT_R16_UINT, 0);
-    ID3D11Buffer* vertexBuffers[] = { m_pTransVertexBuffer };
-    UINT stride = sizeof(XMFLOAT4);
-    UINT offset = 0;
-    context->IASetVertexBuffers(0, 1, vertexBuffers, &stride, &offset);
-    context->IASetInputLayout(m_pTransInputLayout);
+void Scene::Render(ID3D11DeviceContext* context) {
+    // Compute pass, post effect and ImGui change context states between frames
+    m_pRenderBackend->Invalidate();
+    m_pRenderBackend->ResetStats();
 
-    context->RSSetState(m_pRasterizerState);
-    context->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    context->RSSetState(m_pTransRasterizerState);
+    m_pSceneFrame->Render(m_pRenderQueue);
+    if (m_useCommandLists) {
+        SubmitCommandLists(context);
+    }
+    else {
+        m_pRenderQueue->Submit(m_pFrameRecorder);
+        m_stateStats = m_pRenderBackend->GetStateStats();
+    }
+    // Constant ranges of this frame are freed once GPU passes this point
+    m_pFrameRecorder->EndFrame();
+    ReadQueries(context);
 
-    context->VSSetShader(m_pTransVertexShader, nullptr, 0);
-    context->PSSetShader(m_pTransPixelShader, nullptr, 0);
-    context->VSSetConstantBuffers(1, 1, &m_pSceneConstantBuffer);
-    context->PSSetConstantBuffers(2, 1, &m_pLightConstantBuffer);
+    ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
+}
 
-    context->OMSetBlendState(m_pTransBlendState, nullptr, 0xFFFFFFFF);
-    context->OMSetDepthStencilState(m_pTransDepthState, 0);
+// Function to create deferred contexts for parallel recording
+HRESULT Scene::InitCommandLists(ID3D11Device* device) {
+    HRESULT hr = S_OK;
 
-    if (m_yellowRect) {
-        {
-            context->VSSetConstantBuffers(0, 1, &m_pTransWorldMatrixBuffer2);
-            context->PSSetConstantBuffers(0, 1, &m_pTransWorldMatrixBuffer2);
+    for (int i = 0; i < MAX_COMMAND_LISTS && SUCCEEDED(hr); i++) {
+        CommandList& list = m_commandLists[i];
+        ID3D11DeviceContext* context = nullptr;
+        hr = device->CreateDeferredContext(0, &context);
+        if (SUCCEEDED(hr)) {
+            hr = context->QueryInterface(__uuidof(ID3D11DeviceContext1), reinterpret_cast<void**>(&list.pContext));
+        }
+        SAFE_RELEASE(context);
+        assert(SUCCEEDED(hr));
 
-            context->DrawIndexed(6, 0, 0);
+        if (SUCCEEDED(hr)) {
+            list.pBackend = new D3D11Backend;
+            list.pCounter = new RecordingBackend;
+            if (!list.pBackend || !list.pCounter) {
+                hr = S_FALSE;
+            }
         }
-        {
-            context->VSSetConstantBuffers(0, 1, &m_pTransWorldMatrixBuffer);
-            context->PSSetConstantBuffers(0, 1, &m_pTransWorldMatrixBuffer);
 
-            context->DrawIndexed(6, 0, 0);
+        if (SUCCEEDED(hr)) {
+            list.pBackend->InitDeferred(list.pContext, m_pRenderBackend);
+            list.pCounter->Init(false, list.pBackend);
         }
     }
-    else {
-        {
-            context->VSSetConstantBuffers(0, 1, &m_pTransWorldMatrixBuffer);
-            context->PSSetConstantBuffers(0, 1, &m_pTransWorldMatrixBuffer);
 
-            context->DrawIndexed(6, 0, 0);
-        }
-        {
-            context->VSSetConstantBuffers(0, 1, &m_pTransWorldMatrixBuffer2);
-            context->PSSetConstantBuffers(0, 1, &m_pTransWorldMatrixBuffer2);
+    return hr;
+}
 
-            context->DrawIndexed(6, 0, 0);
+// Function to record sorted packets to deferred contexts in parallel and execute them in order
+void Scene::SubmitCommandLists(ID3D11DeviceContext* context) {
+    int partsCount = m_pRenderQueue->GetSubmitParts((std::min)(MAX_COMMAND_LISTS, m_pJobSystem->GetWorkersCount() + 1));
+
+    RenderBackend* backends[MAX_COMMAND_LISTS];
+    for (int i = 0; i < partsCount; i++) {
+        CommandList& list = m_commandLists[i];
+        // Deferred context starts every command list with default states
+        list.pBackend->Invalidate();
+        list.pBackend->ResetStats();
+        list.pBackend->CopyTargets(context);
+        list.pCounter->Reset();
+        backends[i] = list.pCounter;
+    }
+
+    m_pRenderQueue->SubmitParallel(backends, partsCount);
+
+    // Lists are executed in part order, so draws keep sort order whatever threads recorded them
+    m_stateStats = m_pRenderBackend->GetStateStats();
+    for (int i = 0; i < partsCount; i++) {
+        CommandList& list = m_commandLists[i];
+        ID3D11CommandList* commandList = nullptr;
+        HRESULT hr = list.pContext->FinishCommandList(FALSE, &commandList);
+        assert(SUCCEEDED(hr));
+        if (SUCCEEDED(hr)) {
+            // Immediate context keeps its states for post effect
+            context->ExecuteCommandList(commandList, TRUE);
+            SAFE_RELEASE(commandList);
         }
+
+        m_pFrameRecorder->Append(*list.pCounter);
+        m_stateStats.issued += list.pBackend->GetStateStats().issued;
+        m_stateStats.elided += list.pBackend->GetStateStats().elided;
     }
 }
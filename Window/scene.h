@@ -3,32 +3,30 @@
 
 #include <d3dcompiler.h>
 #include <dxgi.h>
-#include <d3d11.h>
+#include <d3d11_1.h>
 #include <directxmath.h>
 #include <string>
 #include <algorithm>
 #include <vector>
 #include "cubemap.h"
 #include "texture.h"
+#include "textureStreamSink.h"
 #include "light.h"
 #include "DDSTextureLoader.h"
 #include "utility.h"
 #include "defines.h"
 #include "frustum.h"
+#include "cubeInstances.h"
+#include "jobSystem.h"
+#include "sceneFrame.h"
+#include "sceneGenerator.h"
+#include "sceneFile.h"
+#include "pipelineStateCache.h"
+#include "shaderCompiler.h"
+#include "renderBackend.h"
 
 using namespace DirectX;
 
-static const XMFLOAT4 AABB[] = {
-     {-0.5f, -0.5f, -0.5f, 1.0f},
-     {0.5f, -0.5f, -0.5f, 1.0f},
-     {-0.5f, 0.5f, -0.5f, 1.0f},
-     {-0.5f, -0.5f, 0.5f, 1.0f},
-     {0.5f, 0.5f, -0.5f, 1.0f},
-     {0.5f, -0.5f, 0.5f, 1.0f},
-     {-0.5f, 0.5f, 0.5f, 1.0f},
-     {0.5f,  0.5f, 0.5f, 1.0f}
-};
-
 static const XMFLOAT4 Vertices[] = {
     {0, -1, -1, 1},
     {0,  1, -1, 1},
@@ -46,52 +44,43 @@ private:
         XMFLOAT3 tangent;
     };
 
-    struct GeomBuffer {
-        XMMATRIX mWorldMatrix;
-        XMMATRIX norm;
-        XMFLOAT4 shineSpeedTexIdNM;
-    };
-
-    struct CubeModel {
-        XMFLOAT4 pos;
-        XMFLOAT4 shineSpeedIdNM;
+    // Deferred context with its backend, records part of render queue on worker thread
+    struct CommandList {
+        ID3D11DeviceContext1* pContext = nullptr;
+        D3D11Backend* pBackend = nullptr;
+        RecordingBackend* pCounter = nullptr;
     };
 
-    struct WorldMatrixBuffer {
-        XMMATRIX mWorldMatrix;
-        XMFLOAT4 color;
-    };
-
-    struct SceneConstantBuffer {
-        XMMATRIX mViewProjectionMatrix;
-        XMFLOAT4 planes[6];
-    };
-
-    struct CullParams {
-        XMINT4 numShapes; // x - objects count;
-        XMFLOAT4 bbMin[MAX_CUBE];
-        XMFLOAT4 bbMax[MAX_CUBE];
-    };
-
-    struct LightConstantBuffer {
-        XMFLOAT4 cameraPos;
-        XMINT4 lightCount;
-        XMFLOAT4 lightPos[MAX_LIGHT];
-        XMFLOAT4 lightColor[MAX_LIGHT];
-        XMFLOAT4 ambientColor;
+    // Shader bytecode prepared by load tasks
+    struct LoadedData {
+        ID3D10Blob* pVertexShaderBuffer = nullptr;
+        ID3D10Blob* pPixelShaderBuffer = nullptr;
+        ID3D10Blob* pComputeShaderBuffer = nullptr;
+        ID3D10Blob* pTransVertexShaderBuffer = nullptr;
+        ID3D10Blob* pTransPixelShaderBuffer = nullptr;
+
+        void Release() {
+            SAFE_RELEASE(pVertexShaderBuffer);
+            SAFE_RELEASE(pPixelShaderBuffer);
+            SAFE_RELEASE(pComputeShaderBuffer);
+            SAFE_RELEASE(pTransVertexShaderBuffer);
+            SAFE_RELEASE(pTransPixelShaderBuffer);
+        };
     };
 
 public:
-    // Initialize all needed instances
-    HRESULT Init(ID3D11Device* device, ID3D11DeviceContext* context, int screenWidth, int screenHeight);
+    // Function to add tasks compiling shaders and preparing cube map and lights, they run before Init
+    void AddLoadTasks(TaskGraph& graph, ShaderCompiler* shaderCompiler, std::vector<int>& tasks);
+    // Initialize all needed instances, resources of frame are created in render backend
+    HRESULT Init(ID3D11Device* device, ID3D11DeviceContext* context, PipelineStateCache* stateCache, D3D11Backend* backend, int screenWidth, int screenHeight);
     // Clean up all the objects we've created
     void Release();
     // Resize function
-    void Resize(int screenWidth, int screenHeight) { m_pCubeMap->Resize(screenWidth, screenHeight); };
+    void Resize(int screenWidth, int screenHeight) { m_screenHeight = screenHeight; m_pCubeMap->Resize(screenWidth, screenHeight); };
     // Render function
     void Render(ID3D11DeviceContext* context);
-    // Render the frame
-    bool Frame(ID3D11DeviceContext* context, XMMATRIX worldMatrix, XMMATRIX viewMatrix, XMMATRIX projectionMatrix, XMFLOAT3 cameraPos);
+    // Function to send uploads, constants and culling of frame to backend, Render submits draws to the same backend
+    bool Frame(RenderBackend* backend, XMMATRIX worldMatrix, XMMATRIX viewMatrix, XMMATRIX projectionMatrix, XMFLOAT3 cameraPos, float time);
 
     // ImGui Light change
     void CreateNewLight();
@@ -99,48 +88,73 @@ public:
     // ImGui Cube change
     void CreateNewCube();
     void DeleteCube();
+    // Function to add count generated cubes
+    void SpawnCubes(int count);
+    // Function to replace cubes and lights with generated ones
+    void GenerateScene(const SceneGenerator::SceneDesc& desc);
+    // Function to save cubes, lights and texture names to binary scene file
+    bool SaveScene(const char* path);
+    // Function to replace cubes and lights with ones from binary scene file
+    bool LoadScene(const char* path);
+    // Function to add transparent quad with given center and color, returns its id
+    int AddTransparentQuad(const XMFLOAT3& position, const XMFLOAT4& color) { return m_pSceneFrame->AddTransparentQuad(position, color); };
+    // Get parameters of current generated scene
+    const SceneGenerator::SceneDesc& GetSceneDesc() { return m_pSceneGenerator->GetDesc(); };
 
     // Switch flags functions
-    void ToggleSpheres() { m_isSpheresOn = !m_isSpheresOn; };
-    void ToggleNormalMaps() { m_useNormalMap = !m_useNormalMap; };
-    void ToggleShowNormals() { m_showNormals = !m_showNormals; };
-    void ToggleCulling() { m_isCullingOn = !m_isCullingOn; };
-    void ToggleGPUCulling() { m_computeCull = !m_computeCull; };
-    void GPUCullingOFF() { m_computeCull = false; };
+    void ToggleSpheres() { m_pSceneFrame->GetSettings().isSpheresOn = !m_pSceneFrame->GetSettings().isSpheresOn; };
+    void ToggleNormalMaps() { m_pSceneFrame->GetSettings().useNormalMap = !m_pSceneFrame->GetSettings().useNormalMap; };
+    void ToggleShowNormals() { m_pSceneFrame->GetSettings().showNormals = !m_pSceneFrame->GetSettings().showNormals; };
+    void ToggleCulling() { m_pSceneFrame->GetSettings().isCullingOn = !m_pSceneFrame->GetSettings().isCullingOn; };
+    void ToggleGPUCulling() { m_pSceneFrame->GetSettings().computeCull = !m_pSceneFrame->GetSettings().computeCull; };
+    void GPUCullingOFF() { m_pSceneFrame->GetSettings().computeCull = false; };
+    void ToggleBVH() { m_pSceneFrame->GetSettings().useBVH = !m_pSceneFrame->GetSettings().useBVH; };
+    void ToggleCommandLists() { m_useCommandLists = !m_useCommandLists; };
     // Get light info vector
     std::vector<std::pair<XMFLOAT3, XMFLOAT3>>& GetLightVector() { return  m_pLight->GetLightVector(); };
     // Get cube count
-    int GetCubeCount() { return m_cubesCount; };
-    int GetCubeRendered() { return m_computeCull ? m_cubesCountGPU : (int)m_cubeIndexies.size(); };
-    int GetCubeCulled() { return m_computeCull ? m_cubesCount - m_cubesCountGPU : m_cubesCount - (int)m_cubeIndexies.size(); };
+    int GetCubeCount() { return m_pCubeInstances->GetCount(); };
+    int GetCubeRendered() { return m_pSceneFrame->GetSettings().computeCull ? m_cubesCountGPU : m_pCubeInstances->GetVisibleCount(); };
+    int GetCubeCulled() { return GetCubeCount() - GetCubeRendered(); };
+    // Get draws, dispatches and uploads counters of last frame
+    const RecordingBackend& GetFrameCounters() { return *m_pFrameRecorder; };
+    // Get state binds counters of last frame
+    const D3D11Backend::StateStats& GetStateStats() { return m_stateStats; };
+    // Get cubes update counters of last frame
+    const CubeInstances::UpdateStats& GetCubeUpdateStats() { return m_pCubeInstances->GetUpdateStats(); };
+    // Get resident bytes, budget and loads of streamed textures
+    TextureStreamer::Stats GetStreamingStats() { return m_pTextureStreamer->GetStats(); };
 private:
-    std::vector<CubeModel> m_cubeModelVector;
-    std::vector<int> m_cubeIndexies;
-    int m_cubesCount = MAX_CUBE;
-    int m_cubesCountGPU = MAX_CUBE;
+    int m_cubesCountGPU = 0;
+    // Index of next generated cube
+    int m_nextCubeIndex = 0;
+    // Function to create instances buffers in backend for given cubes count, scene frame grows them
+    HRESULT CreateInstanceBuffers(int capacity);
     // Function to initialize scene's geometry
-    HRESULT InitScene(ID3D11Device* device, ID3D11DeviceContext* context);
+    HRESULT InitScene(ID3D11Device* device, ID3D11DeviceContext* context, PipelineStateCache* stateCache);
+    // Function to create transparent objects buffer in backend for given objects count, scene frame grows it
+    HRESULT CreateTransparentBuffers(int capacity);
     // Function to initialize transperent scene's geometry
-    HRESULT InitSceneTransparent(ID3D11Device* device, ID3D11DeviceContext* context);
-    // Render transperent part
-    void RenderTransparent(ID3D11DeviceContext* context);
+    HRESULT InitSceneTransparent(ID3D11Device* device, ID3D11DeviceContext* context, PipelineStateCache* stateCache);
+    // Function to create deferred contexts for parallel recording
+    HRESULT InitCommandLists(ID3D11Device* device);
+    // Function to record sorted packets to deferred contexts in parallel and execute them in order
+    void SubmitCommandLists(ID3D11DeviceContext* context);
+    // Function to register pipelines, materials and draw resources of scene parts in render backend
+    void RegisterStates();
+    // Function to report screen sizes of streamed textures and apply their loaded mips
+    void UpdateStreaming(XMMATRIX projectionMatrix, XMFLOAT3 cameraPos);
     // Function to get info from Queries
     void ReadQueries(ID3D11DeviceContext* context);
 
     ID3D11Buffer* m_pVertexBuffer = nullptr;
     ID3D11Buffer* m_pIndexBuffer = nullptr;
-    ID3D11Buffer* m_pGeomBufferInst = nullptr;
-    ID3D11Buffer* m_pSceneConstantBuffer = nullptr;
-    ID3D11Buffer* m_pCullParams = nullptr;
-    ID3D11Buffer* m_pLightConstantBuffer = nullptr;
     ID3D11RasterizerState* m_pRasterizerState = nullptr;
     ID3D11SamplerState* m_pSampler = nullptr;
     ID3D11DepthStencilState* m_pDepthState = nullptr;
 
     ID3D11Buffer* m_pTransVertexBuffer = nullptr;
     ID3D11Buffer* m_pTransIndexBuffer = nullptr;
-    ID3D11Buffer* m_pTransWorldMatrixBuffer = nullptr;
-    ID3D11Buffer* m_pTransWorldMatrixBuffer2 = nullptr;
     ID3D11RasterizerState* m_pTransRasterizerState = nullptr;
     ID3D11DepthStencilState* m_pTransDepthState = nullptr;
     ID3D11BlendState* m_pTransBlendState = nullptr;
@@ -154,33 +168,43 @@ private:
     ID3D11VertexShader* m_pTransVertexShader = nullptr;
     ID3D11PixelShader* m_pTransPixelShader = nullptr;
 
-    ID3D11Buffer* m_pInderectArgsSrc = nullptr;
-    ID3D11Buffer* m_pInderectArgs = nullptr;
-    ID3D11UnorderedAccessView* m_pInderectArgsUAV = nullptr;
-    ID3D11Buffer* m_pGeomBufferInstVis = nullptr;
-    ID3D11Buffer* m_pGeomBufferInstVisGpu = nullptr;
-    ID3D11UnorderedAccessView* m_pGeomBufferInstVisGpu_UAV = nullptr;
-
+    JobSystem* m_pJobSystem = nullptr;
+    SceneGenerator* m_pSceneGenerator = nullptr;
+    CubeInstances* m_pCubeInstances = nullptr;
     CubeMap* m_pCubeMap = nullptr;
     Light* m_pLight = nullptr;
-    Frustum* m_pFrustum = nullptr;
-
-    std::vector<Texture> m_textureArray;
-
-    ID3D11Query* m_queries[MAX_QUERY];
-    unsigned int m_curFrame = 0;
+    SceneFrame* m_pSceneFrame = nullptr;
+    RenderQueue* m_pRenderQueue = nullptr;
+    // Owned by renderer, keeps buffers and constants of scene
+    D3D11Backend* m_pRenderBackend = nullptr;
+    // Counts all commands of frame and passes them to backend given to Frame
+    RecordingBackend* m_pFrameRecorder = nullptr;
+    CommandList m_commandLists[MAX_COMMAND_LISTS];
+    // State binds of immediate and deferred contexts
+    D3D11Backend::StateStats m_stateStats;
+
+    // Render backend ids, given to scene frame
+    SceneFrame::Ids m_ids;
+    // Backend views of streamed textures, updated after streaming every frame
+    int m_diffuseView = -1;
+    int m_normalView = -1;
+    int m_skyView = -1;
+
+    TextureStreamer* m_pTextureStreamer = nullptr;
+    D3D11TextureSink* m_pTextureSink = nullptr;
+    // Streamed texture ids
+    int m_diffuseTexture = -1;
+    // Files of diffuse texture array, material ids of cubes index its slices
+    std::vector<std::string> m_diffuseTextureNames = { "data/brick_diffuse.dds", "data/morgana.dds" };
+    int m_normalTexture = -1;
+    int m_skyTexture = -1;
+    int m_screenHeight = 0;
+    // Data prepared by load tasks, released by Init
+    LoadedData m_loadedData;
+
+    ID3D11Query* m_queries[MAX_QUERY] = {};
     unsigned int m_lastCompletedFrame = 0;
 
-    // flag to know what rect to draw
-    bool m_yellowRect = false;
-    // flag to render light spheres
-    bool m_isSpheresOn = true;
-    // flag to use normal maps on cubes
-    bool m_useNormalMap = true;
-    // flag to show normals
-    bool m_showNormals = false;
-    // flag to turn culling
-    bool m_isCullingOn = true;
-    // flag to turn gpu culling
-    bool m_computeCull = true;
+    // flag to record draws to deferred contexts on worker threads
+    bool m_useCommandLists = false;
 };
@@ -0,0 +1,190 @@
+#include "sceneFile.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace {
+    // Function to round offset up to file alignment
+    inline uint64_t AlignOffset(uint64_t offset) {
+        return (offset + SCENE_FILE_ALIGNMENT - 1) / SCENE_FILE_ALIGNMENT * SCENE_FILE_ALIGNMENT;
+    };
+}
+
+// Function to get element size of known block type
+uint32_t SceneFile::GetElementSize(uint32_t type) {
+    switch (type) {
+    case BLOCK_POSITION_X:
+    case BLOCK_POSITION_Y:
+    case BLOCK_POSITION_Z:
+    case BLOCK_ANGULAR_SPEED:
+        return sizeof(float);
+    case BLOCK_MATERIAL:
+        return sizeof(XMFLOAT4);
+    case BLOCK_LIGHT_POSITION:
+    case BLOCK_LIGHT_COLOR:
+        return sizeof(XMFLOAT3);
+    case BLOCK_TEXTURE_NAME:
+        return SCENE_TEXTURE_NAME_SIZE;
+    default:
+        return 0;
+    }
+}
+
+// Function to write cubes, lights and texture names to file
+bool SceneFile::Write(const char* path, const CubeInstances& cubes, const std::vector<std::pair<XMFLOAT3, XMFLOAT3>>& lights, const std::vector<std::string>& textureNames) {
+    std::vector<XMFLOAT3> lightPositions, lightColors;
+    for (const auto& light : lights) {
+        lightPositions.push_back(light.first);
+        lightColors.push_back(light.second);
+    }
+    std::vector<char> names(textureNames.size() * SCENE_TEXTURE_NAME_SIZE, 0);
+    for (size_t i = 0; i < textureNames.size(); i++) {
+        memcpy(&names[i * SCENE_TEXTURE_NAME_SIZE], textureNames[i].c_str(), (std::min)(textureNames[i].size(), (size_t)SCENE_TEXTURE_NAME_SIZE - 1));
+    }
+
+    uint64_t cubesCount = (uint64_t)cubes.GetCount();
+    const void* blocksData[BLOCK_COUNT] = {
+        cubes.GetPositionsX().data(),
+        cubes.GetPositionsY().data(),
+        cubes.GetPositionsZ().data(),
+        cubes.GetAngularSpeeds().data(),
+        cubes.GetMaterials().data(),
+        lightPositions.data(),
+        lightColors.data(),
+        names.data()
+    };
+    uint64_t blocksCount[BLOCK_COUNT] = {
+        cubesCount, cubesCount, cubesCount, cubesCount, cubesCount,
+        lights.size(), lights.size(),
+        textureNames.size()
+    };
+
+    // Lay out blocks after header and block table
+    Header header;
+    header.magic = SCENE_FILE_MAGIC;
+    header.version = SCENE_FILE_VERSION;
+    header.headerSize = sizeof(Header);
+    header.blocksCount = BLOCK_COUNT;
+    header.cubesCount = (uint32_t)cubesCount;
+    header.lightsCount = (uint32_t)lights.size();
+
+    Block blocks[BLOCK_COUNT];
+    uint64_t offset = sizeof(Header) + sizeof(blocks);
+    for (uint32_t i = 0; i < BLOCK_COUNT; i++) {
+        blocks[i].type = i;
+        blocks[i].elementSize = GetElementSize(i);
+        blocks[i].offset = AlignOffset(offset);
+        blocks[i].count = blocksCount[i];
+        offset = blocks[i].offset + blocks[i].count * blocks[i].elementSize;
+    }
+    header.fileSize = offset;
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(blocks), sizeof(blocks));
+    offset = sizeof(Header) + sizeof(blocks);
+    static const char padding[SCENE_FILE_ALIGNMENT] = {};
+    for (uint32_t i = 0; i < BLOCK_COUNT; i++) {
+        std::streamsize size = (std::streamsize)(blocks[i].count * blocks[i].elementSize);
+        file.write(padding, (std::streamsize)(blocks[i].offset - offset));
+        file.write(static_cast<const char*>(blocksData[i]), size);
+        offset = blocks[i].offset + size;
+    }
+
+    file.close();
+    return !file.fail();
+}
+
+// Function to check that data is complete scene file of supported version, fills view with pointers into data on success
+bool SceneFile::Validate(const unsigned char* data, size_t size, View* view) {
+    if (!data || size < sizeof(Header)) {
+        return false;
+    }
+
+    Header header;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != SCENE_FILE_MAGIC || header.version != SCENE_FILE_VERSION || header.headerSize != sizeof(Header) ||
+        header.fileSize != size || header.cubesCount > INT32_MAX || header.lightsCount > INT32_MAX) {
+        return false;
+    }
+    if (header.blocksCount > (size - sizeof(Header)) / sizeof(Block)) {
+        return false;
+    }
+
+    // Blocks of unknown types are skipped for forward compatibility, every known block must appear once
+    const Block* blocks = reinterpret_cast<const Block*>(data + sizeof(Header));
+    const unsigned char* blocksData[BLOCK_COUNT] = {};
+    uint64_t blocksCount[BLOCK_COUNT] = {};
+    for (uint32_t i = 0; i < header.blocksCount; i++) {
+        const Block& block = blocks[i];
+        if (block.offset % SCENE_FILE_ALIGNMENT != 0 || block.offset > size || block.elementSize == 0 ||
+            block.count > (size - block.offset) / block.elementSize) {
+            return false;
+        }
+        if (block.type >= BLOCK_COUNT) {
+            continue;
+        }
+        if (block.elementSize != GetElementSize(block.type) || blocksData[block.type] != nullptr) {
+            return false;
+        }
+        blocksData[block.type] = data + block.offset;
+        blocksCount[block.type] = block.count;
+    }
+
+    for (uint32_t type = 0; type < BLOCK_COUNT; type++) {
+        if (!blocksData[type]) {
+            return false;
+        }
+        uint64_t expectedCount = type <= BLOCK_MATERIAL ? header.cubesCount : header.lightsCount;
+        if (type != BLOCK_TEXTURE_NAME && blocksCount[type] != expectedCount) {
+            return false;
+        }
+    }
+    if (blocksCount[BLOCK_TEXTURE_NAME] > INT32_MAX) {
+        return false;
+    }
+    const char* names = reinterpret_cast<const char*>(blocksData[BLOCK_TEXTURE_NAME]);
+    for (uint64_t i = 0; i < blocksCount[BLOCK_TEXTURE_NAME]; i++) {
+        if (names[(i + 1) * SCENE_TEXTURE_NAME_SIZE - 1] != '\0') {
+            return false;
+        }
+    }
+
+    if (view) {
+        view->cubesCount = (int)header.cubesCount;
+        view->posX = reinterpret_cast<const float*>(blocksData[BLOCK_POSITION_X]);
+        view->posY = reinterpret_cast<const float*>(blocksData[BLOCK_POSITION_Y]);
+        view->posZ = reinterpret_cast<const float*>(blocksData[BLOCK_POSITION_Z]);
+        view->angularSpeed = reinterpret_cast<const float*>(blocksData[BLOCK_ANGULAR_SPEED]);
+        view->materials = reinterpret_cast<const XMFLOAT4*>(blocksData[BLOCK_MATERIAL]);
+        view->lightsCount = (int)header.lightsCount;
+        view->lightPositions = reinterpret_cast<const XMFLOAT3*>(blocksData[BLOCK_LIGHT_POSITION]);
+        view->lightColors = reinterpret_cast<const XMFLOAT3*>(blocksData[BLOCK_LIGHT_COLOR]);
+        view->texturesCount = (int)blocksCount[BLOCK_TEXTURE_NAME];
+        view->textureNames = names;
+    }
+    return true;
+}
+
+// Function to map and validate file
+bool SceneFile::Open(const char* path) {
+    Release();
+    if (!m_file.Open(path)) {
+        return false;
+    }
+    if (!Validate(m_file.GetData(), m_file.GetSize(), &m_view)) {
+        Release();
+        return false;
+    }
+    return true;
+}
+
+// Function to unmap file, view becomes invalid
+void SceneFile::Release() {
+    m_file.Release();
+    m_view = View();
+}
@@ -0,0 +1,87 @@
+// sceneFile.h - class for binary scene file used in place after memory mapping
+#pragma once
+
+#include <directxmath.h>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "cubeInstances.h"
+#include "mappedFile.h"
+
+using namespace DirectX;
+
+#define SCENE_FILE_MAGIC 0x43535844 // "DXSC"
+#define SCENE_FILE_VERSION 1
+#define SCENE_FILE_ALIGNMENT 64
+#define SCENE_TEXTURE_NAME_SIZE 128
+
+// File layout (little-endian): Header, Block table, then blocks of blocks[i].count elements at blocks[i].offset from file start,
+// every offset is aligned to SCENE_FILE_ALIGNMENT so blocks can be used directly as component streams
+class SceneFile {
+public:
+    enum BlockType {
+        BLOCK_POSITION_X = 0,    // float per cube
+        BLOCK_POSITION_Y,        // float per cube
+        BLOCK_POSITION_Z,        // float per cube
+        BLOCK_ANGULAR_SPEED,     // float per cube
+        BLOCK_MATERIAL,          // XMFLOAT4 per cube: specular power, rotation speed, texture id, normal map presence
+        BLOCK_LIGHT_POSITION,    // XMFLOAT3 per light
+        BLOCK_LIGHT_COLOR,       // XMFLOAT3 per light
+        BLOCK_TEXTURE_NAME,      // SCENE_TEXTURE_NAME_SIZE null terminated chars per texture
+        BLOCK_COUNT
+    };
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t headerSize;
+        uint32_t blocksCount;
+        uint64_t fileSize;
+        uint32_t cubesCount;
+        uint32_t lightsCount;
+    };
+
+    struct Block {
+        uint32_t type;
+        uint32_t elementSize;
+        uint64_t offset;
+        uint64_t count;
+    };
+
+    // Pointers to blocks of mapped file
+    struct View {
+        int cubesCount = 0;
+        const float* posX = nullptr;
+        const float* posY = nullptr;
+        const float* posZ = nullptr;
+        const float* angularSpeed = nullptr;
+        const XMFLOAT4* materials = nullptr;
+
+        int lightsCount = 0;
+        const XMFLOAT3* lightPositions = nullptr;
+        const XMFLOAT3* lightColors = nullptr;
+
+        int texturesCount = 0;
+        const char* textureNames = nullptr; // texturesCount names of SCENE_TEXTURE_NAME_SIZE chars
+    };
+
+    // Function to write cubes, lights and texture names to file
+    static bool Write(const char* path, const CubeInstances& cubes, const std::vector<std::pair<XMFLOAT3, XMFLOAT3>>& lights, const std::vector<std::string>& textureNames);
+    // Function to check that data is complete scene file of supported version, fills view with pointers into data on success
+    static bool Validate(const unsigned char* data, size_t size, View* view = nullptr);
+
+    // Function to map and validate file
+    bool Open(const char* path);
+    // Function to unmap file, view becomes invalid
+    void Release();
+
+    const View& GetView() const { return m_view; };
+
+private:
+    // Function to get element size of known block type
+    static uint32_t GetElementSize(uint32_t type);
+
+    MappedFile m_file;
+    View m_view;
+};
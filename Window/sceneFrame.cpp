@@ -0,0 +1,233 @@
+#include "sceneFrame.h"
+#include <algorithm>
+
+// Function to set scene parts and ids of their backend resources
+void SceneFrame::Init(CubeInstances* cubes, LightSpheres* lights, SkySphere* sky, const Ids& ids) {
+    m_pCubeInstances = cubes;
+    m_pLights = lights;
+    m_pSky = sky;
+    m_ids = ids;
+    m_frustum.Init(SCREEN_NEAR);
+    m_identityCount = 0;
+    m_queriesIssued = 0;
+}
+
+// Release function
+void SceneFrame::Release() {
+    m_pCubeInstances = nullptr;
+    m_pLights = nullptr;
+    m_pSky = nullptr;
+    m_frustum.Release();
+    m_transparentList.Release();
+    m_transparentObjects.clear();
+    m_transparentSorted.clear();
+    m_identityCount = 0;
+    m_identityIndices.clear();
+}
+
+// Function to add transparent quad with given center and color, returns its id
+int SceneFrame::AddTransparentQuad(const XMFLOAT3& position, const XMFLOAT4& color) {
+    WorldMatrixBuffer object;
+    object.mWorldMatrix = XMMatrixTranslation(position.x, position.y, position.z);
+    object.color = color;
+    m_transparentObjects.push_back(object);
+    return m_transparentList.Add(position);
+}
+
+bool SceneFrame::Frame(RenderBackend* backend, XMMATRIX viewMatrix, XMMATRIX projectionMatrix, XMFLOAT3 cameraPos, float time) {
+    if (!GrowBuffers(backend)) {
+        return false;
+    }
+
+    // Calculate world matrices and bounding boxes of moving and changed cubes
+    m_pCubeInstances->Update(time);
+
+    // Calculate frustum
+    m_frustum.ConstructFrustum(viewMatrix, projectionMatrix);
+    // Find cubes in frustum, compute shader writes its own visible list
+    m_pCubeInstances->Cull(m_settings.isCullingOn && !m_settings.computeCull ? &m_frustum : nullptr, m_settings.useBVH);
+
+    UploadBuffers(backend, viewMatrix);
+
+    // Dispatch is split in rows to not exceed groups count limit
+    uint32_t cubesCount = (uint32_t)m_pCubeInstances->GetCount();
+    uint32_t groupNumber = cubesCount / CULL_GROUP_SIZE + !!(cubesCount % CULL_GROUP_SIZE);
+    uint32_t groupNumberX = (std::min)(groupNumber, (uint32_t)CULL_MAX_GROUPS);
+    uint32_t groupNumberY = groupNumberX > 0 ? groupNumber / groupNumberX + !!(groupNumber % groupNumberX) : 0;
+
+    // All constants of frame are sub-allocated by backend, its ranges are kept until GPU finishes frame
+    if (!backend->MapConstants()) {
+        return false;
+    }
+    bool isAllocated = WriteConstants(backend, viewMatrix, projectionMatrix, cameraPos, groupNumberX);
+    isAllocated = isAllocated && m_pLights->Frame(backend, viewMatrix, projectionMatrix);
+    isAllocated = isAllocated && m_pSky->Frame(backend, viewMatrix, projectionMatrix, cameraPos);
+    backend->UnmapConstants();
+    if (!isAllocated) {
+        return false;
+    }
+
+    // GPU Culling
+    IndirectArgs args;
+    args.indexCountPerInstance = 36;
+    args.instanceCount = 0;
+    args.startInstanceLocation = 0;
+    args.baseVertexLocation = 0;
+    args.startIndexLocation = 0;
+    backend->UploadBuffer(m_ids.indirectArgsSrcBuffer, 0, &args, sizeof(args));
+    backend->Dispatch(m_ids.cullCompute, groupNumberX, groupNumberY, 1);
+    backend->CopyBuffer(m_ids.indirectArgsBuffer, m_ids.indirectArgsSrcBuffer);
+
+    return true;
+}
+
+// Function to grow buffers which don't fit objects, returns false if backend can't resize them
+bool SceneFrame::GrowBuffers(RenderBackend* backend) {
+    // New instances buffers need all cubes data
+    int cubesCount = m_pCubeInstances->GetCount();
+    if (cubesCount > m_ids.instanceCapacity) {
+        int capacity = (std::max)(cubesCount, m_ids.instanceCapacity * 2);
+        bool isResized = backend->ResizeBuffer(m_ids.geomBuffer, uint32_t(sizeof(CubeInstances::GeomBuffer) * capacity));
+        isResized = isResized && backend->ResizeBuffer(m_ids.cullBoxesBuffer, uint32_t(sizeof(CubeInstances::CullBox) * capacity));
+        isResized = isResized && backend->ResizeBuffer(m_ids.visibleBuffer, uint32_t(sizeof(uint32_t) * capacity));
+        isResized = isResized && backend->ResizeBuffer(m_ids.visibleGpuBuffer, uint32_t(sizeof(uint32_t) * capacity));
+        m_identityCount = 0;
+        if (!isResized) {
+            m_ids.instanceCapacity = 0;
+            return false;
+        }
+        m_ids.instanceCapacity = capacity;
+        m_pCubeInstances->MarkAllDirty();
+    }
+
+    int transparentCount = (int)m_transparentObjects.size();
+    if (transparentCount > m_ids.transparentCapacity) {
+        int capacity = (std::max)(transparentCount, m_ids.transparentCapacity * 2);
+        if (!backend->ResizeBuffer(m_ids.transGeomBuffer, uint32_t(sizeof(WorldMatrixBuffer) * capacity))) {
+            m_ids.transparentCapacity = 0;
+            return false;
+        }
+        m_ids.transparentCapacity = capacity;
+    }
+
+    return true;
+}
+
+// Function to upload changed cubes, sorted transparent objects and visible list
+void SceneFrame::UploadBuffers(RenderBackend* backend, XMMATRIX viewMatrix) {
+    // Upload only changed ranges
+    const CubeInstances::GeomBuffer* geomBuffers = m_pCubeInstances->GetGeomBuffers().data();
+    const CubeInstances::CullBox* cullBoxes = m_pCubeInstances->GetCullBoxes().data();
+    for (const CubeInstances::DirtyRange& range : m_pCubeInstances->GetDirtyRanges()) {
+        int count = range.last - range.first;
+        backend->UploadBuffer(m_ids.geomBuffer, uint32_t(sizeof(CubeInstances::GeomBuffer) * range.first),
+            geomBuffers + range.first, uint32_t(sizeof(CubeInstances::GeomBuffer) * count));
+        backend->UploadBuffer(m_ids.cullBoxesBuffer, uint32_t(sizeof(CubeInstances::CullBox) * range.first),
+            cullBoxes + range.first, uint32_t(sizeof(CubeInstances::CullBox) * count));
+    }
+
+    // Sort transparent objects back to front by view depth and upload them in that order
+    int transparentCount = (int)m_transparentObjects.size();
+    m_transparentList.Sort(viewMatrix);
+    const std::vector<int>& transparentOrder = m_transparentList.GetOrder();
+    m_transparentSorted.resize(transparentCount);
+    for (int i = 0; i < transparentCount; i++) {
+        m_transparentSorted[i] = m_transparentObjects[transparentOrder[i]];
+    }
+    if (transparentCount > 0) {
+        backend->UploadBuffer(m_ids.transGeomBuffer, 0, m_transparentSorted.data(), uint32_t(sizeof(WorldMatrixBuffer) * transparentCount));
+    }
+
+    int cubesCount = m_pCubeInstances->GetCount();
+    const std::vector<int>& visible = m_pCubeInstances->GetVisible();
+    if (!IsGpuCulling() && m_pCubeInstances->IsAllVisible()) {
+        // Identity list is kept in buffer, only indices of added cubes are uploaded
+        if (cubesCount > m_identityCount) {
+            int first = (int)m_identityIndices.size();
+            m_identityIndices.resize((std::max)(first, cubesCount));
+            for (int i = first; i < cubesCount; i++) {
+                m_identityIndices[i] = uint32_t(i);
+            }
+            backend->UploadBuffer(m_ids.visibleBuffer, uint32_t(sizeof(uint32_t) * m_identityCount), m_identityIndices.data() + m_identityCount,
+                uint32_t(sizeof(uint32_t) * (cubesCount - m_identityCount)));
+            m_identityCount = cubesCount;
+        }
+    }
+    else if (!IsGpuCulling() && !visible.empty()) {
+        backend->UploadBuffer(m_ids.visibleBuffer, 0, visible.data(), uint32_t(sizeof(uint32_t) * visible.size()));
+        m_identityCount = 0;
+    }
+}
+
+// Function to write scene and light constants
+bool SceneFrame::WriteConstants(RenderBackend* backend, XMMATRIX viewMatrix, XMMATRIX projectionMatrix, XMFLOAT3 cameraPos, uint32_t groupsX) {
+    CullParams* cullParams = static_cast<CullParams*>(backend->AllocateConstants(m_ids.cullParams, sizeof(CullParams)));
+    SceneConstantBuffer* sceneBuffer = static_cast<SceneConstantBuffer*>(backend->AllocateConstants(m_ids.sceneConstants, sizeof(SceneConstantBuffer)));
+    LightConstantBuffer* lightBuffer = static_cast<LightConstantBuffer*>(backend->AllocateConstants(m_ids.lightConstants, sizeof(LightConstantBuffer)));
+    if (!cullParams || !sceneBuffer || !lightBuffer) {
+        return false;
+    }
+
+    cullParams->numShapes = XMINT4(m_pCubeInstances->GetCount(), int(groupsX * CULL_GROUP_SIZE), 0, 0);
+
+    // Update Scene matrix
+    sceneBuffer->mViewProjectionMatrix = XMMatrixMultiply(viewMatrix, projectionMatrix);
+    XMFLOAT4* planes = m_frustum.GetPlanes();
+    for (int i = 0; i < 6; i++) {
+        sceneBuffer->planes[i] = planes[i];
+    }
+
+    // Update Light buffer
+    lightBuffer->cameraPos = XMFLOAT4(cameraPos.x, cameraPos.y, cameraPos.z, 1.0f);
+    lightBuffer->ambientColor = XMFLOAT4(0.9f, 0.9f, 0.9f, 1.0f);
+    auto& lightPosColorVector = m_pLights->GetLightVector();
+    lightBuffer->lightCount = XMINT4(int(lightPosColorVector.size()), m_settings.useNormalMap ? 1 : 0, m_settings.showNormals ? 1 : 0, 0);
+    for (size_t i = 0; i < lightPosColorVector.size(); i++) {
+        lightBuffer->lightPos[i] = XMFLOAT4(lightPosColorVector[i].first.x, lightPosColorVector[i].first.y, lightPosColorVector[i].first.z, 1.0f);
+        lightBuffer->lightColor[i] = XMFLOAT4(lightPosColorVector[i].second.x, lightPosColorVector[i].second.y, lightPosColorVector[i].second.z, 1.0f);
+    }
+
+    return true;
+}
+
+// Function to add draws of frame to render queue and sort it
+void SceneFrame::Render(RenderQueue* queue) {
+    queue->Clear();
+
+    // Visible list is chosen by material, so culling mode switches without touching backend
+    int material = IsGpuCulling() ? m_ids.cubesGpuMaterial : m_ids.cubesMaterial;
+    DrawPacket packet;
+    packet.key = RenderQueue::MakeKey(RenderQueue::PASS_OPAQUE, false, m_ids.cubesPipeline, material, 0.0f);
+    packet.pipeline = m_ids.cubesPipeline;
+    packet.material = material;
+    packet.indexCount = 36;
+    packet.instanceCount = m_pCubeInstances->GetVisibleCount();
+    if (IsGpuCulling()) {
+        packet.indirectArgs = m_ids.indirectArgsBuffer;
+        if (m_ids.firstQuery >= 0) {
+            packet.query = m_ids.firstQuery + m_queriesIssued % MAX_QUERY;
+            m_queriesIssued++;
+        }
+    }
+    queue->Push(packet);
+
+    // Render Spheres
+    if (m_settings.isSpheresOn) {
+        m_pLights->Render(queue);
+    }
+    m_pSky->Render(queue);
+
+    // Objects inside instanced draw are already sorted back to front by TransparentList
+    if (!m_transparentObjects.empty()) {
+        packet = DrawPacket();
+        packet.key = RenderQueue::MakeKey(RenderQueue::PASS_TRANSPARENT, true, m_ids.transPipeline, m_ids.transMaterial, 0.0f);
+        packet.pipeline = m_ids.transPipeline;
+        packet.material = m_ids.transMaterial;
+        packet.indexCount = 6;
+        packet.instanceCount = (int)m_transparentObjects.size();
+        queue->Push(packet);
+    }
+
+    // Draw everything in key order
+    queue->Sort();
+}
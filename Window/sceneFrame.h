@@ -0,0 +1,137 @@
+// sceneFrame.h - class for per-frame work of scene done through render backend: culling, uploads, constants and draws
+#pragma once
+
+#include <directxmath.h>
+#include <cstdint>
+#include <vector>
+#include "cubeInstances.h"
+#include "defines.h"
+#include "frustum.h"
+#include "lightSpheres.h"
+#include "renderQueue.h"
+#include "skySphere.h"
+#include "transparentList.h"
+
+using namespace DirectX;
+
+// Threads in group of culling compute shader and limit of groups along one dimension of dispatch
+#define CULL_GROUP_SIZE 64
+#define CULL_MAX_GROUPS 65535
+
+// Knows scene only by backend ids, so whole frame runs without graphics API against recording backend
+class SceneFrame {
+public:
+    struct WorldMatrixBuffer {
+        XMMATRIX mWorldMatrix;
+        XMFLOAT4 color;
+    };
+
+    struct SceneConstantBuffer {
+        XMMATRIX mViewProjectionMatrix;
+        XMFLOAT4 planes[6];
+    };
+
+    struct CullParams {
+        XMINT4 numShapes; // x - objects count, y - threads count in dispatch row
+    };
+
+    struct LightConstantBuffer {
+        XMFLOAT4 cameraPos;
+        XMINT4 lightCount;
+        XMFLOAT4 lightPos[MAX_LIGHT];
+        XMFLOAT4 lightColor[MAX_LIGHT];
+        XMFLOAT4 ambientColor;
+    };
+
+    // Layout of indexed instanced indirect draw arguments, instance count is written by culling compute shader
+    struct IndirectArgs {
+        uint32_t indexCountPerInstance;
+        uint32_t instanceCount;
+        uint32_t startIndexLocation;
+        int32_t baseVertexLocation;
+        uint32_t startInstanceLocation;
+    };
+
+    // Render backend ids of scene, buffers are created with given capacities and grown by Frame
+    struct Ids {
+        int cubesPipeline = 0;
+        int cubesMaterial = 0;      // instances are read through visible list uploaded from CPU
+        int cubesGpuMaterial = 0;   // instances are read through visible list written by culling compute shader
+        int transPipeline = 0;
+        int transMaterial = 0;
+        int geomBuffer = 0;
+        int cullBoxesBuffer = 0;
+        int visibleBuffer = 0;
+        int visibleGpuBuffer = 0;
+        int transGeomBuffer = 0;
+        int indirectArgsBuffer = 0;
+        int indirectArgsSrcBuffer = 0;
+        int cullCompute = 0;
+        int firstQuery = -1;        // MAX_QUERY queries wrapped around GPU culled draws, -1 for none
+        int cullParams = 0;
+        int sceneConstants = 0;
+        int lightConstants = 0;
+        int instanceCapacity = 0;
+        int transparentCapacity = 0;
+    };
+
+    struct Settings {
+        // flag to render light spheres
+        bool isSpheresOn = true;
+        // flag to use normal maps on cubes
+        bool useNormalMap = true;
+        // flag to show normals
+        bool showNormals = false;
+        // flag to turn culling
+        bool isCullingOn = true;
+        // flag to turn gpu culling
+        bool computeCull = true;
+        // flag to cull on cpu through bounding volume hierarchy
+        bool useBVH = false;
+    };
+
+    // Function to set scene parts and ids of their backend resources
+    void Init(CubeInstances* cubes, LightSpheres* lights, SkySphere* sky, const Ids& ids);
+    // Release function
+    void Release();
+
+    // Function to add transparent quad with given center and color, returns its id
+    int AddTransparentQuad(const XMFLOAT3& position, const XMFLOAT4& color);
+
+    // Function to update and cull cubes, then send buffer uploads, constants and culling dispatch of frame to backend.
+    // Returns false if buffers can't be grown or constants can't be allocated, then frame must not be drawn
+    bool Frame(RenderBackend* backend, XMMATRIX viewMatrix, XMMATRIX projectionMatrix, XMFLOAT3 cameraPos, float time);
+    // Function to add draws of frame to render queue and sort it
+    void Render(RenderQueue* queue);
+
+    Settings& GetSettings() { return m_settings; };
+    bool IsGpuCulling() const { return m_settings.isCullingOn && m_settings.computeCull; };
+    int GetTransparentCount() const { return (int)m_transparentObjects.size(); };
+    // Count of draws wrapped in queries, query of draw n is firstQuery + n % MAX_QUERY
+    unsigned int GetQueriesIssued() const { return m_queriesIssued; };
+
+private:
+    // Function to grow buffers which don't fit objects, returns false if backend can't resize them
+    bool GrowBuffers(RenderBackend* backend);
+    // Function to upload changed cubes, sorted transparent objects and visible list
+    void UploadBuffers(RenderBackend* backend, XMMATRIX viewMatrix);
+    // Function to write scene and light constants
+    bool WriteConstants(RenderBackend* backend, XMMATRIX viewMatrix, XMMATRIX projectionMatrix, XMFLOAT3 cameraPos, uint32_t groupsX);
+
+    CubeInstances* m_pCubeInstances = nullptr;
+    LightSpheres* m_pLights = nullptr;
+    SkySphere* m_pSky = nullptr;
+    Ids m_ids;
+    Settings m_settings;
+
+    Frustum m_frustum;
+    TransparentList m_transparentList;
+    // Transparent objects in add order and sorted back to front for upload
+    std::vector<WorldMatrixBuffer> m_transparentObjects;
+    std::vector<WorldMatrixBuffer> m_transparentSorted;
+
+    // Count of identity indices at start of visible buffer, they stay valid while culling is off
+    int m_identityCount = 0;
+    std::vector<uint32_t> m_identityIndices;
+    unsigned int m_queriesIssued = 0;
+};
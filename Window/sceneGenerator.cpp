@@ -0,0 +1,251 @@
+#include "sceneGenerator.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define SCENE_GENERATOR_SSE
+#endif
+
+namespace {
+    const uint32_t PhiloxM0 = 0xD2511F53;
+    const uint32_t PhiloxM1 = 0xCD9E8D57;
+    const uint32_t PhiloxW0 = 0x9E3779B9;
+    const uint32_t PhiloxW1 = 0xBB67AE85;
+    const int PhiloxRounds = 10;
+
+    // City layout: floors in tower and lots in block between streets
+    const int CityFloors = 8;
+    const int CityBlockLots = 3;
+}
+
+// Function to get 4 random words for counter
+void Philox::Generate(const uint32_t counter[4], const uint32_t key[2], uint32_t result[4]) {
+    uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+    uint32_t k0 = key[0], k1 = key[1];
+
+    for (int i = 0; i < PhiloxRounds; i++) {
+        uint64_t p0 = (uint64_t)PhiloxM0 * c0;
+        uint64_t p1 = (uint64_t)PhiloxM1 * c2;
+        uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+        uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+        c1 = (uint32_t)p1;
+        c3 = (uint32_t)p0;
+        c0 = n0;
+        c2 = n2;
+        k0 += PhiloxW0;
+        k1 += PhiloxW1;
+    }
+
+    result[0] = c0;
+    result[1] = c1;
+    result[2] = c2;
+    result[3] = c3;
+}
+
+#ifdef SCENE_GENERATOR_SSE
+namespace {
+    // Function to multiply 4 words by constant, giving high and low words of 64 bit products
+    inline void MulHiLo(__m128i a, __m128i m, __m128i& hi, __m128i& lo) {
+        __m128i even = _mm_mul_epu32(a, m);
+        __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), m);
+        even = _mm_shuffle_epi32(even, _MM_SHUFFLE(3, 1, 2, 0));
+        odd = _mm_shuffle_epi32(odd, _MM_SHUFFLE(3, 1, 2, 0));
+        lo = _mm_unpacklo_epi32(even, odd);
+        hi = _mm_unpackhi_epi32(even, odd);
+    };
+}
+#endif
+
+// Function to get 4 random words for counters {first + i, block, stream, 0}, i = 0..3; result[j][i] is word j of counter i
+void Philox::Generate4(uint32_t first, uint32_t block, uint32_t stream, const uint32_t key[2], uint32_t result[4][4]) {
+#ifdef SCENE_GENERATOR_SSE
+    // Same rounds as Generate, one counter per lane
+    __m128i c0 = _mm_add_epi32(_mm_set1_epi32((int)first), _mm_set_epi32(3, 2, 1, 0));
+    __m128i c1 = _mm_set1_epi32((int)block);
+    __m128i c2 = _mm_set1_epi32((int)stream);
+    __m128i c3 = _mm_setzero_si128();
+    __m128i m0 = _mm_set1_epi32((int)PhiloxM0);
+    __m128i m1 = _mm_set1_epi32((int)PhiloxM1);
+    uint32_t k0 = key[0], k1 = key[1];
+
+    for (int i = 0; i < PhiloxRounds; i++) {
+        __m128i hi0, lo0, hi1, lo1;
+        MulHiLo(c0, m0, hi0, lo0);
+        MulHiLo(c2, m1, hi1, lo1);
+        c0 = _mm_xor_si128(_mm_xor_si128(hi1, c1), _mm_set1_epi32((int)k0));
+        c2 = _mm_xor_si128(_mm_xor_si128(hi0, c3), _mm_set1_epi32((int)k1));
+        c1 = lo1;
+        c3 = lo0;
+        k0 += PhiloxW0;
+        k1 += PhiloxW1;
+    }
+
+    _mm_storeu_si128((__m128i*)result[0], c0);
+    _mm_storeu_si128((__m128i*)result[1], c1);
+    _mm_storeu_si128((__m128i*)result[2], c2);
+    _mm_storeu_si128((__m128i*)result[3], c3);
+#else
+    for (uint32_t i = 0; i < 4; i++) {
+        uint32_t counter[4] = { first + i, block, stream, 0 };
+        uint32_t words[4];
+        Generate(counter, key, words);
+        for (int j = 0; j < 4; j++) {
+            result[j][i] = words[j];
+        }
+    }
+#endif
+}
+
+// Function to set generation parameters, bulk generation is split across job system if it is given
+void SceneGenerator::Init(const SceneDesc& desc, JobSystem* jobSystem) {
+    m_desc = desc;
+    m_pJobSystem = jobSystem;
+    m_key[0] = (uint32_t)desc.seed;
+    m_key[1] = (uint32_t)(desc.seed >> 32);
+
+    m_clusterCenters.clear();
+    for (int i = 0; i < desc.clustersCount; i++) {
+        uint32_t counter[4] = { (uint32_t)i, 0, STREAM_CLUSTERS, 0 };
+        uint32_t random[4];
+        Philox::Generate(counter, m_key, random);
+        m_clusterCenters.push_back(XMFLOAT3(
+            (Philox::ToFloat(random[0]) * 2.0f - 1.0f) * desc.extent,
+            (Philox::ToFloat(random[1]) * 2.0f - 1.0f) * desc.extent,
+            (Philox::ToFloat(random[2]) * 2.0f - 1.0f) * desc.extent));
+    }
+
+    // Smallest cube of grid cells fitting all cubes
+    m_gridSide = 1;
+    while ((int64_t)m_gridSide * m_gridSide * m_gridSide < desc.cubesCount) {
+        m_gridSide++;
+    }
+}
+
+// Function to release resources
+void SceneGenerator::Release() {
+    m_clusterCenters.clear();
+    m_pJobSystem = nullptr;
+}
+
+// Function to generate cube with index
+CubeInstances::CubeModel SceneGenerator::GenerateCube(int index) const {
+    uint32_t random[8];
+    for (uint32_t block = 0; block < 2; block++) {
+        uint32_t counter[4] = { (uint32_t)index, block, STREAM_CUBES, 0 };
+        Philox::Generate(counter, m_key, random + block * 4);
+    }
+    return MakeCube(index, random);
+}
+
+// Function to generate cubes [first, first + count) into component streams
+void SceneGenerator::GenerateCubes(int first, int count, CubeStreams& cubes) const {
+    cubes.Resize(count);
+
+    JobSystem::RangeFunc generate = [this, first, &cubes](int rangeFirst, int rangeLast) {
+        int i = rangeFirst;
+        // Four cubes per generator call
+        for (; i + 4 <= rangeLast; i += 4) {
+            uint32_t random[2][4][4];
+            Philox::Generate4((uint32_t)(first + i), 0, STREAM_CUBES, m_key, random[0]);
+            Philox::Generate4((uint32_t)(first + i), 1, STREAM_CUBES, m_key, random[1]);
+            for (int j = 0; j < 4; j++) {
+                uint32_t cubeRandom[8] = {
+                    random[0][0][j], random[0][1][j], random[0][2][j], random[0][3][j],
+                    random[1][0][j], random[1][1][j], random[1][2][j], random[1][3][j]
+                };
+                StoreCube(MakeCube(first + i + j, cubeRandom), cubes, i + j);
+            }
+        }
+        for (; i < rangeLast; i++) {
+            StoreCube(GenerateCube(first + i), cubes, i);
+        }
+    };
+
+    if (m_pJobSystem != nullptr) {
+        m_pJobSystem->ParallelFor(0, count, GenerateGrain, generate);
+    }
+    else {
+        generate(0, count);
+    }
+}
+
+// Function to generate desc.lightsCount lights, but no more than MAX_LIGHT
+void SceneGenerator::GenerateLights(std::vector<std::pair<XMFLOAT3, XMFLOAT3>>& lights) const {
+    int count = (std::min)((std::max)(m_desc.lightsCount, 0), MAX_LIGHT);
+    lights.clear();
+    for (int i = 0; i < count; i++) {
+        uint32_t counter[4] = { (uint32_t)i, 0, STREAM_LIGHTS, 0 };
+        uint32_t random[4];
+        Philox::Generate(counter, m_key, random);
+        uint32_t color = random[3];
+        lights.push_back(std::pair<XMFLOAT3, XMFLOAT3>(
+            XMFLOAT3(
+                (Philox::ToFloat(random[0]) * 2.0f - 1.0f) * m_desc.extent,
+                (Philox::ToFloat(random[1]) * 2.0f - 1.0f) * m_desc.extent,
+                (Philox::ToFloat(random[2]) * 2.0f - 1.0f) * m_desc.extent),
+            XMFLOAT3(1.0f, (color & 0xFF) / 255.0f, ((color >> 8) & 0xFF) / 255.0f)));
+    }
+}
+
+// Function to make cube from its index and 8 random words
+CubeInstances::CubeModel SceneGenerator::MakeCube(int index, const uint32_t random[8]) const {
+    XMFLOAT3 pos;
+    float extent = m_desc.extent;
+
+    switch (m_desc.distribution) {
+    case DISTRIBUTION_CLUSTERED: {
+        const XMFLOAT3& center = m_clusterCenters.empty() ? XMFLOAT3(0.0f, 0.0f, 0.0f) : m_clusterCenters[random[3] % m_clusterCenters.size()];
+        // Sum of two uniforms from word halves gives bell-like (triangular) offset in [-clusterSize, clusterSize)
+        float offset[3];
+        for (int i = 0; i < 3; i++) {
+            offset[i] = (((random[i] & 0xFFFF) + (random[i] >> 16)) / 65536.0f - 1.0f) * m_desc.clusterSize;
+        }
+        pos = XMFLOAT3(center.x + offset[0], center.y + offset[1], center.z + offset[2]);
+        break;
+    }
+    case DISTRIBUTION_GRID: {
+        float step = 2.0f * extent / m_gridSide;
+        int x = index % m_gridSide;
+        int y = (index / m_gridSide) % m_gridSide;
+        int z = index / (m_gridSide * m_gridSide);
+        pos = XMFLOAT3(-extent + (x + 0.5f) * step, -extent + (y + 0.5f) * step, -extent + (z + 0.5f) * step);
+        break;
+    }
+    case DISTRIBUTION_CITY: {
+        // Towers of CityFloors cubes on square lots, every CityBlockLots lots are followed by street of one lot width
+        int towersCount = (m_desc.cubesCount + CityFloors - 1) / CityFloors;
+        int side = (std::max)((int)std::ceil(std::sqrt((double)towersCount)), 1);
+        int tower = index / CityFloors;
+        int lotX = tower % side;
+        int lotZ = tower / side;
+        float cityHalfSize = 0.5f * (side + (side - 1) / CityBlockLots);
+        pos = XMFLOAT3(
+            lotX + lotX / CityBlockLots - cityHalfSize + 0.5f,
+            -extent + 0.5f + index % CityFloors,
+            lotZ + lotZ / CityBlockLots - cityHalfSize + 0.5f);
+        break;
+    }
+    default:
+        pos = XMFLOAT3(
+            (Philox::ToFloat(random[0]) * 2.0f - 1.0f) * extent,
+            (Philox::ToFloat(random[1]) * 2.0f - 1.0f) * extent,
+            (Philox::ToFloat(random[2]) * 2.0f - 1.0f) * extent);
+        break;
+    }
+
+    CubeInstances::CubeModel cube;
+    float textureIndex = (float)(random[6] % 2);
+    cube.pos = XMFLOAT4(pos.x, pos.y, pos.z, (float)((int)(random[4] % 6) - 3));
+    cube.shineSpeedIdNM = XMFLOAT4(300.0f, (float)(random[5] % 5), textureIndex, textureIndex > 0.0f ? 0.0f : 1.0f);
+    return cube;
+}
+
+// Function to store cube into index of component streams
+void SceneGenerator::StoreCube(const CubeInstances::CubeModel& cube, CubeStreams& cubes, int index) {
+    cubes.posX[index] = cube.pos.x;
+    cubes.posY[index] = cube.pos.y;
+    cubes.posZ[index] = cube.pos.z;
+    cubes.angularSpeed[index] = cube.pos.w * cube.shineSpeedIdNM.y;
+    cubes.materials[index] = cube.shineSpeedIdNM;
+}
@@ -0,0 +1,99 @@
+// sceneGenerator.h - class for reproducible procedural scene generation from seed
+#pragma once
+
+#include <directxmath.h>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "alignedAllocator.h"
+#include "cubeInstances.h"
+#include "jobSystem.h"
+#include "defines.h"
+
+using namespace DirectX;
+
+// Counter-based random generator (Philox4x32-10): output depends only on key and counter,
+// so any element of any stream can be generated independently and in any order
+struct Philox {
+    // Function to get 4 random words for counter
+    static void Generate(const uint32_t counter[4], const uint32_t key[2], uint32_t result[4]);
+    // Function to get 4 random words for counters {first + i, block, stream, 0}, i = 0..3; result[j][i] is word j of counter i
+    static void Generate4(uint32_t first, uint32_t block, uint32_t stream, const uint32_t key[2], uint32_t result[4][4]);
+    // Function to map random word to [0, 1)
+    static float ToFloat(uint32_t value) { return (value >> 8) * (1.0f / 16777216.0f); };
+};
+
+class SceneGenerator {
+public:
+    enum Distribution {
+        DISTRIBUTION_UNIFORM = 0, // uniform in scene volume
+        DISTRIBUTION_CLUSTERED,   // bell-like clusters around random centers
+        DISTRIBUTION_GRID,        // regular 3D grid
+        DISTRIBUTION_CITY,        // towers in rows separated by streets
+        DISTRIBUTION_COUNT
+    };
+
+    // Cubes as component streams of CubeInstances bulk Add
+    struct CubeStreams {
+        AlignedVector<float> posX;
+        AlignedVector<float> posY;
+        AlignedVector<float> posZ;
+        AlignedVector<float> angularSpeed;
+        AlignedVector<XMFLOAT4> materials;
+
+        // Function to change cubes count
+        void Resize(size_t count) {
+            posX.resize(count);
+            posY.resize(count);
+            posZ.resize(count);
+            angularSpeed.resize(count);
+            materials.resize(count);
+        };
+    };
+
+    struct SceneDesc {
+        uint64_t seed = 0;
+        Distribution distribution = DISTRIBUTION_UNIFORM;
+        int cubesCount = START_CUBE;
+        int lightsCount = MAX_LIGHT;
+        float extent = 5.0f;     // half size of scene volume
+        int clustersCount = 16;
+        float clusterSize = 1.0f; // cluster radius
+    };
+
+    // Function to set generation parameters, bulk generation is split across job system if it is given
+    void Init(const SceneDesc& desc, JobSystem* jobSystem = nullptr);
+    // Function to release resources
+    void Release();
+
+    // Function to generate cube with index
+    CubeInstances::CubeModel GenerateCube(int index) const;
+    // Function to generate cubes [first, first + count) into component streams
+    void GenerateCubes(int first, int count, CubeStreams& cubes) const;
+    // Function to generate desc.lightsCount lights, but no more than MAX_LIGHT
+    void GenerateLights(std::vector<std::pair<XMFLOAT3, XMFLOAT3>>& lights) const;
+
+    const SceneDesc& GetDesc() const { return m_desc; };
+
+private:
+    // Random streams
+    enum Stream {
+        STREAM_CUBES = 0,
+        STREAM_LIGHTS,
+        STREAM_CLUSTERS
+    };
+
+    // Cubes count generated by one job
+    static const int GenerateGrain = 8192;
+
+    // Function to make cube from its index and 8 random words
+    CubeInstances::CubeModel MakeCube(int index, const uint32_t random[8]) const;
+    // Function to store cube into index of component streams
+    static void StoreCube(const CubeInstances::CubeModel& cube, CubeStreams& cubes, int index);
+
+    SceneDesc m_desc;
+    uint32_t m_key[2] = { 0, 0 };
+    std::vector<XMFLOAT3> m_clusterCenters;
+    int m_gridSide = 1;
+    JobSystem* m_pJobSystem = nullptr;
+};
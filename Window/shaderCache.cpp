@@ -0,0 +1,283 @@
+#include "shaderCache.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include "hash.h"
+
+// Function to map cache file and read its index, missing or broken file gives empty cache
+bool ShaderCache::Open(const char* path) {
+    Release();
+    m_path = path;
+
+    if (!m_file.Open(path)) {
+        return false;
+    }
+
+    if (!ReadIndex()) {
+        // File is rewritten from scratch on save
+        m_entries.clear();
+        m_file.Release();
+        m_isDirty = true;
+        return false;
+    }
+    return true;
+}
+
+// Function to parse index of mapped file
+bool ShaderCache::ReadIndex() {
+    const unsigned char* data = m_file.GetData();
+    size_t size = m_file.GetSize();
+    if (size < sizeof(Header)) {
+        return false;
+    }
+
+    Header header;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != SHADER_CACHE_MAGIC || header.version != SHADER_CACHE_VERSION || header.headerSize != sizeof(Header) ||
+        header.fileSize != size) {
+        return false;
+    }
+
+    size_t offset = sizeof(Header);
+    for (uint32_t i = 0; i < header.entriesCount; i++) {
+        EntryHeader entryHeader;
+        if (size - offset < sizeof(EntryHeader)) {
+            return false;
+        }
+        memcpy(&entryHeader, data + offset, sizeof(entryHeader));
+        offset += sizeof(EntryHeader);
+        if (entryHeader.blobOffset > size || entryHeader.blobSize > size - entryHeader.blobOffset) {
+            return false;
+        }
+
+        Entry entry;
+        entry.key = entryHeader.key;
+        entry.pBlob = data + entryHeader.blobOffset;
+        entry.blobSize = entryHeader.blobSize;
+        for (uint32_t j = 0; j < entryHeader.dependenciesCount; j++) {
+            DependencyHeader dependencyHeader;
+            if (size - offset < sizeof(DependencyHeader)) {
+                return false;
+            }
+            memcpy(&dependencyHeader, data + offset, sizeof(dependencyHeader));
+            offset += sizeof(DependencyHeader);
+            if (dependencyHeader.pathLength > size - offset) {
+                return false;
+            }
+
+            Dependency dependency;
+            dependency.path.assign(reinterpret_cast<const char*>(data + offset), dependencyHeader.pathLength);
+            dependency.hash = dependencyHeader.hash;
+            entry.dependencies.push_back(dependency);
+            offset += dependencyHeader.pathLength;
+        }
+
+        if (GetKey(entryHeader.requestHash, entry.dependencies) != entry.key) {
+            return false;
+        }
+        m_entries[entryHeader.requestHash] = std::move(entry);
+    }
+
+    return true;
+}
+
+// Function to write cache file if entries were added, cache stays usable
+bool ShaderCache::Save() {
+    if (!m_isDirty || m_path.empty()) {
+        return true;
+    }
+
+    // Mapped file is replaced, so blobs of loaded entries are copied out first
+    for (auto& item : m_entries) {
+        Entry& entry = item.second;
+        if (entry.pBlob) {
+            entry.bytecode.assign(entry.pBlob, entry.pBlob + entry.blobSize);
+            entry.pBlob = nullptr;
+        }
+    }
+    m_file.Release();
+
+    Header header;
+    header.magic = SHADER_CACHE_MAGIC;
+    header.version = SHADER_CACHE_VERSION;
+    header.headerSize = sizeof(Header);
+    header.entriesCount = (uint32_t)m_entries.size();
+
+    uint64_t indexSize = sizeof(Header);
+    for (const auto& item : m_entries) {
+        indexSize += sizeof(EntryHeader);
+        for (const Dependency& dependency : item.second.dependencies) {
+            indexSize += sizeof(DependencyHeader) + dependency.path.size();
+        }
+    }
+
+    std::vector<char> index;
+    index.reserve((size_t)indexSize);
+    uint64_t blobOffset = indexSize;
+    for (const auto& item : m_entries) {
+        const Entry& entry = item.second;
+        EntryHeader entryHeader;
+        entryHeader.requestHash = item.first;
+        entryHeader.key = entry.key;
+        entryHeader.blobOffset = blobOffset;
+        entryHeader.blobSize = (uint32_t)entry.bytecode.size();
+        entryHeader.dependenciesCount = (uint32_t)entry.dependencies.size();
+        index.insert(index.end(), reinterpret_cast<const char*>(&entryHeader), reinterpret_cast<const char*>(&entryHeader + 1));
+
+        for (const Dependency& dependency : entry.dependencies) {
+            DependencyHeader dependencyHeader;
+            dependencyHeader.hash = dependency.hash;
+            dependencyHeader.pathLength = (uint32_t)dependency.path.size();
+            dependencyHeader.reserved = 0;
+            index.insert(index.end(), reinterpret_cast<const char*>(&dependencyHeader), reinterpret_cast<const char*>(&dependencyHeader + 1));
+            index.insert(index.end(), dependency.path.begin(), dependency.path.end());
+        }
+        blobOffset += entry.bytecode.size();
+    }
+    header.fileSize = blobOffset;
+
+    std::ofstream file(m_path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(index.data(), (std::streamsize)index.size());
+    for (const auto& item : m_entries) {
+        const std::vector<uint8_t>& bytecode = item.second.bytecode;
+        file.write(reinterpret_cast<const char*>(bytecode.data()), (std::streamsize)bytecode.size());
+    }
+
+    file.close();
+    if (file.fail()) {
+        return false;
+    }
+    m_isDirty = false;
+    return true;
+}
+
+// Function to unmap file and forget entries
+void ShaderCache::Release() {
+    m_entries.clear();
+    m_file.Release();
+    m_path.clear();
+    m_isDirty = false;
+    m_stats = Stats();
+}
+
+// Function to get bytecode of request, compiles it if source or any of its includes changed since it was cached.
+// Can be called from several threads, compilation runs outside of lock
+bool ShaderCache::Get(const Request& request, Compiler& compiler, std::vector<uint8_t>& bytecode) {
+    uint64_t requestHash = HashRequest(request);
+
+    // Entry is copied, so sources are hashed without holding lock
+    Entry cached;
+    bool isCached = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(requestHash);
+        if (it != m_entries.end()) {
+            cached.dependencies = it->second.dependencies;
+            if (it->second.pBlob) {
+                cached.bytecode.assign(it->second.pBlob, it->second.pBlob + it->second.blobSize);
+            }
+            else {
+                cached.bytecode = it->second.bytecode;
+            }
+            isCached = true;
+        }
+    }
+
+    if (isCached && IsValid(cached)) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.hits++;
+        bytecode.swap(cached.bytecode);
+        return true;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.misses++;
+        if (isCached) {
+            m_stats.invalidated++;
+        }
+    }
+
+    std::vector<std::string> includes;
+    bytecode.clear();
+    if (!compiler.Compile(request, bytecode, includes)) {
+        return false;
+    }
+
+    // Source comes first, includes once each in order they were opened
+    Entry entry;
+    includes.insert(includes.begin(), request.path);
+    for (const std::string& path : includes) {
+        auto isSame = [&path](const Dependency& dependency) { return dependency.path == path; };
+        if (std::find_if(entry.dependencies.begin(), entry.dependencies.end(), isSame) != entry.dependencies.end())
+            continue;
+
+        Dependency dependency;
+        dependency.path = path;
+        if (!HashFile(path, dependency.hash)) {
+            // Bytecode is still valid for this run, it is only not cached
+            return true;
+        }
+        entry.dependencies.push_back(dependency);
+    }
+    entry.key = GetKey(requestHash, entry.dependencies);
+    entry.bytecode = bytecode;
+    entry.blobSize = bytecode.size();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries[requestHash] = std::move(entry);
+    m_isDirty = true;
+    return true;
+}
+
+// Function to check that all dependencies have same contents as when entry was compiled
+bool ShaderCache::IsValid(const Entry& entry) const {
+    for (const Dependency& dependency : entry.dependencies) {
+        uint64_t hash = 0;
+        if (!HashFile(dependency.path, hash) || hash != dependency.hash) {
+            return false;
+        }
+    }
+    return !entry.dependencies.empty();
+}
+
+// Function to hash request without sources
+uint64_t ShaderCache::HashRequest(const Request& request) {
+    // Strings are hashed with terminating zero so that neighbouring strings can't be merged
+    uint64_t hash = HashBytes(request.path.c_str(), request.path.size() + 1);
+    for (const Define& define : request.defines) {
+        hash = HashBytes(define.name.c_str(), define.name.size() + 1, hash);
+        hash = HashBytes(define.value.c_str(), define.value.size() + 1, hash);
+    }
+    hash = HashBytes(request.entryPoint.c_str(), request.entryPoint.size() + 1, hash);
+    hash = HashBytes(request.profile.c_str(), request.profile.size() + 1, hash);
+    return HashBytes(&request.flags, sizeof(request.flags), hash);
+}
+
+// Function to hash file contents, returns false if file can't be read
+bool ShaderCache::HashFile(const std::string& path, uint64_t& hash) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    std::vector<char> contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    hash = HashBytes(contents.data(), contents.size());
+    return !file.bad();
+}
+
+// Key of entry is hash of request and contents of all its dependencies
+uint64_t ShaderCache::GetKey(uint64_t requestHash, const std::vector<Dependency>& dependencies) {
+    uint64_t key = HashBytes(&requestHash, sizeof(requestHash));
+    for (const Dependency& dependency : dependencies) {
+        key = HashBytes(dependency.path.c_str(), dependency.path.size() + 1, key);
+        key = HashBytes(&dependency.hash, sizeof(dependency.hash), key);
+    }
+    return key;
+}
@@ -0,0 +1,119 @@
+// shaderCache.h - class for keeping compiled shader bytecode between launches
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "mappedFile.h"
+
+#define SHADER_CACHE_MAGIC 0x43485344 // "DSHC"
+#define SHADER_CACHE_VERSION 1
+
+// File layout (little-endian): Header, then entries of Entry header followed by its dependencies
+// (Dependency header and path chars), then bytecode blobs at offsets from file start.
+// Only index is parsed when file is opened, blobs stay in mapped file until requested
+class ShaderCache {
+public:
+    struct Define {
+        std::string name;
+        std::string value;
+    };
+
+    // Everything which changes bytecode except sources, those are hashed separately
+    struct Request {
+        std::string path;
+        std::vector<Define> defines;
+        std::string entryPoint;
+        std::string profile;
+        uint32_t flags = 0;
+    };
+
+    // Compiles shader file and reports all files it included
+    class Compiler {
+    public:
+        virtual ~Compiler() = default;
+        virtual bool Compile(const Request& request, std::vector<uint8_t>& bytecode, std::vector<std::string>& includes) = 0;
+    };
+
+    struct Stats {
+        int hits = 0;
+        int misses = 0;         // requests compiled, including invalidated ones
+        int invalidated = 0;    // requests with cached bytecode of changed sources
+    };
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t headerSize;
+        uint32_t entriesCount;
+        uint64_t fileSize;
+    };
+
+    struct EntryHeader {
+        uint64_t requestHash;
+        uint64_t key;
+        uint64_t blobOffset;
+        uint32_t blobSize;
+        uint32_t dependenciesCount;
+    };
+
+    struct DependencyHeader {
+        uint64_t hash;
+        uint32_t pathLength;
+        uint32_t reserved;
+    };
+
+    // Function to map cache file and read its index, missing or broken file gives empty cache
+    bool Open(const char* path);
+    // Function to write cache file if entries were added, cache stays usable
+    bool Save();
+    // Function to unmap file and forget entries
+    void Release();
+
+    // Function to get bytecode of request, compiles it if source or any of its includes changed since it was cached.
+    // Can be called from several threads, compilation runs outside of lock
+    bool Get(const Request& request, Compiler& compiler, std::vector<uint8_t>& bytecode);
+
+    // Function to hash request without sources
+    static uint64_t HashRequest(const Request& request);
+    // Function to hash file contents, returns false if file can't be read
+    static bool HashFile(const std::string& path, uint64_t& hash);
+
+    int GetSize() const { return (int)m_entries.size(); };
+    Stats GetStats() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    };
+
+private:
+    struct Dependency {
+        std::string path;
+        uint64_t hash;
+    };
+
+    struct Entry {
+        uint64_t key = 0;
+        std::vector<Dependency> dependencies;
+        // Blob in mapped file, or own bytecode of entries compiled since opening
+        const uint8_t* pBlob = nullptr;
+        size_t blobSize = 0;
+        std::vector<uint8_t> bytecode;
+    };
+
+    // Function to parse index of mapped file
+    bool ReadIndex();
+    // Function to check that all dependencies have same contents as when entry was compiled
+    bool IsValid(const Entry& entry) const;
+    // Key of entry is hash of request and contents of all its dependencies
+    static uint64_t GetKey(uint64_t requestHash, const std::vector<Dependency>& dependencies);
+
+    // Guards entries and stats while requests are served in parallel
+    mutable std::mutex m_mutex;
+    std::string m_path;
+    MappedFile m_file;
+    std::unordered_map<uint64_t, Entry> m_entries;
+    bool m_isDirty = false;
+    Stats m_stats;
+};
@@ -0,0 +1,72 @@
+#include "shaderCompiler.h"
+#include <cstring>
+#include "D3DInclude.h"
+#include "utility.h"
+
+// Function to open cache file, missing cache is created on save
+HRESULT ShaderCompiler::Init(const char* cachePath) {
+    m_cache.Open(cachePath);
+    return S_OK;
+}
+
+// Function to save cache and close it
+void ShaderCompiler::Release() {
+    m_cache.Save();
+    m_cache.Release();
+}
+
+// Function to compile shader as D3DCompileFromFile does, bytecode is taken from cache while sources and includes don't change
+HRESULT ShaderCompiler::CompileFromFile(const char* path, const D3D_SHADER_MACRO* defines, const char* entryPoint, const char* profile, UINT flags, ID3DBlob** code) {
+    ShaderCache::Request request;
+    request.path = path;
+    for (const D3D_SHADER_MACRO* define = defines; define && define->Name; define++) {
+        request.defines.push_back({ define->Name, define->Definition ? define->Definition : "" });
+    }
+    request.entryPoint = entryPoint;
+    request.profile = profile;
+    request.flags = flags;
+
+    std::vector<uint8_t> bytecode;
+    if (!m_cache.Get(request, *this, bytecode)) {
+        return E_FAIL;
+    }
+
+    HRESULT hr = D3DCreateBlob(bytecode.size(), code);
+    if (SUCCEEDED(hr)) {
+        memcpy((*code)->GetBufferPointer(), bytecode.data(), bytecode.size());
+    }
+    return hr;
+}
+
+// Function to add worker task compiling shader into code, defines and code must live until graph is run
+int ShaderCompiler::AddCompileTask(TaskGraph& graph, const char* path, const D3D_SHADER_MACRO* defines, const char* entryPoint, const char* profile, UINT flags, ID3DBlob** code) {
+    std::string name = std::string(path) + " " + profile;
+    return graph.AddTask(name, [=]() { return SUCCEEDED(CompileFromFile(path, defines, entryPoint, profile, flags, code)); });
+}
+
+// Function to compile shader with D3DCompileFromFile, includes are opened relative to working directory
+bool ShaderCompiler::Compile(const ShaderCache::Request& request, std::vector<uint8_t>& bytecode, std::vector<std::string>& includes) {
+    std::vector<D3D_SHADER_MACRO> defines;
+    for (const ShaderCache::Define& define : request.defines) {
+        defines.push_back({ define.name.c_str(), define.value.c_str() });
+    }
+    defines.push_back({ NULL, NULL });
+
+    std::wstring path(request.path.begin(), request.path.end());
+    D3DInclude includeObj;
+    ID3DBlob* code = nullptr;
+    ID3DBlob* errors = nullptr;
+    HRESULT hr = D3DCompileFromFile(path.c_str(), defines.data(), &includeObj, request.entryPoint.c_str(), request.profile.c_str(), request.flags, 0, &code, &errors);
+    if (errors) {
+        OutputDebugStringA(static_cast<const char*>(errors->GetBufferPointer()));
+    }
+    if (SUCCEEDED(hr)) {
+        const uint8_t* data = static_cast<const uint8_t*>(code->GetBufferPointer());
+        bytecode.assign(data, data + code->GetBufferSize());
+        includes = includeObj.GetIncludes();
+    }
+
+    SAFE_RELEASE(code);
+    SAFE_RELEASE(errors);
+    return SUCCEEDED(hr);
+}
@@ -0,0 +1,32 @@
+// shaderCompiler.h - class for compiling shaders through persistent bytecode cache
+#pragma once
+
+#include <d3dcompiler.h>
+#include <d3d11.h>
+#include "shaderCache.h"
+#include "taskGraph.h"
+
+class ShaderCompiler : public ShaderCache::Compiler {
+public:
+    // Function to open cache file, missing cache is created on save
+    HRESULT Init(const char* cachePath);
+    // Function to write bytecode compiled since last save to cache file
+    void Save() { m_cache.Save(); };
+    // Function to save cache and close it
+    void Release();
+
+    // Function to compile shader as D3DCompileFromFile does, bytecode is taken from cache while sources and includes don't change.
+    // Can be called from several threads
+    HRESULT CompileFromFile(const char* path, const D3D_SHADER_MACRO* defines, const char* entryPoint, const char* profile, UINT flags, ID3DBlob** code);
+
+    // Function to add worker task compiling shader into code, defines and code must live until graph is run
+    int AddCompileTask(TaskGraph& graph, const char* path, const D3D_SHADER_MACRO* defines, const char* entryPoint, const char* profile, UINT flags, ID3DBlob** code);
+
+    // Function to compile shader with D3DCompileFromFile, includes are opened relative to working directory
+    bool Compile(const ShaderCache::Request& request, std::vector<uint8_t>& bytecode, std::vector<std::string>& includes) override;
+
+    ShaderCache::Stats GetStats() const { return m_cache.GetStats(); };
+
+private:
+    ShaderCache m_cache;
+};
@@ -0,0 +1,30 @@
+#include "skySphere.h"
+
+// Function to write sky constants of this frame through backend
+bool SkySphere::Frame(RenderBackend* backend, XMMATRIX viewMatrix, XMMATRIX projectionMatrix, XMFLOAT3 cameraPos) {
+    WorldMatrixBuffer* worldMatrixBuffer = static_cast<WorldMatrixBuffer*>(backend->AllocateConstants(m_ids.worldConstants, sizeof(WorldMatrixBuffer)));
+    SceneMatrixBuffer* sceneBuffer = static_cast<SceneMatrixBuffer*>(backend->AllocateConstants(m_ids.sceneConstants, sizeof(SceneMatrixBuffer)));
+    if (!worldMatrixBuffer || !sceneBuffer) {
+        return false;
+    }
+
+    // Update world matrix
+    worldMatrixBuffer->mWorldMatrix = XMMatrixIdentity();
+    worldMatrixBuffer->size = XMFLOAT4(m_radius, 0.0f, 0.0f, 0.0f);
+
+    // Update Scene matrix
+    sceneBuffer->mViewProjectionMatrix = XMMatrixMultiply(viewMatrix, projectionMatrix);
+    sceneBuffer->cameraPos = XMFLOAT4(cameraPos.x , cameraPos.y, cameraPos.z ,1.0f);
+
+    return true;
+}
+
+// Function to add sky sphere draw to render queue
+void SkySphere::Render(RenderQueue* queue) {
+    DrawPacket packet;
+    packet.key = RenderQueue::MakeKey(RenderQueue::PASS_SKY, false, m_ids.pipeline, m_ids.material, 0.0f);
+    packet.pipeline = m_ids.pipeline;
+    packet.material = m_ids.material;
+    packet.indexCount = m_ids.indexCount;
+    queue->Push(packet);
+}
@@ -0,0 +1,39 @@
+// skySphere.h - class for sky sphere around camera drawn by render queue
+#pragma once
+
+#include <directxmath.h>
+#include "renderQueue.h"
+
+using namespace DirectX;
+
+class SkySphere {
+public:
+    struct WorldMatrixBuffer {
+        XMMATRIX mWorldMatrix;
+        XMFLOAT4 size;
+    };
+    struct SceneMatrixBuffer {
+        XMMATRIX mViewProjectionMatrix;
+        XMFLOAT4 cameraPos;
+    };
+
+    // Render backend ids of sky draw
+    struct Ids {
+        int pipeline = 0;
+        int material = 0;
+        int worldConstants = 0;
+        int sceneConstants = 0;
+        int indexCount = 0;
+    };
+
+    // Function to set ids sky is drawn with
+    void SetIds(const Ids& ids) { m_ids = ids; };
+    // Function to write sky constants of this frame through backend
+    bool Frame(RenderBackend* backend, XMMATRIX viewMatrix, XMMATRIX projectionMatrix, XMFLOAT3 cameraPos);
+    // Function to add sky sphere draw to render queue
+    void Render(RenderQueue* queue);
+
+protected:
+    Ids m_ids;
+    float m_radius = 1.0f;
+};
@@ -0,0 +1,351 @@
+// stateCache.h - class for filtering redundant state binds of device context
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+// Context is ID3D11DeviceContext or any class with same binding functions, objects are compared only by address
+// so arguments may be any pointers, including nullptr
+template <class Context>
+class StateCache {
+public:
+    // Slot counts of D3D11 pipeline stages
+    static const unsigned MaxVertexBuffers = 32;
+    static const unsigned MaxConstantBuffers = 14;
+    static const unsigned MaxResources = 128;
+    static const unsigned MaxSamplers = 16;
+
+    struct Stats {
+        int issued = 0;     // calls passed to context
+        int elided = 0;     // calls dropped because nothing would change
+    };
+
+    // Function to set wrapped context, cache starts with unknown state
+    void Init(Context* context) {
+        m_pContext = context;
+        Invalidate();
+        ResetStats();
+    };
+    // Function to forget shadow state, needed after context was used directly
+    void Invalidate() {
+        m_inputLayout = Unknown();
+        m_topology = -1;
+        m_vertexShader = Unknown();
+        m_pixelShader = Unknown();
+        m_rasterizerState = Unknown();
+        m_blendState = Unknown();
+        m_depthState = Unknown();
+        m_indexBuffer = Unknown();
+        for (unsigned i = 0; i < MaxVertexBuffers; i++) {
+            m_vertexBuffers[i] = Unknown();
+        }
+        for (unsigned i = 0; i < MaxConstantBuffers; i++) {
+            m_vsConstantBuffers[i] = m_psConstantBuffers[i] = Unknown();
+        }
+        for (unsigned i = 0; i < MaxResources; i++) {
+            m_vsResources[i] = m_psResources[i] = Unknown();
+        }
+        for (unsigned i = 0; i < MaxSamplers; i++) {
+            m_psSamplers[i] = Unknown();
+        }
+    };
+    void ResetStats() { m_stats = Stats(); };
+
+    Context* GetContext() const { return m_pContext; };
+    const Stats& GetStats() const { return m_stats; };
+
+    template <class InputLayout>
+    void IASetInputLayout(InputLayout inputLayout) {
+        if (Update(m_inputLayout, inputLayout)) {
+            m_pContext->IASetInputLayout(inputLayout);
+        }
+    };
+
+    template <class Topology>
+    void IASetPrimitiveTopology(Topology topology) {
+        if (Update(m_topology, (int)topology)) {
+            m_pContext->IASetPrimitiveTopology(topology);
+        }
+    };
+
+    template <class Buffer>
+    void IASetVertexBuffers(unsigned startSlot, unsigned count, Buffer* const* buffers, const unsigned* strides, const unsigned* offsets) {
+        if (startSlot + count > MaxVertexBuffers) {
+            // Out of tracked range, pass call through and forget what it may overwrite
+            for (unsigned slot = startSlot; slot < MaxVertexBuffers; slot++) {
+                m_vertexBuffers[slot] = Unknown();
+            }
+            Issue();
+            m_pContext->IASetVertexBuffers(startSlot, count, buffers, strides, offsets);
+            return;
+        }
+
+        // Slot changes if any of buffer, stride or offset differs
+        unsigned first = count;
+        unsigned last = 0;
+        for (unsigned i = 0; i < count; i++) {
+            unsigned slot = startSlot + i;
+            if (m_vertexBuffers[slot] != buffers[i] || m_vertexStrides[slot] != strides[i] || m_vertexOffsets[slot] != offsets[i]) {
+                m_vertexBuffers[slot] = buffers[i];
+                m_vertexStrides[slot] = strides[i];
+                m_vertexOffsets[slot] = offsets[i];
+                first = (std::min)(first, i);
+                last = i;
+            }
+        }
+
+        if (first < count) {
+            Issue();
+            m_pContext->IASetVertexBuffers(startSlot + first, last - first + 1, buffers + first, strides + first, offsets + first);
+        }
+        else {
+            m_stats.elided++;
+        }
+    };
+
+    template <class Buffer, class Format>
+    void IASetIndexBuffer(Buffer buffer, Format format, unsigned offset) {
+        if (m_indexBuffer != buffer || m_indexFormat != (int)format || m_indexOffset != offset) {
+            m_indexBuffer = buffer;
+            m_indexFormat = (int)format;
+            m_indexOffset = offset;
+            Issue();
+            m_pContext->IASetIndexBuffer(buffer, format, offset);
+        }
+        else {
+            m_stats.elided++;
+        }
+    };
+
+    // Shaders with class instances are always bound
+    template <class Shader, class ClassInstances>
+    void VSSetShader(Shader shader, ClassInstances classInstances, unsigned count) {
+        if (count > 0 ? Reset(m_vertexShader) : Update(m_vertexShader, shader)) {
+            m_pContext->VSSetShader(shader, classInstances, count);
+        }
+    };
+
+    template <class Shader, class ClassInstances>
+    void PSSetShader(Shader shader, ClassInstances classInstances, unsigned count) {
+        if (count > 0 ? Reset(m_pixelShader) : Update(m_pixelShader, shader)) {
+            m_pContext->PSSetShader(shader, classInstances, count);
+        }
+    };
+
+    template <class State>
+    void RSSetState(State state) {
+        if (Update(m_rasterizerState, state)) {
+            m_pContext->RSSetState(state);
+        }
+    };
+
+    // Null blend factor means {1, 1, 1, 1}, as in D3D11
+    template <class State>
+    void OMSetBlendState(State state, const float blendFactor[4], unsigned sampleMask) {
+        float factor[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        if (blendFactor) {
+            for (int i = 0; i < 4; i++) {
+                factor[i] = blendFactor[i];
+            }
+        }
+
+        bool changed = m_blendState != state || m_sampleMask != sampleMask;
+        for (int i = 0; i < 4; i++) {
+            changed = changed || m_blendFactor[i] != factor[i];
+        }
+
+        if (changed) {
+            m_blendState = state;
+            m_sampleMask = sampleMask;
+            for (int i = 0; i < 4; i++) {
+                m_blendFactor[i] = factor[i];
+            }
+            Issue();
+            m_pContext->OMSetBlendState(state, blendFactor, sampleMask);
+        }
+        else {
+            m_stats.elided++;
+        }
+    };
+
+    template <class State>
+    void OMSetDepthStencilState(State state, unsigned stencilRef) {
+        if (m_depthState != state || m_stencilRef != stencilRef) {
+            m_depthState = state;
+            m_stencilRef = stencilRef;
+            Issue();
+            m_pContext->OMSetDepthStencilState(state, stencilRef);
+        }
+        else {
+            m_stats.elided++;
+        }
+    };
+
+    template <class Buffer>
+    void VSSetConstantBuffers(unsigned startSlot, unsigned count, Buffer* const* buffers) {
+        unsigned first, changed;
+        if (UpdateSlots(m_vsConstantBuffers, MaxConstantBuffers, startSlot, count, buffers, first, changed, m_vsConstantRanges)) {
+            m_pContext->VSSetConstantBuffers(startSlot + first, changed, buffers + first);
+        }
+    };
+
+    template <class Buffer>
+    void PSSetConstantBuffers(unsigned startSlot, unsigned count, Buffer* const* buffers) {
+        unsigned first, changed;
+        if (UpdateSlots(m_psConstantBuffers, MaxConstantBuffers, startSlot, count, buffers, first, changed, m_psConstantRanges)) {
+            m_pContext->PSSetConstantBuffers(startSlot + first, changed, buffers + first);
+        }
+    };
+
+    // D3D11.1 binds of constant buffer ranges, slot changes if buffer or range differs
+    template <class Buffer>
+    void VSSetConstantBuffers1(unsigned startSlot, unsigned count, Buffer* const* buffers, const unsigned* firstConstants, const unsigned* numConstants) {
+        unsigned first, changed;
+        if (UpdateSlots(m_vsConstantBuffers, MaxConstantBuffers, startSlot, count, buffers, first, changed, m_vsConstantRanges, firstConstants, numConstants)) {
+            m_pContext->VSSetConstantBuffers1(startSlot + first, changed, buffers + first, firstConstants + first, numConstants + first);
+        }
+    };
+
+    template <class Buffer>
+    void PSSetConstantBuffers1(unsigned startSlot, unsigned count, Buffer* const* buffers, const unsigned* firstConstants, const unsigned* numConstants) {
+        unsigned first, changed;
+        if (UpdateSlots(m_psConstantBuffers, MaxConstantBuffers, startSlot, count, buffers, first, changed, m_psConstantRanges, firstConstants, numConstants)) {
+            m_pContext->PSSetConstantBuffers1(startSlot + first, changed, buffers + first, firstConstants + first, numConstants + first);
+        }
+    };
+
+    template <class View>
+    void VSSetShaderResources(unsigned startSlot, unsigned count, View* const* views) {
+        unsigned first, changed;
+        if (UpdateSlots(m_vsResources, MaxResources, startSlot, count, views, first, changed)) {
+            m_pContext->VSSetShaderResources(startSlot + first, changed, views + first);
+        }
+    };
+
+    template <class View>
+    void PSSetShaderResources(unsigned startSlot, unsigned count, View* const* views) {
+        unsigned first, changed;
+        if (UpdateSlots(m_psResources, MaxResources, startSlot, count, views, first, changed)) {
+            m_pContext->PSSetShaderResources(startSlot + first, changed, views + first);
+        }
+    };
+
+    template <class Sampler>
+    void PSSetSamplers(unsigned startSlot, unsigned count, Sampler* const* samplers) {
+        unsigned first, changed;
+        if (UpdateSlots(m_psSamplers, MaxSamplers, startSlot, count, samplers, first, changed)) {
+            m_pContext->PSSetSamplers(startSlot + first, changed, samplers + first);
+        }
+    };
+
+private:
+    // Address never equal to bound object, marks shadow state as unknown
+    static const void* Unknown() {
+        static const char unknown = 0;
+        return &unknown;
+    };
+
+    void Issue() { m_stats.issued++; };
+
+    // Function to update shadow value, returns true if call should be issued
+    template <class T, class U>
+    bool Update(T& shadow, const U& value) {
+        if (shadow == value) {
+            m_stats.elided++;
+            return false;
+        }
+        shadow = value;
+        Issue();
+        return true;
+    };
+
+    // Function to mark shadow unknown and count issued call, used for binds cache can't compare
+    bool Reset(const void*& shadow) {
+        shadow = Unknown();
+        Issue();
+        return true;
+    };
+
+    // Bound part of constant buffer, whole buffer is bound without range
+    static const unsigned WholeBuffer = ~0u;
+    struct ConstantRange {
+        unsigned first = 0;
+        unsigned count = WholeBuffer;
+    };
+
+    // Function to update shadow slots, returns true with one range covering all changed slots if any of them changed,
+    // constant buffer slots also compare bound ranges, missing firsts and counts mean whole buffers
+    template <class T>
+    bool UpdateSlots(const void** shadow, unsigned slotsCount, unsigned startSlot, unsigned count, T* const* values, unsigned& first, unsigned& changed,
+        ConstantRange* shadowRanges = nullptr, const unsigned* firsts = nullptr, const unsigned* counts = nullptr) {
+        if (startSlot + count > slotsCount) {
+            // Out of tracked range, pass call through and forget what it may overwrite
+            for (unsigned slot = startSlot; slot < slotsCount; slot++) {
+                shadow[slot] = Unknown();
+            }
+            first = 0;
+            changed = count;
+            Issue();
+            return true;
+        }
+
+        first = count;
+        unsigned last = 0;
+        for (unsigned i = 0; i < count; i++) {
+            const void* value = values[i];
+            bool slotChanged = shadow[startSlot + i] != value;
+            shadow[startSlot + i] = value;
+            if (shadowRanges) {
+                ConstantRange range;
+                if (firsts && counts) {
+                    range.first = firsts[i];
+                    range.count = counts[i];
+                }
+                ConstantRange& shadowRange = shadowRanges[startSlot + i];
+                slotChanged = slotChanged || shadowRange.first != range.first || shadowRange.count != range.count;
+                shadowRange = range;
+            }
+            if (slotChanged) {
+                first = (std::min)(first, i);
+                last = i;
+            }
+        }
+
+        if (first == count) {
+            m_stats.elided++;
+            return false;
+        }
+        changed = last - first + 1;
+        Issue();
+        return true;
+    };
+
+    Context* m_pContext = nullptr;
+    Stats m_stats;
+
+    const void* m_inputLayout = nullptr;
+    int m_topology = -1;
+    const void* m_vertexBuffers[MaxVertexBuffers];
+    unsigned m_vertexStrides[MaxVertexBuffers] = {};
+    unsigned m_vertexOffsets[MaxVertexBuffers] = {};
+    const void* m_indexBuffer = nullptr;
+    int m_indexFormat = 0;
+    unsigned m_indexOffset = 0;
+
+    const void* m_vertexShader = nullptr;
+    const void* m_pixelShader = nullptr;
+    const void* m_rasterizerState = nullptr;
+    const void* m_blendState = nullptr;
+    float m_blendFactor[4] = {};
+    unsigned m_sampleMask = 0;
+    const void* m_depthState = nullptr;
+    unsigned m_stencilRef = 0;
+
+    const void* m_vsConstantBuffers[MaxConstantBuffers];
+    const void* m_psConstantBuffers[MaxConstantBuffers];
+    ConstantRange m_vsConstantRanges[MaxConstantBuffers];
+    ConstantRange m_psConstantRanges[MaxConstantBuffers];
+    const void* m_vsResources[MaxResources];
+    const void* m_psResources[MaxResources];
+    const void* m_psSamplers[MaxSamplers];
+};
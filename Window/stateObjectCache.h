@@ -0,0 +1,74 @@
+// stateObjectCache.h - class for sharing state objects created from equal descriptors
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include "hash.h"
+
+// Object is reference counted by AddRef/Release like COM objects. Descriptors are compared by all their bytes,
+// so padding of Desc must be zeroed before filling it
+template <class Desc, class Object>
+class StateObjectCache {
+public:
+    struct Stats {
+        int hits = 0;       // requests served by existing object
+        int misses = 0;     // requests which created new object
+    };
+
+    // Function to get object for descriptor, on miss it is created by create(const Desc*, Object**).
+    // Object is referenced for caller, cache keeps own reference until Release. Returns result of create,
+    // default value on hit
+    template <class Create>
+    auto Get(const Desc& desc, Object** object, Create create) -> decltype(create(&desc, object)) {
+        Key key;
+        std::memcpy(&key.desc, &desc, sizeof(Desc));
+
+        auto it = m_objects.find(key);
+        if (it != m_objects.end()) {
+            m_stats.hits++;
+            it->second->AddRef();
+            *object = it->second;
+            return decltype(create(&desc, object))();
+        }
+
+        m_stats.misses++;
+        *object = nullptr;
+        auto result = create(&desc, object);
+        if (*object) {
+            (*object)->AddRef();
+            m_objects.emplace(key, *object);
+        }
+        return result;
+    };
+
+    // Function to drop cache references, objects live while callers keep theirs
+    void Release() {
+        for (auto& entry : m_objects) {
+            entry.second->Release();
+        }
+        m_objects.clear();
+    };
+    void ResetStats() { m_stats = Stats(); };
+
+    // Number of distinct objects
+    int GetSize() const { return (int)m_objects.size(); };
+    const Stats& GetStats() const { return m_stats; };
+
+private:
+    struct Key {
+        Desc desc;
+    };
+
+    struct KeyHasher {
+        size_t operator()(const Key& key) const { return (size_t)HashBytes(&key.desc, sizeof(Desc)); };
+    };
+
+    struct KeyEqual {
+        bool operator()(const Key& a, const Key& b) const { return std::memcmp(&a.desc, &b.desc, sizeof(Desc)) == 0; };
+    };
+
+    std::unordered_map<Key, Object*, KeyHasher, KeyEqual> m_objects;
+    Stats m_stats;
+};
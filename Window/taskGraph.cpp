@@ -0,0 +1,225 @@
+#include "taskGraph.h"
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+
+// Function to set job system running worker tasks and clock for timeline, job system may be nullptr to run everything on caller
+void TaskGraph::Init(JobSystem* jobSystem, const Clock* clock) {
+    m_pJobSystem = jobSystem;
+    m_pClock = clock;
+    Reset();
+}
+
+// Function to remove all tasks
+void TaskGraph::Reset() {
+    m_tasks.clear();
+    m_ready.clear();
+    m_timeline.clear();
+    m_finishedCount = 0;
+    m_wallTime = 0;
+    m_lanesCount = 0;
+}
+
+// Function to add task, worker task can depend only on worker tasks added before it, returns task id
+int TaskGraph::AddTask(const std::string& name, const TaskFunc& func, Queue queue, std::initializer_list<int> dependencies) {
+    Task task;
+    task.name = name;
+    task.func = func;
+    task.queue = queue;
+    m_tasks.push_back(task);
+
+    int id = (int)m_tasks.size() - 1;
+    for (int dependency : dependencies) {
+        AddDependency(id, dependency);
+    }
+    return id;
+}
+
+void TaskGraph::AddDependency(int task, int dependency) {
+    // Dependencies on earlier tasks only, so graph can't have cycles
+    assert(dependency < task);
+    // Main tasks run after all worker tasks, so worker can't wait for them
+    assert(m_tasks[task].queue == QUEUE_MAIN || m_tasks[dependency].queue == QUEUE_WORKER);
+    m_tasks[task].dependencies.push_back(dependency);
+    m_tasks[dependency].dependents.push_back(task);
+}
+
+// Function to run all tasks, returns false if any task failed or was skipped
+bool TaskGraph::Run() {
+    m_timeline.clear();
+    m_ready.clear();
+    m_finishedCount = 0;
+    m_startTime = m_pClock->GetNanoseconds();
+
+    int workerTasksCount = 0;
+    for (int i = 0; i < (int)m_tasks.size(); i++) {
+        Task& task = m_tasks[i];
+        task.state = STATE_WAITING;
+        task.pendingCount = (int)task.dependencies.size();
+        if (task.queue == QUEUE_WORKER) {
+            workerTasksCount++;
+            if (task.pendingCount == 0) {
+                m_ready.push_back(i);
+            }
+        }
+    }
+    // Ready tasks are taken from back, so first added run first
+    std::reverse(m_ready.begin(), m_ready.end());
+
+    // One loop per worker and one for caller, loops wait for tasks becoming ready
+    int workerLanes = m_pJobSystem ? m_pJobSystem->GetWorkersCount() + 1 : 1;
+    if (workerTasksCount > 0) {
+        if (m_pJobSystem) {
+            m_pJobSystem->ParallelFor(0, workerLanes, 1, [this, workerTasksCount](int first, int last) {
+                for (int lane = first; lane < last; lane++) {
+                    WorkerLoop(lane, workerTasksCount);
+                }
+            });
+        }
+        else {
+            WorkerLoop(0, workerTasksCount);
+        }
+    }
+    m_lanesCount = workerLanes + 1;
+
+    for (int i = 0; i < (int)m_tasks.size(); i++) {
+        Task& task = m_tasks[i];
+        if (task.queue != QUEUE_MAIN)
+            continue;
+
+        bool isReady = true;
+        for (int dependency : task.dependencies) {
+            isReady = isReady && m_tasks[dependency].state == STATE_DONE;
+        }
+        if (!isReady) {
+            task.state = STATE_FAILED;
+            continue;
+        }
+        RunTask(i, workerLanes);
+    }
+
+    bool isSucceeded = true;
+    for (const Task& task : m_tasks) {
+        isSucceeded = isSucceeded && task.state == STATE_DONE;
+    }
+    m_wallTime = m_pClock->GetNanoseconds() - m_startTime;
+    return isSucceeded;
+}
+
+// Loop taking ready worker tasks until all of them are finished
+void TaskGraph::WorkerLoop(int lane, int workerTasksCount) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_readyCondition.wait(lock, [this, workerTasksCount]() { return !m_ready.empty() || m_finishedCount == workerTasksCount; });
+        if (m_ready.empty()) {
+            return;
+        }
+
+        int task = m_ready.back();
+        m_ready.pop_back();
+
+        lock.unlock();
+        bool isSucceeded = RunTask(task, lane);
+        lock.lock();
+
+        // Dependents of failed task are finished as failed without running
+        std::vector<int> finished = { task };
+        std::vector<bool> failed = { !isSucceeded };
+        while (!finished.empty()) {
+            int current = finished.back();
+            bool isFailed = failed.back();
+            finished.pop_back();
+            failed.pop_back();
+            m_finishedCount++;
+
+            for (int dependent : m_tasks[current].dependents) {
+                Task& next = m_tasks[dependent];
+                if (next.queue != QUEUE_WORKER)
+                    continue;
+                if (isFailed) {
+                    next.state = STATE_FAILED;
+                }
+                if (--next.pendingCount > 0)
+                    continue;
+                if (next.state == STATE_FAILED) {
+                    finished.push_back(dependent);
+                    failed.push_back(true);
+                }
+                else {
+                    m_ready.push_back(dependent);
+                }
+            }
+        }
+        m_readyCondition.notify_all();
+    }
+}
+
+// Function to run task and record it, returns false if it failed
+bool TaskGraph::RunTask(int task, int lane) {
+    Task& current = m_tasks[task];
+    current.start = m_pClock->GetNanoseconds() - m_startTime;
+    bool isSucceeded = current.func ? current.func() : true;
+    current.end = m_pClock->GetNanoseconds() - m_startTime;
+    current.state = isSucceeded ? STATE_DONE : STATE_FAILED;
+
+    std::lock_guard<std::mutex> lock(m_timelineMutex);
+    m_timeline.push_back({ task, lane, current.start, current.end });
+    return isSucceeded;
+}
+
+// Sum of task times of last run, wall time of running them one by one
+int64_t TaskGraph::GetSerialTime() const {
+    int64_t time = 0;
+    for (const Event& event : m_timeline) {
+        time += event.end - event.start;
+    }
+    return time;
+}
+
+// Longest chain of dependent tasks of last run, lower bound of wall time for any number of workers
+int64_t TaskGraph::GetCriticalPathTime() const {
+    // Dependencies are always added before dependents, so one pass in id order is enough.
+    // Main tasks run one by one after all worker tasks
+    std::vector<int64_t> finish(m_tasks.size(), 0);
+    int64_t workersTime = 0;
+    int64_t mainTime = 0;
+    for (int i = 0; i < (int)m_tasks.size(); i++) {
+        const Task& task = m_tasks[i];
+        if (task.state != STATE_DONE)
+            continue;
+
+        if (task.queue == QUEUE_MAIN) {
+            mainTime += task.end - task.start;
+            continue;
+        }
+        int64_t start = 0;
+        for (int dependency : task.dependencies) {
+            start = (std::max)(start, finish[dependency]);
+        }
+        finish[i] = start + (task.end - task.start);
+        workersTime = (std::max)(workersTime, finish[i]);
+    }
+    return workersTime + mainTime;
+}
+
+// Function to write timeline of last run in Chrome trace event format
+bool TaskGraph::WriteTrace(const char* path) const {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+
+    file << "{\"traceEvents\":[\n";
+    for (size_t i = 0; i < m_timeline.size(); i++) {
+        const Event& event = m_timeline[i];
+        std::string name = m_tasks[event.task].name;
+        std::replace(name.begin(), name.end(), '"', '\'');
+        file << "{\"name\":\"" << name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.lane <<
+            ",\"ts\":" << event.start / 1000.0 << ",\"dur\":" << (event.end - event.start) / 1000.0 << "}";
+        file << (i + 1 < m_timeline.size() ? ",\n" : "\n");
+    }
+    file << "]}\n";
+
+    file.close();
+    return !file.fail();
+}
@@ -0,0 +1,97 @@
+// taskGraph.h - class for running tasks with dependencies on job system and tracing their timeline
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "clock.h"
+#include "jobSystem.h"
+
+class TaskGraph {
+public:
+    // Task returns false on failure, tasks depending on failed one are skipped
+    typedef std::function<bool()> TaskFunc;
+
+    enum Queue {
+        QUEUE_WORKER = 0,   // runs on any worker as soon as its dependencies are done
+        QUEUE_MAIN          // runs on thread calling Run after all worker tasks, in order of adding
+    };
+
+    // Run of one task, lane is worker loop which ran it, main thread is last lane
+    struct Event {
+        int task;
+        int lane;
+        int64_t start;  // nanoseconds from start of Run
+        int64_t end;
+    };
+
+    // Function to set job system running worker tasks and clock for timeline, job system may be nullptr to run everything on caller
+    void Init(JobSystem* jobSystem, const Clock* clock);
+    // Function to remove all tasks
+    void Reset();
+
+    // Function to add task, worker task can depend only on worker tasks added before it, returns task id
+    int AddTask(const std::string& name, const TaskFunc& func, Queue queue = QUEUE_WORKER, std::initializer_list<int> dependencies = {});
+    void AddDependency(int task, int dependency);
+
+    // Function to run all tasks, returns false if any task failed or was skipped
+    bool Run();
+
+    // Timeline of last run in order tasks finished
+    const std::vector<Event>& GetTimeline() const { return m_timeline; };
+    const std::string& GetTaskName(int task) const { return m_tasks[task].name; };
+    int GetLanesCount() const { return m_lanesCount; };
+    // Time from start to end of last run
+    int64_t GetWallTime() const { return m_wallTime; };
+    // Sum of task times of last run, wall time of running them one by one
+    int64_t GetSerialTime() const;
+    // Longest chain of dependent tasks of last run, lower bound of wall time for any number of workers
+    int64_t GetCriticalPathTime() const;
+
+    // Function to write timeline of last run in Chrome trace event format
+    bool WriteTrace(const char* path) const;
+
+private:
+    enum State {
+        STATE_WAITING = 0,
+        STATE_DONE,
+        STATE_FAILED    // failed or skipped
+    };
+
+    struct Task {
+        std::string name;
+        TaskFunc func;
+        Queue queue;
+        std::vector<int> dependencies;
+        std::vector<int> dependents;
+        int pendingCount = 0;
+        State state = STATE_WAITING;
+        int64_t start = 0;
+        int64_t end = 0;
+    };
+
+    // Loop taking ready worker tasks until all of them are finished
+    void WorkerLoop(int lane, int workerTasksCount);
+    // Function to run task and record it, returns false if it failed
+    bool RunTask(int task, int lane);
+
+    JobSystem* m_pJobSystem = nullptr;
+    const Clock* m_pClock = nullptr;
+    std::vector<Task> m_tasks;
+
+    // Scheduling state of worker tasks
+    std::mutex m_mutex;
+    std::condition_variable m_readyCondition;
+    std::vector<int> m_ready;
+    int m_finishedCount = 0;
+
+    std::mutex m_timelineMutex;
+    std::vector<Event> m_timeline;
+    int64_t m_startTime = 0;
+    int64_t m_wallTime = 0;
+    int m_lanesCount = 0;
+};
@@ -13,31 +13,54 @@ HRESULT Texture::Init(ID3D11Device* device, ID3D11DeviceContext* deviceContext,
     return hr;
 }
 
+// Function to initialize texture from mapped file
+HRESULT Texture::Init(ID3D11Device* device, ID3D11DeviceContext* deviceContext, const DdsFile& file) {
+    return DirectX::CreateDDSTextureFromMemory(device, file.GetData(), file.GetSize(), nullptr, &m_pTextureView);
+}
+
 HRESULT Texture::InitArray(ID3D11Device* device, ID3D11DeviceContext* deviceContext, std::vector<const wchar_t*> filenames) {
-    HRESULT hr = S_OK;
-    auto textureCount = (UINT)filenames.size();
+    std::vector<DdsFile> files(filenames.size());
+    std::vector<const DdsFile*> pFiles;
+    for (size_t i = 0; i < filenames.size(); i++) {
+        if (!files[i].Open(filenames[i])) {
+            return E_FAIL;
+        }
+        pFiles.push_back(&files[i]);
+    }
 
-    // A temporary collection to keep texture resources.
-    std::vector<ID3D11Texture2D*> textures(textureCount);
+    return InitArray(device, deviceContext, pFiles);
+}
 
-    // Load textures from DDS files.
-    for (UINT i = 0; i < textureCount; ++i) {
-        hr = DirectX::CreateDDSTextureFromFile(device, filenames[i], (ID3D11Resource**)(&textures[i]), nullptr);
-    }
-    if (FAILED(hr)) {
-        return hr;
+// Function to initialize texture array from mapped files, subresources are uploaded straight from mapped views
+HRESULT Texture::InitArray(ID3D11Device* device, ID3D11DeviceContext* deviceContext, const std::vector<const DdsFile*>& files) {
+    if (files.empty()) {
+        return E_INVALIDARG;
     }
 
-    // Luna: Create the texture array.
-    D3D11_TEXTURE2D_DESC textureDesc;
-    textures[0]->GetDesc(&textureDesc); // each element in the texture array has the same format and dimensions
+    // Each element in the texture array has the same format and dimensions
+    const DdsFile::Desc& desc = files[0]->GetDesc();
+    std::vector<D3D11_SUBRESOURCE_DATA> initData;
+    for (const DdsFile* file : files) {
+        const DdsFile::Desc& fileDesc = file->GetDesc();
+        if (fileDesc.dimension != DdsFile::DIMENSION_TEXTURE2D || fileDesc.isCubeMap || fileDesc.arraySize != 1 || fileDesc.format != desc.format ||
+            fileDesc.width != desc.width || fileDesc.height != desc.height || fileDesc.mipCount != desc.mipCount) {
+            return E_INVALIDARG;
+        }
+        for (int i = 0; i < (int)fileDesc.subresources.size(); i++) {
+            D3D11_SUBRESOURCE_DATA data;
+            data.pSysMem = file->GetSubresourceData(i);
+            data.SysMemPitch = fileDesc.subresources[i].rowPitch;
+            data.SysMemSlicePitch = fileDesc.subresources[i].slicePitch;
+            initData.push_back(data);
+        }
+    }
 
     D3D11_TEXTURE2D_DESC arrayDesc;
-    arrayDesc.Width = textureDesc.Width;
-    arrayDesc.Height = textureDesc.Height;
-    arrayDesc.MipLevels = textureDesc.MipLevels;
-    arrayDesc.ArraySize = textureCount;
-    arrayDesc.Format = textureDesc.Format;
+    arrayDesc.Width = desc.width;
+    arrayDesc.Height = desc.height;
+    arrayDesc.MipLevels = desc.mipCount;
+    arrayDesc.ArraySize = (UINT)files.size();
+    arrayDesc.Format = (DXGI_FORMAT)desc.format;
     arrayDesc.SampleDesc.Count = 1;
     arrayDesc.SampleDesc.Quality = 0;
     arrayDesc.Usage = D3D11_USAGE_DEFAULT;
@@ -46,20 +69,11 @@ HRESULT Texture::InitArray(ID3D11Device* device, ID3D11DeviceContext* deviceCont
     arrayDesc.MiscFlags = 0;
 
     ID3D11Texture2D* textureArray = nullptr;
-    hr = device->CreateTexture2D(&arrayDesc, 0, &textureArray);
+    HRESULT hr = device->CreateTexture2D(&arrayDesc, initData.data(), &textureArray);
     if (FAILED(hr)) {
         return hr;
     }
 
-    // Copy each texture into the elements of the texture array.
-    for (UINT texElement = 0; texElement < textureCount; ++texElement) {
-        for (UINT mipLevel = 0; mipLevel < textureDesc.MipLevels; ++mipLevel) {
-            const int sourceSubresource = D3D11CalcSubresource(mipLevel, 0, textureDesc.MipLevels);
-            const int destSubresource = D3D11CalcSubresource(mipLevel, texElement, textureDesc.MipLevels);
-            deviceContext->CopySubresourceRegion(textureArray, destSubresource, 0, 0, 0, textures[texElement], sourceSubresource, nullptr);
-        }
-    }
-
     // Luna: Create a resource view to the texture array.
     D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc;
     viewDesc.Format = arrayDesc.Format;
@@ -67,17 +81,11 @@ HRESULT Texture::InitArray(ID3D11Device* device, ID3D11DeviceContext* deviceCont
     viewDesc.Texture2DArray.MostDetailedMip = 0;
     viewDesc.Texture2DArray.MipLevels = arrayDesc.MipLevels;
     viewDesc.Texture2DArray.FirstArraySlice = 0;
-    viewDesc.Texture2DArray.ArraySize = textureCount;
+    viewDesc.Texture2DArray.ArraySize = arrayDesc.ArraySize;
 
     hr = device->CreateShaderResourceView(textureArray, &viewDesc, &m_pTextureView);
-    if (FAILED(hr)) {
-        return hr;
-    }
     // Cleanup - we only need the resource view.
     textureArray->Release();
-    for (UINT i = 0; i < textureCount; ++i) {
-        textures[i]->Release();
-    }
 
     return hr;
 }
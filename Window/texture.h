@@ -3,8 +3,10 @@
 
 #include <d3d11.h>
 #include <stdio.h>
+#include <cstdint>
 #include <vector>
 #include "DDSTextureLoader.h"
+#include "ddsFile.h"
 
 class Texture {
 public:
@@ -12,6 +14,9 @@ public:
     HRESULT Init(ID3D11Device* device, ID3D11DeviceContext* deviceContext, const wchar_t* filename);
     // Funnction to initialize texture array
     HRESULT InitArray(ID3D11Device* device, ID3D11DeviceContext* deviceContext, std::vector<const wchar_t*> filenames);
+    // Functions to initialize texture and texture array from mapped files, files can be opened on worker thread
+    HRESULT Init(ID3D11Device* device, ID3D11DeviceContext* deviceContext, const DdsFile& file);
+    HRESULT InitArray(ID3D11Device* device, ID3D11DeviceContext* deviceContext, const std::vector<const DdsFile*>& files);
     // Function to realese texture
     void Shutdown();
 
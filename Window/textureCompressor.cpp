@@ -0,0 +1,804 @@
+#include "textureCompressor.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define TEXTURE_COMPRESSOR_SSE
+#endif
+
+namespace {
+    // Interpolation weights of BC7 4-bit indices, out of 64
+    const int BC7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+    // Positions between endpoints of BC1 codes in 4 and 3 colors modes
+    const float BC1Positions4[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+    const float BC1Positions3[4] = { 0.0f, 1.0f, 0.5f, 0.0f };
+    const int PowerIterations = 8;
+
+    // Block pixels as channel planes, so SSE processes 4 pixels at once
+    struct alignas(16) BlockPlanes {
+        float values[4][16];
+        float weights[16];  // 0 for pixels which don't count, as transparent ones of BC1
+    };
+
+    // Function to convert 16 RGBA8 pixels to channel planes with weights 1
+    void LoadPlanes(const unsigned char* pixels, BlockPlanes& planes) {
+#ifdef TEXTURE_COMPRESSOR_SSE
+        __m128i zero = _mm_setzero_si128();
+        for (int i = 0; i < 16; i += 4) {
+            __m128i quad = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i * 4));
+            __m128i lo = _mm_unpacklo_epi8(quad, zero);
+            __m128i hi = _mm_unpackhi_epi8(quad, zero);
+            __m128 p0 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero));
+            __m128 p1 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero));
+            __m128 p2 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero));
+            __m128 p3 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero));
+            _MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+            _mm_store_ps(planes.values[0] + i, p0);
+            _mm_store_ps(planes.values[1] + i, p1);
+            _mm_store_ps(planes.values[2] + i, p2);
+            _mm_store_ps(planes.values[3] + i, p3);
+            _mm_store_ps(planes.weights + i, _mm_set1_ps(1.0f));
+        }
+#else
+        for (int i = 0; i < 16; i++) {
+            for (int c = 0; c < 4; c++) {
+                planes.values[c][i] = (float)pixels[i * 4 + c];
+            }
+            planes.weights[i] = 1.0f;
+        }
+#endif
+    }
+
+    // Function to find nearest palette entry of every pixel by weighted squared distance, returns sum of distances of weighted pixels
+    float FindNearest(const BlockPlanes& planes, const float (*palette)[4], int paletteSize, const float channelWeights[4], int* indices) {
+#ifdef TEXTURE_COMPRESSOR_SSE
+        __m128 error = _mm_setzero_ps();
+        for (int i = 0; i < 16; i += 4) {
+            __m128 values[4];
+            for (int c = 0; c < 4; c++) {
+                values[c] = _mm_load_ps(planes.values[c] + i);
+            }
+            __m128 best = _mm_set1_ps(FLT_MAX);
+            __m128i bestIndex = _mm_setzero_si128();
+            for (int k = 0; k < paletteSize; k++) {
+                __m128 distance = _mm_setzero_ps();
+                for (int c = 0; c < 4; c++) {
+                    __m128 d = _mm_sub_ps(values[c], _mm_set1_ps(palette[k][c]));
+                    distance = _mm_add_ps(distance, _mm_mul_ps(_mm_mul_ps(d, d), _mm_set1_ps(channelWeights[c])));
+                }
+                __m128i isCloser = _mm_castps_si128(_mm_cmplt_ps(distance, best));
+                best = _mm_min_ps(distance, best);
+                bestIndex = _mm_or_si128(_mm_and_si128(isCloser, _mm_set1_epi32(k)), _mm_andnot_si128(isCloser, bestIndex));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(indices + i), bestIndex);
+            error = _mm_add_ps(error, _mm_mul_ps(best, _mm_load_ps(planes.weights + i)));
+        }
+        alignas(16) float sums[4];
+        _mm_store_ps(sums, error);
+        return sums[0] + sums[1] + sums[2] + sums[3];
+#else
+        float error = 0.0f;
+        for (int i = 0; i < 16; i++) {
+            float best = FLT_MAX;
+            indices[i] = 0;
+            for (int k = 0; k < paletteSize; k++) {
+                float distance = 0.0f;
+                for (int c = 0; c < 4; c++) {
+                    float d = planes.values[c][i] - palette[k][c];
+                    distance += d * d * channelWeights[c];
+                }
+                if (distance < best) {
+                    best = distance;
+                    indices[i] = k;
+                }
+            }
+            error += best * planes.weights[i];
+        }
+        return error;
+#endif
+    }
+
+    // Function to get range of projections of weighted pixels to axis going through origin
+    void ProjectRange(const BlockPlanes& planes, const float origin[4], const float axis[4], float& low, float& high) {
+#ifdef TEXTURE_COMPRESSOR_SSE
+        __m128 lowest = _mm_set1_ps(FLT_MAX);
+        __m128 highest = _mm_set1_ps(-FLT_MAX);
+        for (int i = 0; i < 16; i += 4) {
+            __m128 t = _mm_setzero_ps();
+            for (int c = 0; c < 4; c++) {
+                t = _mm_add_ps(t, _mm_mul_ps(_mm_sub_ps(_mm_load_ps(planes.values[c] + i), _mm_set1_ps(origin[c])), _mm_set1_ps(axis[c])));
+            }
+            __m128 isCounted = _mm_cmpgt_ps(_mm_load_ps(planes.weights + i), _mm_setzero_ps());
+            lowest = _mm_min_ps(lowest, _mm_or_ps(_mm_and_ps(isCounted, t), _mm_andnot_ps(isCounted, _mm_set1_ps(FLT_MAX))));
+            highest = _mm_max_ps(highest, _mm_or_ps(_mm_and_ps(isCounted, t), _mm_andnot_ps(isCounted, _mm_set1_ps(-FLT_MAX))));
+        }
+        alignas(16) float lows[4];
+        alignas(16) float highs[4];
+        _mm_store_ps(lows, lowest);
+        _mm_store_ps(highs, highest);
+        low = (std::min)((std::min)(lows[0], lows[1]), (std::min)(lows[2], lows[3]));
+        high = (std::max)((std::max)(highs[0], highs[1]), (std::max)(highs[2], highs[3]));
+#else
+        low = FLT_MAX;
+        high = -FLT_MAX;
+        for (int i = 0; i < 16; i++) {
+            if (planes.weights[i] <= 0.0f) {
+                continue;
+            }
+            float t = 0.0f;
+            for (int c = 0; c < 4; c++) {
+                t += (planes.values[c][i] - origin[c]) * axis[c];
+            }
+            low = (std::min)(low, t);
+            high = (std::max)(high, t);
+        }
+#endif
+    }
+
+    // Function to get codes of nearest values of 8 values BC4 palette going from high to low, its interpolated values are evenly spaced
+    void ComputeBC4Codes(const float* values, float high, float low, int* codes) {
+        float scale = 7.0f / (high - low);
+#ifdef TEXTURE_COMPRESSOR_SSE
+        for (int i = 0; i < 16; i += 4) {
+            __m128 t = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(high), _mm_load_ps(values + i)), _mm_set1_ps(scale));
+            t = _mm_min_ps(_mm_max_ps(t, _mm_setzero_ps()), _mm_set1_ps(7.0f));
+            __m128i position = _mm_cvtps_epi32(t);
+            // Position 0 is code 0, position 7 is code 1, others are position + 1
+            __m128i isFirst = _mm_cmpeq_epi32(position, _mm_setzero_si128());
+            __m128i isLast = _mm_cmpeq_epi32(position, _mm_set1_epi32(7));
+            __m128i code = _mm_andnot_si128(isFirst, _mm_add_epi32(position, _mm_set1_epi32(1)));
+            code = _mm_or_si128(_mm_andnot_si128(isLast, code), _mm_and_si128(isLast, _mm_set1_epi32(1)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(codes + i), code);
+        }
+#else
+        for (int i = 0; i < 16; i++) {
+            float t = (std::min)((std::max)((high - values[i]) * scale, 0.0f), 7.0f);
+            int position = (int)std::lround(t);
+            codes[i] = position == 0 ? 0 : (position == 7 ? 1 : position + 1);
+        }
+#endif
+    }
+
+    // Function to fit segment covering weighted pixels along their principal axis, only first channelsCount channels are fitted
+    void FitEndpoints(const BlockPlanes& planes, int channelsCount, float e0[4], float e1[4]) {
+        float mean[4] = {};
+        float weightSum = 0.0f;
+        for (int i = 0; i < 16; i++) {
+            weightSum += planes.weights[i];
+            for (int c = 0; c < channelsCount; c++) {
+                mean[c] += planes.values[c][i] * planes.weights[i];
+            }
+        }
+        for (int c = 0; c < 4; c++) {
+            mean[c] = weightSum > 0.0f && c < channelsCount ? mean[c] / weightSum : 0.0f;
+        }
+
+        float covariance[4][4] = {};
+        for (int i = 0; i < 16; i++) {
+            for (int a = 0; a < channelsCount; a++) {
+                for (int b = a; b < channelsCount; b++) {
+                    covariance[a][b] += (planes.values[a][i] - mean[a]) * (planes.values[b][i] - mean[b]) * planes.weights[i];
+                }
+            }
+        }
+        for (int a = 0; a < channelsCount; a++) {
+            for (int b = 0; b < a; b++) {
+                covariance[a][b] = covariance[b][a];
+            }
+        }
+
+        // Power iteration converges to axis of largest variance, block of one color has no axis
+        float axis[4] = {};
+        for (int c = 0; c < channelsCount; c++) {
+            axis[c] = 1.0f;
+        }
+        for (int iteration = 0; iteration < PowerIterations; iteration++) {
+            float next[4] = {};
+            float norm = 0.0f;
+            for (int a = 0; a < channelsCount; a++) {
+                for (int b = 0; b < channelsCount; b++) {
+                    next[a] += covariance[a][b] * axis[b];
+                }
+                norm = (std::max)(norm, fabsf(next[a]));
+            }
+            if (norm < 1e-6f) {
+                memset(axis, 0, sizeof(axis));
+                break;
+            }
+            for (int c = 0; c < 4; c++) {
+                axis[c] = next[c] / norm;
+            }
+        }
+        float length = sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2] + axis[3] * axis[3]);
+        for (int c = 0; c < 4; c++) {
+            axis[c] = length > 0.0f ? axis[c] / length : 0.0f;
+        }
+
+        float low = 0.0f;
+        float high = 0.0f;
+        if (weightSum > 0.0f) {
+            ProjectRange(planes, mean, axis, low, high);
+        }
+        for (int c = 0; c < 4; c++) {
+            e0[c] = (std::min)((std::max)(mean[c] + axis[c] * low, 0.0f), 255.0f);
+            e1[c] = (std::min)((std::max)(mean[c] + axis[c] * high, 0.0f), 255.0f);
+        }
+    }
+
+    // Function to fit endpoints with least squared error of weighted pixels for their indices, positions are places of indices
+    // between endpoints. Returns false if all pixels are at one place
+    bool RefineEndpoints(const BlockPlanes& planes, const int* indices, const float* positions, int channelsCount, float e0[4], float e1[4]) {
+        float a = 0.0f;
+        float b = 0.0f;
+        float c = 0.0f;
+        float x[4] = {};
+        float y[4] = {};
+        for (int i = 0; i < 16; i++) {
+            if (planes.weights[i] <= 0.0f) {
+                continue;
+            }
+            float t = positions[indices[i]];
+            float s = 1.0f - t;
+            a += s * s;
+            b += s * t;
+            c += t * t;
+            for (int ch = 0; ch < channelsCount; ch++) {
+                x[ch] += s * planes.values[ch][i];
+                y[ch] += t * planes.values[ch][i];
+            }
+        }
+
+        float determinant = a * c - b * b;
+        if (fabsf(determinant) < 1e-6f) {
+            return false;
+        }
+        for (int ch = 0; ch < channelsCount; ch++) {
+            e0[ch] = (std::min)((std::max)((c * x[ch] - b * y[ch]) / determinant, 0.0f), 255.0f);
+            e1[ch] = (std::min)((std::max)((a * y[ch] - b * x[ch]) / determinant, 0.0f), 255.0f);
+        }
+        return true;
+    }
+
+    uint16_t Pack565(const float color[4]) {
+        int r = (std::min)((std::max)((int)(color[0] * 31.0f / 255.0f + 0.5f), 0), 31);
+        int g = (std::min)((std::max)((int)(color[1] * 63.0f / 255.0f + 0.5f), 0), 63);
+        int b = (std::min)((std::max)((int)(color[2] * 31.0f / 255.0f + 0.5f), 0), 31);
+        return (uint16_t)((r << 11) | (g << 5) | b);
+    }
+
+    void Unpack565(uint16_t color, unsigned char* pixel) {
+        int r = (color >> 11) & 31;
+        int g = (color >> 5) & 63;
+        int b = color & 31;
+        pixel[0] = (unsigned char)((r << 3) | (r >> 2));
+        pixel[1] = (unsigned char)((g << 2) | (g >> 4));
+        pixel[2] = (unsigned char)((b << 3) | (b >> 2));
+        pixel[3] = 255;
+    }
+
+    // Function to get palette of BC1 color block in code order, 3 colors and transparent black for BC1 with c0 <= c1
+    void GetBC1Palette(uint16_t c0, uint16_t c1, bool isBC1, unsigned char palette[4][4]) {
+        Unpack565(c0, palette[0]);
+        Unpack565(c1, palette[1]);
+        if (c0 > c1 || !isBC1) {
+            for (int c = 0; c < 3; c++) {
+                palette[2][c] = (unsigned char)((2 * palette[0][c] + palette[1][c]) / 3);
+                palette[3][c] = (unsigned char)((palette[0][c] + 2 * palette[1][c]) / 3);
+            }
+            palette[2][3] = palette[3][3] = 255;
+        }
+        else {
+            for (int c = 0; c < 3; c++) {
+                palette[2][c] = (unsigned char)((palette[0][c] + palette[1][c]) / 2);
+                palette[3][c] = 0;
+            }
+            palette[2][3] = 255;
+            palette[3][3] = 0;
+        }
+    }
+
+    // Function to get palette of BC4 block in code order, 8 values if e0 > e1, else 6 values, 0 and 255
+    void GetBC4Palette(int e0, int e1, int palette[8]) {
+        palette[0] = e0;
+        palette[1] = e1;
+        if (e0 > e1) {
+            for (int i = 1; i < 7; i++) {
+                palette[i + 1] = ((7 - i) * e0 + i * e1 + 3) / 7;
+            }
+        }
+        else {
+            for (int i = 1; i < 5; i++) {
+                palette[i + 1] = ((5 - i) * e0 + i * e1 + 2) / 5;
+            }
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+    }
+
+    // Function to quantize endpoint to 7 bits per channel and p-bit shared by channels, p-bit with least error is taken
+    void QuantizeBC7Endpoint(const float endpoint[4], int quantized[4], int& pBit) {
+        float bestError = FLT_MAX;
+        for (int p = 0; p < 2; p++) {
+            int values[4];
+            float error = 0.0f;
+            for (int c = 0; c < 4; c++) {
+                values[c] = (std::min)((std::max)((int)((endpoint[c] - p) * 0.5f + 0.5f), 0), 127);
+                float d = (float)((values[c] << 1) | p) - endpoint[c];
+                error += d * d;
+            }
+            if (error < bestError) {
+                bestError = error;
+                pBit = p;
+                memcpy(quantized, values, sizeof(values));
+            }
+        }
+    }
+
+    void WriteBits(unsigned char* block, int& position, uint32_t value, int count) {
+        for (int i = 0; i < count; i++, position++) {
+            block[position >> 3] |= (unsigned char)(((value >> i) & 1) << (position & 7));
+        }
+    }
+
+    uint32_t ReadBits(const unsigned char* block, int& position, int count) {
+        uint32_t value = 0;
+        for (int i = 0; i < count; i++, position++) {
+            value |= (uint32_t)((block[position >> 3] >> (position & 7)) & 1) << i;
+        }
+        return value;
+    }
+
+    // Function to get bytes of 4x4 block of format, 0 for formats without encoder
+    uint32_t GetBlockSize(DdsFile::Format format) {
+        switch (format) {
+        case DdsFile::FORMAT_BC1_UNORM:
+        case DdsFile::FORMAT_BC1_UNORM_SRGB:
+        case DdsFile::FORMAT_BC4_UNORM:
+            return 8;
+        case DdsFile::FORMAT_BC3_UNORM:
+        case DdsFile::FORMAT_BC3_UNORM_SRGB:
+        case DdsFile::FORMAT_BC5_UNORM:
+        case DdsFile::FORMAT_BC7_UNORM:
+        case DdsFile::FORMAT_BC7_UNORM_SRGB:
+            return 16;
+        default:
+            return 0;
+        }
+    }
+
+    // Function to copy 4x4 block at block coordinates, pixels outside image repeat last column and row
+    void GatherBlock(const TextureCompressor::Image& image, uint32_t blockX, uint32_t blockY, unsigned char* pixels) {
+        uint32_t x0 = blockX * 4;
+        uint32_t y0 = blockY * 4;
+        if (x0 + 4 <= image.width && y0 + 4 <= image.height) {
+            for (uint32_t y = 0; y < 4; y++) {
+                memcpy(pixels + y * 16, image.pixels.data() + ((size_t)(y0 + y) * image.width + x0) * 4, 16);
+            }
+            return;
+        }
+
+        for (uint32_t y = 0; y < 4; y++) {
+            uint32_t sy = (std::min)(y0 + y, image.height - 1);
+            for (uint32_t x = 0; x < 4; x++) {
+                uint32_t sx = (std::min)(x0 + x, image.width - 1);
+                memcpy(pixels + (y * 4 + x) * 4, image.pixels.data() + ((size_t)sy * image.width + sx) * 4, 4);
+            }
+        }
+    }
+
+    void EncodeBlock(DdsFile::Format format, const unsigned char* pixels, unsigned char* block) {
+        switch (format) {
+        case DdsFile::FORMAT_BC1_UNORM:
+        case DdsFile::FORMAT_BC1_UNORM_SRGB:
+            TextureCompressor::EncodeBC1(pixels, block, true);
+            break;
+        case DdsFile::FORMAT_BC3_UNORM:
+        case DdsFile::FORMAT_BC3_UNORM_SRGB:
+            TextureCompressor::EncodeBC4(pixels, 3, block);
+            TextureCompressor::EncodeBC1(pixels, block + 8, false);
+            break;
+        case DdsFile::FORMAT_BC4_UNORM:
+            TextureCompressor::EncodeBC4(pixels, 0, block);
+            break;
+        case DdsFile::FORMAT_BC5_UNORM:
+            TextureCompressor::EncodeBC4(pixels, 0, block);
+            TextureCompressor::EncodeBC4(pixels, 1, block + 8);
+            break;
+        default:
+            TextureCompressor::EncodeBC7(pixels, block);
+            break;
+        }
+    }
+
+    bool DecodeBlock(DdsFile::Format format, const unsigned char* block, unsigned char* pixels) {
+        // Channels missing in BC4 and BC5 read as 0, alpha as 1
+        for (int i = 0; i < 16; i++) {
+            pixels[i * 4] = pixels[i * 4 + 1] = pixels[i * 4 + 2] = 0;
+            pixels[i * 4 + 3] = 255;
+        }
+
+        switch (format) {
+        case DdsFile::FORMAT_BC1_UNORM:
+        case DdsFile::FORMAT_BC1_UNORM_SRGB:
+            TextureCompressor::DecodeBC1(block, pixels, true);
+            return true;
+        case DdsFile::FORMAT_BC3_UNORM:
+        case DdsFile::FORMAT_BC3_UNORM_SRGB:
+            TextureCompressor::DecodeBC1(block + 8, pixels, false);
+            TextureCompressor::DecodeBC4(block, 3, pixels);
+            return true;
+        case DdsFile::FORMAT_BC4_UNORM:
+            TextureCompressor::DecodeBC4(block, 0, pixels);
+            return true;
+        case DdsFile::FORMAT_BC5_UNORM:
+            TextureCompressor::DecodeBC4(block, 0, pixels);
+            TextureCompressor::DecodeBC4(block + 8, 1, pixels);
+            return true;
+        default:
+            return TextureCompressor::DecodeBC7(block, pixels);
+        }
+    }
+}
+
+// Function to compress image to BC1, BC3, BC4 (red), BC5 (red and green) or BC7, returns false for other formats
+bool TextureCompressor::Compress(const Image& image, DdsFile::Format format, std::vector<unsigned char>& blocks) const {
+    uint32_t blockSize = GetBlockSize(format);
+    if (!blockSize || !image.width || !image.height || image.pixels.size() != (size_t)image.width * image.height * 4) {
+        return false;
+    }
+
+    uint32_t blocksX = (image.width + 3) / 4;
+    uint32_t blocksY = (image.height + 3) / 4;
+    blocks.resize((size_t)blocksX * blocksY * blockSize);
+    unsigned char* data = blocks.data();
+    // Blocks are independent, so rows of them are compressed in any order
+    JobSystem::RangeFunc compressRows = [&image, format, blockSize, blocksX, data](int first, int last) {
+        unsigned char pixels[64];
+        for (int y = first; y < last; y++) {
+            for (uint32_t x = 0; x < blocksX; x++) {
+                GatherBlock(image, x, (uint32_t)y, pixels);
+                EncodeBlock(format, pixels, data + ((size_t)y * blocksX + x) * blockSize);
+            }
+        }
+    };
+
+    if (m_pJobSystem) {
+        m_pJobSystem->ParallelFor(0, (int)blocksY, TEXTURE_COMPRESSOR_GRAIN, compressRows);
+    }
+    else {
+        compressRows(0, (int)blocksY);
+    }
+    return true;
+}
+
+// Function to compress every mip of 2D texture from DDS file and write them into new DDS file of given format
+bool TextureCompressor::Convert(const DdsFile& file, DdsFile::Format format, const char* path) const {
+    const DdsFile::Desc& desc = file.GetDesc();
+    if (desc.dimension != DdsFile::DIMENSION_TEXTURE2D || desc.arraySize != 1 || !GetBlockSize(format)) {
+        return false;
+    }
+
+    std::vector<std::vector<unsigned char>> mips(desc.mipCount);
+    Image image;
+    for (uint32_t mip = 0; mip < desc.mipCount; mip++) {
+        if (!ReadImage(file, (int)mip, image) || !Compress(image, format, mips[mip])) {
+            return false;
+        }
+    }
+    return DdsFile::Write(path, format, desc.width, desc.height, mips);
+}
+
+// Function to decode BC1-BC5 or BC7 blocks to image, returns false for other formats and BC7 blocks not in mode 6
+bool TextureCompressor::Decompress(const unsigned char* blocks, uint32_t width, uint32_t height, DdsFile::Format format, Image& image) {
+    uint32_t blockSize = GetBlockSize(format);
+    if (!blockSize || !width || !height) {
+        return false;
+    }
+
+    image.width = width;
+    image.height = height;
+    image.pixels.resize((size_t)width * height * 4);
+    uint32_t blocksX = (width + 3) / 4;
+    uint32_t blocksY = (height + 3) / 4;
+    unsigned char pixels[64];
+    for (uint32_t blockY = 0; blockY < blocksY; blockY++) {
+        for (uint32_t blockX = 0; blockX < blocksX; blockX++) {
+            if (!DecodeBlock(format, blocks + ((size_t)blockY * blocksX + blockX) * blockSize, pixels)) {
+                return false;
+            }
+            uint32_t columns = (std::min)(4u, width - blockX * 4);
+            uint32_t rows = (std::min)(4u, height - blockY * 4);
+            for (uint32_t y = 0; y < rows; y++) {
+                memcpy(image.pixels.data() + ((size_t)(blockY * 4 + y) * width + blockX * 4) * 4, pixels + y * 16, columns * 4);
+            }
+        }
+    }
+    return true;
+}
+
+// Function to get mip of DDS file as image, RGBA8, BGRA8, BGRX8 and formats of Decompress are supported
+bool TextureCompressor::ReadImage(const DdsFile& file, int subresource, Image& image) {
+    const DdsFile::Desc& desc = file.GetDesc();
+    if (subresource < 0 || subresource >= (int)desc.subresources.size() || desc.subresources[subresource].depth != 1) {
+        return false;
+    }
+
+    const DdsFile::Subresource& info = desc.subresources[subresource];
+    const unsigned char* data = file.GetSubresourceData(subresource);
+    switch (desc.format) {
+    case DdsFile::FORMAT_R8G8B8A8_UNORM:
+    case DdsFile::FORMAT_R8G8B8A8_UNORM_SRGB:
+    case DdsFile::FORMAT_B8G8R8A8_UNORM:
+    case DdsFile::FORMAT_B8G8R8A8_UNORM_SRGB:
+    case DdsFile::FORMAT_B8G8R8X8_UNORM:
+    case DdsFile::FORMAT_B8G8R8X8_UNORM_SRGB: {
+        bool isBGR = desc.format != DdsFile::FORMAT_R8G8B8A8_UNORM && desc.format != DdsFile::FORMAT_R8G8B8A8_UNORM_SRGB;
+        bool hasAlpha = desc.format != DdsFile::FORMAT_B8G8R8X8_UNORM && desc.format != DdsFile::FORMAT_B8G8R8X8_UNORM_SRGB;
+        image.width = info.width;
+        image.height = info.height;
+        image.pixels.resize((size_t)info.width * info.height * 4);
+        for (uint32_t y = 0; y < info.height; y++) {
+            const unsigned char* src = data + (size_t)y * info.rowPitch;
+            unsigned char* dst = image.pixels.data() + (size_t)y * info.width * 4;
+            for (uint32_t x = 0; x < info.width; x++, src += 4, dst += 4) {
+                dst[0] = isBGR ? src[2] : src[0];
+                dst[1] = src[1];
+                dst[2] = isBGR ? src[0] : src[2];
+                dst[3] = hasAlpha ? src[3] : 255;
+            }
+        }
+        return true;
+    }
+    default:
+        return Decompress(data, info.width, info.height, desc.format, image);
+    }
+}
+
+// Function to get peak signal to noise ratio in dB over channels set in mask (bit 0 - red), infinity for equal images
+double TextureCompressor::ComputePSNR(const Image& a, const Image& b, uint32_t channelsMask) {
+    if (a.width != b.width || a.height != b.height || a.pixels.size() != b.pixels.size()) {
+        return 0.0;
+    }
+
+    double sum = 0.0;
+    size_t count = 0;
+    for (size_t i = 0; i < a.pixels.size(); i++) {
+        if (channelsMask & (1u << (i & 3))) {
+            double d = (double)a.pixels[i] - (double)b.pixels[i];
+            sum += d * d;
+            count++;
+        }
+    }
+    if (!count || sum == 0.0) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return 10.0 * log10(255.0 * 255.0 / (sum / count));
+}
+
+// Function to encode BC1 block or color block of BC3
+void TextureCompressor::EncodeBC1(const unsigned char* pixels, unsigned char* block, bool isBC1) {
+    BlockPlanes planes;
+    LoadPlanes(pixels, planes);
+    bool hasTransparent = false;
+    if (isBC1) {
+        for (int i = 0; i < 16; i++) {
+            if (pixels[i * 4 + 3] < 128) {
+                planes.weights[i] = 0.0f;
+                hasTransparent = true;
+            }
+        }
+    }
+
+    float e0[4];
+    float e1[4];
+    FitEndpoints(planes, 3, e0, e1);
+
+    static const float ColorWeights[4] = { 1.0f, 1.0f, 1.0f, 0.0f };
+    uint16_t bestC0 = 0;
+    uint16_t bestC1 = 0;
+    int bestIndices[16] = {};
+    float bestError = FLT_MAX;
+    for (int pass = 0; pass < 2; pass++) {
+        uint16_t c0 = Pack565(e0);
+        uint16_t c1 = Pack565(e1);
+        // BC1 has 4 colors only if c0 > c1, 3 colors and transparent black if c0 <= c1
+        if (hasTransparent ? c0 > c1 : c0 < c1) {
+            std::swap(c0, c1);
+            std::swap(e0, e1);
+        }
+
+        unsigned char colors[4][4];
+        GetBC1Palette(c0, c1, isBC1, colors);
+        float palette[4][4];
+        for (int k = 0; k < 4; k++) {
+            for (int c = 0; c < 4; c++) {
+                palette[k][c] = colors[k][c];
+            }
+        }
+        // Equal endpoints mean 3 colors mode in BC1, so only first color is used
+        int paletteSize = hasTransparent ? 3 : (c0 == c1 ? 1 : 4);
+        int indices[16];
+        float error = FindNearest(planes, palette, paletteSize, ColorWeights, indices);
+        if (error < bestError) {
+            bestError = error;
+            bestC0 = c0;
+            bestC1 = c1;
+            memcpy(bestIndices, indices, sizeof(indices));
+        }
+        if (pass == 0 && !RefineEndpoints(planes, indices, hasTransparent ? BC1Positions3 : BC1Positions4, 3, e0, e1)) {
+            break;
+        }
+    }
+
+    uint32_t bits = 0;
+    for (int i = 0; i < 16; i++) {
+        uint32_t code = hasTransparent && planes.weights[i] <= 0.0f ? 3 : (uint32_t)bestIndices[i];
+        bits |= code << (i * 2);
+    }
+    block[0] = (unsigned char)(bestC0 & 0xff);
+    block[1] = (unsigned char)(bestC0 >> 8);
+    block[2] = (unsigned char)(bestC1 & 0xff);
+    block[3] = (unsigned char)(bestC1 >> 8);
+    for (int i = 0; i < 4; i++) {
+        block[4 + i] = (unsigned char)(bits >> (i * 8));
+    }
+}
+
+// Function to encode one channel of pixels to BC4 block, also used for alpha of BC3 and channels of BC5
+void TextureCompressor::EncodeBC4(const unsigned char* pixels, int channel, unsigned char* block) {
+    BlockPlanes planes;
+    LoadPlanes(pixels, planes);
+    const float* values = planes.values[channel];
+    float high = values[0];
+    float low = values[0];
+    for (int i = 1; i < 16; i++) {
+        high = (std::max)(high, values[i]);
+        low = (std::min)(low, values[i]);
+    }
+
+    // 8 values mode needs first endpoint larger, block of one value uses first endpoint only
+    int codes[16] = {};
+    if (high > low) {
+        ComputeBC4Codes(values, high, low, codes);
+    }
+
+    uint64_t bits = 0;
+    for (int i = 0; i < 16; i++) {
+        bits |= (uint64_t)codes[i] << (i * 3);
+    }
+    block[0] = (unsigned char)high;
+    block[1] = (unsigned char)low;
+    for (int i = 0; i < 6; i++) {
+        block[2 + i] = (unsigned char)(bits >> (i * 8));
+    }
+}
+
+// Function to encode pixels to BC7 block in mode 6
+void TextureCompressor::EncodeBC7(const unsigned char* pixels, unsigned char* block) {
+    BlockPlanes planes;
+    LoadPlanes(pixels, planes);
+    float e0[4];
+    float e1[4];
+    FitEndpoints(planes, 4, e0, e1);
+
+    static const float ChannelWeights[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    float positions[16];
+    for (int k = 0; k < 16; k++) {
+        positions[k] = BC7Weights[k] / 64.0f;
+    }
+
+    int bestQ0[4] = {};
+    int bestQ1[4] = {};
+    int bestP0 = 0;
+    int bestP1 = 0;
+    int bestIndices[16] = {};
+    float bestError = FLT_MAX;
+    for (int pass = 0; pass < 2; pass++) {
+        int q0[4];
+        int q1[4];
+        int p0 = 0;
+        int p1 = 0;
+        QuantizeBC7Endpoint(e0, q0, p0);
+        QuantizeBC7Endpoint(e1, q1, p1);
+
+        float palette[16][4];
+        for (int c = 0; c < 4; c++) {
+            int u0 = (q0[c] << 1) | p0;
+            int u1 = (q1[c] << 1) | p1;
+            for (int k = 0; k < 16; k++) {
+                palette[k][c] = (float)(((64 - BC7Weights[k]) * u0 + BC7Weights[k] * u1 + 32) >> 6);
+            }
+        }
+        int indices[16];
+        float error = FindNearest(planes, palette, 16, ChannelWeights, indices);
+        if (error < bestError) {
+            bestError = error;
+            memcpy(bestQ0, q0, sizeof(q0));
+            memcpy(bestQ1, q1, sizeof(q1));
+            bestP0 = p0;
+            bestP1 = p1;
+            memcpy(bestIndices, indices, sizeof(indices));
+        }
+        if (pass == 0 && !RefineEndpoints(planes, indices, positions, 4, e0, e1)) {
+            break;
+        }
+    }
+
+    // Highest bit of first index is implicit zero, so endpoints are swapped when it is set
+    if (bestIndices[0] & 8) {
+        std::swap(bestQ0, bestQ1);
+        std::swap(bestP0, bestP1);
+        for (int& index : bestIndices) {
+            index = 15 - index;
+        }
+    }
+
+    memset(block, 0, 16);
+    int position = 0;
+    WriteBits(block, position, 1 << 6, 7);
+    for (int c = 0; c < 4; c++) {
+        WriteBits(block, position, bestQ0[c], 7);
+        WriteBits(block, position, bestQ1[c], 7);
+    }
+    WriteBits(block, position, bestP0, 1);
+    WriteBits(block, position, bestP1, 1);
+    for (int i = 0; i < 16; i++) {
+        WriteBits(block, position, bestIndices[i], i == 0 ? 3 : 4);
+    }
+}
+
+// Function to decode BC1 block or color block of BC3
+void TextureCompressor::DecodeBC1(const unsigned char* block, unsigned char* pixels, bool isBC1) {
+    uint16_t c0 = (uint16_t)(block[0] | (block[1] << 8));
+    uint16_t c1 = (uint16_t)(block[2] | (block[3] << 8));
+    unsigned char palette[4][4];
+    GetBC1Palette(c0, c1, isBC1, palette);
+    uint32_t bits = block[4] | (block[5] << 8) | (block[6] << 16) | ((uint32_t)block[7] << 24);
+    for (int i = 0; i < 16; i++) {
+        memcpy(pixels + i * 4, palette[(bits >> (i * 2)) & 3], 4);
+    }
+}
+
+// Function to decode BC4 block to one channel of pixels
+void TextureCompressor::DecodeBC4(const unsigned char* block, int channel, unsigned char* pixels) {
+    int palette[8];
+    GetBC4Palette(block[0], block[1], palette);
+    uint64_t bits = 0;
+    for (int i = 0; i < 6; i++) {
+        bits |= (uint64_t)block[2 + i] << (i * 8);
+    }
+    for (int i = 0; i < 16; i++) {
+        pixels[i * 4 + channel] = (unsigned char)palette[(bits >> (i * 3)) & 7];
+    }
+}
+
+// Function to decode BC7 block in mode 6, returns false for other modes
+bool TextureCompressor::DecodeBC7(const unsigned char* block, unsigned char* pixels) {
+    if ((block[0] & 0x7f) != 0x40) {
+        return false;
+    }
+
+    int position = 7;
+    int q0[4];
+    int q1[4];
+    for (int c = 0; c < 4; c++) {
+        q0[c] = (int)ReadBits(block, position, 7);
+        q1[c] = (int)ReadBits(block, position, 7);
+    }
+    int p0 = (int)ReadBits(block, position, 1);
+    int p1 = (int)ReadBits(block, position, 1);
+    for (int i = 0; i < 16; i++) {
+        int weight = BC7Weights[ReadBits(block, position, i == 0 ? 3 : 4)];
+        for (int c = 0; c < 4; c++) {
+            int u0 = (q0[c] << 1) | p0;
+            int u1 = (q1[c] << 1) | p1;
+            pixels[i * 4 + c] = (unsigned char)(((64 - weight) * u0 + weight * u1 + 32) >> 6);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,52 @@
+// textureCompressor.h - class for compressing images to BC formats on CPU and decoding them back for validation
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "ddsFile.h"
+#include "jobSystem.h"
+
+// Rows of 4x4 blocks compressed by one job
+#define TEXTURE_COMPRESSOR_GRAIN 4
+
+// Encoders take 4x4 blocks of RGBA8 pixels, blocks on right and bottom edges repeat last column and row.
+// BC1 and BC7 endpoints are fitted along principal axis of block colors and refined once by least squares,
+// BC4 and BC5 endpoints are channel range. BC7 blocks are written only in mode 6 (one subset, RGBA endpoints, 4-bit indices)
+class TextureCompressor {
+public:
+    // RGBA8 image with tightly packed rows
+    struct Image {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<unsigned char> pixels;
+    };
+
+    // Function to set job system compressing block rows in parallel, without it blocks are compressed on caller
+    void Init(JobSystem* jobSystem = nullptr) { m_pJobSystem = jobSystem; };
+    void Release() { m_pJobSystem = nullptr; };
+
+    // Function to compress image to BC1, BC3, BC4 (red), BC5 (red and green) or BC7, returns false for other formats
+    bool Compress(const Image& image, DdsFile::Format format, std::vector<unsigned char>& blocks) const;
+    // Function to compress every mip of 2D texture from DDS file and write them into new DDS file of given format
+    bool Convert(const DdsFile& file, DdsFile::Format format, const char* path) const;
+
+    // Function to decode BC1-BC5 or BC7 blocks to image, returns false for other formats and BC7 blocks not in mode 6.
+    // BC4 and BC5 give zero in missing color channels and opaque alpha as GPU does
+    static bool Decompress(const unsigned char* blocks, uint32_t width, uint32_t height, DdsFile::Format format, Image& image);
+    // Function to get mip of DDS file as image, RGBA8, BGRA8, BGRX8 and formats of Decompress are supported
+    static bool ReadImage(const DdsFile& file, int subresource, Image& image);
+    // Function to get peak signal to noise ratio in dB over channels set in mask (bit 0 - red), infinity for equal images
+    static double ComputePSNR(const Image& a, const Image& b, uint32_t channelsMask = 0xf);
+
+    // Block functions, pixels are 16 RGBA8 pixels of 4x4 block in row order.
+    // BC1 blocks get 3 colors and transparent black for pixels with alpha below 128, color blocks of BC3 always have 4 colors
+    static void EncodeBC1(const unsigned char* pixels, unsigned char* block, bool isBC1);
+    static void EncodeBC4(const unsigned char* pixels, int channel, unsigned char* block);
+    static void EncodeBC7(const unsigned char* pixels, unsigned char* block);
+    static void DecodeBC1(const unsigned char* block, unsigned char* pixels, bool isBC1);
+    static void DecodeBC4(const unsigned char* block, int channel, unsigned char* pixels);
+    static bool DecodeBC7(const unsigned char* block, unsigned char* pixels);
+
+private:
+    JobSystem* m_pJobSystem = nullptr;
+};
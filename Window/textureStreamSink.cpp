@@ -0,0 +1,94 @@
+#include <algorithm>
+#include "textureStreamSink.h"
+#include "utility.h"
+
+// Function to release views of all textures
+void D3D11TextureSink::Release() {
+    for (ID3D11ShaderResourceView*& view : m_views) {
+        SAFE_RELEASE(view);
+    }
+    m_views.clear();
+    m_pDevice = nullptr;
+}
+
+// Function to create texture of mips from firstMip to last one, old view is replaced only if new one is created
+bool D3D11TextureSink::SetResidency(int texture, const std::vector<const DdsFile*>& files, uint32_t firstMip) {
+    const DdsFile::Desc& desc = files[0]->GetDesc();
+    std::vector<D3D11_SUBRESOURCE_DATA> initData;
+    UINT arraySize = 0;
+    for (const DdsFile* file : files) {
+        const DdsFile::Desc& fileDesc = file->GetDesc();
+        for (uint32_t slice = 0; slice < fileDesc.arraySize; slice++) {
+            for (uint32_t mip = firstMip; mip < fileDesc.mipCount; mip++) {
+                int subresource = mip + slice * fileDesc.mipCount;
+                D3D11_SUBRESOURCE_DATA data;
+                data.pSysMem = file->GetSubresourceData(subresource);
+                data.SysMemPitch = fileDesc.subresources[subresource].rowPitch;
+                data.SysMemSlicePitch = fileDesc.subresources[subresource].slicePitch;
+                initData.push_back(data);
+            }
+        }
+        arraySize += fileDesc.arraySize;
+    }
+
+    D3D11_TEXTURE2D_DESC textureDesc;
+    textureDesc.Width = (std::max)(desc.width >> firstMip, 1u);
+    textureDesc.Height = (std::max)(desc.height >> firstMip, 1u);
+    textureDesc.MipLevels = desc.mipCount - firstMip;
+    textureDesc.ArraySize = arraySize;
+    textureDesc.Format = (DXGI_FORMAT)desc.format;
+    textureDesc.SampleDesc.Count = 1;
+    textureDesc.SampleDesc.Quality = 0;
+    textureDesc.Usage = D3D11_USAGE_IMMUTABLE;
+    textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    textureDesc.CPUAccessFlags = 0;
+    textureDesc.MiscFlags = desc.isCubeMap ? D3D11_RESOURCE_MISC_TEXTURECUBE : 0;
+
+    ID3D11Texture2D* resource = nullptr;
+    HRESULT hr = m_pDevice->CreateTexture2D(&textureDesc, initData.data(), &resource);
+    if (FAILED(hr)) {
+        return false;
+    }
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc = {};
+    viewDesc.Format = textureDesc.Format;
+    if (desc.isCubeMap) {
+        viewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBE;
+        viewDesc.TextureCube.MostDetailedMip = 0;
+        viewDesc.TextureCube.MipLevels = textureDesc.MipLevels;
+    }
+    else if (files.size() > 1 || arraySize > 1) {
+        viewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+        viewDesc.Texture2DArray.MostDetailedMip = 0;
+        viewDesc.Texture2DArray.MipLevels = textureDesc.MipLevels;
+        viewDesc.Texture2DArray.FirstArraySlice = 0;
+        viewDesc.Texture2DArray.ArraySize = arraySize;
+    }
+    else {
+        viewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+        viewDesc.Texture2D.MostDetailedMip = 0;
+        viewDesc.Texture2D.MipLevels = textureDesc.MipLevels;
+    }
+
+    ID3D11ShaderResourceView* view = nullptr;
+    hr = m_pDevice->CreateShaderResourceView(resource, &viewDesc, &view);
+    // View keeps texture alive
+    resource->Release();
+    if (FAILED(hr)) {
+        return false;
+    }
+
+    if (texture >= (int)m_views.size()) {
+        m_views.resize(texture + 1, nullptr);
+    }
+    SAFE_RELEASE(m_views[texture]);
+    m_views[texture] = view;
+    return true;
+}
+
+// Function to free texture
+void D3D11TextureSink::RemoveTexture(int texture) {
+    if (texture < (int)m_views.size()) {
+        SAFE_RELEASE(m_views[texture]);
+    }
+}
@@ -0,0 +1,26 @@
+// textureStreamSink.h - class for creating D3D11 textures of streamed mips
+#pragma once
+
+#include <d3d11.h>
+#include <vector>
+#include "textureStreamer.h"
+
+// Texture is created again with new mips range on every residency change, data is uploaded straight from mapped files
+class D3D11TextureSink : public TextureStreamer::Sink {
+public:
+    // Function to set device creating textures
+    void Init(ID3D11Device* device) { m_pDevice = device; };
+    // Function to release views of all textures
+    void Release();
+
+    bool SetResidency(int texture, const std::vector<const DdsFile*>& files, uint32_t firstMip) override;
+    void RemoveTexture(int texture) override;
+
+    // View of resident mips, it changes when mips are loaded or evicted so it is taken every frame. It is nullptr for id -1 of
+    // texture which failed to load
+    ID3D11ShaderResourceView* GetView(int texture) const { return texture >= 0 && texture < (int)m_views.size() ? m_views[texture] : nullptr; };
+
+private:
+    ID3D11Device* m_pDevice = nullptr;
+    std::vector<ID3D11ShaderResourceView*> m_views;
+};
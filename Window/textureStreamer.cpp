@@ -0,0 +1,334 @@
+#include "textureStreamer.h"
+#include <algorithm>
+#include <cmath>
+
+// Function to start I/O workers, budget includes mip tails
+void TextureStreamer::Init(Sink* sink, uint64_t budgetBytes, int workersCount) {
+    Release();
+    m_pSink = sink;
+    m_budget = budgetBytes;
+    m_isStopping = false;
+    // Workers mostly wait for disk, so they are separate from compute job system
+    for (int i = 0; i < (std::max)(1, workersCount); i++) {
+        m_workers.emplace_back(&TextureStreamer::WorkerLoop, this);
+    }
+}
+
+// Function to stop workers and remove all textures from sink
+void TextureStreamer::Release() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isStopping = true;
+    }
+    m_requestCondition.notify_all();
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+
+    if (m_pSink) {
+        for (int i = 0; i < (int)m_textures.size(); i++) {
+            m_pSink->RemoveTexture(i);
+        }
+    }
+    m_textures.clear();
+    m_requests.clear();
+    m_readRequests.clear();
+    m_readingCount = 0;
+    m_frame = 1;
+    m_stats = Stats();
+    m_pSink = nullptr;
+}
+
+// Function to add texture of array slices from files with same size, format and mips count, mip tail is resident on return.
+// Returns texture id or -1 if files can't be opened
+int TextureStreamer::AddTexture(const std::vector<std::string>& paths, bool isNormalMap) {
+    std::unique_ptr<Texture> texture(new Texture);
+    for (const std::string& path : paths) {
+        std::unique_ptr<DdsFile> file(new DdsFile);
+        if (!file->Open(path.c_str())) {
+            return -1;
+        }
+        GenerateMips(file, isNormalMap);
+
+        const DdsFile::Desc& desc = file->GetDesc();
+        const DdsFile::Desc& firstDesc = texture->files.empty() ? desc : texture->files[0]->GetDesc();
+        if (desc.dimension != DdsFile::DIMENSION_TEXTURE2D || desc.format != firstDesc.format || desc.width != firstDesc.width ||
+            desc.height != firstDesc.height || desc.mipCount != firstDesc.mipCount || desc.isCubeMap != firstDesc.isCubeMap) {
+            return -1;
+        }
+        texture->slicesCount += desc.arraySize;
+        texture->pFiles.push_back(file.get());
+        texture->files.push_back(std::move(file));
+    }
+    if (texture->files.empty()) {
+        return -1;
+    }
+
+    const DdsFile::Desc& desc = texture->files[0]->GetDesc();
+    texture->tailMip = GetTailMip(desc);
+    texture->residentMip = desc.mipCount;
+    texture->desiredMip = texture->tailMip;
+
+    int id = (int)m_textures.size();
+    m_textures.push_back(std::move(texture));
+    // Tail is small, it is read on caller so texture can be drawn right away
+    for (uint32_t mip = m_textures[id]->tailMip; mip < desc.mipCount; mip++) {
+        for (const DdsFile* file : m_textures[id]->pFiles) {
+            file->PrefetchMip(mip);
+        }
+    }
+    if (!SetResidency(id, m_textures[id]->tailMip)) {
+        m_textures.pop_back();
+        return -1;
+    }
+    return id;
+}
+
+// Function to replace 2D file without mips by file in memory with mip chain filtered on CPU, as RGBA8 of file's color space
+void TextureStreamer::GenerateMips(std::unique_ptr<DdsFile>& file, bool isNormalMap) {
+    const DdsFile::Desc& desc = file->GetDesc();
+    if (desc.mipCount > 1 || desc.dimension != DdsFile::DIMENSION_TEXTURE2D || desc.arraySize != 1 || (desc.width == 1 && desc.height == 1)) {
+        return;
+    }
+
+    MipGenerator generator;
+    MipGenerator::Options options;
+    options.isSRGB = DdsFile::IsSRGB(desc.format);
+    options.isNormalMap = isNormalMap;
+    TextureCompressor::Image image;
+    std::vector<TextureCompressor::Image> mips;
+    if (!TextureCompressor::ReadImage(*file, 0, image) || !generator.Generate(image, options, mips)) {
+        return;
+    }
+
+    std::vector<std::vector<unsigned char>> data(mips.size());
+    for (size_t i = 0; i < mips.size(); i++) {
+        data[i] = std::move(mips[i].pixels);
+    }
+    DdsFile::Format format = options.isSRGB ? DdsFile::FORMAT_R8G8B8A8_UNORM_SRGB : DdsFile::FORMAT_R8G8B8A8_UNORM;
+    std::vector<unsigned char> fileData;
+    std::unique_ptr<DdsFile> generated(new DdsFile);
+    if (DdsFile::Serialize(format, image.width, image.height, data, fileData) && generated->Load(std::move(fileData))) {
+        file = std::move(generated);
+    }
+}
+
+// Function to report use of texture in this frame, screenSize is largest size of it on screen in pixels
+void TextureStreamer::UseTexture(int texture, float screenSize, float distance) {
+    Texture& data = *m_textures[texture];
+    if (data.lastUsedFrame != m_frame) {
+        data.lastUsedFrame = m_frame;
+        data.screenSize = screenSize;
+        data.distance = distance;
+    }
+    else {
+        data.screenSize = (std::max)(data.screenSize, screenSize);
+        data.distance = (std::min)(data.distance, distance);
+    }
+}
+
+// Function to apply read mips, evict least recently used ones to fit budget and queue next mips, called once per frame
+void TextureStreamer::Update() {
+    // Usage reported since last update gives wanted mips and priorities
+    for (auto& texture : m_textures) {
+        if (texture->lastUsedFrame == m_frame) {
+            const DdsFile::Desc& desc = texture->files[0]->GetDesc();
+            texture->desiredMip = (std::min)(GetMipForScreenSize(desc, texture->screenSize), texture->tailMip);
+            texture->priority = texture->screenSize / (1.0f + (std::max)(0.0f, texture->distance));
+        }
+        else {
+            // Unused textures keep their mips until budget is needed, but don't get new ones
+            texture->desiredMip = texture->tailMip;
+            texture->priority = 0.0f;
+        }
+    }
+
+    std::vector<Request> readRequests;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        readRequests.swap(m_readRequests);
+    }
+
+    for (const Request& request : readRequests) {
+        Texture& texture = *m_textures[request.texture];
+        texture.isLoading = false;
+        // Texture may be not needed that fine anymore
+        if (request.mip >= texture.residentMip || request.mip < texture.desiredMip) {
+            continue;
+        }
+
+        const DdsFile::Desc& desc = texture.files[0]->GetDesc();
+        uint64_t needed = GetMipsSize(desc, request.mip, texture.slicesCount) - texture.residentBytes;
+        while (m_stats.residentBytes + needed > m_budget && EvictOne(request.texture)) {
+        }
+        if (m_stats.residentBytes + needed > m_budget) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stats.deferredLoads++;
+            continue;
+        }
+        uint32_t loadedMips = texture.residentMip - request.mip;
+        if (SetResidency(request.texture, request.mip)) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stats.loadedMips += loadedMips;
+        }
+    }
+
+    // Next finer mip of every texture which needs it, one at a time so texture gets sharper progressively
+    std::vector<Request> newRequests;
+    for (int i = 0; i < (int)m_textures.size(); i++) {
+        Texture& texture = *m_textures[i];
+        if (texture.isLoading || texture.residentMip <= texture.desiredMip) {
+            continue;
+        }
+
+        Request request;
+        request.texture = i;
+        request.mip = texture.residentMip - 1;
+        request.priority = texture.priority;
+        request.files = texture.pFiles;
+        texture.isLoading = true;
+        newRequests.push_back(request);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (Request& request : m_requests) {
+            request.priority = m_textures[request.texture]->priority;
+        }
+        m_requests.insert(m_requests.end(), newRequests.begin(), newRequests.end());
+        m_stats.pendingLoads = (int)m_requests.size() + m_readingCount;
+    }
+    if (!newRequests.empty()) {
+        m_requestCondition.notify_all();
+    }
+
+    m_frame++;
+}
+
+// Function to wait until workers read all queued mips, they still have to be applied by Update
+void TextureStreamer::WaitIdle() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idleCondition.wait(lock, [this]() { return (m_requests.empty() && m_readingCount == 0) || m_workers.empty(); });
+}
+
+TextureStreamer::Stats TextureStreamer::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats = m_stats;
+    stats.budgetBytes = m_budget;
+    return stats;
+}
+
+// Worker loop reading most important requested mips
+void TextureStreamer::WorkerLoop() {
+    while (true) {
+        Request request;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_requestCondition.wait(lock, [this]() { return m_isStopping || !m_requests.empty(); });
+            if (m_isStopping) {
+                return;
+            }
+
+            // Few textures are requested at once, so linear search is enough
+            auto it = std::max_element(m_requests.begin(), m_requests.end(),
+                [](const Request& a, const Request& b) { return a.priority < b.priority; });
+            request = std::move(*it);
+            m_requests.erase(it);
+            m_readingCount++;
+        }
+
+        for (const DdsFile* file : request.files) {
+            file->PrefetchMip(request.mip);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_readRequests.push_back(std::move(request));
+            m_readingCount--;
+        }
+        m_idleCondition.notify_all();
+    }
+}
+
+// Function to make texture mips resident through sink and count their bytes
+bool TextureStreamer::SetResidency(int texture, uint32_t firstMip) {
+    Texture& data = *m_textures[texture];
+    if (!m_pSink->SetResidency(texture, data.pFiles, firstMip)) {
+        return false;
+    }
+
+    uint64_t bytes = GetMipsSize(data.files[0]->GetDesc(), firstMip, data.slicesCount);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.residentBytes = m_stats.residentBytes - data.residentBytes + bytes;
+    }
+    data.residentMip = firstMip;
+    data.residentBytes = bytes;
+    return true;
+}
+
+// Function to drop finest mip of least recently used texture except given one, returns false if nothing can be evicted
+bool TextureStreamer::EvictOne(int exceptTexture) {
+    // Mips finer than needed go first, then mips of textures not used in last frame, least recently used first
+    int victim = -1;
+    for (int i = 0; i < (int)m_textures.size(); i++) {
+        const Texture& texture = *m_textures[i];
+        if (i == exceptTexture || texture.residentMip >= texture.tailMip) {
+            continue;
+        }
+        bool isExcess = texture.residentMip < texture.desiredMip;
+        if (!isExcess && texture.lastUsedFrame == m_frame) {
+            continue;
+        }
+
+        if (victim < 0) {
+            victim = i;
+            continue;
+        }
+        const Texture& best = *m_textures[victim];
+        bool isBestExcess = best.residentMip < best.desiredMip;
+        if (isExcess != isBestExcess ? isExcess : texture.lastUsedFrame < best.lastUsedFrame) {
+            victim = i;
+        }
+    }
+
+    if (victim < 0 || !SetResidency(victim, m_textures[victim]->residentMip + 1)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.evictedMips++;
+    return true;
+}
+
+// Function to get first mip which is not magnified at screen size
+uint32_t TextureStreamer::GetMipForScreenSize(const DdsFile::Desc& desc, float screenSize) {
+    uint32_t size = (std::max)(desc.width, desc.height);
+    if (screenSize < 1.0f) {
+        return desc.mipCount - 1;
+    }
+    if (screenSize >= (float)size) {
+        return 0;
+    }
+    uint32_t mip = (uint32_t)std::floor(std::log2((float)size / screenSize));
+    return (std::min)(mip, desc.mipCount - 1);
+}
+
+// Function to get first mip not larger than STREAMING_TAIL_SIZE, last mip if all are larger
+uint32_t TextureStreamer::GetTailMip(const DdsFile::Desc& desc) {
+    for (uint32_t mip = 0; mip < desc.mipCount; mip++) {
+        if ((std::max)(desc.width >> mip, desc.height >> mip) <= STREAMING_TAIL_SIZE) {
+            return mip;
+        }
+    }
+    return desc.mipCount - 1;
+}
+
+// Function to get bytes of mips from firstMip to last one of texture
+uint64_t TextureStreamer::GetMipsSize(const DdsFile::Desc& desc, uint32_t firstMip, uint32_t slicesCount) {
+    uint64_t size = 0;
+    for (uint32_t mip = firstMip; mip < desc.mipCount; mip++) {
+        size += desc.subresources[mip].size;
+    }
+    return size * slicesCount;
+}
@@ -0,0 +1,122 @@
+// textureStreamer.h - class for streaming texture mips in background under memory budget
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ddsFile.h"
+#include "mipGenerator.h"
+
+// Mips not larger than this are tail which is loaded on adding texture and never evicted
+#define STREAMING_TAIL_SIZE 64
+#define STREAMING_WORKERS 2
+
+// Texture starts with its mip tail resident and is refined one mip at a time towards mip its screen size needs.
+// I/O workers read mips of mapped files in, in order of priority, Update applies them through sink on calling thread.
+// Resident bytes stay under budget by evicting finest mips of least recently used textures
+class TextureStreamer {
+public:
+    // Receives residency changes on thread calling AddTexture and Update, for D3D11 it recreates texture with new mips range
+    class Sink {
+    public:
+        virtual ~Sink() = default;
+        // Function to make mips from firstMip to last one resident, files are array slices in order and have data of all mips
+        virtual bool SetResidency(int texture, const std::vector<const DdsFile*>& files, uint32_t firstMip) = 0;
+        // Function to free texture
+        virtual void RemoveTexture(int texture) = 0;
+    };
+
+    struct Stats {
+        uint64_t residentBytes = 0;
+        uint64_t budgetBytes = 0;
+        int pendingLoads = 0;
+        int loadedMips = 0;     // mips made resident since Init
+        int evictedMips = 0;
+        int deferredLoads = 0;  // read mips which didn't fit into budget
+    };
+
+    // Function to start I/O workers, budget includes mip tails
+    void Init(Sink* sink, uint64_t budgetBytes, int workersCount = STREAMING_WORKERS);
+    // Function to stop workers and remove all textures from sink
+    void Release();
+
+    // Function to add texture of array slices from files with same size, format and mips count, mip tail is resident on return.
+    // Files without mips get them generated on caller, normals of normal map are renormalized. Returns texture id or -1 if files can't be opened
+    int AddTexture(const std::vector<std::string>& paths, bool isNormalMap = false);
+    // Function to report use of texture in this frame, screenSize is largest size of it on screen in pixels
+    void UseTexture(int texture, float screenSize, float distance);
+    // Function to apply read mips, evict least recently used ones to fit budget and queue next mips, called once per frame
+    void Update();
+    // Function to wait until workers read all queued mips, they still have to be applied by Update
+    void WaitIdle();
+
+    void SetBudget(uint64_t budgetBytes) { m_budget = budgetBytes; };
+    uint32_t GetResidentMip(int texture) const { return m_textures[texture]->residentMip; };
+    uint32_t GetDesiredMip(int texture) const { return m_textures[texture]->desiredMip; };
+    uint32_t GetTailMip(int texture) const { return m_textures[texture]->tailMip; };
+    const DdsFile::Desc& GetDesc(int texture) const { return m_textures[texture]->files[0]->GetDesc(); };
+    Stats GetStats() const;
+
+    // Function to get first mip which is not magnified at screen size
+    static uint32_t GetMipForScreenSize(const DdsFile::Desc& desc, float screenSize);
+    // Function to get first mip not larger than STREAMING_TAIL_SIZE, last mip if all are larger
+    static uint32_t GetTailMip(const DdsFile::Desc& desc);
+    // Function to get bytes of mips from firstMip to last one of texture
+    static uint64_t GetMipsSize(const DdsFile::Desc& desc, uint32_t firstMip, uint32_t slicesCount);
+
+private:
+    struct Texture {
+        std::vector<std::unique_ptr<DdsFile>> files;
+        std::vector<const DdsFile*> pFiles;
+        uint32_t slicesCount = 0;
+        uint32_t tailMip = 0;
+        uint32_t residentMip = 0;
+        uint32_t desiredMip = 0;
+        uint64_t residentBytes = 0;
+        bool isLoading = false;
+        // Usage of current frame is accumulated, usage of last frame gives priority
+        float screenSize = 0.0f;
+        float distance = 0.0f;
+        float priority = 0.0f;
+        uint64_t lastUsedFrame = 0;  // 0 if never used
+    };
+
+    // Read of one mip of all slices, files are kept by texture until Release
+    struct Request {
+        int texture;
+        uint32_t mip;
+        float priority;
+        std::vector<const DdsFile*> files;
+    };
+
+    // Function to replace 2D file without mips by file in memory with mip chain filtered on CPU, as RGBA8 of file's color space.
+    // Files of formats generator can't read are kept as they are
+    static void GenerateMips(std::unique_ptr<DdsFile>& file, bool isNormalMap);
+    // Worker loop reading most important requested mips
+    void WorkerLoop();
+    // Function to make texture mips resident through sink and count their bytes
+    bool SetResidency(int texture, uint32_t firstMip);
+    // Function to drop finest mip of least recently used texture except given one, returns false if nothing can be evicted
+    bool EvictOne(int exceptTexture);
+
+    Sink* m_pSink = nullptr;
+    uint64_t m_budget = 0;
+    // Starts from 1 so lastUsedFrame of never used texture is not current frame
+    uint64_t m_frame = 1;
+    std::vector<std::unique_ptr<Texture>> m_textures;
+
+    std::vector<std::thread> m_workers;
+    // Guards requests, read mips and stats shared with workers
+    mutable std::mutex m_mutex;
+    std::condition_variable m_requestCondition;
+    std::condition_variable m_idleCondition;
+    std::vector<Request> m_requests;
+    std::vector<Request> m_readRequests;
+    int m_readingCount = 0;
+    bool m_isStopping = false;
+    Stats m_stats;
+};
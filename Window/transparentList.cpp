@@ -0,0 +1,117 @@
+#include "transparentList.h"
+#include <cstring>
+
+// Function to add object with world space center, returns its id
+int TransparentList::Add(const XMFLOAT3& center) {
+    int id = (int)m_centerX.size();
+    m_centerX.push_back(center.x);
+    m_centerY.push_back(center.y);
+    m_centerZ.push_back(center.z);
+    m_keys.push_back(0);
+    m_items.push_back((uint64_t)id);
+    m_order.push_back(id);
+    return id;
+}
+
+// Function to move object
+void TransparentList::SetCenter(int id, const XMFLOAT3& center) {
+    m_centerX[id] = center.x;
+    m_centerY[id] = center.y;
+    m_centerZ[id] = center.z;
+}
+
+// Function to remove all objects
+void TransparentList::Clear() {
+    m_centerX.clear();
+    m_centerY.clear();
+    m_centerZ.clear();
+    m_keys.clear();
+    m_items.clear();
+    m_order.clear();
+}
+
+// Function to map view depth to key which ascending order is back to front
+uint32_t TransparentList::DepthToKey(float depth) {
+    uint32_t bits;
+    memcpy(&bits, &depth, sizeof(bits));
+    // Usual float to sortable uint flip: negative floats invert all bits, positive ones only the sign
+    bits ^= (bits & 0x80000000u) ? 0xFFFFFFFFu : 0x80000000u;
+    // Invert again so farthest objects get smallest keys
+    return ~bits;
+}
+
+// Function to sort objects back to front by view space depth of their centers
+void TransparentList::Sort(FXMMATRIX viewMatrix) {
+    int count = GetCount();
+    if (count < 2)
+        return;
+
+    XMFLOAT4X4 view;
+    XMStoreFloat4x4(&view, viewMatrix);
+
+    // View space z is third column of row-major view matrix, computed in id order so loop vectorizes
+    const float* centerX = m_centerX.data();
+    const float* centerY = m_centerY.data();
+    const float* centerZ = m_centerZ.data();
+    uint32_t* keys = m_keys.data();
+    for (int i = 0; i < count; i++) {
+        keys[i] = DepthToKey(centerX[i] * view._13 + centerY[i] * view._23 + centerZ[i] * view._33 + view._43);
+    }
+
+    // Refresh keys in last frame order, while camera moves smoothly they are almost sorted already
+    bool sorted = true;
+    uint64_t prev = 0;
+    for (int i = 0; i < count; i++) {
+        uint32_t id = (uint32_t)m_items[i];
+        uint64_t item = ((uint64_t)keys[id] << 32) | id;
+        sorted = sorted && (prev >> 32) <= (item >> 32);
+        m_items[i] = prev = item;
+    }
+
+    if (!sorted) {
+        RadixSort();
+        for (int i = 0; i < count; i++) {
+            m_order[i] = (int)(uint32_t)m_items[i];
+        }
+    }
+}
+
+// Function to sort m_items by LSD radix sort on keys, stable so equal depths keep previous order
+void TransparentList::RadixSort() {
+    int count = (int)m_items.size();
+    m_tempItems.resize(count);
+
+    // Histograms of all passes in one read of keys
+    int histogram[RadixPasses][RadixSize] = {};
+    for (int i = 0; i < count; i++) {
+        uint32_t key = (uint32_t)(m_items[i] >> 32);
+        for (int pass = 0; pass < RadixPasses; pass++) {
+            histogram[pass][(key >> (pass * RadixBits)) & (RadixSize - 1)]++;
+        }
+    }
+
+    for (int pass = 0; pass < RadixPasses; pass++) {
+        int* counts = histogram[pass];
+        int shift = 32 + pass * RadixBits;
+
+        // All keys have same digit, pass would not change order
+        if (counts[(m_items[0] >> shift) & (RadixSize - 1)] == count)
+            continue;
+
+        int offset = 0;
+        for (int digit = 0; digit < RadixSize; digit++) {
+            int digitCount = counts[digit];
+            counts[digit] = offset;
+            offset += digitCount;
+        }
+
+        const uint64_t* src = m_items.data();
+        uint64_t* dst = m_tempItems.data();
+        for (int i = 0; i < count; i++) {
+            uint64_t item = src[i];
+            dst[counts[(item >> shift) & (RadixSize - 1)]++] = item;
+        }
+
+        m_items.swap(m_tempItems);
+    }
+}
@@ -0,0 +1,50 @@
+// transparentList.h - class for sorting transparent objects back to front by view space depth
+#pragma once
+
+#include <directxmath.h>
+#include <cstdint>
+#include <vector>
+#include "alignedAllocator.h"
+
+using namespace DirectX;
+
+class TransparentList {
+public:
+    // Release function
+    void Release() { Clear(); };
+
+    // Function to add object with world space center, returns its id
+    int Add(const XMFLOAT3& center);
+    // Function to move object
+    void SetCenter(int id, const XMFLOAT3& center);
+    // Function to remove all objects
+    void Clear();
+    // Function to sort objects back to front by view space depth of their centers
+    void Sort(FXMMATRIX viewMatrix);
+
+    int GetCount() const { return (int)m_centerX.size(); };
+    // Object ids from farthest to nearest
+    const std::vector<int>& GetOrder() const { return m_order; };
+
+private:
+    // Radix sort digits
+    static const int RadixBits = 11;
+    static const int RadixSize = 1 << RadixBits;
+    static const int RadixPasses = (32 + RadixBits - 1) / RadixBits;
+
+    // Function to map view depth to key which ascending order is back to front
+    static uint32_t DepthToKey(float depth);
+    // Function to sort m_items by LSD radix sort on keys, stable so equal depths keep previous order
+    void RadixSort();
+
+    AlignedVector<float> m_centerX;
+    AlignedVector<float> m_centerY;
+    AlignedVector<float> m_centerZ;
+    // Depth keys indexed by object id
+    AlignedVector<uint32_t> m_keys;
+
+    // Key in high half and object id in low half, kept in order of last sort as starting sequence of next one
+    std::vector<uint64_t> m_items;
+    std::vector<uint64_t> m_tempItems;
+    std::vector<int> m_order;
+};
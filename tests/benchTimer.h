@@ -0,0 +1,23 @@
+// benchTimer.h - helpers timing benchmark loops
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+
+// Function to run func repeats times, returns best time of one run in milliseconds
+template <typename Func>
+double MeasureBest(int repeats, Func func) {
+    double best = 1e30;
+    for (int i = 0; i < repeats; i++) {
+        auto start = std::chrono::steady_clock::now();
+        func();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        best = ms < best ? ms : best;
+    }
+    return best;
+}
+
+// Function to print one benchmark result with time per item
+inline void PrintResult(const char* name, double ms, size_t items) {
+    printf("%-40s %10.3f ms %10.2f ns/item\n", name, ms, items ? ms * 1e6 / (double)items : 0.0);
+}
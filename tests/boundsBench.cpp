@@ -0,0 +1,58 @@
+// boundsBench.cpp - world boxes from 8 transformed corners against closed form at 1k, 100k and 1M instances
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "benchTimer.h"
+#include "bounds.h"
+
+int main() {
+    const int counts[] = { 1000, 100000, 1000000 };
+    XMVECTOR localMin = XMVectorSet(-0.5f, -0.5f, -0.5f, 1.0f);
+    XMVECTOR localMax = XMVectorSet(0.5f, 0.5f, 0.5f, 1.0f);
+    bool isValid = true;
+    for (int count : counts) {
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        std::vector<XMMATRIX> worlds(count);
+        for (int i = 0; i < count; i++) {
+            worlds[i] = XMMatrixRotationY(unit(rng) * XM_PI) * XMMatrixTranslation(unit(rng) * 50.0f, unit(rng) * 50.0f, unit(rng) * 50.0f);
+        }
+        AABBSoA boxes;
+        boxes.Resize(count);
+
+        // Small sets are repeated more so their times are above timer resolution
+        int repeats = count < 100000 ? 50 : 5;
+        double corners = MeasureBest(repeats, [&]() {
+            for (int i = 0; i < count; i++) {
+                XMVECTOR min = XMVectorReplicate(1e30f), max = XMVectorReplicate(-1e30f);
+                for (int c = 0; c < 8; c++) {
+                    XMVECTOR corner = XMVectorSet(c & 1 ? 0.5f : -0.5f, c & 2 ? 0.5f : -0.5f, c & 4 ? 0.5f : -0.5f, 1.0f);
+                    XMVECTOR p = XMVector3Transform(corner, worlds[i]);
+                    min = XMVectorMin(min, p);
+                    max = XMVectorMax(max, p);
+                }
+                boxes.minX[i] = XMVectorGetX(min);
+                boxes.minY[i] = XMVectorGetY(min);
+                boxes.minZ[i] = XMVectorGetZ(min);
+                boxes.maxX[i] = XMVectorGetX(max);
+                boxes.maxY[i] = XMVectorGetY(max);
+                boxes.maxZ[i] = XMVectorGetZ(max);
+            }
+        });
+        float check = boxes.maxX[count / 2];
+        double closed = MeasureBest(repeats, [&]() {
+            for (int i = 0; i < count; i++) {
+                TransformBox(worlds[i], localMin, localMax, boxes, i);
+            }
+        });
+
+        std::string suffix = " x" + std::to_string(count);
+        PrintResult(("8 transformed corners" + suffix).c_str(), corners, count);
+        PrintResult(("TransformBox closed form" + suffix).c_str(), closed, count);
+        printf("speedup %.2fx\n", corners / closed);
+        isValid = isValid && fabsf(check - boxes.maxX[count / 2]) < 1e-3f;
+    }
+    return isValid ? 0 : 1;
+}
@@ -0,0 +1,58 @@
+// boundsTest.cpp - closed form world box against transformed corners
+#include <gtest/gtest.h>
+#include <random>
+#include "bounds.h"
+
+namespace {
+    // Function to get box of 8 transformed corners of local box
+    void TransformCorners(FXMMATRIX world, const XMFLOAT3& localMin, const XMFLOAT3& localMax, XMFLOAT3& min, XMFLOAT3& max) {
+        min = XMFLOAT3(1e30f, 1e30f, 1e30f);
+        max = XMFLOAT3(-1e30f, -1e30f, -1e30f);
+        for (int i = 0; i < 8; i++) {
+            XMVECTOR corner = XMVectorSet(i & 1 ? localMax.x : localMin.x, i & 2 ? localMax.y : localMin.y, i & 4 ? localMax.z : localMin.z, 1.0f);
+            XMFLOAT3 p;
+            XMStoreFloat3(&p, XMVector3Transform(corner, world));
+            min = XMFLOAT3((std::min)(min.x, p.x), (std::min)(min.y, p.y), (std::min)(min.z, p.z));
+            max = XMFLOAT3((std::max)(max.x, p.x), (std::max)(max.y, p.y), (std::max)(max.z, p.z));
+        }
+    }
+}
+
+TEST(Bounds, TransformBoxMatchesCorners) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    AABBSoA boxes;
+    boxes.Resize(1);
+
+    for (int i = 0; i < 1000; i++) {
+        XMFLOAT3 localMin(unit(rng) - 1.0f, unit(rng) - 1.0f, unit(rng) - 1.0f);
+        XMFLOAT3 localMax(unit(rng) + 1.0f, unit(rng) + 1.0f, unit(rng) + 1.0f);
+        XMMATRIX world = XMMatrixScaling(1.0f + unit(rng) * 0.5f, 1.0f + unit(rng) * 0.5f, 1.0f + unit(rng) * 0.5f) *
+            XMMatrixRotationX(unit(rng) * XM_PI) * XMMatrixRotationY(unit(rng) * XM_PI) * XMMatrixRotationZ(unit(rng) * XM_PI) *
+            XMMatrixTranslation(unit(rng) * 100.0f, unit(rng) * 100.0f, unit(rng) * 100.0f);
+
+        TransformBox(world, XMLoadFloat3(&localMin), XMLoadFloat3(&localMax), boxes, 0);
+        XMFLOAT3 min, max;
+        TransformCorners(world, localMin, localMax, min, max);
+        EXPECT_NEAR(boxes.minX[0], min.x, 1e-3f);
+        EXPECT_NEAR(boxes.minY[0], min.y, 1e-3f);
+        EXPECT_NEAR(boxes.minZ[0], min.z, 1e-3f);
+        EXPECT_NEAR(boxes.maxX[0], max.x, 1e-3f);
+        EXPECT_NEAR(boxes.maxY[0], max.y, 1e-3f);
+        EXPECT_NEAR(boxes.maxZ[0], max.z, 1e-3f);
+    }
+}
+
+TEST(Bounds, ResizeAndCopy) {
+    AABBSoA boxes;
+    boxes.Resize(3);
+    EXPECT_EQ(boxes.Size(), 3u);
+    TransformBox(XMMatrixTranslation(1.0f, 2.0f, 3.0f), XMVectorSet(-1.0f, -1.0f, -1.0f, 1.0f), XMVectorSet(1.0f, 1.0f, 1.0f, 1.0f), boxes, 0);
+    boxes.Copy(0, 2);
+    EXPECT_FLOAT_EQ(boxes.minX[2], 0.0f);
+    EXPECT_FLOAT_EQ(boxes.minY[2], 1.0f);
+    EXPECT_FLOAT_EQ(boxes.minZ[2], 2.0f);
+    EXPECT_FLOAT_EQ(boxes.maxX[2], 2.0f);
+    EXPECT_FLOAT_EQ(boxes.maxY[2], 3.0f);
+    EXPECT_FLOAT_EQ(boxes.maxZ[2], 4.0f);
+}
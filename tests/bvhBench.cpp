@@ -0,0 +1,50 @@
+// bvhBench.cpp - hierarchy build, refit and culling against batch culling of every box
+#include <random>
+#include "benchTimer.h"
+#include "bvh.h"
+#include "frustum.h"
+
+int main() {
+    const int count = 1000000;
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> pos(-500.0f, 500.0f);
+    AABBSoA boxes;
+    boxes.Resize(count);
+    for (int i = 0; i < count; i++) {
+        float x = pos(rng), y = pos(rng), z = pos(rng);
+        boxes.minX[i] = x - 0.5f;
+        boxes.minY[i] = y - 0.5f;
+        boxes.minZ[i] = z - 0.5f;
+        boxes.maxX[i] = x + 0.5f;
+        boxes.maxY[i] = y + 0.5f;
+        boxes.maxZ[i] = z + 0.5f;
+    }
+
+    BVH bvh;
+    double build = MeasureBest(1, [&]() { bvh.Build(boxes); });
+    double refit = MeasureBest(3, [&]() { bvh.Refit(boxes); });
+
+    Frustum frustum;
+    frustum.Init(100.0f);
+    XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.0f, 0.0f, -50.0f, 0.0f), XMVectorSet(0.0f, 0.0f, 0.0f, 0.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+    frustum.ConstructFrustum(view, XMMatrixPerspectiveFovLH(XM_PI / 3, 16.0f / 9.0f, 0.1f, 100.0f));
+
+    std::vector<int> visible;
+    visible.reserve(count);
+    double batch = MeasureBest(5, [&]() {
+        visible.clear();
+        frustum.CheckRectangles(boxes, 0, count, visible);
+    });
+    size_t batchVisible = visible.size();
+    double hierarchical = MeasureBest(5, [&]() {
+        visible.clear();
+        frustum.CheckBVH(bvh, boxes, visible);
+    });
+
+    PrintResult("BVH::Build", build, count);
+    PrintResult("BVH::Refit", refit, count);
+    PrintResult("CheckRectangles every box", batch, count);
+    PrintResult("CheckBVH", hierarchical, count);
+    printf("visible %zu / %zu, speedup %.2fx\n", visible.size(), batchVisible, batch / hierarchical);
+    return visible.size() == batchVisible ? 0 : 1;
+}
@@ -0,0 +1,127 @@
+// bvhTest.cpp - hierarchy structure, refit and hierarchical culling against batch culling
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include "bvh.h"
+#include "frustum.h"
+
+namespace {
+    void FillBoxes(AABBSoA& boxes, int count, float range, unsigned seed) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> pos(-range, range);
+        boxes.Resize(count);
+        for (int i = 0; i < count; i++) {
+            float x = pos(rng), y = pos(rng), z = pos(rng);
+            boxes.minX[i] = x - 0.5f;
+            boxes.minY[i] = y - 0.5f;
+            boxes.minZ[i] = z - 0.5f;
+            boxes.maxX[i] = x + 0.5f;
+            boxes.maxY[i] = y + 0.5f;
+            boxes.maxZ[i] = z + 0.5f;
+        }
+    }
+
+    // Function to check node contains all primitives of its subtree and children partition its range
+    void CheckNode(const BVH& bvh, const AABBSoA& boxes, int nodeIdx) {
+        const BVH::Node& node = bvh.GetNodes()[nodeIdx];
+        const std::vector<int>& indices = bvh.GetIndices();
+        for (int i = node.first; i < node.first + node.count; i++) {
+            int idx = indices[i];
+            ASSERT_LE(node.bbMin.x, boxes.minX[idx]);
+            ASSERT_LE(node.bbMin.y, boxes.minY[idx]);
+            ASSERT_LE(node.bbMin.z, boxes.minZ[idx]);
+            ASSERT_GE(node.bbMax.x, boxes.maxX[idx]);
+            ASSERT_GE(node.bbMax.y, boxes.maxY[idx]);
+            ASSERT_GE(node.bbMax.z, boxes.maxZ[idx]);
+        }
+        if (node.left >= 0) {
+            const BVH::Node& left = bvh.GetNodes()[node.left];
+            const BVH::Node& right = bvh.GetNodes()[node.left + 1];
+            ASSERT_EQ(left.first, node.first);
+            ASSERT_EQ(right.first, left.first + left.count);
+            ASSERT_EQ(left.count + right.count, node.count);
+            CheckNode(bvh, boxes, node.left);
+            CheckNode(bvh, boxes, node.left + 1);
+        }
+    }
+}
+
+TEST(BVH, BuildCoversEveryPrimitiveOnce) {
+    AABBSoA boxes;
+    FillBoxes(boxes, 5000, 100.0f, 1);
+    BVH bvh;
+    bvh.Build(boxes);
+
+    ASSERT_EQ(bvh.GetPrimitiveCount(), 5000);
+    std::vector<int> indices = bvh.GetIndices();
+    std::sort(indices.begin(), indices.end());
+    for (int i = 0; i < 5000; i++) {
+        ASSERT_EQ(indices[i], i);
+    }
+    EXPECT_GT(bvh.GetNodes().size(), 1u);
+    CheckNode(bvh, boxes, 0);
+}
+
+TEST(BVH, RefitKeepsBoundsAfterMoves) {
+    AABBSoA boxes;
+    FillBoxes(boxes, 3000, 50.0f, 2);
+    BVH bvh;
+    bvh.Build(boxes);
+    size_t nodesCount = bvh.GetNodes().size();
+
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> move(-5.0f, 5.0f);
+    for (size_t i = 0; i < boxes.Size(); i++) {
+        float dx = move(rng), dy = move(rng), dz = move(rng);
+        boxes.minX[i] += dx;
+        boxes.maxX[i] += dx;
+        boxes.minY[i] += dy;
+        boxes.maxY[i] += dy;
+        boxes.minZ[i] += dz;
+        boxes.maxZ[i] += dz;
+    }
+    bvh.Refit(boxes);
+
+    EXPECT_EQ(bvh.GetNodes().size(), nodesCount);
+    CheckNode(bvh, boxes, 0);
+}
+
+TEST(BVH, HierarchicalCullingMatchesBatch) {
+    AABBSoA boxes;
+    FillBoxes(boxes, 20000, 100.0f, 4);
+    BVH bvh;
+    bvh.Build(boxes);
+    Frustum frustum;
+    frustum.Init(100.0f);
+
+    for (int v = 0; v < 4; v++) {
+        XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(3.0f + v * 10.0f, 2.0f, -4.0f, 0.0f), XMVectorSet((float)v, 0.0f, v * 3.0f, 0.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+        frustum.ConstructFrustum(view, XMMatrixPerspectiveFovLH(XM_PIDIV2, 1.7f, 0.1f, 100.0f));
+
+        std::vector<int> batch, hierarchical;
+        frustum.CheckRectangles(boxes, 0, (int)boxes.Size(), batch);
+        frustum.CheckBVH(bvh, boxes, hierarchical);
+        std::sort(hierarchical.begin(), hierarchical.end());
+        EXPECT_EQ(hierarchical, batch) << "view " << v;
+
+        for (size_t i = 0; i < boxes.Size(); i++) {
+            boxes.minX[i] += 0.3f;
+            boxes.maxX[i] += 0.3f;
+        }
+        bvh.Refit(boxes);
+    }
+}
+
+TEST(BVH, EmptyHierarchy) {
+    AABBSoA boxes;
+    BVH bvh;
+    bvh.Build(boxes);
+    EXPECT_EQ(bvh.GetPrimitiveCount(), 0);
+
+    Frustum frustum;
+    frustum.Init(100.0f);
+    frustum.ConstructFrustum(XMMatrixIdentity(), XMMatrixPerspectiveFovLH(XM_PIDIV2, 1.0f, 0.1f, 100.0f));
+    std::vector<int> visible;
+    frustum.CheckBVH(bvh, boxes, visible);
+    EXPECT_TRUE(visible.empty());
+}
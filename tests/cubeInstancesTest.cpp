@@ -0,0 +1,131 @@
+// cubeInstancesTest.cpp - component streams and stable handles of cube instances
+#include <gtest/gtest.h>
+#include "cubeInstances.h"
+
+namespace {
+    CubeInstances::CubeModel MakeCube(float x, float direction = 0.0f, float speed = 0.0f) {
+        CubeInstances::CubeModel cube;
+        cube.pos = XMFLOAT4(x, 0.0f, 0.0f, direction);
+        cube.shineSpeedIdNM = XMFLOAT4(300.0f, speed, 0.0f, 1.0f);
+        return cube;
+    }
+}
+
+TEST(CubeInstances, AddFillsStreams) {
+    CubeInstances instances;
+    instances.Init(4);
+    CubeInstances::Handle a = instances.Add(MakeCube(1.0f));
+    CubeInstances::Handle b = instances.Add(MakeCube(2.0f, -1.0f, 3.0f));
+
+    ASSERT_EQ(instances.GetCount(), 2);
+    EXPECT_EQ(instances.GetIndex(a), 0);
+    EXPECT_EQ(instances.GetIndex(b), 1);
+    EXPECT_EQ(instances.GetPositionsX()[1], 2.0f);
+    EXPECT_EQ(instances.GetAngularSpeeds()[1], -3.0f);
+    EXPECT_EQ(instances.GetMaterials()[1].y, 3.0f);
+    EXPECT_EQ(instances.GetGeomBuffers().size(), 2u);
+    EXPECT_EQ(instances.GetCullBoxes().size(), 2u);
+    instances.Release();
+}
+
+TEST(CubeInstances, StreamsAreCacheLineAligned) {
+    CubeInstances instances;
+    instances.Init(0);
+    for (int i = 0; i < 37; i++) {
+        instances.Add(MakeCube((float)i));
+    }
+    EXPECT_EQ((uintptr_t)instances.GetPositionsX().data() % CACHE_LINE_SIZE, 0u);
+    EXPECT_EQ((uintptr_t)instances.GetPositionsY().data() % CACHE_LINE_SIZE, 0u);
+    EXPECT_EQ((uintptr_t)instances.GetPositionsZ().data() % CACHE_LINE_SIZE, 0u);
+    EXPECT_EQ((uintptr_t)instances.GetAngularSpeeds().data() % CACHE_LINE_SIZE, 0u);
+    EXPECT_EQ((uintptr_t)instances.GetMaterials().data() % CACHE_LINE_SIZE, 0u);
+    instances.Release();
+}
+
+TEST(CubeInstances, RemoveKeepsOtherHandles) {
+    CubeInstances instances;
+    instances.Init(0);
+    std::vector<CubeInstances::Handle> handles;
+    for (int i = 0; i < 10; i++) {
+        handles.push_back(instances.Add(MakeCube((float)i)));
+    }
+
+    // Last cube moves into removed one's place, its handle follows it
+    EXPECT_TRUE(instances.Remove(handles[3]));
+    EXPECT_FALSE(instances.IsValid(handles[3]));
+    EXPECT_FALSE(instances.Remove(handles[3]));
+    EXPECT_EQ(instances.GetCount(), 9);
+    EXPECT_EQ(instances.GetIndex(handles[9]), 3);
+    EXPECT_EQ(instances.GetPositionsX()[3], 9.0f);
+    for (int i = 0; i < 10; i++) {
+        if (i != 3) {
+            int index = instances.GetIndex(handles[i]);
+            ASSERT_GE(index, 0);
+            EXPECT_EQ(instances.GetPositionsX()[index], (float)i);
+        }
+    }
+
+    // Removing last cube moves nothing
+    EXPECT_TRUE(instances.Remove(handles[8]));
+    EXPECT_EQ(instances.GetIndex(handles[9]), 3);
+    EXPECT_EQ(instances.GetCount(), 8);
+    instances.Release();
+}
+
+TEST(CubeInstances, FreedSlotIsReusedWithNewGeneration) {
+    CubeInstances instances;
+    instances.Init(0);
+    CubeInstances::Handle a = instances.Add(MakeCube(1.0f));
+    instances.Add(MakeCube(2.0f));
+    instances.Remove(a);
+
+    CubeInstances::Handle c = instances.Add(MakeCube(3.0f));
+    EXPECT_EQ(c.slot, a.slot);
+    EXPECT_NE(c.generation, a.generation);
+    EXPECT_FALSE(instances.IsValid(a));
+    EXPECT_TRUE(instances.IsValid(c));
+    EXPECT_EQ(instances.GetPositionsX()[instances.GetIndex(c)], 3.0f);
+
+    CubeInstances::Handle fromIndex = instances.GetHandle(instances.GetIndex(c));
+    EXPECT_EQ(fromIndex.slot, c.slot);
+    EXPECT_EQ(fromIndex.generation, c.generation);
+    EXPECT_FALSE(instances.IsValid(instances.GetHandle(5)));
+    instances.Release();
+}
+
+TEST(CubeInstances, BulkAddAfterRemoveReusesSlots) {
+    CubeInstances instances;
+    instances.Init(0);
+    CubeInstances::Handle a = instances.Add(MakeCube(1.0f));
+    instances.Add(MakeCube(2.0f));
+    instances.Remove(a);
+
+    float posX[3] = { 10.0f, 11.0f, 12.0f };
+    float zeros[3] = { 0.0f, 0.0f, 0.0f };
+    XMFLOAT4 materials[3] = { XMFLOAT4(1.0f, 0.0f, 0.0f, 0.0f), XMFLOAT4(2.0f, 0.0f, 0.0f, 0.0f), XMFLOAT4(3.0f, 0.0f, 0.0f, 0.0f) };
+    instances.Add(3, posX, zeros, zeros, zeros, materials);
+
+    ASSERT_EQ(instances.GetCount(), 4);
+    for (int i = 0; i < 4; i++) {
+        CubeInstances::Handle handle = instances.GetHandle(i);
+        EXPECT_TRUE(instances.IsValid(handle));
+        EXPECT_EQ(instances.GetIndex(handle), i);
+    }
+    EXPECT_EQ(instances.GetPositionsX()[3], 12.0f);
+    instances.Release();
+}
+
+TEST(CubeInstances, UpdateComputesBoundsAroundPositions) {
+    CubeInstances instances;
+    instances.Init(0);
+    instances.Add(MakeCube(5.0f));
+    instances.Update(0.0f);
+
+    const CubeInstances::CullBox& box = instances.GetCullBoxes()[0];
+    EXPECT_NEAR(box.bbMin.x, 4.5f, 1e-5f);
+    EXPECT_NEAR(box.bbMax.x, 5.5f, 1e-5f);
+    EXPECT_NEAR(box.bbMin.y, -0.5f, 1e-5f);
+    EXPECT_NEAR(box.bbMax.z, 0.5f, 1e-5f);
+
+    instances.Release();
+}
@@ -0,0 +1,347 @@
+// ddsFileTest.cpp - parsing of DDS headers, subresource layout and rejection of broken files
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <utility>
+#include "ddsFile.h"
+#include "testPath.h"
+
+namespace {
+    // Function to build file of given headers followed by dataSize zero bytes
+    std::vector<unsigned char> MakeFile(const DdsFile::Header& header, const DdsFile::HeaderDx10* headerDx10, size_t dataSize) {
+        std::vector<unsigned char> data(sizeof(uint32_t) + sizeof(DdsFile::Header) + (headerDx10 ? sizeof(DdsFile::HeaderDx10) : 0) + dataSize);
+        uint32_t magic = DDS_FILE_MAGIC;
+        memcpy(data.data(), &magic, sizeof(magic));
+        memcpy(data.data() + sizeof(magic), &header, sizeof(header));
+        if (headerDx10) {
+            memcpy(data.data() + sizeof(magic) + sizeof(header), headerDx10, sizeof(*headerDx10));
+        }
+        return data;
+    }
+
+    DdsFile::Header MakeHeader(uint32_t width, uint32_t height, uint32_t mipCount) {
+        DdsFile::Header header = {};
+        header.size = sizeof(DdsFile::Header);
+        header.flags = DdsFile::FLAG_CAPS | DdsFile::FLAG_HEIGHT | DdsFile::FLAG_WIDTH | DdsFile::FLAG_PIXELFORMAT | DdsFile::FLAG_MIPMAPCOUNT;
+        header.width = width;
+        header.height = height;
+        header.mipMapCount = mipCount;
+        header.ddspf.size = sizeof(DdsFile::PixelFormat);
+        header.caps = DdsFile::CAPS_TEXTURE;
+        return header;
+    }
+
+    DdsFile::Header MakeDx10Header(uint32_t width, uint32_t height, uint32_t mipCount) {
+        DdsFile::Header header = MakeHeader(width, height, mipCount);
+        header.ddspf.flags = DdsFile::PIXEL_FOURCC;
+        header.ddspf.fourCC = DDS_FILE_FOURCC('D', 'X', '1', '0');
+        return header;
+    }
+
+    DdsFile::HeaderDx10 MakeHeaderDx10(DdsFile::Format format, DdsFile::Dimension dimension, uint32_t arraySize) {
+        DdsFile::HeaderDx10 headerDx10 = {};
+        headerDx10.dxgiFormat = format;
+        headerDx10.resourceDimension = dimension;
+        headerDx10.arraySize = arraySize;
+        return headerDx10;
+    }
+
+    // Function to get mips of 2D texture filled with byte pattern
+    std::vector<std::vector<unsigned char>> MakeMips(DdsFile::Format format, uint32_t width, uint32_t height, uint32_t count) {
+        std::vector<std::vector<unsigned char>> mips;
+        for (uint32_t mip = 0; mip < count; mip++) {
+            uint32_t rowPitch = 0;
+            uint32_t slicePitch = 0;
+            DdsFile::GetSurfaceInfo(format, width, height, rowPitch, slicePitch);
+            mips.emplace_back(slicePitch, (unsigned char)(mip + 1));
+            width = (std::max)(1u, width / 2);
+            height = (std::max)(1u, height / 2);
+        }
+        return mips;
+    }
+
+    // Function to check that subresources follow each other inside file
+    void ExpectPackedSubresources(const DdsFile::Desc& desc, size_t size) {
+        ASSERT_EQ(desc.subresources.size(), (size_t)desc.mipCount * desc.arraySize);
+        uint64_t offset = desc.dataOffset;
+        for (const DdsFile::Subresource& subresource : desc.subresources) {
+            EXPECT_EQ(subresource.offset, offset);
+            EXPECT_EQ(subresource.size, (uint64_t)subresource.slicePitch * subresource.depth);
+            EXPECT_GT(subresource.size, 0u);
+            offset += subresource.size;
+        }
+        EXPECT_LE(offset, size);
+    }
+}
+
+TEST(DdsFile, SurfaceInfoOfPixelAndBlockFormats) {
+    uint32_t rowPitch = 0;
+    uint32_t slicePitch = 0;
+    uint32_t rows = 0;
+    ASSERT_TRUE(DdsFile::GetSurfaceInfo(DdsFile::FORMAT_R8G8B8A8_UNORM, 5, 3, rowPitch, slicePitch, &rows));
+    EXPECT_EQ(rowPitch, 20u);
+    EXPECT_EQ(slicePitch, 60u);
+    EXPECT_EQ(rows, 3u);
+
+    // Mips smaller than block still take whole block
+    ASSERT_TRUE(DdsFile::GetSurfaceInfo(DdsFile::FORMAT_BC1_UNORM, 1, 1, rowPitch, slicePitch, &rows));
+    EXPECT_EQ(rowPitch, 8u);
+    EXPECT_EQ(slicePitch, 8u);
+    EXPECT_EQ(rows, 1u);
+    ASSERT_TRUE(DdsFile::GetSurfaceInfo(DdsFile::FORMAT_BC7_UNORM, 10, 6, rowPitch, slicePitch, &rows));
+    EXPECT_EQ(rowPitch, 48u);
+    EXPECT_EQ(slicePitch, 96u);
+    EXPECT_EQ(rows, 2u);
+
+    EXPECT_FALSE(DdsFile::GetSurfaceInfo(DdsFile::FORMAT_UNKNOWN, 4, 4, rowPitch, slicePitch));
+}
+
+TEST(DdsFile, SurfaceInfoRejectsSliceOver4GB) {
+    uint32_t rowPitch = 0;
+    uint32_t slicePitch = 0;
+    // 16384 * 16384 * 16 bytes is exactly 4 GB
+    EXPECT_FALSE(DdsFile::GetSurfaceInfo(DdsFile::FORMAT_R32G32B32A32_FLOAT, 16384, 16384, rowPitch, slicePitch));
+    ASSERT_TRUE(DdsFile::GetSurfaceInfo(DdsFile::FORMAT_R32G32B32A32_FLOAT, 16384, 8192, rowPitch, slicePitch));
+    EXPECT_EQ(rowPitch, 262144u);
+    EXPECT_EQ(slicePitch, 2147483648u);
+    EXPECT_FALSE(DdsFile::GetSurfaceInfo(DdsFile::FORMAT_R8_UNORM, UINT32_MAX, 2, rowPitch, slicePitch));
+}
+
+TEST(DdsFile, MaxMipCount) {
+    EXPECT_EQ(DdsFile::GetMaxMipCount(1, 1), 1u);
+    EXPECT_EQ(DdsFile::GetMaxMipCount(4, 4), 3u);
+    EXPECT_EQ(DdsFile::GetMaxMipCount(5, 1), 3u);
+    EXPECT_EQ(DdsFile::GetMaxMipCount(1, 1024), 11u);
+    EXPECT_EQ(DdsFile::GetMaxMipCount(16, 16, 64), 7u);
+    EXPECT_EQ(DdsFile::GetMaxMipCount(DDS_FILE_MAX_SIZE, DDS_FILE_MAX_SIZE), (uint32_t)DDS_FILE_MAX_MIPS);
+}
+
+TEST(DdsFile, SerializedFileParsesBack) {
+    const DdsFile::Format formats[] = { DdsFile::FORMAT_R8G8B8A8_UNORM, DdsFile::FORMAT_BC1_UNORM, DdsFile::FORMAT_BC5_UNORM, DdsFile::FORMAT_BC7_UNORM };
+    for (DdsFile::Format format : formats) {
+        std::vector<std::vector<unsigned char>> mips = MakeMips(format, 64, 16, 7);
+        std::vector<unsigned char> data;
+        ASSERT_TRUE(DdsFile::Serialize(format, 64, 16, mips, data));
+
+        DdsFile::Desc desc;
+        ASSERT_TRUE(DdsFile::Parse(data.data(), data.size(), desc)) << format;
+        EXPECT_EQ(desc.format, format);
+        EXPECT_EQ(desc.dimension, DdsFile::DIMENSION_TEXTURE2D);
+        EXPECT_EQ(desc.width, 64u);
+        EXPECT_EQ(desc.height, 16u);
+        EXPECT_EQ(desc.mipCount, 7u);
+        EXPECT_EQ(desc.arraySize, 1u);
+        EXPECT_FALSE(desc.isCubeMap);
+        // Only formats old readers don't know get DX10 header
+        EXPECT_EQ(desc.dataOffset, sizeof(uint32_t) + sizeof(DdsFile::Header) + (format == DdsFile::FORMAT_BC7_UNORM ? sizeof(DdsFile::HeaderDx10) : 0));
+        ExpectPackedSubresources(desc, data.size());
+        EXPECT_EQ(desc.subresources.back().offset + desc.subresources.back().size, data.size());
+        for (uint32_t mip = 0; mip < desc.mipCount; mip++) {
+            const DdsFile::Subresource& subresource = desc.subresources[mip];
+            EXPECT_EQ(subresource.width, (std::max)(1u, 64u >> mip));
+            EXPECT_EQ(subresource.height, (std::max)(1u, 16u >> mip));
+            EXPECT_EQ(data[(size_t)subresource.offset], mip + 1);
+        }
+    }
+}
+
+TEST(DdsFile, SerializeRejectsWrongMips) {
+    std::vector<unsigned char> data;
+    std::vector<std::vector<unsigned char>> mips = MakeMips(DdsFile::FORMAT_R8G8B8A8_UNORM, 4, 4, 3);
+    EXPECT_FALSE(DdsFile::Serialize(DdsFile::FORMAT_UNKNOWN, 4, 4, mips, data));
+    EXPECT_FALSE(DdsFile::Serialize(DdsFile::FORMAT_R8G8B8A8_UNORM, 4, 4, {}, data));
+    mips.push_back(mips.back());
+    EXPECT_FALSE(DdsFile::Serialize(DdsFile::FORMAT_R8G8B8A8_UNORM, 4, 4, mips, data));
+    mips.pop_back();
+    mips[1].pop_back();
+    EXPECT_FALSE(DdsFile::Serialize(DdsFile::FORMAT_R8G8B8A8_UNORM, 4, 4, mips, data));
+}
+
+TEST(DdsFile, LegacyCubeMapHasSixSlices) {
+    DdsFile::Header header = MakeHeader(8, 8, 4);
+    header.ddspf.flags = DdsFile::PIXEL_FOURCC;
+    header.ddspf.fourCC = DDS_FILE_FOURCC('D', 'X', 'T', '5');
+    header.caps2 = DdsFile::CAPS2_CUBEMAP | DdsFile::CAPS2_CUBEMAP_ALLFACES;
+    // Mips 8x8 and 4x4 take one block each, 2x2 and 1x1 take whole blocks too
+    std::vector<unsigned char> data = MakeFile(header, nullptr, 6 * (64 + 16 + 16 + 16));
+
+    DdsFile::Desc desc;
+    ASSERT_TRUE(DdsFile::Parse(data.data(), data.size(), desc));
+    EXPECT_EQ(desc.format, DdsFile::FORMAT_BC3_UNORM);
+    EXPECT_TRUE(desc.isCubeMap);
+    EXPECT_EQ(desc.arraySize, 6u);
+    ExpectPackedSubresources(desc, data.size());
+    EXPECT_EQ(desc.subresources[4].offset, desc.dataOffset + 112);
+
+    // D3D11 has no partial cube maps
+    header.caps2 = DdsFile::CAPS2_CUBEMAP | 0x400;
+    data = MakeFile(header, nullptr, 6 * 112);
+    EXPECT_FALSE(DdsFile::Parse(data.data(), data.size(), desc));
+}
+
+TEST(DdsFile, Dx10VolumeAndArrays) {
+    // Volume mips halve depth too, so depth counts in mip chain length
+    DdsFile::Header header = MakeDx10Header(4, 4, 4);
+    header.flags |= DdsFile::FLAG_VOLUME;
+    header.depth = 8;
+    DdsFile::HeaderDx10 headerDx10 = MakeHeaderDx10(DdsFile::FORMAT_R8_UNORM, DdsFile::DIMENSION_TEXTURE3D, 1);
+    std::vector<unsigned char> data = MakeFile(header, &headerDx10, 16 * 8 + 4 * 4 + 1 * 2 + 1 * 1);
+    DdsFile::Desc desc;
+    ASSERT_TRUE(DdsFile::Parse(data.data(), data.size(), desc));
+    EXPECT_EQ(desc.dimension, DdsFile::DIMENSION_TEXTURE3D);
+    EXPECT_EQ(desc.depth, 8u);
+    ExpectPackedSubresources(desc, data.size());
+    EXPECT_EQ(desc.subresources[1].depth, 4u);
+    EXPECT_EQ(desc.subresources[3].size, 1u);
+
+    // Array of 1D textures, height is forced to 1
+    header = MakeDx10Header(16, 0, 0);
+    header.flags &= ~(uint32_t)DdsFile::FLAG_HEIGHT;
+    headerDx10 = MakeHeaderDx10(DdsFile::FORMAT_R16G16B16A16_FLOAT, DdsFile::DIMENSION_TEXTURE1D, 3);
+    data = MakeFile(header, &headerDx10, 3 * 16 * 8);
+    ASSERT_TRUE(DdsFile::Parse(data.data(), data.size(), desc));
+    EXPECT_EQ(desc.height, 1u);
+    EXPECT_EQ(desc.arraySize, 3u);
+    ExpectPackedSubresources(desc, data.size());
+
+    // Arrays of cube maps
+    header = MakeDx10Header(4, 4, 1);
+    headerDx10 = MakeHeaderDx10(DdsFile::FORMAT_BC7_UNORM, DdsFile::DIMENSION_TEXTURE2D, 2);
+    headerDx10.miscFlag = DdsFile::MISC_TEXTURECUBE;
+    data = MakeFile(header, &headerDx10, 12 * 16);
+    ASSERT_TRUE(DdsFile::Parse(data.data(), data.size(), desc));
+    EXPECT_TRUE(desc.isCubeMap);
+    EXPECT_EQ(desc.arraySize, 12u);
+}
+
+// 164 bytes claiming 4 GB mip, its slice pitch wrapped to 0 in 32 bits so file looked complete
+TEST(DdsFile, RejectsSliceWrappingTo0) {
+    DdsFile::Header header = MakeDx10Header(16384, 16384, 1);
+    DdsFile::HeaderDx10 headerDx10 = MakeHeaderDx10(DdsFile::FORMAT_R32G32B32A32_FLOAT, DdsFile::DIMENSION_TEXTURE2D, 1);
+    std::vector<unsigned char> data = MakeFile(header, &headerDx10, 16);
+    ASSERT_EQ(data.size(), 164u);
+
+    DdsFile::Desc desc;
+    EXPECT_FALSE(DdsFile::Parse(data.data(), data.size(), desc));
+    EXPECT_TRUE(desc.subresources.empty());
+
+    std::string path = GetTestPath("texture.dds");
+    FILE* file = fopen(path.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    fwrite(data.data(), 1, data.size(), file);
+    fclose(file);
+    DdsFile ddsFile;
+    EXPECT_FALSE(ddsFile.Open(path.c_str()));
+    EXPECT_FALSE(ddsFile.IsOpen());
+    std::remove(path.c_str());
+}
+
+TEST(DdsFile, RejectsMipChainLongerThanFull) {
+    // 4x4 has mips 4, 2 and 1, fourth one would be 1x1 again
+    std::vector<std::vector<unsigned char>> mips = MakeMips(DdsFile::FORMAT_R8G8B8A8_UNORM, 4, 4, 3);
+    std::vector<unsigned char> data;
+    ASSERT_TRUE(DdsFile::Serialize(DdsFile::FORMAT_R8G8B8A8_UNORM, 4, 4, mips, data));
+    DdsFile::Desc desc;
+    ASSERT_TRUE(DdsFile::Parse(data.data(), data.size(), desc));
+
+    DdsFile::Header header;
+    memcpy(&header, data.data() + sizeof(uint32_t), sizeof(header));
+    header.mipMapCount = 4;
+    data.resize(data.size() + 4);
+    memcpy(data.data() + sizeof(uint32_t), &header, sizeof(header));
+    EXPECT_FALSE(DdsFile::Parse(data.data(), data.size(), desc));
+}
+
+TEST(DdsFile, RejectsBrokenHeaders) {
+    std::vector<unsigned char> valid;
+    ASSERT_TRUE(DdsFile::Serialize(DdsFile::FORMAT_BC7_UNORM, 8, 8, MakeMips(DdsFile::FORMAT_BC7_UNORM, 8, 8, 4), valid));
+    DdsFile::Desc desc;
+    ASSERT_TRUE(DdsFile::Parse(valid.data(), valid.size(), desc));
+
+    EXPECT_FALSE(DdsFile::Parse(nullptr, 0, desc));
+    EXPECT_FALSE(DdsFile::Parse(valid.data(), valid.size() - 1, desc));
+    EXPECT_FALSE(DdsFile::Parse(valid.data(), sizeof(uint32_t) + sizeof(DdsFile::Header) + 4, desc));
+
+    // Offsets of fields: magic, header size, then width, then DX10 format and array size after header
+    auto expectBroken = [&](size_t offset, uint32_t value) {
+        std::vector<unsigned char> data = valid;
+        memcpy(data.data() + offset, &value, sizeof(value));
+        EXPECT_FALSE(DdsFile::Parse(data.data(), data.size(), desc)) << offset;
+        EXPECT_TRUE(desc.subresources.empty());
+    };
+    const size_t dx10Offset = sizeof(uint32_t) + sizeof(DdsFile::Header);
+    expectBroken(0, 0x12345678);
+    expectBroken(4, 100);
+    expectBroken(16, 0);
+    expectBroken(16, DDS_FILE_MAX_SIZE + 1);
+    expectBroken(dx10Offset, 1000);
+    expectBroken(dx10Offset + 4, DdsFile::DIMENSION_UNKNOWN);
+    expectBroken(dx10Offset + 12, 0);
+    expectBroken(dx10Offset + 12, DDS_FILE_MAX_ARRAY_SIZE + 1);
+}
+
+TEST(DdsFile, RandomDamageNeverPointsOutsideFile) {
+    std::vector<unsigned char> valid;
+    ASSERT_TRUE(DdsFile::Serialize(DdsFile::FORMAT_R16G16B16A16_FLOAT, 32, 32, MakeMips(DdsFile::FORMAT_R16G16B16A16_FLOAT, 32, 32, 6), valid));
+    std::mt19937 random(19);
+    const size_t headersSize = sizeof(uint32_t) + sizeof(DdsFile::Header) + sizeof(DdsFile::HeaderDx10);
+    DdsFile::Desc desc;
+    for (int i = 0; i < 20000; i++) {
+        std::vector<unsigned char> data = valid;
+        for (int j = 0; j < 4; j++) {
+            data[random() % headersSize] = (unsigned char)random();
+        }
+        if (DdsFile::Parse(data.data(), data.size(), desc)) {
+            ExpectPackedSubresources(desc, data.size());
+            ASSERT_LE(desc.mipCount, DdsFile::GetMaxMipCount(desc.width, desc.height, desc.depth));
+        }
+    }
+}
+
+TEST(DdsFile, OpenMapsWrittenFile) {
+    std::string path = GetTestPath("texture.dds");
+    std::vector<std::vector<unsigned char>> mips = MakeMips(DdsFile::FORMAT_R8G8B8A8_UNORM, 16, 16, 5);
+    ASSERT_TRUE(DdsFile::Write(path.c_str(), DdsFile::FORMAT_R8G8B8A8_UNORM, 16, 16, mips));
+
+    DdsFile file;
+    ASSERT_TRUE(file.Open(path.c_str(), true));
+    EXPECT_EQ(file.GetDesc().mipCount, 5u);
+    for (int mip = 0; mip < 5; mip++) {
+        EXPECT_EQ(memcmp(file.GetSubresourceData(mip), mips[mip].data(), mips[mip].size()), 0);
+    }
+    file.PrefetchMip(4);
+    file.Release();
+    EXPECT_FALSE(file.IsOpen());
+    EXPECT_TRUE(file.GetDesc().subresources.empty());
+    std::remove(path.c_str());
+
+    EXPECT_FALSE(file.Open(path.c_str()));
+}
+
+TEST(DdsFile, LoadKeepsSerializedData) {
+    std::vector<std::vector<unsigned char>> mips = MakeMips(DdsFile::FORMAT_R8G8B8A8_UNORM_SRGB, 16, 8, 5);
+    std::vector<unsigned char> data;
+    ASSERT_TRUE(DdsFile::Serialize(DdsFile::FORMAT_R8G8B8A8_UNORM_SRGB, 16, 8, mips, data));
+    size_t size = data.size();
+
+    DdsFile file;
+    ASSERT_TRUE(file.Load(std::move(data)));
+    EXPECT_TRUE(file.IsOpen());
+    EXPECT_EQ(file.GetSize(), size);
+    EXPECT_EQ(file.GetDesc().format, DdsFile::FORMAT_R8G8B8A8_UNORM_SRGB);
+    EXPECT_EQ(file.GetDesc().mipCount, 5u);
+    for (int mip = 0; mip < 5; mip++) {
+        EXPECT_EQ(memcmp(file.GetSubresourceData(mip), mips[mip].data(), mips[mip].size()), 0);
+    }
+    // Data in memory has nothing to read in
+    file.PrefetchMip(0);
+    file.Release();
+    EXPECT_FALSE(file.IsOpen());
+    EXPECT_EQ(file.GetSize(), 0u);
+
+    std::vector<unsigned char> broken(64, 0);
+    EXPECT_FALSE(file.Load(std::move(broken)));
+    EXPECT_FALSE(file.IsOpen());
+}
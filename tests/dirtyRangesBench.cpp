@@ -0,0 +1,35 @@
+// dirtyRangesBench.cpp - update and upload volume of scene where few cubes move
+#include "benchTimer.h"
+#include "cubeInstances.h"
+
+int main() {
+    const int count = 1000000;
+    CubeInstances instances;
+    instances.Init(count);
+    for (int i = 0; i < count; i++) {
+        CubeInstances::CubeModel cube;
+        // Every 100th cube rotates
+        cube.pos = XMFLOAT4((float)(i % 1000), (float)(i / 1000), 0.0f, i % 100 == 0 ? 1.0f : 0.0f);
+        cube.shineSpeedIdNM = XMFLOAT4(300.0f, 1.0f, 0.0f, 1.0f);
+        instances.Add(cube);
+    }
+
+    double full = MeasureBest(1, [&]() { instances.Update(0.0f); });
+    size_t fullBytes = instances.GetUpdateStats().uploaded * sizeof(CubeInstances::GeomBuffer);
+    float time = 0.0f;
+    double partial = MeasureBest(5, [&]() {
+        time += 0.01f;
+        instances.Update(time);
+    });
+    const CubeInstances::UpdateStats& stats = instances.GetUpdateStats();
+    size_t partialBytes = stats.uploaded * sizeof(CubeInstances::GeomBuffer);
+
+    PrintResult("Update of every cube", full, count);
+    PrintResult("Update of 1% moving cubes", partial, count);
+    printf("rebuilt %d, ranges %d, upload %zu KB instead of %zu KB\n", stats.rebuilt, stats.uploadRanges, partialBytes / 1024, fullBytes / 1024);
+
+    instances.Cull(nullptr, false);
+    bool isEmpty = instances.GetVisible().empty();
+    instances.Release();
+    return isEmpty ? 0 : 1;
+}
@@ -0,0 +1,113 @@
+// dirtyRangesTest.cpp - rebuild and upload of moving or changed cubes only, culling without visible list
+#include <gtest/gtest.h>
+#include "cubeInstances.h"
+
+namespace {
+    // Function to add count cubes, every movingStep-th one rotates
+    void AddCubes(CubeInstances& instances, int count, int movingStep) {
+        for (int i = 0; i < count; i++) {
+            CubeInstances::CubeModel cube;
+            bool isMoving = movingStep > 0 && i % movingStep == 0;
+            cube.pos = XMFLOAT4((float)i, 0.0f, 0.0f, isMoving ? 1.0f : 0.0f);
+            cube.shineSpeedIdNM = XMFLOAT4(300.0f, 1.0f, 0.0f, 1.0f);
+            instances.Add(cube);
+        }
+    }
+}
+
+TEST(DirtyRanges, StaticSceneUploadsOnce) {
+    CubeInstances instances;
+    instances.Init(0);
+    AddCubes(instances, 1000, 0);
+
+    instances.Update(0.0f);
+    ASSERT_EQ(instances.GetDirtyRanges().size(), 1u);
+    EXPECT_EQ(instances.GetDirtyRanges()[0].first, 0);
+    EXPECT_EQ(instances.GetDirtyRanges()[0].last, 1000);
+    EXPECT_EQ(instances.GetUpdateStats().rebuilt, 1000);
+
+    instances.Update(1.0f);
+    EXPECT_TRUE(instances.GetDirtyRanges().empty());
+    EXPECT_EQ(instances.GetUpdateStats().rebuilt, 0);
+    EXPECT_EQ(instances.GetUpdateStats().uploaded, 0);
+    instances.Release();
+}
+
+TEST(DirtyRanges, OnlyMovingCubesAreRebuilt) {
+    CubeInstances instances;
+    instances.Init(0);
+    // Moving cubes 100 apart are farther than merge gap, every one is own range
+    AddCubes(instances, 1000, 100);
+    instances.Update(0.0f);
+
+    instances.Update(0.5f);
+    EXPECT_EQ(instances.GetUpdateStats().rebuilt, 10);
+    ASSERT_EQ(instances.GetDirtyRanges().size(), 10u);
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ(instances.GetDirtyRanges()[i].first, i * 100);
+        EXPECT_EQ(instances.GetDirtyRanges()[i].last, i * 100 + 1);
+    }
+    EXPECT_EQ(instances.GetUpdateStats().uploaded, 10);
+    instances.Release();
+}
+
+TEST(DirtyRanges, CloseRangesAreMerged) {
+    CubeInstances instances;
+    instances.Init(0);
+    // Moving cubes 10 apart are within merge gap, they are uploaded with cubes between them
+    AddCubes(instances, 101, 10);
+    instances.Update(0.0f);
+
+    instances.Update(0.5f);
+    EXPECT_EQ(instances.GetUpdateStats().rebuilt, 11);
+    ASSERT_EQ(instances.GetDirtyRanges().size(), 1u);
+    EXPECT_EQ(instances.GetDirtyRanges()[0].first, 0);
+    EXPECT_EQ(instances.GetDirtyRanges()[0].last, 101);
+    EXPECT_EQ(instances.GetUpdateStats().uploaded, 101);
+    instances.Release();
+}
+
+TEST(DirtyRanges, RemoveAndMarkAllDirty) {
+    CubeInstances instances;
+    instances.Init(0);
+    AddCubes(instances, 500, 0);
+    instances.Update(0.0f);
+
+    // Last cube moved into removed one's place must be uploaded there
+    instances.Remove(instances.GetHandle(100));
+    instances.Update(0.0f);
+    ASSERT_EQ(instances.GetDirtyRanges().size(), 1u);
+    EXPECT_EQ(instances.GetDirtyRanges()[0].first, 100);
+    EXPECT_EQ(instances.GetDirtyRanges()[0].last, 101);
+    EXPECT_EQ(instances.GetGeomBuffers()[100].position.x, 499.0f);
+
+    instances.MarkAllDirty();
+    instances.Update(0.0f);
+    ASSERT_EQ(instances.GetDirtyRanges().size(), 1u);
+    EXPECT_EQ(instances.GetDirtyRanges()[0].last, 499);
+    EXPECT_EQ(instances.GetUpdateStats().rebuilt, 499);
+    instances.Release();
+}
+
+TEST(DirtyRanges, CullWithoutFrustumBuildsNoList) {
+    CubeInstances instances;
+    instances.Init(0);
+    AddCubes(instances, 300, 0);
+    instances.Update(0.0f);
+
+    instances.Cull(nullptr, false);
+    EXPECT_TRUE(instances.IsAllVisible());
+    EXPECT_TRUE(instances.GetVisible().empty());
+    EXPECT_EQ(instances.GetVisibleCount(), 300);
+
+    Frustum frustum;
+    frustum.Init(100.0f);
+    XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.0f, 0.0f, -10.0f, 0.0f), XMVectorSet(0.0f, 0.0f, 0.0f, 0.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+    frustum.ConstructFrustum(view, XMMatrixPerspectiveFovLH(XM_PIDIV2, 1.0f, 0.1f, 100.0f));
+    instances.Cull(&frustum, false);
+    EXPECT_FALSE(instances.IsAllVisible());
+    EXPECT_EQ(instances.GetVisibleCount(), (int)instances.GetVisible().size());
+    EXPECT_GT(instances.GetVisibleCount(), 0);
+    EXPECT_LT(instances.GetVisibleCount(), 300);
+    instances.Release();
+}
@@ -0,0 +1,137 @@
+// fixedTimestepTest.cpp - deterministic stepping on fake clock and frame rate independent movement
+#include <gtest/gtest.h>
+#include <random>
+#include "clock.h"
+#include "fixedTimestep.h"
+#include "movement.h"
+
+namespace {
+    const double STEP = 1.0 / 120.0;
+
+    // Function to simulate holding forward key with frames of given nanoseconds, returns final position
+    XMFLOAT3 HoldForward(const std::vector<int64_t>& frameTimes, int* stepsCount = nullptr) {
+        FakeClock clock;
+        FixedTimestep timestep;
+        timestep.Init(&clock, STEP);
+        Movement movement;
+        movement.Reset(XMFLOAT3(0.0f, 0.0f, 0.0f));
+        bool isPressed[Movement::DIRECTION_COUNT] = { true, false, false, false };
+
+        int total = 0;
+        for (int64_t frameTime : frameTimes) {
+            clock.Advance(frameTime);
+            int steps = timestep.Advance();
+            for (int i = 0; i < steps; i++) {
+                movement.Step(isPressed, (float)timestep.GetStep());
+            }
+            total += steps;
+        }
+        if (stepsCount) {
+            *stepsCount = total;
+        }
+        return movement.GetPosition();
+    }
+}
+
+TEST(FixedTimestep, StepsDontDependOnFrameRate) {
+    for (double frameTime : { 1.0 / 30.0, 1.0 / 60.0, 1.0 / 144.0, 1.0 / 1000.0 }) {
+        FakeClock clock;
+        FixedTimestep timestep;
+        timestep.Init(&clock, STEP);
+        int steps = 0;
+        // Frames end exactly at 1 second, last one takes the rest
+        int frames = (int)(1.0 / frameTime);
+        for (int i = 0; i < frames; i++) {
+            clock.AdvanceSeconds(frameTime);
+            steps += timestep.Advance();
+            ASSERT_GE(timestep.GetAlpha(), 0.0);
+            ASSERT_LT(timestep.GetAlpha(), 1.0);
+        }
+        clock.Advance(1000000000 - clock.GetNanoseconds());
+        steps += timestep.Advance();
+        EXPECT_EQ(steps, 120) << frameTime;
+        EXPECT_NEAR(timestep.GetRenderTime(), 1.0, 1e-9);
+    }
+}
+
+TEST(FixedTimestep, LongFrameIsClamped) {
+    FakeClock clock;
+    FixedTimestep timestep;
+    timestep.Init(&clock, STEP, 8);
+    clock.AdvanceSeconds(2.0);
+    EXPECT_EQ(timestep.Advance(), 8);
+    EXPECT_NEAR(timestep.GetFrameTime(), 2.0, 1e-9);
+    clock.AdvanceSeconds(STEP);
+    EXPECT_EQ(timestep.Advance(), 1);
+}
+
+TEST(FixedTimestep, MovementIsSameForAnyFrameTimes) {
+    // Five seconds split into steady 60 Hz frames and into frames around 144 Hz with +-80% jitter
+    const int64_t duration = 5000000000;
+    std::vector<int64_t> steady(300, duration / 300);
+    std::vector<int64_t> jittered;
+    std::mt19937 random(7);
+    std::uniform_int_distribution<int64_t> jitter(1388889, 12500000);
+    int64_t time = 0;
+    while (time < duration) {
+        int64_t frameTime = (std::min)(jitter(random), duration - time);
+        jittered.push_back(frameTime);
+        time += frameTime;
+    }
+
+    int steadySteps = 0, jitteredSteps = 0;
+    XMFLOAT3 a = HoldForward(steady, &steadySteps);
+    XMFLOAT3 b = HoldForward(jittered, &jitteredSteps);
+    // Same steps give bit exact state, whatever frames they were split into
+    ASSERT_EQ(steadySteps, jitteredSteps);
+    EXPECT_EQ(a.x, b.x);
+    EXPECT_EQ(a.z, b.z);
+    // Speed is reached in MAX / ACCELERATION seconds, then stays at maximum
+    float accelerationTime = MOVEMENT_MAX_SPEED / MOVEMENT_ACCELERATION;
+    float expected = MOVEMENT_MAX_SPEED * (5.0f - accelerationTime * 0.5f);
+    EXPECT_NEAR(a.x, expected, 0.02f);
+}
+
+TEST(Movement, RatesArePerSecond) {
+    // Same second of holding with different step lengths ends at nearly same place and speed
+    bool isPressed[Movement::DIRECTION_COUNT] = { false, false, true, false };
+    float positions[2];
+    int stepsCounts[2] = { 60, 480 };
+    for (int i = 0; i < 2; i++) {
+        Movement movement;
+        movement.Reset(XMFLOAT3(0.0f, 0.0f, 0.0f));
+        for (int step = 0; step < stepsCounts[i]; step++) {
+            movement.Step(isPressed, 1.0f / stepsCounts[i]);
+        }
+        EXPECT_FLOAT_EQ(movement.GetSpeed(Movement::DIRECTION_LEFT), MOVEMENT_MAX_SPEED);
+        positions[i] = movement.GetPosition().z;
+    }
+    EXPECT_NEAR(positions[0], positions[1], 0.02f);
+
+    // Released key slows down to stop
+    Movement movement;
+    movement.Reset(XMFLOAT3(0.0f, 0.0f, 0.0f));
+    for (int step = 0; step < 120; step++) {
+        movement.Step(isPressed, 1.0f / 120.0f);
+    }
+    bool isReleased[Movement::DIRECTION_COUNT] = {};
+    for (int step = 0; step < 120; step++) {
+        movement.Step(isReleased, 1.0f / 120.0f);
+    }
+    EXPECT_EQ(movement.GetSpeed(Movement::DIRECTION_LEFT), 0.0f);
+}
+
+TEST(Movement, InterpolatesBetweenSteps) {
+    bool isPressed[Movement::DIRECTION_COUNT] = { true, false, false, false };
+    Movement movement;
+    movement.Reset(XMFLOAT3(1.0f, 2.0f, 3.0f));
+    movement.Step(isPressed, 0.1f);
+    movement.Step(isPressed, 0.1f);
+    XMFLOAT3 previous = movement.GetPosition(0.0f);
+    XMFLOAT3 last = movement.GetPosition(1.0f);
+    XMFLOAT3 half = movement.GetPosition(0.5f);
+    EXPECT_FLOAT_EQ(last.x, movement.GetPosition().x);
+    EXPECT_LT(previous.x, last.x);
+    EXPECT_FLOAT_EQ(half.x, (previous.x + last.x) * 0.5f);
+    EXPECT_EQ(half.y, 2.0f);
+}
@@ -0,0 +1,62 @@
+// frameGraphBench.cpp - per frame cost of building and compiling frame graph, memory saved by aliasing transients
+#include <algorithm>
+#include <random>
+#include "benchTimer.h"
+#include "frameGraph.h"
+
+int main() {
+    const int passesCount = 64;
+    const int frames = 1000;
+    const uint32_t sizes[] = { 1920, 960, 480, 240 };
+    int executed = 0;
+
+    // Post processing like chain of downsampled targets with debug views nobody reads
+    FrameGraph graph;
+    auto build = [&]() {
+        std::mt19937 random(13);
+        graph.Reset();
+        int backBuffer = graph.ImportTexture("BackBuffer", FrameGraph::ACCESS_RENDER_TARGET);
+        int depth = graph.ImportTexture("Depth", FrameGraph::ACCESS_DEPTH_WRITE);
+        std::vector<int> written;
+        for (int i = 0; i < passesCount; i++) {
+            int pass = graph.AddPass("Pass", [&]() { executed++; });
+            for (int j = 0; j < 2 && !written.empty(); j++) {
+                graph.Read(pass, written[written.size() - 1 - random() % (std::min)(written.size(), (size_t)4)]);
+            }
+            if (i == 0) {
+                graph.Write(pass, depth, FrameGraph::ACCESS_DEPTH_WRITE);
+            }
+            FrameGraph::TextureDesc desc;
+            uint32_t size = sizes[random() % 4];
+            desc.width = size;
+            desc.height = size * 9 / 16;
+            desc.format = 10;
+            desc.bytesPerPixel = 8;
+            int target = graph.CreateTexture("Target", desc);
+            graph.Write(pass, i == passesCount - 1 ? backBuffer : target);
+            if (i % 8 != 7) {
+                written.push_back(target);
+            }
+        }
+    };
+
+    double buildMs = MeasureBest(5, [&]() {
+        for (int i = 0; i < frames; i++) {
+            build();
+        }
+    });
+    double compileMs = MeasureBest(5, [&]() {
+        for (int i = 0; i < frames; i++) {
+            build();
+            graph.Compile();
+        }
+    }) - buildMs;
+    graph.Execute();
+
+    const FrameGraph::Stats& stats = graph.GetStats();
+    PrintResult("Build graph", buildMs / frames, passesCount);
+    PrintResult("Compile graph", compileMs / frames, passesCount);
+    printf("passes %d, culled %d, transients %d in %d physical textures\n", stats.passes, stats.culledPasses, stats.transients, stats.physicalTextures);
+    printf("transients %.1f MB, aliased pool %.1f MB\n", stats.transientBytes / 1048576.0, stats.aliasedBytes / 1048576.0);
+    return executed == (int)graph.GetOrder().size() && stats.aliasedBytes <= stats.transientBytes ? 0 : 1;
+}
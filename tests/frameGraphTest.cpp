@@ -0,0 +1,265 @@
+// frameGraphTest.cpp - pass culling, transitions and aliasing of transient textures in frame graph
+#include <gtest/gtest.h>
+#include <random>
+#include "frameGraph.h"
+
+namespace {
+    FrameGraph::TextureDesc MakeDesc(uint32_t width, uint32_t height, uint32_t format = 28) {
+        FrameGraph::TextureDesc desc;
+        desc.width = width;
+        desc.height = height;
+        desc.format = format;
+        return desc;
+    }
+
+    uint64_t GetSize(const FrameGraph::TextureDesc& desc) {
+        uint64_t size = (uint64_t)desc.width * desc.height * desc.bytesPerPixel;
+        return (size + FrameGraph::PoolAlignment - 1) / FrameGraph::PoolAlignment * FrameGraph::PoolAlignment;
+    }
+
+    bool IsUsed(const FrameGraph& graph, int resource) {
+        return graph.GetFirstUse(resource) <= graph.GetLastUse(resource);
+    }
+
+    bool IsLiveTogether(const FrameGraph& graph, int a, int b) {
+        return graph.GetFirstUse(a) <= graph.GetLastUse(b) && graph.GetFirstUse(b) <= graph.GetLastUse(a);
+    }
+
+    // Function to check that transients live at same time don't share pool memory or physical texture
+    void ExpectNoAliasingConflicts(const FrameGraph& graph, const std::vector<int>& transients, const std::vector<FrameGraph::TextureDesc>& descs) {
+        for (size_t i = 0; i < transients.size(); i++) {
+            int a = transients[i];
+            if (!IsUsed(graph, a)) {
+                EXPECT_EQ(graph.GetPhysical(a), -1);
+                continue;
+            }
+            ASSERT_GE(graph.GetPhysical(a), 0);
+            EXPECT_TRUE(FrameGraph::IsEqual(graph.GetPhysicalDesc(graph.GetPhysical(a)), descs[i]));
+            EXPECT_EQ(graph.GetPoolOffset(a) % FrameGraph::PoolAlignment, 0u);
+            EXPECT_LE(graph.GetPoolOffset(a) + GetSize(descs[i]), graph.GetStats().aliasedBytes);
+
+            for (size_t j = i + 1; j < transients.size(); j++) {
+                int b = transients[j];
+                if (!IsUsed(graph, b) || !IsLiveTogether(graph, a, b))
+                    continue;
+                EXPECT_NE(graph.GetPhysical(a), graph.GetPhysical(b)) << a << " " << b;
+                bool isDisjoint = graph.GetPoolOffset(a) + GetSize(descs[i]) <= graph.GetPoolOffset(b) ||
+                    graph.GetPoolOffset(b) + GetSize(descs[j]) <= graph.GetPoolOffset(a);
+                EXPECT_TRUE(isDisjoint) << a << " " << b;
+            }
+        }
+    }
+}
+
+TEST(FrameGraph, CullsPassesWithUnreadOutputs) {
+    FrameGraph graph;
+    int backBuffer = graph.ImportTexture("BackBuffer", FrameGraph::ACCESS_RENDER_TARGET);
+    int color = graph.CreateTexture("Color", MakeDesc(64, 64));
+    int debug = graph.CreateTexture("Debug", MakeDesc(64, 64));
+    int blur = graph.CreateTexture("Blur", MakeDesc(64, 64));
+    int blurDebug = graph.CreateTexture("BlurDebug", MakeDesc(64, 64));
+
+    int scene = graph.AddPass("Scene", nullptr);
+    graph.Write(scene, color);
+    // Chain of passes whose last output is never read is culled whole
+    int debugPass = graph.AddPass("Debug", nullptr);
+    graph.Read(debugPass, color);
+    graph.Write(debugPass, debug);
+    int blurPass = graph.AddPass("Blur", nullptr);
+    graph.Read(blurPass, debug);
+    graph.Write(blurPass, blur);
+    int blurDebugPass = graph.AddPass("BlurDebug", nullptr);
+    graph.Read(blurDebugPass, blur);
+    graph.Write(blurDebugPass, blurDebug);
+    int present = graph.AddPass("Present", nullptr);
+    graph.Read(present, color);
+    graph.Write(present, backBuffer);
+    graph.Compile();
+
+    EXPECT_FALSE(graph.IsCulled(scene));
+    EXPECT_TRUE(graph.IsCulled(debugPass));
+    EXPECT_TRUE(graph.IsCulled(blurPass));
+    EXPECT_TRUE(graph.IsCulled(blurDebugPass));
+    EXPECT_FALSE(graph.IsCulled(present));
+    EXPECT_EQ(graph.GetOrder(), std::vector<int>({ scene, present }));
+    EXPECT_EQ(graph.GetStats().passes, 5);
+    EXPECT_EQ(graph.GetStats().culledPasses, 3);
+    EXPECT_EQ(graph.GetStats().transients, 1);
+    EXPECT_FALSE(IsUsed(graph, debug));
+    EXPECT_EQ(graph.GetPhysical(debug), -1);
+}
+
+TEST(FrameGraph, KeepsPassesWritingImportedResources) {
+    FrameGraph graph;
+    int history = graph.ImportTexture("History", FrameGraph::ACCESS_SHADER_READ);
+    int temp = graph.CreateTexture("Temp", MakeDesc(32, 32));
+
+    int write = graph.AddPass("WriteTemp", nullptr);
+    graph.Write(write, temp);
+    int copy = graph.AddPass("CopyToHistory", nullptr);
+    graph.Read(copy, temp);
+    graph.Write(copy, history);
+    // Pass with no outputs at all has nothing to keep it
+    int empty = graph.AddPass("Empty", nullptr);
+    graph.Read(empty, temp);
+    graph.Compile();
+
+    EXPECT_FALSE(graph.IsCulled(write));
+    EXPECT_FALSE(graph.IsCulled(copy));
+    EXPECT_TRUE(graph.IsCulled(empty));
+    EXPECT_EQ(graph.GetLastUse(temp), 1);
+}
+
+TEST(FrameGraph, ExecutesPassesInDeclarationOrder) {
+    FrameGraph graph;
+    int backBuffer = graph.ImportTexture("BackBuffer", FrameGraph::ACCESS_RENDER_TARGET);
+    int first = graph.CreateTexture("First", MakeDesc(16, 16));
+    int unused = graph.CreateTexture("Unused", MakeDesc(16, 16));
+    std::vector<int> executed;
+
+    int a = graph.AddPass("A", [&]() { executed.push_back(0); });
+    graph.Write(a, first);
+    int b = graph.AddPass("B", [&]() { executed.push_back(1); });
+    graph.Write(b, unused);
+    int c = graph.AddPass("C", [&]() { executed.push_back(2); });
+    graph.Read(c, first);
+    graph.Write(c, backBuffer);
+    graph.Compile();
+    graph.Execute();
+
+    EXPECT_TRUE(graph.IsCulled(b));
+    EXPECT_EQ(executed, std::vector<int>({ 0, 2 }));
+    EXPECT_EQ(graph.GetPassName(c), "C");
+    EXPECT_EQ(graph.GetResourceName(unused), "Unused");
+}
+
+TEST(FrameGraph, PlansTransitionsOnAccessChanges) {
+    FrameGraph graph;
+    int depth = graph.ImportTexture("Depth", FrameGraph::ACCESS_DEPTH_WRITE);
+    int backBuffer = graph.ImportTexture("BackBuffer", FrameGraph::ACCESS_RENDER_TARGET);
+    int color = graph.CreateTexture("Color", MakeDesc(64, 64));
+
+    int scene = graph.AddPass("Scene", nullptr);
+    graph.Write(scene, color);
+    graph.Write(scene, depth, FrameGraph::ACCESS_DEPTH_WRITE);
+    int post = graph.AddPass("Post", nullptr);
+    graph.Read(post, color);
+    graph.Read(post, depth, FrameGraph::ACCESS_DEPTH_READ);
+    graph.Write(post, backBuffer);
+    graph.Compile();
+
+    // Transient starts undefined, depth already is in its access
+    const std::vector<FrameGraph::Barrier>& sceneBarriers = graph.GetBarriers(scene);
+    ASSERT_EQ(sceneBarriers.size(), 1u);
+    EXPECT_EQ(sceneBarriers[0].resource, color);
+    EXPECT_EQ(sceneBarriers[0].before, FrameGraph::ACCESS_NONE);
+    EXPECT_EQ(sceneBarriers[0].after, FrameGraph::ACCESS_RENDER_TARGET);
+
+    const std::vector<FrameGraph::Barrier>& postBarriers = graph.GetBarriers(post);
+    ASSERT_EQ(postBarriers.size(), 2u);
+    EXPECT_EQ(postBarriers[0].resource, color);
+    EXPECT_EQ(postBarriers[0].before, FrameGraph::ACCESS_RENDER_TARGET);
+    EXPECT_EQ(postBarriers[0].after, FrameGraph::ACCESS_SHADER_READ);
+    EXPECT_EQ(postBarriers[1].resource, depth);
+    EXPECT_EQ(postBarriers[1].after, FrameGraph::ACCESS_DEPTH_READ);
+
+    // Imported resources go back to access they had before graph
+    const std::vector<FrameGraph::Barrier>& finalBarriers = graph.GetFinalBarriers();
+    ASSERT_EQ(finalBarriers.size(), 1u);
+    EXPECT_EQ(finalBarriers[0].resource, depth);
+    EXPECT_EQ(finalBarriers[0].before, FrameGraph::ACCESS_DEPTH_READ);
+    EXPECT_EQ(finalBarriers[0].after, FrameGraph::ACCESS_DEPTH_WRITE);
+}
+
+TEST(FrameGraph, AliasesTransientsWithDisjointLifetimes) {
+    FrameGraph graph;
+    int backBuffer = graph.ImportTexture("BackBuffer", FrameGraph::ACCESS_RENDER_TARGET);
+    std::vector<FrameGraph::TextureDesc> descs(4, MakeDesc(256, 256));
+    std::vector<int> transients;
+    for (int i = 0; i < (int)descs.size(); i++) {
+        transients.push_back(graph.CreateTexture("Ping" + std::to_string(i), descs[i]));
+    }
+
+    // Ping-pong chain: each transient lives over two neighbouring passes
+    int pass = graph.AddPass("Pass0", nullptr);
+    graph.Write(pass, transients[0]);
+    for (int i = 1; i < (int)transients.size(); i++) {
+        pass = graph.AddPass("Pass" + std::to_string(i), nullptr);
+        graph.Read(pass, transients[i - 1]);
+        graph.Write(pass, transients[i]);
+    }
+    pass = graph.AddPass("Present", nullptr);
+    graph.Read(pass, transients.back());
+    graph.Write(pass, backBuffer);
+    graph.Compile();
+
+    ExpectNoAliasingConflicts(graph, transients, descs);
+    const FrameGraph::Stats& stats = graph.GetStats();
+    EXPECT_EQ(stats.transients, 4);
+    EXPECT_EQ(stats.physicalTextures, 2);
+    EXPECT_EQ(graph.GetPhysical(transients[0]), graph.GetPhysical(transients[2]));
+    EXPECT_EQ(graph.GetPhysical(transients[1]), graph.GetPhysical(transients[3]));
+    EXPECT_EQ(stats.transientBytes, 4 * GetSize(descs[0]));
+    EXPECT_EQ(stats.aliasedBytes, 2 * GetSize(descs[0]));
+}
+
+TEST(FrameGraph, SharesPhysicalOnlyWithEqualDescs) {
+    FrameGraph graph;
+    int backBuffer = graph.ImportTexture("BackBuffer", FrameGraph::ACCESS_RENDER_TARGET);
+    std::vector<FrameGraph::TextureDesc> descs = { MakeDesc(128, 128), MakeDesc(128, 128, 10), MakeDesc(64, 64) };
+    std::vector<int> transients;
+    int previous = -1;
+    for (int i = 0; i < (int)descs.size(); i++) {
+        transients.push_back(graph.CreateTexture("T" + std::to_string(i), descs[i]));
+        int pass = graph.AddPass("P" + std::to_string(i), nullptr);
+        if (previous >= 0) {
+            graph.Read(pass, previous);
+        }
+        graph.Write(pass, transients[i]);
+        previous = transients[i];
+    }
+    int present = graph.AddPass("Present", nullptr);
+    graph.Read(present, previous);
+    graph.Write(present, backBuffer);
+    graph.Compile();
+
+    ExpectNoAliasingConflicts(graph, transients, descs);
+    // First and last don't overlap in time but differ in desc, pool memory is still shared
+    EXPECT_EQ(graph.GetStats().physicalTextures, 3);
+    EXPECT_EQ(graph.GetPoolOffset(transients[2]), 0u);
+    EXPECT_LT(graph.GetStats().aliasedBytes, graph.GetStats().transientBytes);
+}
+
+TEST(FrameGraph, RandomGraphsHaveNoAliasingConflicts) {
+    std::mt19937 random(11);
+    std::uniform_int_distribution<int> sizeIndex(0, 3);
+    const uint32_t sizes[] = { 64, 200, 512, 1024 };
+    FrameGraph graph;
+    for (int iteration = 0; iteration < 50; iteration++) {
+        graph.Reset();
+        int backBuffer = graph.ImportTexture("BackBuffer", FrameGraph::ACCESS_RENDER_TARGET);
+        std::vector<int> transients;
+        std::vector<FrameGraph::TextureDesc> descs;
+        std::vector<int> written;
+        for (int i = 0; i < 24; i++) {
+            int pass = graph.AddPass("Pass", nullptr);
+            for (int j = 0; j < 2 && !written.empty(); j++) {
+                graph.Read(pass, written[random() % written.size()]);
+            }
+            descs.push_back(MakeDesc(sizes[sizeIndex(random)], sizes[sizeIndex(random)], random() % 2));
+            transients.push_back(graph.CreateTexture("Target", descs.back()));
+            graph.Write(pass, transients.back());
+            written.push_back(transients.back());
+            if (random() % 6 == 0) {
+                graph.Write(pass, backBuffer);
+            }
+        }
+        graph.Compile();
+
+        ExpectNoAliasingConflicts(graph, transients, descs);
+        const FrameGraph::Stats& stats = graph.GetStats();
+        EXPECT_LE(stats.aliasedBytes, stats.transientBytes);
+        EXPECT_LE(stats.physicalTextures, stats.transients);
+        EXPECT_EQ(stats.culledPasses + (int)graph.GetOrder().size(), stats.passes);
+    }
+}
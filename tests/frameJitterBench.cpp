@@ -0,0 +1,75 @@
+// frameJitterBench.cpp - smoothness of motion on screen with jittered frame times, per-frame movement against fixed steps
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "clock.h"
+#include "fixedTimestep.h"
+#include "movement.h"
+
+namespace {
+    // Function to get relative standard deviation of apparent speed, displacement of frame over its real duration
+    double GetSpeedDeviation(const std::vector<double>& positions, const std::vector<double>& frameTimes) {
+        std::vector<double> speeds;
+        for (size_t i = 1; i < positions.size(); i++) {
+            speeds.push_back((positions[i] - positions[i - 1]) / frameTimes[i]);
+        }
+        double mean = 0.0;
+        for (double speed : speeds) {
+            mean += speed;
+        }
+        mean /= (double)speeds.size();
+        double variance = 0.0;
+        for (double speed : speeds) {
+            variance += (speed - mean) * (speed - mean);
+        }
+        return std::sqrt(variance / (double)speeds.size()) / mean;
+    }
+}
+
+int main() {
+    // Frames around 144 Hz with +-80% jitter, key held all the time at full speed
+    const int framesCount = 10000;
+    std::mt19937 random(1);
+    std::uniform_real_distribution<double> jitter(0.2, 1.8);
+    std::vector<double> frameTimes(framesCount);
+    for (double& frameTime : frameTimes) {
+        frameTime = jitter(random) / 144.0;
+    }
+    bool isPressed[Movement::DIRECTION_COUNT] = { true, false, false, false };
+
+    // Constant move per frame, as movement was before fixed steps
+    std::vector<double> perFrame(framesCount);
+    double position = 0.0;
+    for (int i = 0; i < framesCount; i++) {
+        position += MOVEMENT_MAX_SPEED / 144.0;
+        perFrame[i] = position;
+    }
+
+    // Fixed steps, rendered at last step or interpolated between last two
+    std::vector<double> stepped(framesCount), interpolated(framesCount);
+    FakeClock clock;
+    FixedTimestep timestep;
+    timestep.Init(&clock, 1.0 / 120.0);
+    Movement movement;
+    movement.Reset(XMFLOAT3(0.0f, 0.0f, 0.0f));
+    for (int i = 0; i < 120; i++) {
+        movement.Step(isPressed, 1.0f / 120.0f);
+    }
+    double origin = movement.GetPosition().x;
+    for (int i = 0; i < framesCount; i++) {
+        clock.AdvanceSeconds(frameTimes[i]);
+        int steps = timestep.Advance();
+        for (int step = 0; step < steps; step++) {
+            movement.Step(isPressed, (float)timestep.GetStep());
+        }
+        stepped[i] = movement.GetPosition().x - origin;
+        interpolated[i] = movement.GetPosition((float)timestep.GetAlpha()).x - origin;
+    }
+
+    printf("Apparent speed deviation with %d jittered frames:\n", framesCount);
+    printf("%-40s %8.2f %%\n", "Move per frame", GetSpeedDeviation(perFrame, frameTimes) * 100.0);
+    printf("%-40s %8.2f %%\n", "Fixed steps", GetSpeedDeviation(stepped, frameTimes) * 100.0);
+    printf("%-40s %8.2f %%\n", "Fixed steps with interpolation", GetSpeedDeviation(interpolated, frameTimes) * 100.0);
+    return 0;
+}
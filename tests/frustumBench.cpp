@@ -0,0 +1,47 @@
+// frustumBench.cpp - per-box frustum test against batch SoA culling
+#include <random>
+#include "benchTimer.h"
+#include "frustum.h"
+
+int main() {
+    const int count = 1000000;
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> pos(-50.0f, 50.0f);
+    AABBSoA boxes;
+    boxes.Resize(count);
+    for (int i = 0; i < count; i++) {
+        float x = pos(rng), y = pos(rng), z = pos(rng);
+        boxes.minX[i] = x - 0.5f;
+        boxes.minY[i] = y - 0.5f;
+        boxes.minZ[i] = z - 0.5f;
+        boxes.maxX[i] = x + 0.5f;
+        boxes.maxY[i] = y + 0.5f;
+        boxes.maxZ[i] = z + 0.5f;
+    }
+
+    Frustum frustum;
+    frustum.Init(100.0f);
+    XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.0f, 0.0f, -60.0f, 0.0f), XMVectorSet(0.0f, 0.0f, 0.0f, 0.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+    frustum.ConstructFrustum(view, XMMatrixPerspectiveFovLH(XM_PI / 3, 16.0f / 9.0f, 0.1f, 100.0f));
+
+    std::vector<int> visible;
+    visible.reserve(count);
+    double perBox = MeasureBest(5, [&]() {
+        visible.clear();
+        for (int i = 0; i < count; i++) {
+            if (frustum.CheckRectangle(XMFLOAT4(boxes.minX[i], boxes.minY[i], boxes.minZ[i], 1.0f), XMFLOAT4(boxes.maxX[i], boxes.maxY[i], boxes.maxZ[i], 1.0f))) {
+                visible.push_back(i);
+            }
+        }
+    });
+    size_t perBoxVisible = visible.size();
+    double batch = MeasureBest(5, [&]() {
+        visible.clear();
+        frustum.CheckRectangles(boxes, 0, count, visible);
+    });
+
+    PrintResult("CheckRectangle per box", perBox, count);
+    PrintResult("CheckRectangles batch", batch, count);
+    printf("visible %zu / %zu, speedup %.2fx\n", visible.size(), perBoxVisible, perBox / batch);
+    return visible.size() == perBoxVisible ? 0 : 1;
+}
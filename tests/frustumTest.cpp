@@ -0,0 +1,105 @@
+// frustumTest.cpp - batch frustum culling against per-box test
+#include <gtest/gtest.h>
+#include <random>
+#include "frustum.h"
+
+namespace {
+    // Function to fill count unit boxes at random positions in [-range, range]
+    void FillBoxes(AABBSoA& boxes, int count, float range, unsigned seed) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> pos(-range, range);
+        boxes.Resize(count);
+        for (int i = 0; i < count; i++) {
+            float x = pos(rng), y = pos(rng), z = pos(rng);
+            boxes.minX[i] = x - 0.5f;
+            boxes.minY[i] = y - 0.5f;
+            boxes.minZ[i] = z - 0.5f;
+            boxes.maxX[i] = x + 0.5f;
+            boxes.maxY[i] = y + 0.5f;
+            boxes.maxZ[i] = z + 0.5f;
+        }
+    }
+
+    Frustum MakeFrustum() {
+        Frustum frustum;
+        frustum.Init(100.0f);
+        XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(3.0f, 2.0f, -4.0f, 0.0f), XMVectorSet(0.0f, 0.0f, 0.0f, 0.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+        XMMATRIX proj = XMMatrixPerspectiveFovLH(XM_PI / 3, 16.0f / 9.0f, 0.1f, 100.0f);
+        frustum.ConstructFrustum(view, proj);
+        return frustum;
+    }
+
+    std::vector<int> CheckOneByOne(Frustum& frustum, const AABBSoA& boxes, int first, int last) {
+        std::vector<int> visible;
+        for (int i = first; i < last; i++) {
+            if (frustum.CheckRectangle(XMFLOAT4(boxes.minX[i], boxes.minY[i], boxes.minZ[i], 1.0f), XMFLOAT4(boxes.maxX[i], boxes.maxY[i], boxes.maxZ[i], 1.0f))) {
+                visible.push_back(i);
+            }
+        }
+        return visible;
+    }
+}
+
+TEST(Frustum, BatchMatchesPerBoxTest) {
+    Frustum frustum = MakeFrustum();
+    AABBSoA boxes;
+    FillBoxes(boxes, 10007, 20.0f, 1);
+
+    std::vector<int> visible;
+    frustum.CheckRectangles(boxes, 0, (int)boxes.Size(), visible);
+    std::vector<int> expected = CheckOneByOne(frustum, boxes, 0, (int)boxes.Size());
+    EXPECT_EQ(visible, expected);
+    EXPECT_GT(visible.size(), 0u);
+    EXPECT_LT(visible.size(), boxes.Size());
+}
+
+TEST(Frustum, UnalignedRangesAndTails) {
+    Frustum frustum = MakeFrustum();
+    AABBSoA boxes;
+    FillBoxes(boxes, 257, 10.0f, 2);
+
+    for (int first = 0; first < 9; first++) {
+        for (int last = first; last < first + 19; last++) {
+            std::vector<int> visible;
+            frustum.CheckRectangles(boxes, first, last, visible);
+            EXPECT_EQ(visible, CheckOneByOne(frustum, boxes, first, last)) << first << " " << last;
+        }
+    }
+}
+
+TEST(Frustum, AppendsToVisibleList) {
+    Frustum frustum = MakeFrustum();
+    AABBSoA boxes;
+    FillBoxes(boxes, 100, 10.0f, 3);
+
+    std::vector<int> visible = { -1, -2 };
+    frustum.CheckRectangles(boxes, 0, 100, visible);
+    ASSERT_GE(visible.size(), 2u);
+    EXPECT_EQ(visible[0], -1);
+    EXPECT_EQ(visible[1], -2);
+    std::vector<int> tail(visible.begin() + 2, visible.end());
+    EXPECT_EQ(tail, CheckOneByOne(frustum, boxes, 0, 100));
+
+    frustum.CheckRectangles(boxes, 50, 50, visible);
+    EXPECT_EQ(visible.size(), tail.size() + 2);
+}
+
+TEST(Frustum, BoxesInFrontAndBehindCamera) {
+    Frustum frustum = MakeFrustum();
+    AABBSoA boxes;
+    boxes.Resize(2);
+    // Origin is looked at, the box far behind the eye is outside
+    float centers[2][3] = { { 0.0f, 0.0f, 0.0f }, { 30.0f, 20.0f, -40.0f } };
+    for (int i = 0; i < 2; i++) {
+        boxes.minX[i] = centers[i][0] - 0.5f;
+        boxes.minY[i] = centers[i][1] - 0.5f;
+        boxes.minZ[i] = centers[i][2] - 0.5f;
+        boxes.maxX[i] = centers[i][0] + 0.5f;
+        boxes.maxY[i] = centers[i][1] + 0.5f;
+        boxes.maxZ[i] = centers[i][2] + 0.5f;
+    }
+
+    std::vector<int> visible;
+    frustum.CheckRectangles(boxes, 0, 2, visible);
+    EXPECT_EQ(visible, std::vector<int>({ 0 }));
+}
@@ -0,0 +1,35 @@
+// instanceFormatBench.cpp - encoding and upload size of packed instances against full matrices
+#include <random>
+#include <vector>
+#include "benchTimer.h"
+#include "instanceFormat.h"
+
+int main() {
+    const int count = 1000000;
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::vector<XMMATRIX> worlds(count);
+    for (int i = 0; i < count; i++) {
+        worlds[i] = XMMatrixRotationY(unit(rng) * XM_PI) * XMMatrixTranslation(unit(rng) * 50.0f, unit(rng) * 50.0f, unit(rng) * 50.0f);
+    }
+
+    std::vector<XMFLOAT4X4> matrices(count);
+    std::vector<PackedInstance> packed(count);
+    double full = MeasureBest(5, [&]() {
+        for (int i = 0; i < count; i++) {
+            XMStoreFloat4x4(&matrices[i], XMMatrixTranspose(worlds[i]));
+        }
+    });
+    double encoded = MeasureBest(5, [&]() {
+        for (int i = 0; i < count; i++) {
+            EncodeInstance(worlds[i], 0u, packed[i]);
+        }
+    });
+
+    PrintResult("Store transposed 4x4 matrix", full, count);
+    PrintResult("EncodeInstance", encoded, count);
+    // Previous record was world and normal matrices with float4 material
+    size_t fullSize = sizeof(XMFLOAT4X4) * 2 + sizeof(XMFLOAT4);
+    printf("upload %zu MB instead of %zu MB\n", count * sizeof(PackedInstance) >> 20, count * fullSize >> 20);
+    return 0;
+}
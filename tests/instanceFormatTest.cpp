@@ -0,0 +1,71 @@
+// instanceFormatTest.cpp - packed instance encoding against full world matrices
+#include <gtest/gtest.h>
+#include <random>
+#include "instanceFormat.h"
+
+namespace {
+    // Function to rotate vector by unit quaternion the same way as RotateVector of shaders
+    XMFLOAT3 RotateVector(const XMFLOAT4& q, const XMFLOAT3& v) {
+        XMVECTOR qv = XMVectorSet(q.x, q.y, q.z, 0.0f);
+        XMVECTOR vv = XMLoadFloat3(&v);
+        XMVECTOR t = XMVectorAdd(XMVector3Cross(qv, vv), XMVectorScale(vv, q.w));
+        XMFLOAT3 result;
+        XMStoreFloat3(&result, XMVectorAdd(vv, XMVectorScale(XMVector3Cross(qv, t), 2.0f)));
+        return result;
+    }
+}
+
+TEST(InstanceFormat, LayoutIs36Bytes) {
+    EXPECT_EQ(sizeof(PackedInstance), 36u);
+}
+
+TEST(InstanceFormat, MaterialRoundTrip) {
+    for (int shine = 0; shine < 1024; shine += 37) {
+        for (int texture = 0; texture < 256; texture += 51) {
+            for (int normalMap = 0; normalMap < 2; normalMap++) {
+                XMFLOAT4 material = UnpackMaterial(PackMaterial((float)shine, (float)texture, normalMap != 0));
+                ASSERT_EQ(material.x, (float)shine);
+                ASSERT_EQ(material.z, (float)texture);
+                ASSERT_EQ(material.w, (float)normalMap);
+            }
+        }
+    }
+    // Out of range values are clamped and don't spill into other fields
+    XMFLOAT4 clamped = UnpackMaterial(PackMaterial(5000.0f, 300.0f, false));
+    EXPECT_EQ(clamped.x, 1023.0f);
+    EXPECT_EQ(clamped.z, 255.0f);
+    EXPECT_EQ(clamped.w, 0.0f);
+    EXPECT_EQ(UnpackMaterial(PackMaterial(-3.0f, -1.0f, true)).x, 0.0f);
+}
+
+TEST(InstanceFormat, EncodeDecodeMatchesWorldMatrix) {
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    for (int i = 0; i < 500; i++) {
+        float scale = 0.25f + (unit(rng) + 1.0f);
+        XMMATRIX world = XMMatrixScaling(scale, scale, scale) * XMMatrixRotationX(unit(rng) * XM_PI) *
+            XMMatrixRotationY(unit(rng) * XM_PI) * XMMatrixRotationZ(unit(rng) * XM_PI) *
+            XMMatrixTranslation(unit(rng) * 100.0f, unit(rng) * 100.0f, unit(rng) * 100.0f);
+
+        PackedInstance instance;
+        EncodeInstance(world, 77u, instance);
+        EXPECT_EQ(instance.material, 77u);
+        EXPECT_NEAR(instance.scale, scale, 1e-4f);
+
+        XMMATRIX decoded = DecodeInstance(instance);
+        for (int r = 0; r < 4; r++) {
+            for (int c = 0; c < 4; c++) {
+                ASSERT_NEAR(decoded.r[r].v[c], world.r[r].v[c], 2e-4f * (r == 3 ? 100.0f : 1.0f)) << r << c;
+            }
+        }
+
+        // Vertex transform of shaders gives the same point as world matrix
+        XMFLOAT3 local(unit(rng), unit(rng), unit(rng));
+        XMFLOAT3 rotated = RotateVector(instance.rotation, local);
+        XMFLOAT3 expected;
+        XMStoreFloat3(&expected, XMVector3Transform(XMLoadFloat3(&local), world));
+        EXPECT_NEAR(instance.position.x + instance.scale * rotated.x, expected.x, 1e-3f);
+        EXPECT_NEAR(instance.position.y + instance.scale * rotated.y, expected.y, 1e-3f);
+        EXPECT_NEAR(instance.position.z + instance.scale * rotated.z, expected.z, 1e-3f);
+    }
+}
@@ -0,0 +1,57 @@
+// jobSystemBench.cpp - per-instance update and culling on caller against job system
+#include <random>
+#include <thread>
+#include "benchTimer.h"
+#include "cubeInstances.h"
+#include "jobSystem.h"
+
+namespace {
+    void FillInstances(CubeInstances& instances, int count) {
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<float> pos(-200.0f, 200.0f);
+        for (int i = 0; i < count; i++) {
+            CubeInstances::CubeModel cube;
+            cube.pos = XMFLOAT4(pos(rng), pos(rng) * 0.1f, pos(rng), 1.0f);
+            cube.shineSpeedIdNM = XMFLOAT4(300.0f, 1.0f, 0.0f, 0.0f);
+            instances.Add(cube);
+        }
+    }
+}
+
+int main() {
+    const int count = 1000000;
+    JobSystem jobSystem;
+    jobSystem.Init();
+    CubeInstances serial, parallel;
+    serial.Init(count);
+    parallel.Init(count, &jobSystem);
+    FillInstances(serial, count);
+    FillInstances(parallel, count);
+
+    Frustum frustum;
+    frustum.Init(100.0f);
+    frustum.ConstructFrustum(XMMatrixIdentity(), XMMatrixPerspectiveFovLH(1.0f, 1.3f, 0.1f, 100.0f));
+
+    float time = 0.0f;
+    double serialMs = MeasureBest(5, [&]() {
+        time += 0.01f;
+        serial.Update(time);
+        serial.Cull(&frustum, false);
+    });
+    time = 0.0f;
+    double parallelMs = MeasureBest(5, [&]() {
+        time += 0.01f;
+        parallel.Update(time);
+        parallel.Cull(&frustum, false);
+    });
+
+    printf("workers %d of %u hardware threads\n", jobSystem.GetWorkersCount(), std::thread::hardware_concurrency());
+    PrintResult("Update + Cull on caller", serialMs, count);
+    PrintResult("Update + Cull on job system", parallelMs, count);
+    printf("speedup %.2fx\n", serialMs / parallelMs);
+    bool isEqual = serial.GetVisible() == parallel.GetVisible();
+    parallel.Release();
+    serial.Release();
+    jobSystem.Release();
+    return isEqual ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+// jobSystemTest.cpp - parallel-for coverage, nesting and per-instance work split across jobs
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstring>
+#include <random>
+#include <thread>
+#include "cubeInstances.h"
+#include "jobSystem.h"
+
+TEST(JobSystem, EveryIndexProcessedOnce) {
+    JobSystem jobSystem;
+    jobSystem.Init(4);
+    std::vector<int> counts(100003, 0);
+    for (int grain : { 1, 7, 1000, 200000 }) {
+        std::fill(counts.begin(), counts.end(), 0);
+        std::atomic<int> maxRange{ 0 };
+        jobSystem.ParallelFor(0, (int)counts.size(), grain, [&](int first, int last) {
+            int size = last - first;
+            int prev = maxRange.load();
+            while (size > prev && !maxRange.compare_exchange_weak(prev, size)) {
+            }
+            for (int i = first; i < last; i++) {
+                counts[i]++;
+            }
+        });
+        for (size_t i = 0; i < counts.size(); i++) {
+            ASSERT_EQ(counts[i], 1) << "grain " << grain << " index " << i;
+        }
+        EXPECT_LE(maxRange.load(), grain);
+    }
+    jobSystem.Release();
+}
+
+TEST(JobSystem, RangesCount) {
+    EXPECT_EQ(JobSystem::GetRangesCount(0, 0, 10), 0);
+    EXPECT_EQ(JobSystem::GetRangesCount(5, 3, 10), 0);
+    EXPECT_EQ(JobSystem::GetRangesCount(0, 10, 10), 1);
+    EXPECT_EQ(JobSystem::GetRangesCount(0, 11, 10), 2);
+    EXPECT_EQ(JobSystem::GetRangesCount(3, 103, 25), 4);
+}
+
+TEST(JobSystem, EmptyRangeAndNoWorkers) {
+    JobSystem jobSystem;
+    jobSystem.Init(2);
+    int calls = 0;
+    jobSystem.ParallelFor(10, 10, 4, [&](int, int) { calls++; });
+    EXPECT_EQ(calls, 0);
+    jobSystem.Release();
+
+    // Without workers everything runs on caller in one range
+    JobSystem serial;
+    std::thread::id caller = std::this_thread::get_id();
+    serial.ParallelFor(0, 1000, 10, [&](int first, int last) {
+        EXPECT_EQ(std::this_thread::get_id(), caller);
+        EXPECT_EQ(first, 0);
+        EXPECT_EQ(last, 1000);
+        calls++;
+    });
+    EXPECT_EQ(calls, 1);
+}
+
+TEST(JobSystem, NestedParallelFor) {
+    JobSystem jobSystem;
+    jobSystem.Init(3);
+    std::atomic<int> total{ 0 };
+    jobSystem.ParallelFor(0, 64, 1, [&](int, int) {
+        jobSystem.ParallelFor(0, 100, 7, [&](int first, int last) { total += last - first; });
+    });
+    EXPECT_EQ(total.load(), 6400);
+    jobSystem.Release();
+}
+
+TEST(JobSystem, ParallelForFromSeveralThreads) {
+    JobSystem jobSystem;
+    jobSystem.Init(2);
+    std::atomic<long long> total{ 0 };
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.push_back(std::thread([&]() {
+            for (int r = 0; r < 20; r++) {
+                jobSystem.ParallelFor(0, 1000, 33, [&](int first, int last) { total += last - first; });
+            }
+        }));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(total.load(), 4 * 20 * 1000);
+    jobSystem.Release();
+}
+
+TEST(JobSystem, ParallelInstancesMatchSerial) {
+    JobSystem jobSystem;
+    jobSystem.Init(3);
+    CubeInstances serial, parallel;
+    serial.Init(0);
+    parallel.Init(0, &jobSystem);
+
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> pos(-100.0f, 100.0f);
+    for (int i = 0; i < 50000; i++) {
+        CubeInstances::CubeModel cube;
+        cube.pos = XMFLOAT4(pos(rng), pos(rng) * 0.1f, pos(rng), (float)(i % 3 - 1));
+        cube.shineSpeedIdNM = XMFLOAT4(300.0f, 1.0f, (float)(i % 2), 0.0f);
+        serial.Add(cube);
+        parallel.Add(cube);
+    }
+
+    Frustum frustum;
+    frustum.Init(100.0f);
+    frustum.ConstructFrustum(XMMatrixIdentity(), XMMatrixPerspectiveFovLH(1.0f, 1.3f, 0.1f, 100.0f));
+    for (float time : { 0.0f, 0.5f, 1.25f }) {
+        serial.Update(time);
+        parallel.Update(time);
+        serial.Cull(&frustum, false);
+        parallel.Cull(&frustum, false);
+        EXPECT_EQ(serial.GetVisible(), parallel.GetVisible());
+        EXPECT_EQ(serial.GetUpdateStats().rebuilt, parallel.GetUpdateStats().rebuilt);
+        ASSERT_EQ(serial.GetDirtyRanges().size(), parallel.GetDirtyRanges().size());
+        EXPECT_EQ(0, memcmp(serial.GetGeomBuffers().data(), parallel.GetGeomBuffers().data(), serial.GetGeomBuffers().size() * sizeof(CubeInstances::GeomBuffer)));
+    }
+    parallel.Release();
+    serial.Release();
+    jobSystem.Release();
+}
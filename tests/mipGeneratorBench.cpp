@@ -0,0 +1,62 @@
+// mipGeneratorBench.cpp - full mip chain of large image with every filter, on caller and on job system
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include "benchTimer.h"
+#include "mipGenerator.h"
+
+int main() {
+    const uint32_t size = 1024;
+    TextureCompressor::Image image;
+    image.width = size;
+    image.height = size;
+    image.pixels.resize((size_t)size * size * 4);
+    for (uint32_t y = 0; y < size; y++) {
+        for (uint32_t x = 0; x < size; x++) {
+            unsigned char* pixel = &image.pixels[((size_t)y * size + x) * 4];
+            pixel[0] = (unsigned char)(128.0f + 100.0f * sinf(x * 0.05f + y * 0.03f));
+            pixel[1] = (unsigned char)(128.0f + 100.0f * sinf(x * 0.07f));
+            pixel[2] = (unsigned char)(128.0f + 100.0f * cosf(y * 0.06f));
+            pixel[3] = (unsigned char)((x ^ y) & 0xff);
+        }
+    }
+
+    JobSystem jobSystem;
+    jobSystem.Init();
+    MipGenerator serial;
+    MipGenerator parallel;
+    parallel.Init(&jobSystem);
+
+    struct Case {
+        const char* name;
+        MipGenerator::Filter filter;
+        bool isSRGB;
+        bool isNormalMap;
+    };
+    const Case cases[] = {
+        { "box", MipGenerator::FILTER_BOX, false, false },
+        { "Kaiser", MipGenerator::FILTER_KAISER, false, false },
+        { "Lanczos", MipGenerator::FILTER_LANCZOS, false, false },
+        { "Kaiser sRGB", MipGenerator::FILTER_KAISER, true, false },
+        { "Kaiser normal map", MipGenerator::FILTER_KAISER, false, true }
+    };
+
+    // Items are pixels of source image
+    bool isValid = true;
+    std::vector<TextureCompressor::Image> mips;
+    for (const Case& test : cases) {
+        MipGenerator::Options options;
+        options.filter = test.filter;
+        options.isSRGB = test.isSRGB;
+        options.isNormalMap = test.isNormalMap;
+        double serialTime = MeasureBest(3, [&]() { isValid = serial.Generate(image, options, mips) && isValid; });
+        double parallelTime = MeasureBest(3, [&]() { isValid = parallel.Generate(image, options, mips) && isValid; });
+        PrintResult((std::string(test.name) + ", caller").c_str(), serialTime, size * size);
+        PrintResult((std::string(test.name) + ", job system").c_str(), parallelTime, size * size);
+    }
+    printf("%ux%u RGBA, %d mips\n", size, size, (int)mips.size());
+
+    parallel.Release();
+    jobSystem.Release();
+    return isValid && mips.size() == MipGenerator::GetMipsCount(size, size) ? 0 : 1;
+}
@@ -0,0 +1,250 @@
+// mipGeneratorTest.cpp - mip sizes, box average, sRGB and normal map filtering, parallel rows and DDS conversion of mip generator
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include "mipGenerator.h"
+#include "testPath.h"
+
+namespace {
+    // Function to make image of random pixels
+    TextureCompressor::Image MakeImage(uint32_t width, uint32_t height, unsigned seed) {
+        std::mt19937 random(seed);
+        std::uniform_int_distribution<int> value(0, 255);
+        TextureCompressor::Image image;
+        image.width = width;
+        image.height = height;
+        image.pixels.resize((size_t)width * height * 4);
+        for (unsigned char& pixel : image.pixels) {
+            pixel = (unsigned char)value(random);
+        }
+        return image;
+    }
+
+    // Function to make image of smooth waves, close to photographed textures
+    TextureCompressor::Image MakeSmoothImage(uint32_t width, uint32_t height) {
+        TextureCompressor::Image image = MakeImage(width, height, 0);
+        for (uint32_t y = 0; y < height; y++) {
+            for (uint32_t x = 0; x < width; x++) {
+                unsigned char* pixel = &image.pixels[((size_t)y * width + x) * 4];
+                pixel[0] = (unsigned char)(128.0f + 100.0f * sinf(x * 0.05f + y * 0.03f));
+                pixel[1] = (unsigned char)(128.0f + 100.0f * sinf(x * 0.07f));
+                pixel[2] = (unsigned char)(128.0f + 100.0f * cosf(y * 0.06f));
+                pixel[3] = (unsigned char)(128.0f + 120.0f * cosf(x * 0.02f - y * 0.04f));
+            }
+        }
+        return image;
+    }
+
+    // Function to make normal map of random unit normals facing +z
+    TextureCompressor::Image MakeNormalMap(uint32_t width, uint32_t height, unsigned seed) {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+        TextureCompressor::Image image = MakeImage(width, height, seed);
+        for (size_t i = 0; i < image.pixels.size(); i += 4) {
+            float n[3] = { value(random), value(random), 0.5f + 0.5f * std::fabs(value(random)) };
+            float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            for (int c = 0; c < 3; c++) {
+                image.pixels[i + c] = (unsigned char)((n[c] / length * 0.5f + 0.5f) * 255.0f + 0.5f);
+            }
+        }
+        return image;
+    }
+
+    // Function to get length of normal stored in pixel
+    float GetNormalLength(const unsigned char* pixel) {
+        float sum = 0.0f;
+        for (int c = 0; c < 3; c++) {
+            float n = pixel[c] / 255.0f * 2.0f - 1.0f;
+            sum += n * n;
+        }
+        return std::sqrt(sum);
+    }
+}
+
+TEST(MipGenerator, MipsCountDownToOnePixel) {
+    EXPECT_EQ(MipGenerator::GetMipsCount(1, 1), 1u);
+    EXPECT_EQ(MipGenerator::GetMipsCount(2, 1), 2u);
+    EXPECT_EQ(MipGenerator::GetMipsCount(256, 256), 9u);
+    EXPECT_EQ(MipGenerator::GetMipsCount(300, 100), 9u);
+    EXPECT_EQ(MipGenerator::GetMipsCount(1, 7), 3u);
+    EXPECT_EQ(MipGenerator::GetMipsCount(1024, 1024), DdsFile::GetMaxMipCount(1024, 1024));
+}
+
+TEST(MipGenerator, GeneratesChainOfHalvedSizes) {
+    MipGenerator generator;
+    generator.Init();
+    MipGenerator::Options options;
+    std::vector<TextureCompressor::Image> mips;
+    TextureCompressor::Image image = MakeImage(7, 3, 1);
+    ASSERT_TRUE(generator.Generate(image, options, mips));
+    ASSERT_EQ(mips.size(), 3u);
+    EXPECT_EQ(mips[0].pixels, image.pixels);
+    EXPECT_EQ(mips[1].width, 3u);
+    EXPECT_EQ(mips[1].height, 1u);
+    EXPECT_EQ(mips[2].width, 1u);
+    EXPECT_EQ(mips[2].height, 1u);
+    EXPECT_EQ(mips[2].pixels.size(), 4u);
+
+    options.mipsCount = 2;
+    ASSERT_TRUE(generator.Generate(MakeImage(64, 64, 2), options, mips));
+    EXPECT_EQ(mips.size(), 2u);
+
+    TextureCompressor::Image empty;
+    EXPECT_FALSE(generator.Generate(empty, options, mips));
+    image.pixels.pop_back();
+    EXPECT_FALSE(generator.Generate(image, options, mips));
+}
+
+TEST(MipGenerator, BoxAveragesTwoByTwoPixels) {
+    MipGenerator generator;
+    MipGenerator::Options options;
+    options.filter = MipGenerator::FILTER_BOX;
+    std::vector<TextureCompressor::Image> mips;
+    TextureCompressor::Image image = MakeImage(16, 8, 3);
+    ASSERT_TRUE(generator.Generate(image, options, mips));
+
+    const TextureCompressor::Image& mip = mips[1];
+    for (uint32_t y = 0; y < mip.height; y++) {
+        for (uint32_t x = 0; x < mip.width; x++) {
+            for (int c = 0; c < 4; c++) {
+                int sum = 0;
+                for (uint32_t i = 0; i < 4; i++) {
+                    sum += image.pixels[((size_t)(y * 2 + i / 2) * image.width + x * 2 + i % 2) * 4 + c];
+                }
+                ASSERT_LE(std::fabs(mip.pixels[((size_t)y * mip.width + x) * 4 + c] - sum / 4.0f), 0.5f) << x << " " << y << " " << c;
+            }
+        }
+    }
+}
+
+TEST(MipGenerator, ConstantImageStaysConstantWithAllFilters) {
+    MipGenerator generator;
+    TextureCompressor::Image image = MakeImage(37, 20, 4);
+    for (size_t i = 0; i < image.pixels.size(); i++) {
+        image.pixels[i] = (unsigned char)(40 + 50 * (i % 4));
+    }
+    for (MipGenerator::Filter filter : { MipGenerator::FILTER_BOX, MipGenerator::FILTER_KAISER, MipGenerator::FILTER_LANCZOS }) {
+        for (bool isSRGB : { false, true }) {
+            MipGenerator::Options options;
+            options.filter = filter;
+            options.isSRGB = isSRGB;
+            std::vector<TextureCompressor::Image> mips;
+            ASSERT_TRUE(generator.Generate(image, options, mips));
+            for (const TextureCompressor::Image& mip : mips) {
+                for (size_t i = 0; i < mip.pixels.size(); i++) {
+                    ASSERT_NEAR(mip.pixels[i], 40 + 50 * (i % 4), 1) << filter << " " << isSRGB << " " << mip.width;
+                }
+            }
+        }
+    }
+}
+
+TEST(MipGenerator, SRGBColorIsAveragedInLinearSpace) {
+    // Black and white columns, alpha goes from 0 to 255 along with color
+    TextureCompressor::Image image;
+    image.width = 2;
+    image.height = 2;
+    image.pixels = { 0, 0, 0, 0, 255, 255, 255, 255, 0, 0, 0, 0, 255, 255, 255, 255 };
+    MipGenerator generator;
+    MipGenerator::Options options;
+    options.filter = MipGenerator::FILTER_BOX;
+    std::vector<TextureCompressor::Image> mips;
+
+    ASSERT_TRUE(generator.Generate(image, options, mips));
+    EXPECT_EQ(mips[1].pixels, std::vector<unsigned char>({ 128, 128, 128, 128 }));
+
+    // Half of linear intensity is 188 in sRGB, alpha stays linear
+    options.isSRGB = true;
+    ASSERT_TRUE(generator.Generate(image, options, mips));
+    EXPECT_EQ(mips[1].pixels, std::vector<unsigned char>({ 188, 188, 188, 128 }));
+}
+
+TEST(MipGenerator, NormalsOfNormalMapStayUnit) {
+    TextureCompressor::Image image = MakeNormalMap(64, 64, 5);
+    MipGenerator generator;
+    MipGenerator::Options options;
+    std::vector<TextureCompressor::Image> mips;
+
+    // Averaged random normals get much shorter without renormalization
+    ASSERT_TRUE(generator.Generate(image, options, mips));
+    float shortest = 1.0f;
+    for (size_t i = 0; i < mips[2].pixels.size(); i += 4) {
+        shortest = (std::min)(shortest, GetNormalLength(&mips[2].pixels[i]));
+    }
+    EXPECT_LT(shortest, 0.9f);
+
+    options.isNormalMap = true;
+    ASSERT_TRUE(generator.Generate(image, options, mips));
+    for (size_t mip = 1; mip < mips.size(); mip++) {
+        for (size_t i = 0; i < mips[mip].pixels.size(); i += 4) {
+            // Rounding of components to 8 bits moves length by up to sqrt(3) / 255
+            ASSERT_NEAR(GetNormalLength(&mips[mip].pixels[i]), 1.0f, 0.007f) << mip << " " << i;
+        }
+    }
+}
+
+TEST(MipGenerator, ParallelRowsMatchSerial) {
+    JobSystem jobSystem;
+    jobSystem.Init(4);
+    MipGenerator serial;
+    MipGenerator parallel;
+    parallel.Init(&jobSystem);
+    TextureCompressor::Image image = MakeImage(257, 131, 6);
+    for (MipGenerator::Filter filter : { MipGenerator::FILTER_BOX, MipGenerator::FILTER_KAISER, MipGenerator::FILTER_LANCZOS }) {
+        MipGenerator::Options options;
+        options.filter = filter;
+        options.isSRGB = filter == MipGenerator::FILTER_KAISER;
+        std::vector<TextureCompressor::Image> serialMips;
+        std::vector<TextureCompressor::Image> parallelMips;
+        ASSERT_TRUE(serial.Generate(image, options, serialMips));
+        ASSERT_TRUE(parallel.Generate(image, options, parallelMips));
+        ASSERT_EQ(serialMips.size(), parallelMips.size());
+        for (size_t mip = 0; mip < serialMips.size(); mip++) {
+            EXPECT_EQ(serialMips[mip].pixels, parallelMips[mip].pixels) << filter << " " << mip;
+        }
+    }
+    parallel.Release();
+    jobSystem.Release();
+}
+
+TEST(MipGenerator, ConvertWritesFullChain) {
+    std::string sourceFile = GetTestPath("source.dds");
+    std::string convertedFile = GetTestPath("mips.dds");
+    TextureCompressor::Image image = MakeSmoothImage(64, 32);
+    ASSERT_TRUE(DdsFile::Write(sourceFile.c_str(), DdsFile::FORMAT_R8G8B8A8_UNORM_SRGB, image.width, image.height, { image.pixels }));
+    DdsFile source;
+    ASSERT_TRUE(source.Open(sourceFile.c_str()));
+
+    MipGenerator generator;
+    MipGenerator::Options options;
+    options.isSRGB = true;
+    std::vector<TextureCompressor::Image> mips;
+    ASSERT_TRUE(generator.Generate(image, options, mips));
+
+    ASSERT_TRUE(generator.Convert(source, options, DdsFile::FORMAT_R8G8B8A8_UNORM_SRGB, convertedFile.c_str()));
+    DdsFile converted;
+    ASSERT_TRUE(converted.Open(convertedFile.c_str()));
+    EXPECT_EQ(converted.GetDesc().format, DdsFile::FORMAT_R8G8B8A8_UNORM_SRGB);
+    ASSERT_EQ(converted.GetDesc().mipCount, 7u);
+    for (uint32_t mip = 0; mip < 7; mip++) {
+        TextureCompressor::Image read;
+        ASSERT_TRUE(TextureCompressor::ReadImage(converted, (int)mip, read));
+        EXPECT_EQ(read.pixels, mips[mip].pixels) << mip;
+    }
+    converted.Release();
+
+    ASSERT_TRUE(generator.Convert(source, options, DdsFile::FORMAT_BC7_UNORM_SRGB, convertedFile.c_str()));
+    ASSERT_TRUE(converted.Open(convertedFile.c_str()));
+    EXPECT_EQ(converted.GetDesc().format, DdsFile::FORMAT_BC7_UNORM_SRGB);
+    EXPECT_EQ(converted.GetDesc().mipCount, 7u);
+    TextureCompressor::Image read;
+    ASSERT_TRUE(TextureCompressor::ReadImage(converted, 1, read));
+    EXPECT_GT(TextureCompressor::ComputePSNR(read, mips[1]), 32.0);
+
+    converted.Release();
+    source.Release();
+    std::remove(sourceFile.c_str());
+    std::remove(convertedFile.c_str());
+}
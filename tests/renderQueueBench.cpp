@@ -0,0 +1,101 @@
+// renderQueueBench.cpp - radix sort of draw packets against std::stable_sort, state changes of sorted submission
+// and submission split in parts recorded on worker threads
+#include <algorithm>
+#include <random>
+#include "benchTimer.h"
+#include "jobSystem.h"
+#include "renderQueue.h"
+
+int main() {
+    const int count = 200000;
+    std::mt19937 random(9);
+    std::uniform_int_distribution<int> state(0, 63);
+    std::uniform_real_distribution<float> depth(0.0f, 1000.0f);
+    RenderQueue queue;
+    queue.Init();
+    for (int i = 0; i < count; i++) {
+        DrawPacket packet;
+        packet.pipeline = state(random) % 8;
+        packet.material = state(random);
+        bool transparent = i % 10 == 0;
+        RenderQueue::Pass pass = transparent ? RenderQueue::PASS_TRANSPARENT : RenderQueue::PASS_OPAQUE;
+        packet.key = RenderQueue::MakeKey(pass, transparent, packet.pipeline, packet.material, depth(random));
+        queue.Push(packet);
+    }
+
+    double radix = MeasureBest(5, [&]() { queue.Sort(); });
+
+    std::vector<std::pair<uint64_t, int>> items(count);
+    double stdSort = MeasureBest(5, [&]() {
+        for (int i = 0; i < count; i++) {
+            items[i] = std::make_pair(queue.GetPackets()[i].key, i);
+        }
+        std::stable_sort(items.begin(), items.end(), [](const std::pair<uint64_t, int>& a, const std::pair<uint64_t, int>& b) { return a.first < b.first; });
+    });
+
+    // Binds of sorted submission against binds in push order
+    RecordingBackend backend;
+    backend.Init(false);
+    double submit = MeasureBest(5, [&]() {
+        backend.Reset();
+        queue.Submit(&backend);
+    });
+    int unsortedChanges = 0;
+    for (int i = 0; i < count; i++) {
+        const DrawPacket& packet = queue.GetPackets()[i];
+        unsortedChanges += i == 0 || packet.pipeline != queue.GetPackets()[i - 1].pipeline;
+        unsortedChanges += i == 0 || packet.material != queue.GetPackets()[i - 1].material;
+    }
+
+    PrintResult("Radix sort", radix, count);
+    PrintResult("std::stable_sort", stdSort, count);
+    PrintResult("Submit to counting backend", submit, count);
+    printf("state changes %d sorted, %d in push order\n", backend.GetPipelineChanges() + backend.GetMaterialChanges(), unsortedChanges);
+
+    // Recording backends store commands like deferred contexts, so parts do real work to split
+    const int maxParts = 8;
+    JobSystem jobSystem;
+    jobSystem.Init();
+    std::vector<DrawPacket> packets = queue.GetPackets();
+    queue.Init(&jobSystem);
+    for (const DrawPacket& packet : packets) {
+        queue.Push(packet);
+    }
+    queue.Sort();
+    RecordingBackend parts[maxParts];
+    RenderBackend* backends[maxParts];
+    for (int i = 0; i < maxParts; i++) {
+        parts[i].Init();
+        backends[i] = &parts[i];
+    }
+    RecordingBackend merged;
+    merged.Init();
+    for (int partsCount = 1; partsCount <= maxParts; partsCount *= 2) {
+        double parallel = MeasureBest(5, [&]() {
+            for (int i = 0; i < partsCount; i++) {
+                parts[i].Reset();
+            }
+            queue.SubmitParallel(backends, partsCount);
+        });
+        double merge = MeasureBest(5, [&]() {
+            merged.Reset();
+            for (int i = 0; i < partsCount; i++) {
+                merged.Append(parts[i]);
+            }
+        });
+        char name[64];
+        snprintf(name, sizeof(name), "Submit in %d parts", partsCount);
+        PrintResult(name, parallel, queue.GetCount());
+        snprintf(name, sizeof(name), "Append %d parts", partsCount);
+        PrintResult(name, merge, queue.GetCount());
+    }
+
+    for (RecordingBackend& part : parts) {
+        part.Release();
+    }
+    merged.Release();
+    backend.Release();
+    queue.Release();
+    jobSystem.Release();
+    return backend.GetDrawsCount() == count && merged.GetDrawsCount() == count ? 0 : 1;
+}
@@ -0,0 +1,325 @@
+// renderQueueTest.cpp - sort keys, stable radix sort and state change elision of render queue
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include "jobSystem.h"
+#include "renderQueue.h"
+
+namespace {
+    // Function to fill queue with packets of random passes, states and depths
+    void PushRandomPackets(RenderQueue& queue, int count, unsigned int seed) {
+        std::mt19937 random(seed);
+        std::uniform_int_distribution<int> pass(0, RenderQueue::PASS_COUNT - 1);
+        std::uniform_int_distribution<int> state(0, 15);
+        std::uniform_real_distribution<float> depth(-10.0f, 100.0f);
+        for (int i = 0; i < count; i++) {
+            DrawPacket packet;
+            RenderQueue::Pass packetPass = (RenderQueue::Pass)pass(random);
+            packet.pipeline = state(random);
+            packet.material = state(random);
+            // Few distinct depths, so equal keys are common and stability is checked
+            float packetDepth = std::floor(depth(random) * 0.1f);
+            packet.key = RenderQueue::MakeKey(packetPass, packetPass == RenderQueue::PASS_TRANSPARENT, packet.pipeline, packet.material, packetDepth);
+            packet.startIndex = i;
+            queue.Push(packet);
+        }
+    }
+
+    // Function to check that sorted order is stable sort of packets by keys
+    void ExpectStableSorted(const RenderQueue& queue) {
+        std::vector<int> expected(queue.GetCount());
+        for (int i = 0; i < queue.GetCount(); i++) {
+            expected[i] = i;
+        }
+        const std::vector<DrawPacket>& packets = queue.GetPackets();
+        std::stable_sort(expected.begin(), expected.end(), [&](int a, int b) { return packets[a].key < packets[b].key; });
+        for (int i = 0; i < queue.GetCount(); i++) {
+            ASSERT_EQ(queue.GetSortedIndex(i), expected[i]) << i;
+        }
+    }
+}
+
+TEST(RenderQueue, KeysOrderPassesAndDepths) {
+    typedef RenderQueue Q;
+    // Passes go in order whatever other fields are
+    EXPECT_LT(Q::MakeKey(Q::PASS_OPAQUE, false, 2047, 65535, 1e30f), Q::MakeKey(Q::PASS_SKY, false, 0, 0, -1e30f));
+    EXPECT_LT(Q::MakeKey(Q::PASS_SKY, false, 2047, 65535, 1e30f), Q::MakeKey(Q::PASS_TRANSPARENT, true, 0, 0, 1e30f));
+
+    // Opaque packets are grouped by pipeline, then material, then front to back
+    EXPECT_LT(Q::MakeKey(Q::PASS_OPAQUE, false, 1, 9, 100.0f), Q::MakeKey(Q::PASS_OPAQUE, false, 2, 0, 0.0f));
+    EXPECT_LT(Q::MakeKey(Q::PASS_OPAQUE, false, 1, 1, 100.0f), Q::MakeKey(Q::PASS_OPAQUE, false, 1, 2, 0.0f));
+    EXPECT_LT(Q::MakeKey(Q::PASS_OPAQUE, false, 1, 1, -5.0f), Q::MakeKey(Q::PASS_OPAQUE, false, 1, 1, 3.0f));
+    EXPECT_LT(Q::MakeKey(Q::PASS_OPAQUE, false, 1, 1, 3.0f), Q::MakeKey(Q::PASS_OPAQUE, false, 1, 1, 4.0f));
+
+    // Transparent packets go back to front before states
+    EXPECT_LT(Q::MakeKey(Q::PASS_TRANSPARENT, true, 5, 5, 10.0f), Q::MakeKey(Q::PASS_TRANSPARENT, true, 0, 0, 2.0f));
+    EXPECT_LT(Q::MakeKey(Q::PASS_TRANSPARENT, true, 5, 5, 2.0f), Q::MakeKey(Q::PASS_TRANSPARENT, true, 0, 0, -2.0f));
+    EXPECT_LT(Q::MakeKey(Q::PASS_TRANSPARENT, true, 0, 5, 2.0f), Q::MakeKey(Q::PASS_TRANSPARENT, true, 1, 0, 2.0f));
+}
+
+TEST(RenderQueue, SortIsStable) {
+    for (int count : { 0, 1, 7, 1000, 50000 }) {
+        RenderQueue queue;
+        queue.Init();
+        PushRandomPackets(queue, count, (unsigned int)count);
+        queue.Sort();
+        ExpectStableSorted(queue);
+        queue.Release();
+    }
+}
+
+TEST(RenderQueue, ParallelSortMatchesSerial) {
+    JobSystem jobSystem;
+    jobSystem.Init(4);
+    RenderQueue queue;
+    queue.Init(&jobSystem);
+    PushRandomPackets(queue, 100000, 11);
+    queue.Sort();
+    ExpectStableSorted(queue);
+
+    // Queue is reused between frames
+    queue.Clear();
+    PushRandomPackets(queue, 30000, 12);
+    queue.Sort();
+    ExpectStableSorted(queue);
+    queue.Release();
+    jobSystem.Release();
+}
+
+TEST(RenderQueue, SubmitSkipsRepeatedStates) {
+    RenderQueue queue;
+    queue.Init();
+    // Two pipelines with two materials each, pushed interleaved
+    for (int i = 0; i < 40; i++) {
+        DrawPacket packet;
+        packet.pipeline = i % 2;
+        packet.material = (i / 2) % 2;
+        packet.key = RenderQueue::MakeKey(RenderQueue::PASS_OPAQUE, false, packet.pipeline, packet.material, (float)i);
+        queue.Push(packet);
+    }
+    queue.Sort();
+
+    RecordingBackend backend;
+    backend.Init();
+    queue.Submit(&backend);
+    EXPECT_EQ(backend.GetDrawsCount(), 40);
+    EXPECT_EQ(backend.GetPipelineChanges(), 2);
+    EXPECT_EQ(backend.GetMaterialChanges(), 4);
+    EXPECT_EQ(queue.GetSubmitStats().packets, 40);
+    EXPECT_EQ(queue.GetSubmitStats().pipelineChanges, 2);
+    EXPECT_EQ(queue.GetSubmitStats().materialChanges, 4);
+
+    // Commands come in key order: pipeline, material, its draws, next material...
+    const std::vector<RecordingBackend::Command>& commands = backend.GetCommands();
+    ASSERT_EQ(commands.size(), 46u);
+    EXPECT_EQ(commands[0].type, RecordingBackend::COMMAND_SET_PIPELINE);
+    EXPECT_EQ(commands[0].id, 0);
+    EXPECT_EQ(commands[1].type, RecordingBackend::COMMAND_SET_MATERIAL);
+    EXPECT_EQ(commands[1].id, 0);
+    EXPECT_EQ(commands[2].type, RecordingBackend::COMMAND_DRAW);
+    EXPECT_EQ(commands[2].id, 0);
+    backend.Release();
+    queue.Release();
+}
+
+TEST(RecordingBackend, CountsAndForwardsCommands) {
+    RecordingBackend next;
+    next.Init();
+    RecordingBackend backend;
+    backend.Init(false, &next);
+
+    DrawPacket packet;
+    backend.SetPipeline(3);
+    backend.SetMaterial(4);
+    backend.Draw(packet);
+    int data[4] = {};
+    backend.UploadBuffer(1, 0, data, sizeof(data));
+    backend.CopyBuffer(2, 1);
+    backend.Dispatch(0, 8, 1, 1);
+
+    // Not recording backend counts only
+    EXPECT_TRUE(backend.GetCommands().empty());
+    EXPECT_EQ(backend.GetDrawsCount(), 1);
+    EXPECT_EQ(backend.GetUploadBytes(), sizeof(data));
+    EXPECT_EQ(backend.GetCopiesCount(), 1);
+    EXPECT_EQ(backend.GetDispatchesCount(), 1);
+    ASSERT_EQ(next.GetCommands().size(), 6u);
+    EXPECT_EQ(next.GetCommands()[3].type, RecordingBackend::COMMAND_UPLOAD);
+    EXPECT_EQ(next.GetCommands()[3].bytes, sizeof(data));
+
+    backend.Reset();
+    EXPECT_EQ(backend.GetDrawsCount(), 0);
+    backend.Release();
+    next.Release();
+}
+
+TEST(RecordingBackend, WritesConstantsWithoutNextBackend) {
+    RecordingBackend backend;
+    backend.Init();
+
+    EXPECT_TRUE(backend.MapConstants());
+    float* constants = static_cast<float*>(backend.AllocateConstants(2, 64));
+    ASSERT_NE(constants, nullptr);
+    EXPECT_EQ((uintptr_t)constants % 16, 0u);
+    constants[15] = 5.0f;
+    backend.UnmapConstants();
+    EXPECT_TRUE(backend.ResizeBuffer(1, 256));
+    backend.EndFrame();
+
+    // Written values stay readable, ids never allocated have none
+    ASSERT_NE(backend.GetConstants(2), nullptr);
+    EXPECT_EQ(static_cast<const float*>(backend.GetConstants(2))[15], 5.0f);
+    EXPECT_EQ(backend.GetConstants(0), nullptr);
+    EXPECT_EQ(backend.GetConstants(3), nullptr);
+    EXPECT_EQ(backend.GetConstantBytes(), 64u);
+    EXPECT_EQ(backend.GetResizesCount(), 1);
+
+    const std::vector<RecordingBackend::Command>& commands = backend.GetCommands();
+    ASSERT_EQ(commands.size(), 3u);
+    EXPECT_EQ(commands[0].type, RecordingBackend::COMMAND_CONSTANTS);
+    EXPECT_EQ(commands[0].id, 2);
+    EXPECT_EQ(commands[1].type, RecordingBackend::COMMAND_RESIZE);
+    EXPECT_EQ(commands[1].bytes, 256u);
+    EXPECT_EQ(commands[2].type, RecordingBackend::COMMAND_END_FRAME);
+    backend.Release();
+}
+
+TEST(RecordingBackend, ForwardsConstantsToNextBackend) {
+    RecordingBackend next;
+    next.Init();
+    RecordingBackend backend;
+    backend.Init(false, &next);
+
+    EXPECT_TRUE(backend.MapConstants());
+    void* constants = backend.AllocateConstants(0, 16);
+    backend.UnmapConstants();
+    backend.ResizeBuffer(3, 32);
+    backend.EndFrame();
+
+    // Memory comes from next backend, counters are kept by both
+    EXPECT_EQ(constants, next.GetConstants(0));
+    EXPECT_EQ(backend.GetConstants(0), nullptr);
+    EXPECT_EQ(backend.GetConstantBytes(), 16u);
+    EXPECT_EQ(backend.GetResizesCount(), 1);
+    EXPECT_EQ(next.GetResizesCount(), 1);
+    ASSERT_EQ(next.GetCommands().size(), 3u);
+    EXPECT_EQ(next.GetCommands()[2].type, RecordingBackend::COMMAND_END_FRAME);
+    backend.Release();
+    next.Release();
+}
+
+namespace {
+    // Function to check that recorded draws use pipeline and material of packets in sorted order
+    void ExpectDrawsInSortedOrder(const RenderQueue& queue, const RecordingBackend& backend) {
+        int pipeline = -1;
+        int material = -1;
+        int draws = 0;
+        for (const RecordingBackend::Command& command : backend.GetCommands()) {
+            if (command.type == RecordingBackend::COMMAND_SET_PIPELINE) {
+                pipeline = command.id;
+            }
+            else if (command.type == RecordingBackend::COMMAND_SET_MATERIAL) {
+                material = command.id;
+            }
+            else if (command.type == RecordingBackend::COMMAND_DRAW) {
+                ASSERT_EQ(command.id, draws);
+                const DrawPacket& packet = queue.GetPackets()[queue.GetSortedIndex(draws)];
+                ASSERT_EQ(pipeline, packet.pipeline) << draws;
+                ASSERT_EQ(material, packet.material) << draws;
+                draws++;
+            }
+        }
+        EXPECT_EQ(draws, queue.GetCount());
+    }
+}
+
+TEST(RenderQueue, SubmitPartsDependOnPacketsCount) {
+    RenderQueue queue;
+    queue.Init();
+    EXPECT_EQ(queue.GetSubmitParts(8), 1);
+    PushRandomPackets(queue, 100, 1);
+    EXPECT_EQ(queue.GetSubmitParts(8), 1);
+    PushRandomPackets(queue, 10000, 2);
+    queue.Sort();
+    EXPECT_EQ(queue.GetSubmitParts(8), 8);
+    EXPECT_EQ(queue.GetSubmitParts(3), 3);
+    queue.Release();
+}
+
+TEST(RenderQueue, ParallelSubmitMergesToSortedOrder) {
+    JobSystem jobSystem;
+    jobSystem.Init(4);
+    RenderQueue queue;
+    queue.Init(&jobSystem);
+    PushRandomPackets(queue, 20000, 5);
+    queue.Sort();
+
+    RecordingBackend serial;
+    serial.Init();
+    queue.Submit(&serial);
+    RenderQueue::SubmitStats serialStats = queue.GetSubmitStats();
+    ExpectDrawsInSortedOrder(queue, serial);
+
+    const int partsCount = 4;
+    RecordingBackend parts[partsCount];
+    RenderBackend* backends[partsCount];
+    for (int i = 0; i < partsCount; i++) {
+        parts[i].Init();
+        backends[i] = &parts[i];
+    }
+    queue.SubmitParallel(backends, partsCount);
+
+    // Parts appended in order give the same draws, each part binds its first states again
+    RecordingBackend merged;
+    merged.Init();
+    for (int i = 0; i < partsCount; i++) {
+        EXPECT_GT(parts[i].GetDrawsCount(), 0);
+        merged.Append(parts[i]);
+    }
+    ExpectDrawsInSortedOrder(queue, merged);
+    EXPECT_EQ(merged.GetDrawsCount(), serial.GetDrawsCount());
+    EXPECT_GE(merged.GetPipelineChanges(), serial.GetPipelineChanges());
+    EXPECT_LE(merged.GetPipelineChanges(), serial.GetPipelineChanges() + partsCount - 1);
+    EXPECT_GE(merged.GetMaterialChanges(), serial.GetMaterialChanges());
+    EXPECT_LE(merged.GetMaterialChanges(), serial.GetMaterialChanges() + partsCount - 1);
+
+    const RenderQueue::SubmitStats& stats = queue.GetSubmitStats();
+    EXPECT_EQ(stats.packets, serialStats.packets);
+    EXPECT_EQ(stats.pipelineChanges, merged.GetPipelineChanges());
+    EXPECT_EQ(stats.materialChanges, merged.GetMaterialChanges());
+
+    for (RecordingBackend& part : parts) {
+        part.Release();
+    }
+    merged.Release();
+    serial.Release();
+    queue.Release();
+    jobSystem.Release();
+}
+
+TEST(RecordingBackend, AppendSumsCountersWithoutCommands) {
+    RecordingBackend first;
+    first.Init(false);
+    RecordingBackend second;
+    second.Init();
+    DrawPacket packet;
+    first.SetPipeline(0);
+    first.Draw(packet);
+    second.SetMaterial(1);
+    second.Draw(packet);
+    second.Draw(packet);
+    second.ResizeBuffer(0, 16);
+    second.AllocateConstants(0, 32);
+
+    // Counting backend doesn't take commands of recording one
+    first.Append(second);
+    EXPECT_TRUE(first.GetCommands().empty());
+    EXPECT_EQ(first.GetDrawsCount(), 3);
+    EXPECT_EQ(first.GetPipelineChanges(), 1);
+    EXPECT_EQ(first.GetMaterialChanges(), 1);
+    EXPECT_EQ(first.GetResizesCount(), 1);
+    EXPECT_EQ(first.GetConstantBytes(), 32u);
+    first.Release();
+    second.Release();
+}
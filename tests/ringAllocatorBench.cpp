@@ -0,0 +1,37 @@
+// ringAllocatorBench.cpp - cost and space efficiency of constant sub-allocation with frames in flight
+#include <random>
+#include "benchTimer.h"
+#include "ringAllocator.h"
+
+int main() {
+    // Frames of constants of typical sizes, retired with three frames of latency
+    const int framesCount = 20000;
+    const int perFrame = 64;
+    const uint32_t sizes[] = { 64, 208, 256, 1040 };
+    std::mt19937 random(2);
+    std::uniform_int_distribution<int> sizeIndex(0, 3);
+    std::vector<uint32_t> frameSizes(framesCount * perFrame);
+    for (uint32_t& size : frameSizes) {
+        size = sizes[sizeIndex(random)];
+    }
+
+    RingAllocator ring;
+    double ms = MeasureBest(3, [&]() {
+        ring.Init(1 << 20, 256);
+        uint32_t offset;
+        for (int frame = 0; frame < framesCount; frame++) {
+            for (int i = 0; i < perFrame; i++) {
+                ring.Allocate(frameSizes[frame * perFrame + i], offset);
+            }
+            ring.EndFrame((uint64_t)frame + 1);
+            ring.Retire((uint64_t)(frame > 3 ? frame - 3 : 0));
+        }
+    });
+
+    const RingAllocator::Stats& stats = ring.GetStats();
+    PrintResult("Allocate", ms, frameSizes.size());
+    printf("failed %d, peak %u KB of %u KB, alignment loss %.1f %%, wrap loss %.2f %%\n", stats.failed, stats.peakUsed / 1024, ring.GetSize() / 1024,
+        100.0 * (double)stats.alignmentBytes / (double)(stats.requestedBytes + stats.alignmentBytes + stats.wrapBytes),
+        100.0 * (double)stats.wrapBytes / (double)(stats.requestedBytes + stats.alignmentBytes + stats.wrapBytes));
+    return stats.failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+// ringAllocatorTest.cpp - alignment, wrap and fence recycling of ring allocator
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <deque>
+#include <random>
+#include "ringAllocator.h"
+
+TEST(RingAllocator, AlignsOffsetsAndSizes) {
+    RingAllocator ring;
+    ring.Init(4096, 256);
+    uint32_t a = 1, b = 1;
+    ASSERT_TRUE(ring.Allocate(100, a));
+    ASSERT_TRUE(ring.Allocate(300, b));
+    EXPECT_EQ(a, 0u);
+    EXPECT_EQ(b, 256u);
+    EXPECT_EQ(ring.GetUsed(), 768u);
+    EXPECT_EQ(ring.GetStats().requestedBytes, 400u);
+    EXPECT_EQ(ring.GetStats().alignmentBytes, 368u);
+
+    uint32_t offset;
+    EXPECT_FALSE(ring.Allocate(0, offset));
+    EXPECT_FALSE(ring.Allocate(8192, offset));
+    EXPECT_EQ(ring.GetStats().failed, 2);
+    ring.Release();
+}
+
+TEST(RingAllocator, FullRingWaitsForFence) {
+    RingAllocator ring;
+    ring.Init(1024, 256);
+    uint32_t offset;
+    for (int i = 0; i < 4; i++) {
+        ASSERT_TRUE(ring.Allocate(256, offset));
+    }
+    ring.EndFrame(1);
+    EXPECT_FALSE(ring.Allocate(256, offset));
+
+    uint64_t fence = 0;
+    ASSERT_TRUE(ring.GetOldestFence(fence));
+    EXPECT_EQ(fence, 1u);
+    ring.Retire(0);
+    EXPECT_FALSE(ring.Allocate(256, offset));
+    ring.Retire(1);
+    EXPECT_EQ(ring.GetFramesInFlight(), 0);
+    EXPECT_EQ(ring.GetUsed(), 0u);
+    EXPECT_FALSE(ring.GetOldestFence(fence));
+    EXPECT_TRUE(ring.Allocate(1024, offset));
+    EXPECT_EQ(offset, 0u);
+}
+
+TEST(RingAllocator, WrapsAllocationThatDoesntFitAtEnd) {
+    RingAllocator ring;
+    ring.Init(1024, 256);
+    uint32_t offset;
+    ASSERT_TRUE(ring.Allocate(512, offset));
+    ring.EndFrame(1);
+    ASSERT_TRUE(ring.Allocate(256, offset));
+    EXPECT_EQ(offset, 512u);
+    ring.EndFrame(2);
+    ring.Retire(1);
+
+    // 256 bytes are left at end, 512 go to beginning and end bytes are lost
+    ASSERT_TRUE(ring.Allocate(512, offset));
+    EXPECT_EQ(offset, 0u);
+    EXPECT_EQ(ring.GetStats().wrapBytes, 256u);
+    EXPECT_EQ(ring.GetUsed(), 1024u);
+}
+
+TEST(RingAllocator, LiveRangesNeverOverlap) {
+    struct Range {
+        uint32_t offset;
+        uint32_t size;
+        uint64_t fence;
+    };
+
+    RingAllocator ring;
+    ring.Init(65536, 256);
+    std::mt19937 random(21);
+    std::uniform_int_distribution<uint32_t> size(1, 4096);
+    std::uniform_int_distribution<int> allocations(0, 20);
+    std::uniform_int_distribution<int> latency(0, 3);
+    std::deque<Range> live;
+    uint64_t completed = 0;
+
+    for (uint64_t frame = 1; frame <= 20000; frame++) {
+        int count = allocations(random);
+        for (int i = 0; i < count; i++) {
+            uint32_t bytes = size(random);
+            uint32_t offset;
+            if (!ring.Allocate(bytes, offset)) {
+                continue;
+            }
+            ASSERT_EQ(offset % 256, 0u);
+            ASSERT_LE(offset + bytes, ring.GetSize());
+            for (const Range& range : live) {
+                ASSERT_TRUE(offset + bytes <= range.offset || range.offset + range.size <= offset) << frame;
+            }
+            live.push_back({ offset, bytes, frame });
+        }
+        ring.EndFrame(frame);
+
+        // GPU finishes frames with few frames of latency
+        uint64_t finished = frame > 3 ? frame - (uint64_t)latency(random) : 0;
+        completed = (std::max)(completed, finished);
+        ring.Retire(completed);
+        while (!live.empty() && live.front().fence <= completed) {
+            live.pop_front();
+        }
+        ASSERT_LE(ring.GetUsed(), ring.GetSize());
+    }
+    EXPECT_GT(ring.GetStats().allocations, 100000);
+}
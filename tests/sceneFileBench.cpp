@@ -0,0 +1,51 @@
+// sceneFileBench.cpp - loading of scene file against generating same scene
+#include <cstdio>
+#include "benchTimer.h"
+#include "sceneFile.h"
+#include "sceneGenerator.h"
+
+int main() {
+    const int count = 1000000;
+    const char* path = "sceneFileBench.bin";
+    SceneGenerator::SceneDesc desc;
+    desc.cubesCount = count;
+    SceneGenerator generator;
+    generator.Init(desc);
+
+    // Generation and bulk add, as scene does without file
+    CubeInstances cubes;
+    double generate = MeasureBest(3, [&]() {
+        SceneGenerator::CubeStreams streams;
+        generator.GenerateCubes(0, count, streams);
+        cubes.Release();
+        cubes.Init(count);
+        cubes.Add(count, streams.posX.data(), streams.posY.data(), streams.posZ.data(), streams.angularSpeed.data(), streams.materials.data());
+    });
+    if (!SceneFile::Write(path, cubes, {}, { "data/brick_diffuse.dds" })) {
+        return 1;
+    }
+
+    // Mapping and validation only, what aliasing streams to file would cost
+    double open = MeasureBest(3, [&]() {
+        SceneFile file;
+        file.Open(path);
+    });
+    // Mapping, validation and copy of streams into instances, as Scene::LoadScene does
+    double load = MeasureBest(3, [&]() {
+        SceneFile file;
+        file.Open(path);
+        const SceneFile::View& view = file.GetView();
+        cubes.Release();
+        cubes.Init(view.cubesCount);
+        cubes.Add(view.cubesCount, view.posX, view.posY, view.posZ, view.angularSpeed, view.materials);
+    });
+
+    PrintResult("Generate and add", generate, count);
+    PrintResult("Open file", open, count);
+    PrintResult("Open file and add", load, count);
+
+    bool isLoaded = cubes.GetCount() == count;
+    cubes.Release();
+    std::remove(path);
+    return isLoaded ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+// sceneFileTest.cpp - writing, mapping and validation of binary scene file
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include "sceneFile.h"
+#include "sceneGenerator.h"
+#include "testPath.h"
+
+namespace {
+    // Function to write scene of count generated cubes, two lights and two textures
+    void WriteScene(const std::string& path, int count, CubeInstances& cubes) {
+        SceneGenerator::SceneDesc desc;
+        desc.cubesCount = count;
+        SceneGenerator generator;
+        generator.Init(desc);
+        SceneGenerator::CubeStreams streams;
+        generator.GenerateCubes(0, count, streams);
+        cubes.Init(count);
+        cubes.Add(count, streams.posX.data(), streams.posY.data(), streams.posZ.data(), streams.angularSpeed.data(), streams.materials.data());
+
+        std::vector<std::pair<XMFLOAT3, XMFLOAT3>> lights = {
+            { XMFLOAT3(1.0f, 2.0f, 3.0f), XMFLOAT3(1.0f, 0.0f, 0.0f) },
+            { XMFLOAT3(-1.0f, 0.0f, 5.0f), XMFLOAT3(0.0f, 1.0f, 1.0f) }
+        };
+        ASSERT_TRUE(SceneFile::Write(path.c_str(), cubes, lights, { "data/brick_diffuse.dds", "data/morgana.dds" }));
+    }
+
+    std::vector<unsigned char> ReadBytes(const char* path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::vector<unsigned char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+}
+
+TEST(SceneFile, RoundTrip) {
+    std::string path = GetTestPath("scene.bin");
+    CubeInstances cubes;
+    WriteScene(path, 1000, cubes);
+
+    SceneFile file;
+    ASSERT_TRUE(file.Open(path.c_str()));
+    const SceneFile::View& view = file.GetView();
+    ASSERT_EQ(view.cubesCount, 1000);
+    for (int i = 0; i < view.cubesCount; i++) {
+        ASSERT_EQ(view.posX[i], cubes.GetPositionsX()[i]);
+        ASSERT_EQ(view.posY[i], cubes.GetPositionsY()[i]);
+        ASSERT_EQ(view.posZ[i], cubes.GetPositionsZ()[i]);
+        ASSERT_EQ(view.angularSpeed[i], cubes.GetAngularSpeeds()[i]);
+        ASSERT_EQ(view.materials[i].z, cubes.GetMaterials()[i].z);
+    }
+    ASSERT_EQ(view.lightsCount, 2);
+    EXPECT_EQ(view.lightPositions[1].z, 5.0f);
+    EXPECT_EQ(view.lightColors[0].x, 1.0f);
+    ASSERT_EQ(view.texturesCount, 2);
+    EXPECT_STREQ(view.textureNames, "data/brick_diffuse.dds");
+    EXPECT_STREQ(view.textureNames + SCENE_TEXTURE_NAME_SIZE, "data/morgana.dds");
+
+    // Blocks are used as streams in place, so they keep stream alignment
+    EXPECT_EQ((uintptr_t)view.posX % SCENE_FILE_ALIGNMENT, 0u);
+    EXPECT_EQ((uintptr_t)view.materials % SCENE_FILE_ALIGNMENT, 0u);
+
+    file.Release();
+    cubes.Release();
+    std::remove(path.c_str());
+}
+
+TEST(SceneFile, RejectsDamagedData) {
+    std::string path = GetTestPath("scene.bin");
+    CubeInstances cubes;
+    WriteScene(path, 100, cubes);
+    std::vector<unsigned char> data = ReadBytes(path.c_str());
+    std::remove(path.c_str());
+    ASSERT_TRUE(SceneFile::Validate(data.data(), data.size()));
+
+    // Truncated file
+    EXPECT_FALSE(SceneFile::Validate(data.data(), data.size() - 1));
+    EXPECT_FALSE(SceneFile::Validate(data.data(), sizeof(SceneFile::Header) - 1));
+
+    // Wrong magic
+    std::vector<unsigned char> damaged = data;
+    damaged[0] ^= 0xFF;
+    EXPECT_FALSE(SceneFile::Validate(damaged.data(), damaged.size()));
+
+    // Block past end of file
+    damaged = data;
+    SceneFile::Block* blocks = reinterpret_cast<SceneFile::Block*>(damaged.data() + sizeof(SceneFile::Header));
+    blocks[SceneFile::BLOCK_MATERIAL].count = 1ull << 40;
+    EXPECT_FALSE(SceneFile::Validate(damaged.data(), damaged.size()));
+
+    // Cubes count not matching streams
+    damaged = data;
+    blocks = reinterpret_cast<SceneFile::Block*>(damaged.data() + sizeof(SceneFile::Header));
+    blocks[SceneFile::BLOCK_POSITION_Y].count--;
+    EXPECT_FALSE(SceneFile::Validate(damaged.data(), damaged.size()));
+
+    // Misaligned block
+    damaged = data;
+    blocks = reinterpret_cast<SceneFile::Block*>(damaged.data() + sizeof(SceneFile::Header));
+    blocks[SceneFile::BLOCK_POSITION_X].offset += 4;
+    EXPECT_FALSE(SceneFile::Validate(damaged.data(), damaged.size()));
+
+    // Texture name without terminating zero
+    damaged = data;
+    blocks = reinterpret_cast<SceneFile::Block*>(damaged.data() + sizeof(SceneFile::Header));
+    damaged[(size_t)blocks[SceneFile::BLOCK_TEXTURE_NAME].offset + SCENE_TEXTURE_NAME_SIZE - 1] = 'x';
+    EXPECT_FALSE(SceneFile::Validate(damaged.data(), damaged.size()));
+
+    cubes.Release();
+}
+
+TEST(SceneFile, OpenFailsForMissingFile) {
+    SceneFile file;
+    EXPECT_FALSE(file.Open(GetTestPath("missing.bin").c_str()));
+    EXPECT_EQ(file.GetView().cubesCount, 0);
+}
@@ -0,0 +1,324 @@
+// sceneFrameTest.cpp - whole scene frame and its draws run headless against recording backend
+#include <gtest/gtest.h>
+#include "sceneFrame.h"
+
+namespace {
+    // Backend ids of test scene, buffers, constants, pipelines and materials are numbered separately
+    enum Buffer { GEOM = 0, CULL_BOXES, VISIBLE, VISIBLE_GPU, TRANS_GEOM, INDIRECT_ARGS, INDIRECT_ARGS_SRC };
+    enum Constants { CULL_PARAMS = 0, SCENE, LIGHT, LIGHTS_WORLD, LIGHTS_SCENE, SKY_WORLD, SKY_SCENE };
+    enum Pipeline { CUBES_PIPELINE = 0, TRANS_PIPELINE, LIGHTS_PIPELINE, SKY_PIPELINE };
+    enum Material { CUBES_MATERIAL = 0, CUBES_GPU_MATERIAL, TRANS_MATERIAL, LIGHTS_MATERIAL, SKY_MATERIAL };
+
+    // Backend failing given part of frame
+    class FailingBackend : public RecordingBackend {
+    public:
+        bool failResize = false;
+        bool failConstants = false;
+
+        bool ResizeBuffer(int buffer, uint32_t size) override { RecordingBackend::ResizeBuffer(buffer, size); return !failResize; };
+        void* AllocateConstants(int constants, uint32_t size) override {
+            void* data = RecordingBackend::AllocateConstants(constants, size);
+            return failConstants ? nullptr : data;
+        };
+    };
+
+    struct TestScene {
+        CubeInstances cubes;
+        LightSpheres lights;
+        SkySphere sky;
+        SceneFrame frame;
+        RenderQueue queue;
+        XMMATRIX view;
+        XMMATRIX projection;
+        XMFLOAT3 cameraPos = XMFLOAT3(-10.0f, 0.0f, 0.0f);
+
+        // Camera at x = -10 looks along +x, cubes with x < -10 are behind it
+        explicit TestScene(int cubesCount, int behindCount = 0) {
+            cubes.Init(4);
+            for (int i = 0; i < cubesCount; i++) {
+                CubeInstances::CubeModel cube;
+                float x = i < behindCount ? -20.0f - i : float(i % 5);
+                cube.pos = XMFLOAT4(x, 0.0f, float(i / 5), 0.0f);
+                cube.shineSpeedIdNM = XMFLOAT4(300.0f, 0.0f, 0.0f, 1.0f);
+                cubes.Add(cube);
+            }
+
+            lights.GetLightVector().push_back(std::make_pair(XMFLOAT3(0.0f, 2.0f, 0.0f), XMFLOAT3(1.0f, 0.0f, 0.0f)));
+            lights.GetLightVector().push_back(std::make_pair(XMFLOAT3(1.0f, 2.0f, 0.0f), XMFLOAT3(0.0f, 1.0f, 0.0f)));
+            LightSpheres::Ids lightIds;
+            lightIds.pipeline = LIGHTS_PIPELINE;
+            lightIds.material = LIGHTS_MATERIAL;
+            lightIds.worldConstants = LIGHTS_WORLD;
+            lightIds.sceneConstants = LIGHTS_SCENE;
+            lightIds.indexCount = 30;
+            lights.SetIds(lightIds);
+
+            SkySphere::Ids skyIds;
+            skyIds.pipeline = SKY_PIPELINE;
+            skyIds.material = SKY_MATERIAL;
+            skyIds.worldConstants = SKY_WORLD;
+            skyIds.sceneConstants = SKY_SCENE;
+            skyIds.indexCount = 60;
+            sky.SetIds(skyIds);
+
+            SceneFrame::Ids ids;
+            ids.cubesPipeline = CUBES_PIPELINE;
+            ids.cubesMaterial = CUBES_MATERIAL;
+            ids.cubesGpuMaterial = CUBES_GPU_MATERIAL;
+            ids.transPipeline = TRANS_PIPELINE;
+            ids.transMaterial = TRANS_MATERIAL;
+            ids.geomBuffer = GEOM;
+            ids.cullBoxesBuffer = CULL_BOXES;
+            ids.visibleBuffer = VISIBLE;
+            ids.visibleGpuBuffer = VISIBLE_GPU;
+            ids.transGeomBuffer = TRANS_GEOM;
+            ids.indirectArgsBuffer = INDIRECT_ARGS;
+            ids.indirectArgsSrcBuffer = INDIRECT_ARGS_SRC;
+            ids.firstQuery = 0;
+            ids.cullParams = CULL_PARAMS;
+            ids.sceneConstants = SCENE;
+            ids.lightConstants = LIGHT;
+            ids.instanceCapacity = 4;
+            ids.transparentCapacity = 1;
+            frame.Init(&cubes, &lights, &sky, ids);
+            frame.AddTransparentQuad(XMFLOAT3(0.8f, 0.3f, 1.1f), XMFLOAT4(0.6f, 0.0f, 1.0f, 0.5f));
+            frame.AddTransparentQuad(XMFLOAT3(1.1f, 0.0f, 1.3f), XMFLOAT4(1.0f, 1.0f, 0.0f, 0.5f));
+
+            queue.Init();
+            view = XMMatrixLookAtLH(XMVectorSet(cameraPos.x, cameraPos.y, cameraPos.z, 0.0f), XMVectorSet(0.0f, 0.0f, 0.0f, 0.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+            projection = XMMatrixPerspectiveFovLH(XM_PI / 3, 16.0f / 9.0f, SCREEN_NEAR, SCREEN_FAR);
+        };
+
+        ~TestScene() {
+            frame.Release();
+            queue.Release();
+            cubes.Release();
+        };
+
+        bool Frame(RenderBackend* backend) { return frame.Frame(backend, view, projection, cameraPos, 0.0f); };
+
+        // Function to queue and submit draws of frame
+        void Render(RenderBackend* backend) {
+            frame.Render(&queue);
+            queue.Submit(backend);
+            backend->EndFrame();
+        };
+    };
+
+    // Function to count recorded commands of given type and id, id -1 matches all
+    int CountCommands(const RecordingBackend& backend, RecordingBackend::CommandType type, int id = -1, uint32_t* bytes = nullptr) {
+        int count = 0;
+        for (const RecordingBackend::Command& command : backend.GetCommands()) {
+            if (command.type == type && (id < 0 || command.id == id)) {
+                count++;
+                if (bytes) {
+                    *bytes = command.bytes;
+                }
+            }
+        }
+        return count;
+    }
+}
+
+TEST(SceneFrame, FirstFrameGrowsBuffersAndUploadsAllCubes) {
+    TestScene scene(10);
+    RecordingBackend backend;
+    backend.Init();
+
+    ASSERT_TRUE(scene.Frame(&backend));
+
+    // Capacity doubles unless cubes need more
+    uint32_t bytes = 0;
+    EXPECT_EQ(CountCommands(backend, RecordingBackend::COMMAND_RESIZE, GEOM, &bytes), 1);
+    EXPECT_EQ(bytes, sizeof(CubeInstances::GeomBuffer) * 10);
+    EXPECT_EQ(CountCommands(backend, RecordingBackend::COMMAND_RESIZE, CULL_BOXES, &bytes), 1);
+    EXPECT_EQ(bytes, sizeof(CubeInstances::CullBox) * 10);
+    EXPECT_EQ(CountCommands(backend, RecordingBackend::COMMAND_RESIZE, VISIBLE), 1);
+    EXPECT_EQ(CountCommands(backend, RecordingBackend::COMMAND_RESIZE, VISIBLE_GPU, &bytes), 1);
+    EXPECT_EQ(bytes, sizeof(uint32_t) * 10);
+    EXPECT_EQ(CountCommands(backend, RecordingBackend::COMMAND_RESIZE, TRANS_GEOM, &bytes), 1);
+    EXPECT_EQ(bytes, sizeof(SceneFrame::WorldMatrixBuffer) * 2);
+
+    // Resized buffers get all cubes, GPU culling writes its own visible list
+    EXPECT_EQ(backend.GetResizesCount(), 5);
+    EXPECT_EQ(CountCommands(backend, RecordingBackend::COMMAND_UPLOAD, TRANS_GEOM, &bytes), 1);
+    EXPECT_EQ(bytes, sizeof(SceneFrame::WorldMatrixBuffer) * 2);
+    EXPECT_EQ(CountCommands(backend, RecordingBackend::COMMAND_UPLOAD, VISIBLE), 0);
+    EXPECT_EQ(CountCommands(backend, RecordingBackend::COMMAND_UPLOAD, INDIRECT_ARGS_SRC, &bytes), 1);
+    EXPECT_EQ(bytes, sizeof(SceneFrame::IndirectArgs));
+    uint64_t geomBytes = 0;
+    for (const RecordingBackend::Command& command : backend.GetCommands()) {
+        if (command.type == RecordingBackend::COMMAND_UPLOAD && command.id == GEOM) {
+            geomBytes += command.bytes;
+        }
+    }
+    EXPECT_EQ(geomBytes, sizeof(CubeInstances::GeomBuffer) * 10);
+    EXPECT_EQ(backend.GetDispatchesCount(), 1);
+    EXPECT_EQ(backend.GetCopiesCount(), 1);
+    EXPECT_EQ(backend.GetDrawsCount(), 0);
+
+    // Second frame of same scene keeps buffers
+    backend.Reset();
+    ASSERT_TRUE(scene.Frame(&backend));
+    EXPECT_EQ(backend.GetResizesCount(), 0);
+    backend.Release();
+}
+
+TEST(SceneFrame, FrameWritesConstants) {
+    TestScene scene(70);
+    RecordingBackend backend;
+    backend.Init();
+
+    ASSERT_TRUE(scene.Frame(&backend));
+
+    const SceneFrame::CullParams* cullParams = static_cast<const SceneFrame::CullParams*>(backend.GetConstants(CULL_PARAMS));
+    ASSERT_NE(cullParams, nullptr);
+    EXPECT_EQ(cullParams->numShapes.x, 70);
+    EXPECT_EQ(cullParams->numShapes.y, 2 * CULL_GROUP_SIZE);
+
+    const SceneFrame::LightConstantBuffer* light = static_cast<const SceneFrame::LightConstantBuffer*>(backend.GetConstants(LIGHT));
+    ASSERT_NE(light, nullptr);
+    EXPECT_EQ(light->lightCount.x, 2);
+    EXPECT_EQ(light->lightCount.y, 1);
+    EXPECT_EQ(light->lightCount.z, 0);
+    EXPECT_EQ(light->lightPos[1].x, 1.0f);
+    EXPECT_EQ(light->lightColor[1].y, 1.0f);
+    EXPECT_EQ(light->cameraPos.x, -10.0f);
+
+    const SceneFrame::SceneConstantBuffer* sceneBuffer = static_cast<const SceneFrame::SceneConstantBuffer*>(backend.GetConstants(SCENE));
+    ASSERT_NE(sceneBuffer, nullptr);
+    XMFLOAT4X4 expected;
+    XMFLOAT4X4 actual;
+    XMStoreFloat4x4(&expected, XMMatrixMultiply(scene.view, scene.projection));
+    XMStoreFloat4x4(&actual, sceneBuffer->mViewProjectionMatrix);
+    for (int row = 0; row < 4; row++) {
+        for (int column = 0; column < 4; column++) {
+            EXPECT_FLOAT_EQ(actual.m[row][column], expected.m[row][column]);
+        }
+    }
+
+    // Light spheres and sky write own constants in the same frame
+    const LightSpheres::GeomBuffer* spheres = static_cast<const LightSpheres::GeomBuffer*>(backend.GetConstants(LIGHTS_WORLD));
+    ASSERT_NE(spheres, nullptr);
+    EXPECT_EQ(spheres[0].color.x, 1.0f);
+    EXPECT_NE(backend.GetConstants(LIGHTS_SCENE), nullptr);
+    const SkySphere::WorldMatrixBuffer* sky = static_cast<const SkySphere::WorldMatrixBuffer*>(backend.GetConstants(SKY_WORLD));
+    ASSERT_NE(sky, nullptr);
+    EXPECT_EQ(sky->size.x, 1.0f);
+    EXPECT_NE(backend.GetConstants(SKY_SCENE), nullptr);
+    EXPECT_EQ(backend.GetConstantBytes(), sizeof(SceneFrame::CullParams) + sizeof(SceneFrame::SceneConstantBuffer) + sizeof(SceneFrame::LightConstantBuffer) +
+        sizeof(LightSpheres::GeomBuffer) * MAX_LIGHT + sizeof(LightSpheres::SceneMatrixBuffer) + sizeof(SkySphere::WorldMatrixBuffer) + sizeof(SkySphere::SceneMatrixBuffer));
+    backend.Release();
+}
+
+TEST(SceneFrame, RenderDrawsPassesInOrderWithGpuCulling) {
+    TestScene scene(10);
+    RecordingBackend backend;
+    backend.Init();
+
+    ASSERT_TRUE(scene.Frame(&backend));
+    backend.Reset();
+    scene.Render(&backend);
+
+    // Cubes and light spheres, then sky, then transparent quads
+    ASSERT_EQ(backend.GetDrawsCount(), 4);
+    ASSERT_EQ(scene.queue.GetCount(), 4);
+    std::vector<int> materials;
+    for (int i = 0; i < scene.queue.GetCount(); i++) {
+        materials.push_back(scene.queue.GetPackets()[scene.queue.GetSortedIndex(i)].material);
+    }
+    EXPECT_EQ(materials, std::vector<int>({ CUBES_GPU_MATERIAL, LIGHTS_MATERIAL, SKY_MATERIAL, TRANS_MATERIAL }));
+
+    // Cubes are drawn by arguments of culling shader, wrapped in query
+    const DrawPacket& cubes = scene.queue.GetPackets()[0];
+    EXPECT_EQ(cubes.indirectArgs, INDIRECT_ARGS);
+    EXPECT_EQ(cubes.query, 0);
+    EXPECT_EQ(scene.frame.GetQueriesIssued(), 1u);
+    const DrawPacket& transparent = scene.queue.GetPackets()[3];
+    EXPECT_EQ(transparent.instanceCount, 2);
+    EXPECT_EQ(scene.queue.GetPackets()[1].instanceCount, 2);
+    EXPECT_EQ(scene.queue.GetPackets()[1].indexCount, 30);
+    EXPECT_EQ(backend.GetCommands().back().type, RecordingBackend::COMMAND_END_FRAME);
+
+    // Queries are reused in ring
+    for (int i = 1; i <= MAX_QUERY; i++) {
+        scene.frame.Render(&scene.queue);
+    }
+    EXPECT_EQ(scene.queue.GetPackets()[0].query, 0);
+    EXPECT_EQ(scene.frame.GetQueriesIssued(), unsigned(MAX_QUERY + 1));
+
+    // Hidden spheres are not drawn
+    scene.frame.GetSettings().isSpheresOn = false;
+    scene.frame.Render(&scene.queue);
+    EXPECT_EQ(scene.queue.GetCount(), 3);
+    backend.Release();
+}
+
+TEST(SceneFrame, CpuCullingUploadsVisibleList) {
+    TestScene scene(12, 4);
+    scene.frame.GetSettings().computeCull = false;
+    RecordingBackend backend;
+    backend.Init();
+
+    ASSERT_TRUE(scene.Frame(&backend));
+
+    // Cubes behind camera are culled, the rest go to visible list
+    ASSERT_EQ(scene.cubes.GetVisibleCount(), 8);
+    uint32_t bytes = 0;
+    EXPECT_EQ(CountCommands(backend, RecordingBackend::COMMAND_UPLOAD, VISIBLE, &bytes), 1);
+    EXPECT_EQ(bytes, sizeof(uint32_t) * 8);
+
+    backend.Reset();
+    scene.Render(&backend);
+    const DrawPacket& cubes = scene.queue.GetPackets()[0];
+    EXPECT_EQ(cubes.material, CUBES_MATERIAL);
+    EXPECT_EQ(cubes.indirectArgs, -1);
+    EXPECT_EQ(cubes.query, -1);
+    EXPECT_EQ(cubes.instanceCount, 8);
+    EXPECT_EQ(scene.frame.GetQueriesIssued(), 0u);
+    backend.Release();
+}
+
+TEST(SceneFrame, IdentityListIsUploadedOnce) {
+    TestScene scene(10);
+    scene.frame.GetSettings().isCullingOn = false;
+    RecordingBackend backend;
+    backend.Init();
+
+    ASSERT_TRUE(scene.Frame(&backend));
+    uint32_t bytes = 0;
+    EXPECT_EQ(CountCommands(backend, RecordingBackend::COMMAND_UPLOAD, VISIBLE, &bytes), 1);
+    EXPECT_EQ(bytes, sizeof(uint32_t) * 10);
+
+    // Unchanged identity list stays in buffer
+    backend.Reset();
+    ASSERT_TRUE(scene.Frame(&backend));
+    EXPECT_EQ(CountCommands(backend, RecordingBackend::COMMAND_UPLOAD, VISIBLE), 0);
+    backend.Release();
+}
+
+TEST(SceneFrame, FailedResizeOrConstantsSkipFrame) {
+    TestScene scene(10);
+    FailingBackend backend;
+    backend.Init();
+
+    // Nothing is uploaded to buffers that failed to grow, they are grown again next frame
+    backend.failResize = true;
+    EXPECT_FALSE(scene.Frame(&backend));
+    EXPECT_EQ(backend.GetUploadsCount(), 0);
+    EXPECT_EQ(backend.GetDispatchesCount(), 0);
+
+    backend.failResize = false;
+    backend.failConstants = true;
+    backend.Reset();
+    EXPECT_FALSE(scene.Frame(&backend));
+    EXPECT_EQ(backend.GetResizesCount(), 5);
+    EXPECT_EQ(backend.GetDispatchesCount(), 0);
+
+    backend.failConstants = false;
+    backend.Reset();
+    EXPECT_TRUE(scene.Frame(&backend));
+    EXPECT_EQ(backend.GetResizesCount(), 0);
+    EXPECT_EQ(backend.GetDispatchesCount(), 1);
+    backend.Release();
+}
@@ -0,0 +1,74 @@
+// sceneGeneratorTest.cpp - bulk cube generation into component streams
+#include <gtest/gtest.h>
+#include "sceneGenerator.h"
+
+namespace {
+    void ExpectStreamsMatchCubes(const SceneGenerator& generator, int first, const SceneGenerator::CubeStreams& cubes) {
+        for (size_t i = 0; i < cubes.posX.size(); i++) {
+            CubeInstances::CubeModel cube = generator.GenerateCube(first + (int)i);
+            ASSERT_EQ(cubes.posX[i], cube.pos.x);
+            ASSERT_EQ(cubes.posY[i], cube.pos.y);
+            ASSERT_EQ(cubes.posZ[i], cube.pos.z);
+            ASSERT_EQ(cubes.angularSpeed[i], cube.pos.w * cube.shineSpeedIdNM.y);
+            ASSERT_EQ(cubes.materials[i].x, cube.shineSpeedIdNM.x);
+            ASSERT_EQ(cubes.materials[i].z, cube.shineSpeedIdNM.z);
+        }
+    }
+}
+
+TEST(SceneGenerator, StreamsMatchSingleCubes) {
+    for (int distribution = 0; distribution < SceneGenerator::DISTRIBUTION_COUNT; distribution++) {
+        SceneGenerator::SceneDesc desc;
+        desc.seed = 42;
+        desc.distribution = (SceneGenerator::Distribution)distribution;
+        desc.cubesCount = 1000;
+        SceneGenerator generator;
+        generator.Init(desc);
+
+        // Odd first and count cover four-cube blocks and scalar tail
+        SceneGenerator::CubeStreams cubes;
+        generator.GenerateCubes(13, 999, cubes);
+        ASSERT_EQ(cubes.posX.size(), 999u);
+        ExpectStreamsMatchCubes(generator, 13, cubes);
+    }
+}
+
+TEST(SceneGenerator, ParallelGenerationIsReproducible) {
+    SceneGenerator::SceneDesc desc;
+    desc.seed = 7;
+    desc.cubesCount = 50000;
+    JobSystem jobSystem;
+    jobSystem.Init(3);
+    SceneGenerator parallel, serial;
+    parallel.Init(desc, &jobSystem);
+    serial.Init(desc);
+
+    SceneGenerator::CubeStreams a, b;
+    parallel.GenerateCubes(0, desc.cubesCount, a);
+    serial.GenerateCubes(0, desc.cubesCount, b);
+    EXPECT_TRUE(std::equal(a.posX.begin(), a.posX.end(), b.posX.begin()));
+    EXPECT_TRUE(std::equal(a.posY.begin(), a.posY.end(), b.posY.begin()));
+    EXPECT_TRUE(std::equal(a.posZ.begin(), a.posZ.end(), b.posZ.begin()));
+    EXPECT_TRUE(std::equal(a.angularSpeed.begin(), a.angularSpeed.end(), b.angularSpeed.begin()));
+    jobSystem.Release();
+}
+
+TEST(SceneGenerator, BulkAddKeepsGeneratedCubes) {
+    SceneGenerator::SceneDesc desc;
+    desc.seed = 3;
+    SceneGenerator generator;
+    generator.Init(desc);
+    SceneGenerator::CubeStreams cubes;
+    generator.GenerateCubes(0, 100, cubes);
+
+    CubeInstances instances;
+    instances.Init(16);
+    instances.Add(100, cubes.posX.data(), cubes.posY.data(), cubes.posZ.data(), cubes.angularSpeed.data(), cubes.materials.data());
+    ASSERT_EQ(instances.GetCount(), 100);
+    for (int i = 0; i < 100; i++) {
+        ASSERT_EQ(instances.GetPositionsX()[i], cubes.posX[i]);
+        ASSERT_EQ(instances.GetAngularSpeeds()[i], cubes.angularSpeed[i]);
+        ASSERT_EQ(instances.GetIndex(instances.GetHandle(i)), i);
+    }
+    instances.Release();
+}
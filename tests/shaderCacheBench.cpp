@@ -0,0 +1,90 @@
+// shaderCacheBench.cpp - opening shader cache file and serving hits, which hash all sources of request
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include "benchTimer.h"
+#include "shaderCache.h"
+
+namespace {
+    // Compiler copying source as bytecode, every shader includes shared header
+    class CopyCompiler : public ShaderCache::Compiler {
+    public:
+        std::string include;
+
+        bool Compile(const ShaderCache::Request& request, std::vector<uint8_t>& bytecode, std::vector<std::string>& includes) override {
+            std::ifstream file(request.path, std::ios::binary);
+            bytecode.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            includes.push_back(include);
+            return true;
+        }
+    };
+}
+
+int main() {
+    const int variants = 256;
+    const char* cachePath = "shaderCacheBench.bin";
+    const char* sourcePath = "shaderCacheBench.hlsl";
+    const char* includePath = "shaderCacheBench.hlsli";
+    {
+        // Sizes of cube shader and its lighting include
+        std::ofstream source(sourcePath, std::ios::binary);
+        source << std::string(8 * 1024, 'a');
+        std::ofstream include(includePath, std::ios::binary);
+        include << std::string(4 * 1024, 'b');
+    }
+
+    CopyCompiler compiler;
+    compiler.include = includePath;
+    std::vector<ShaderCache::Request> requests(variants);
+    for (int i = 0; i < variants; i++) {
+        requests[i].path = sourcePath;
+        requests[i].entryPoint = "main";
+        requests[i].profile = i % 2 ? "ps_5_0" : "vs_5_0";
+        requests[i].defines.push_back({ "VARIANT", std::to_string(i) });
+    }
+
+    std::remove(cachePath);
+    ShaderCache cache;
+    cache.Open(cachePath);
+    std::vector<uint8_t> bytecode;
+    double compile = MeasureBest(1, [&]() {
+        for (const ShaderCache::Request& request : requests) {
+            cache.Get(request, compiler, bytecode);
+        }
+    });
+    cache.Save();
+    cache.Release();
+
+    // Only index is read, blobs stay mapped
+    double open = MeasureBest(5, [&]() {
+        cache.Open(cachePath);
+        cache.Release();
+    });
+    cache.Open(cachePath);
+    double hit = MeasureBest(5, [&]() {
+        for (const ShaderCache::Request& request : requests) {
+            cache.Get(request, compiler, bytecode);
+        }
+    });
+    double hashRequest = MeasureBest(5, [&]() {
+        uint64_t sum = 0;
+        for (const ShaderCache::Request& request : requests) {
+            sum += ShaderCache::HashRequest(request);
+        }
+        bytecode.resize(sum == 0);
+    });
+
+    PrintResult("Miss with copying compiler", compile, variants);
+    PrintResult("Open cache file", open, variants);
+    PrintResult("Hit", hit, variants);
+    PrintResult("Hash of request", hashRequest, variants);
+    ShaderCache::Stats stats = cache.GetStats();
+    printf("%d entries, %d hits, %d misses\n", cache.GetSize(), stats.hits, stats.misses);
+
+    bool isValid = cache.GetSize() == variants && stats.misses == 0;
+    cache.Release();
+    std::remove(cachePath);
+    std::remove(sourcePath);
+    std::remove(includePath);
+    return isValid ? 0 : 1;
+}
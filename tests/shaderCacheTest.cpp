@@ -0,0 +1,260 @@
+// shaderCacheTest.cpp - hits, invalidation by changed sources and file round trip of shader cache with stub compiler
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include "jobSystem.h"
+#include "shaderCache.h"
+#include "testPath.h"
+
+namespace {
+    void WriteText(const std::string& path, const std::string& text) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << text;
+    }
+
+    // Compiler which makes bytecode of request text and source contents, includes are set per source path
+    class StubCompiler : public ShaderCache::Compiler {
+    public:
+        std::map<std::string, std::vector<std::string>> includes;
+        std::atomic<int> calls{ 0 };
+        bool isFailing = false;
+
+        bool Compile(const ShaderCache::Request& request, std::vector<uint8_t>& bytecode, std::vector<std::string>& outIncludes) override {
+            calls++;
+            if (isFailing) {
+                return false;
+            }
+            std::string text = request.entryPoint + "/" + request.profile;
+            for (const ShaderCache::Define& define : request.defines) {
+                text += "/" + define.name + "=" + define.value;
+            }
+            std::ifstream file(request.path, std::ios::binary);
+            text += std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            bytecode.assign(text.begin(), text.end());
+            outIncludes = includes[request.path];
+            return true;
+        }
+    };
+
+    class ShaderCacheTest : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            cacheFile = GetTestPath("cache.bin");
+            sourceFile = GetTestPath("shader.hlsl");
+            includeFile = GetTestPath("shader.hlsli");
+            std::remove(cacheFile.c_str());
+            WriteText(sourceFile, "#include \"" + includeFile + "\"\nfloat4 main() : SV_Target { return Color(); }\n");
+            WriteText(includeFile, "float4 Color() { return 1; }\n");
+            compiler.includes[sourceFile] = { includeFile, includeFile };
+            request.path = sourceFile;
+            request.entryPoint = "main";
+            request.profile = "ps_5_0";
+        }
+
+        void TearDown() override {
+            std::remove(cacheFile.c_str());
+            std::remove(sourceFile.c_str());
+            std::remove(includeFile.c_str());
+        }
+
+        std::string cacheFile;
+        std::string sourceFile;
+        std::string includeFile;
+        StubCompiler compiler;
+        ShaderCache::Request request;
+    };
+}
+
+TEST_F(ShaderCacheTest, CompilesOnceThenHits) {
+    ShaderCache cache;
+    EXPECT_FALSE(cache.Open(cacheFile.c_str()));
+    std::vector<uint8_t> compiled;
+    std::vector<uint8_t> cached;
+    ASSERT_TRUE(cache.Get(request, compiler, compiled));
+    ASSERT_TRUE(cache.Get(request, compiler, cached));
+
+    EXPECT_EQ(compiler.calls, 1);
+    EXPECT_FALSE(compiled.empty());
+    EXPECT_EQ(compiled, cached);
+    EXPECT_EQ(cache.GetSize(), 1);
+    EXPECT_EQ(cache.GetStats().hits, 1);
+    EXPECT_EQ(cache.GetStats().misses, 1);
+    EXPECT_EQ(cache.GetStats().invalidated, 0);
+    cache.Release();
+}
+
+TEST_F(ShaderCacheTest, ChangedIncludeInvalidatesEntry) {
+    ShaderCache cache;
+    cache.Open(cacheFile.c_str());
+    std::vector<uint8_t> bytecode;
+    ASSERT_TRUE(cache.Get(request, compiler, bytecode));
+
+    WriteText(includeFile, "float4 Color() { return 0.5; }\n");
+    ASSERT_TRUE(cache.Get(request, compiler, bytecode));
+    EXPECT_EQ(compiler.calls, 2);
+    EXPECT_EQ(cache.GetStats().invalidated, 1);
+
+    // Entry is replaced by bytecode of new sources
+    ASSERT_TRUE(cache.Get(request, compiler, bytecode));
+    EXPECT_EQ(compiler.calls, 2);
+    EXPECT_EQ(cache.GetSize(), 1);
+
+    std::remove(includeFile.c_str());
+    ASSERT_TRUE(cache.Get(request, compiler, bytecode));
+    EXPECT_EQ(compiler.calls, 3);
+    cache.Release();
+}
+
+TEST_F(ShaderCacheTest, DefinesAndProfileMakeSeparateEntries) {
+    ShaderCache cache;
+    cache.Open(cacheFile.c_str());
+    std::vector<uint8_t> plain;
+    std::vector<uint8_t> defined;
+    std::vector<uint8_t> profiled;
+    ASSERT_TRUE(cache.Get(request, compiler, plain));
+    ShaderCache::Request definedRequest = request;
+    definedRequest.defines.push_back({ "USE_NORMAL_MAP", "1" });
+    ASSERT_TRUE(cache.Get(definedRequest, compiler, defined));
+    ShaderCache::Request profiledRequest = request;
+    profiledRequest.profile = "ps_4_0";
+    ASSERT_TRUE(cache.Get(profiledRequest, compiler, profiled));
+
+    EXPECT_EQ(compiler.calls, 3);
+    EXPECT_EQ(cache.GetSize(), 3);
+    EXPECT_NE(plain, defined);
+    EXPECT_NE(plain, profiled);
+    cache.Release();
+}
+
+TEST(ShaderCache, HashRequestKeepsStringsApart) {
+    ShaderCache::Request a;
+    a.path = "shader.hlsl";
+    a.defines.push_back({ "AB", "" });
+    ShaderCache::Request b = a;
+    b.defines[0] = { "A", "B" };
+    EXPECT_NE(ShaderCache::HashRequest(a), ShaderCache::HashRequest(b));
+
+    ShaderCache::Request c = a;
+    c.flags = 1;
+    EXPECT_NE(ShaderCache::HashRequest(a), ShaderCache::HashRequest(c));
+    EXPECT_EQ(ShaderCache::HashRequest(a), ShaderCache::HashRequest(ShaderCache::Request(a)));
+}
+
+TEST_F(ShaderCacheTest, SavedEntriesHitAfterReopen) {
+    std::vector<uint8_t> compiled;
+    {
+        ShaderCache cache;
+        cache.Open(cacheFile.c_str());
+        ASSERT_TRUE(cache.Get(request, compiler, compiled));
+        ShaderCache::Request definedRequest = request;
+        definedRequest.defines.push_back({ "SHOW_NORMALS", "1" });
+        std::vector<uint8_t> defined;
+        ASSERT_TRUE(cache.Get(definedRequest, compiler, defined));
+        ASSERT_TRUE(cache.Save());
+        cache.Release();
+    }
+
+    ShaderCache cache;
+    ASSERT_TRUE(cache.Open(cacheFile.c_str()));
+    EXPECT_EQ(cache.GetSize(), 2);
+    std::vector<uint8_t> loaded;
+    ASSERT_TRUE(cache.Get(request, compiler, loaded));
+    EXPECT_EQ(compiler.calls, 2);
+    EXPECT_EQ(loaded, compiled);
+
+    // Loaded blobs outlive mapping replaced by save
+    ShaderCache::Request newRequest = request;
+    newRequest.entryPoint = "other";
+    ASSERT_TRUE(cache.Get(newRequest, compiler, loaded));
+    ASSERT_TRUE(cache.Save());
+    ASSERT_TRUE(cache.Get(request, compiler, loaded));
+    EXPECT_EQ(loaded, compiled);
+    EXPECT_EQ(compiler.calls, 3);
+    cache.Release();
+}
+
+TEST_F(ShaderCacheTest, DamagedFileGivesEmptyCache) {
+    {
+        ShaderCache cache;
+        cache.Open(cacheFile.c_str());
+        std::vector<uint8_t> bytecode;
+        ASSERT_TRUE(cache.Get(request, compiler, bytecode));
+        ASSERT_TRUE(cache.Save());
+        cache.Release();
+    }
+
+    std::ifstream input(cacheFile.c_str(), std::ios::binary);
+    std::vector<char> data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    input.close();
+    ASSERT_GT(data.size(), sizeof(ShaderCache::Header) + sizeof(ShaderCache::EntryHeader));
+
+    // Changed dependency path no longer matches entry key, truncated file no longer matches its size
+    std::vector<std::vector<char>> damaged(2, data);
+    damaged[0][sizeof(ShaderCache::Header) + sizeof(ShaderCache::EntryHeader) + sizeof(ShaderCache::DependencyHeader)] ^= 1;
+    damaged[1].resize(data.size() - 1);
+    for (const std::vector<char>& bytes : damaged) {
+        std::ofstream output(cacheFile.c_str(), std::ios::binary | std::ios::trunc);
+        output.write(bytes.data(), (std::streamsize)bytes.size());
+        output.close();
+
+        ShaderCache cache;
+        EXPECT_FALSE(cache.Open(cacheFile.c_str()));
+        EXPECT_EQ(cache.GetSize(), 0);
+        // Broken file is rewritten on save even without new entries
+        EXPECT_TRUE(cache.Save());
+        cache.Release();
+        ASSERT_TRUE(cache.Open(cacheFile.c_str()));
+        EXPECT_EQ(cache.GetSize(), 0);
+        cache.Release();
+    }
+}
+
+TEST_F(ShaderCacheTest, FailedCompileIsNotCached) {
+    ShaderCache cache;
+    cache.Open(cacheFile.c_str());
+    std::vector<uint8_t> bytecode;
+    compiler.isFailing = true;
+    EXPECT_FALSE(cache.Get(request, compiler, bytecode));
+    EXPECT_EQ(cache.GetSize(), 0);
+
+    // Bytecode compiled from unreadable include is used once, not cached
+    compiler.isFailing = false;
+    compiler.includes[sourceFile] = { "missing.hlsli" };
+    EXPECT_TRUE(cache.Get(request, compiler, bytecode));
+    EXPECT_FALSE(bytecode.empty());
+    EXPECT_EQ(cache.GetSize(), 0);
+    EXPECT_EQ(compiler.calls, 2);
+    cache.Release();
+}
+
+TEST_F(ShaderCacheTest, ParallelGetsCompileEachRequestOnce) {
+    JobSystem jobSystem;
+    jobSystem.Init(4);
+    ShaderCache cache;
+    cache.Open(cacheFile.c_str());
+    const int count = 64;
+    std::vector<ShaderCache::Request> requests(count, request);
+    for (int i = 0; i < count; i++) {
+        requests[i].defines.push_back({ "VARIANT", std::to_string(i) });
+    }
+
+    std::vector<std::vector<uint8_t>> bytecodes(count);
+    std::atomic<int> failures{ 0 };
+    for (int pass = 0; pass < 2; pass++) {
+        jobSystem.ParallelFor(0, count, 4, [&](int first, int last) {
+            for (int i = first; i < last; i++) {
+                failures += !cache.Get(requests[i], compiler, bytecodes[i]);
+            }
+        });
+    }
+
+    EXPECT_EQ(failures, 0);
+    EXPECT_EQ(compiler.calls, count);
+    EXPECT_EQ(cache.GetSize(), count);
+    EXPECT_EQ(cache.GetStats().hits, count);
+    EXPECT_EQ(cache.GetStats().misses, count);
+    cache.Release();
+    jobSystem.Release();
+}
@@ -0,0 +1,129 @@
+// stateCacheTest.cpp - redundant bind filtering of state cache on mock context
+#include <gtest/gtest.h>
+#include <vector>
+#include "stateCache.h"
+
+namespace {
+    // Context recording binds that reach it, objects are plain ints compared by address
+    struct MockContext {
+        struct Call {
+            const char* name;
+            unsigned startSlot;
+            unsigned count;
+        };
+        std::vector<Call> calls;
+
+        void IASetInputLayout(int*) { calls.push_back({ "IASetInputLayout", 0, 1 }); };
+        void IASetPrimitiveTopology(int) { calls.push_back({ "IASetPrimitiveTopology", 0, 1 }); };
+        void IASetVertexBuffers(unsigned startSlot, unsigned count, int* const*, const unsigned*, const unsigned*) {
+            calls.push_back({ "IASetVertexBuffers", startSlot, count });
+        };
+        void IASetIndexBuffer(int*, int, unsigned) { calls.push_back({ "IASetIndexBuffer", 0, 1 }); };
+        void VSSetShader(int*, int* const*, unsigned) { calls.push_back({ "VSSetShader", 0, 1 }); };
+        void PSSetShader(int*, int* const*, unsigned) { calls.push_back({ "PSSetShader", 0, 1 }); };
+        void OMSetBlendState(int*, const float*, unsigned) { calls.push_back({ "OMSetBlendState", 0, 1 }); };
+        void OMSetDepthStencilState(int*, unsigned) { calls.push_back({ "OMSetDepthStencilState", 0, 1 }); };
+        void VSSetConstantBuffers1(unsigned startSlot, unsigned count, int* const*, const unsigned*, const unsigned*) {
+            calls.push_back({ "VSSetConstantBuffers1", startSlot, count });
+        };
+        void PSSetShaderResources(unsigned startSlot, unsigned count, int* const*) { calls.push_back({ "PSSetShaderResources", startSlot, count }); };
+    };
+}
+
+TEST(StateCache, ElidesRepeatedBinds) {
+    MockContext context;
+    StateCache<MockContext> cache;
+    cache.Init(&context);
+    int layout = 0, shader = 0, otherShader = 0;
+
+    cache.IASetInputLayout(&layout);
+    cache.IASetInputLayout(&layout);
+    cache.VSSetShader(&shader, (int* const*)nullptr, 0);
+    cache.VSSetShader(&shader, (int* const*)nullptr, 0);
+    cache.VSSetShader(&otherShader, (int* const*)nullptr, 0);
+    cache.IASetPrimitiveTopology(4);
+    cache.IASetPrimitiveTopology(4);
+    EXPECT_EQ(context.calls.size(), 4u);
+    EXPECT_EQ(cache.GetStats().issued, 4);
+    EXPECT_EQ(cache.GetStats().elided, 3);
+
+    // Null is valid bound state, unknown shadow is never equal to it
+    cache.Invalidate();
+    cache.IASetInputLayout((int*)nullptr);
+    cache.IASetInputLayout((int*)nullptr);
+    EXPECT_EQ(context.calls.size(), 5u);
+}
+
+TEST(StateCache, BlendAndDepthCompareAllArguments) {
+    MockContext context;
+    StateCache<MockContext> cache;
+    cache.Init(&context);
+    int blend = 0, depth = 0;
+    const float ones[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    const float halves[4] = { 0.5f, 0.5f, 0.5f, 0.5f };
+
+    cache.OMSetBlendState(&blend, nullptr, ~0u);
+    // Null factor is same as ones
+    cache.OMSetBlendState(&blend, ones, ~0u);
+    cache.OMSetBlendState(&blend, halves, ~0u);
+    cache.OMSetBlendState(&blend, halves, 1u);
+    cache.OMSetDepthStencilState(&depth, 0);
+    cache.OMSetDepthStencilState(&depth, 0);
+    cache.OMSetDepthStencilState(&depth, 1);
+    EXPECT_EQ(cache.GetStats().issued, 5);
+    EXPECT_EQ(cache.GetStats().elided, 2);
+}
+
+TEST(StateCache, BindsOnlyChangedSlots) {
+    MockContext context;
+    StateCache<MockContext> cache;
+    cache.Init(&context);
+    int a = 0, b = 0, c = 0;
+    int* views[4] = { &a, &b, &c, nullptr };
+    cache.PSSetShaderResources(0, 4, views);
+    ASSERT_EQ(context.calls.size(), 1u);
+
+    // Only slot 2 differs, one slot is bound
+    views[2] = &a;
+    cache.PSSetShaderResources(0, 4, views);
+    ASSERT_EQ(context.calls.size(), 2u);
+    EXPECT_EQ(context.calls[1].startSlot, 2u);
+    EXPECT_EQ(context.calls[1].count, 1u);
+
+    cache.PSSetShaderResources(0, 4, views);
+    EXPECT_EQ(context.calls.size(), 2u);
+
+    // Constant buffer slots also compare bound ranges
+    int* buffers[1] = { &a };
+    unsigned firsts[1] = { 0 }, counts[1] = { 16 };
+    cache.VSSetConstantBuffers1(0, 1, buffers, firsts, counts);
+    cache.VSSetConstantBuffers1(0, 1, buffers, firsts, counts);
+    firsts[0] = 16;
+    cache.VSSetConstantBuffers1(0, 1, buffers, firsts, counts);
+    EXPECT_EQ(context.calls.size(), 4u);
+}
+
+TEST(StateCache, VertexBuffersOutOfRangeForgetSlots) {
+    MockContext context;
+    StateCache<MockContext> cache;
+    cache.Init(&context);
+    int a = 0;
+    int* buffers[2] = { &a, &a };
+    unsigned strides[2] = { 16, 16 };
+    unsigned offsets[2] = { 0, 0 };
+    cache.IASetVertexBuffers(StateCache<MockContext>::MaxVertexBuffers - 1, 1, buffers, strides, offsets);
+    cache.IASetVertexBuffers(StateCache<MockContext>::MaxVertexBuffers - 1, 1, buffers, strides, offsets);
+    ASSERT_EQ(context.calls.size(), 1u);
+
+    // Call past last slot goes to context as is, slots it may have changed are bound again next time
+    cache.IASetVertexBuffers(StateCache<MockContext>::MaxVertexBuffers - 1, 2, buffers, strides, offsets);
+    ASSERT_EQ(context.calls.size(), 2u);
+    cache.IASetVertexBuffers(StateCache<MockContext>::MaxVertexBuffers - 1, 1, buffers, strides, offsets);
+    EXPECT_EQ(context.calls.size(), 3u);
+
+    // Stride change rebinds slot
+    cache.IASetVertexBuffers(0, 1, buffers, strides, offsets);
+    strides[0] = 32;
+    cache.IASetVertexBuffers(0, 1, buffers, strides, offsets);
+    EXPECT_EQ(context.calls.size(), 5u);
+}
@@ -0,0 +1,71 @@
+// stateObjectCacheBench.cpp - lookup of shared state objects by descriptor bytes
+#include <cstring>
+#include <random>
+#include <vector>
+#include "benchTimer.h"
+#include "stateObjectCache.h"
+
+namespace {
+    struct MockState {
+        int refs = 1;
+
+        void AddRef() { refs++; };
+        void Release() { refs--; };
+    };
+
+    // Size of D3D11_BLEND_DESC, the largest state descriptor
+    struct BlendDesc {
+        int alphaToCoverage;
+        int independentBlend;
+        int targets[8][8];
+    };
+}
+
+int main() {
+    const int descsCount = 64;
+    const int lookups = 1000000;
+    std::vector<BlendDesc> descs(descsCount);
+    for (int i = 0; i < descsCount; i++) {
+        memset(&descs[i], 0, sizeof(BlendDesc));
+        descs[i].targets[0][0] = i % 2;
+        descs[i].targets[0][1] = i;
+    }
+    std::vector<MockState> states(descsCount);
+    int created = 0;
+    auto create = [&](const BlendDesc*, MockState** state) {
+        *state = &states[created++];
+        return 0;
+    };
+
+    // Objects keep scene order, so draws request few states repeatedly
+    std::mt19937 random(17);
+    std::vector<int> requests(lookups);
+    for (int& request : requests) {
+        request = random() % descsCount;
+    }
+
+    StateObjectCache<BlendDesc, MockState> cache;
+    MockState* state = nullptr;
+    for (const BlendDesc& desc : descs) {
+        cache.Get(desc, &state, create);
+    }
+    double hit = MeasureBest(5, [&]() {
+        for (int request : requests) {
+            cache.Get(descs[request], &state, create);
+        }
+    });
+    double hash = MeasureBest(5, [&]() {
+        uint64_t sum = 0;
+        for (int request : requests) {
+            sum += HashBytes(&descs[request], sizeof(BlendDesc));
+        }
+        created += sum == 0;
+    });
+
+    PrintResult("Cache hit", hit, lookups);
+    PrintResult("Hash of descriptor", hash, lookups);
+    printf("descriptor %d bytes, %d objects\n", (int)sizeof(BlendDesc), cache.GetSize());
+    int size = cache.GetSize();
+    cache.Release();
+    return created == descsCount && size == descsCount ? 0 : 1;
+}
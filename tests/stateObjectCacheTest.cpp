@@ -0,0 +1,177 @@
+// stateObjectCacheTest.cpp - sharing and reference counting of state objects created from equal descriptors
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vector>
+#include "stateObjectCache.h"
+
+namespace {
+    // Reference counted like COM object, counts are kept outside so they can be checked after last Release
+    struct MockState {
+        int* refs;
+        int id;
+
+        void AddRef() { (*refs)++; };
+        void Release() { (*refs)--; };
+    };
+
+    // Same layout as D3D11_DEPTH_STENCIL_DESC: byte masks are followed by two bytes of padding
+    struct DepthDesc {
+        int depthEnable;
+        int depthWriteMask;
+        int depthFunc;
+        int stencilEnable;
+        uint8_t stencilReadMask;
+        uint8_t stencilWriteMask;
+        int frontFace[4];
+        int backFace[4];
+    };
+
+    // Device creating states with first reference owned by caller
+    struct MockDevice {
+        std::vector<MockState> states;
+        std::vector<int> refs;
+        bool isFailing = false;
+
+        MockDevice() {
+            states.reserve(16);
+            refs.reserve(16);
+        }
+
+        int Create(const DepthDesc*, MockState** state) {
+            if (isFailing) {
+                return -1;
+            }
+            refs.push_back(1);
+            states.push_back({ &refs.back(), (int)states.size() });
+            *state = &states.back();
+            return 1;
+        }
+    };
+
+    // Function to fill descriptor over given padding bytes, as stack memory of different calls would
+    DepthDesc MakeDesc(int depthFunc, uint8_t padding) {
+        DepthDesc desc;
+        memset(&desc, padding, sizeof(desc));
+        desc.depthEnable = 1;
+        desc.depthWriteMask = 1;
+        desc.depthFunc = depthFunc;
+        desc.stencilEnable = 0;
+        desc.stencilReadMask = 0xff;
+        desc.stencilWriteMask = 0xff;
+        for (int i = 0; i < 4; i++) {
+            desc.frontFace[i] = 1;
+            desc.backFace[i] = 1;
+        }
+        return desc;
+    }
+}
+
+TEST(StateObjectCache, SharesObjectOfEqualDescs) {
+    MockDevice device;
+    StateObjectCache<DepthDesc, MockState> cache;
+    auto create = [&](const DepthDesc* desc, MockState** state) { return device.Create(desc, state); };
+
+    MockState* less = nullptr;
+    MockState* lessAgain = nullptr;
+    MockState* greater = nullptr;
+    EXPECT_EQ(cache.Get(MakeDesc(2, 0), &less, create), 1);
+    // Hit returns default result without calling create
+    EXPECT_EQ(cache.Get(MakeDesc(2, 0), &lessAgain, create), 0);
+    EXPECT_EQ(cache.Get(MakeDesc(5, 0), &greater, create), 1);
+
+    ASSERT_NE(less, nullptr);
+    EXPECT_EQ(less, lessAgain);
+    EXPECT_NE(less, greater);
+    EXPECT_EQ(device.states.size(), 2u);
+    EXPECT_EQ(cache.GetSize(), 2);
+    EXPECT_EQ(cache.GetStats().hits, 1);
+    EXPECT_EQ(cache.GetStats().misses, 2);
+
+    cache.ResetStats();
+    EXPECT_EQ(cache.GetStats().hits, 0);
+    EXPECT_EQ(cache.GetStats().misses, 0);
+    cache.Release();
+}
+
+TEST(StateObjectCache, KeepsOwnReferenceUntilRelease) {
+    MockDevice device;
+    StateObjectCache<DepthDesc, MockState> cache;
+    auto create = [&](const DepthDesc* desc, MockState** state) { return device.Create(desc, state); };
+
+    MockState* first = nullptr;
+    MockState* second = nullptr;
+    cache.Get(MakeDesc(2, 0), &first, create);
+    cache.Get(MakeDesc(2, 0), &second, create);
+    // Two callers and cache
+    EXPECT_EQ(device.refs[0], 3);
+
+    first->Release();
+    second->Release();
+    EXPECT_EQ(device.refs[0], 1);
+    cache.Release();
+    EXPECT_EQ(device.refs[0], 0);
+    EXPECT_EQ(cache.GetSize(), 0);
+}
+
+TEST(StateObjectCache, DoesNotCacheFailedCreate) {
+    MockDevice device;
+    StateObjectCache<DepthDesc, MockState> cache;
+    auto create = [&](const DepthDesc* desc, MockState** state) { return device.Create(desc, state); };
+
+    MockState* state = reinterpret_cast<MockState*>(1);
+    device.isFailing = true;
+    EXPECT_EQ(cache.Get(MakeDesc(2, 0), &state, create), -1);
+    EXPECT_EQ(state, nullptr);
+    EXPECT_EQ(cache.GetSize(), 0);
+
+    device.isFailing = false;
+    EXPECT_EQ(cache.Get(MakeDesc(2, 0), &state, create), 1);
+    EXPECT_NE(state, nullptr);
+    EXPECT_EQ(cache.GetStats().misses, 2);
+    state->Release();
+    cache.Release();
+}
+
+// Keys are compared by bytes, so descriptors must reach cache with zeroed padding
+TEST(StateObjectCache, PaddingTakesPartInKey) {
+    MockDevice device;
+    StateObjectCache<DepthDesc, MockState> cache;
+    auto create = [&](const DepthDesc* desc, MockState** state) { return device.Create(desc, state); };
+
+    MockState* zeroed = nullptr;
+    MockState* dirty = nullptr;
+    cache.Get(MakeDesc(2, 0), &zeroed, create);
+    cache.Get(MakeDesc(2, 0xcd), &dirty, create);
+    EXPECT_NE(zeroed, dirty);
+
+    // Key rebuilt field by field over zeroed memory, as PipelineStateCache does
+    DepthDesc source = MakeDesc(2, 0xcd);
+    DepthDesc key;
+    memset(&key, 0, sizeof(key));
+    key.depthEnable = source.depthEnable;
+    key.depthWriteMask = source.depthWriteMask;
+    key.depthFunc = source.depthFunc;
+    key.stencilEnable = source.stencilEnable;
+    key.stencilReadMask = source.stencilReadMask;
+    key.stencilWriteMask = source.stencilWriteMask;
+    memcpy(key.frontFace, source.frontFace, sizeof(key.frontFace));
+    memcpy(key.backFace, source.backFace, sizeof(key.backFace));
+    MockState* rebuilt = nullptr;
+    cache.Get(key, &rebuilt, create);
+    EXPECT_EQ(rebuilt, zeroed);
+
+    zeroed->Release();
+    dirty->Release();
+    rebuilt->Release();
+    cache.Release();
+}
+
+TEST(Hash, ContinuesFromSeed) {
+    const char text[] = "blend state";
+    uint64_t whole = HashBytes(text, sizeof(text));
+    uint64_t parts = HashBytes(text + 5, sizeof(text) - 5, HashBytes(text, 5));
+    EXPECT_EQ(whole, parts);
+    EXPECT_NE(HashBytes(text, 5), HashBytes(text, 6));
+    // FNV-1a of empty input is its offset basis
+    EXPECT_EQ(HashBytes(text, 0), HASH_SEED);
+}
@@ -0,0 +1,287 @@
+// directxmath.h - scalar stand-in for the subset of DirectXMath used by D3D-free modules, for building tests without Windows SDK
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#define XM_CALLCONV
+
+namespace DirectX {
+
+const float XM_PI = 3.141592654f;
+const float XM_2PI = 6.283185307f;
+const float XM_PIDIV2 = 1.570796327f;
+const float XM_PIDIV4 = 0.785398163f;
+
+struct alignas(16) XMVECTOR {
+    float v[4];
+};
+typedef const XMVECTOR& FXMVECTOR;
+typedef const XMVECTOR& GXMVECTOR;
+typedef const XMVECTOR& HXMVECTOR;
+
+struct alignas(16) XMMATRIX {
+    XMVECTOR r[4];
+};
+typedef const XMMATRIX& FXMMATRIX;
+typedef const XMMATRIX& CXMMATRIX;
+
+struct XMFLOAT2 {
+    float x, y;
+    XMFLOAT2() = default;
+    XMFLOAT2(float _x, float _y) : x(_x), y(_y) {};
+};
+
+struct XMFLOAT3 {
+    float x, y, z;
+    XMFLOAT3() = default;
+    XMFLOAT3(float _x, float _y, float _z) : x(_x), y(_y), z(_z) {};
+};
+
+struct XMFLOAT4 {
+    float x, y, z, w;
+    XMFLOAT4() = default;
+    XMFLOAT4(float _x, float _y, float _z, float _w) : x(_x), y(_y), z(_z), w(_w) {};
+};
+
+struct alignas(16) XMFLOAT4A : public XMFLOAT4 {
+    using XMFLOAT4::XMFLOAT4;
+};
+
+struct XMINT4 {
+    int32_t x, y, z, w;
+    XMINT4() = default;
+    XMINT4(int32_t _x, int32_t _y, int32_t _z, int32_t _w) : x(_x), y(_y), z(_z), w(_w) {};
+};
+
+struct XMUINT4 {
+    uint32_t x, y, z, w;
+    XMUINT4() = default;
+    XMUINT4(uint32_t _x, uint32_t _y, uint32_t _z, uint32_t _w) : x(_x), y(_y), z(_z), w(_w) {};
+};
+
+struct XMFLOAT4X4 {
+    union {
+        float m[4][4];
+        struct {
+            float _11, _12, _13, _14;
+            float _21, _22, _23, _24;
+            float _31, _32, _33, _34;
+            float _41, _42, _43, _44;
+        };
+    };
+};
+
+struct XMFLOAT3X4 {
+    union {
+        float m[3][4];
+        struct {
+            float _11, _12, _13, _14;
+            float _21, _22, _23, _24;
+            float _31, _32, _33, _34;
+        };
+    };
+};
+
+inline XMVECTOR XMVectorSet(float x, float y, float z, float w) { return { { x, y, z, w } }; }
+inline XMVECTOR XMVectorZero() { return XMVectorSet(0.0f, 0.0f, 0.0f, 0.0f); }
+inline XMVECTOR XMVectorReplicate(float value) { return XMVectorSet(value, value, value, value); }
+inline XMVECTOR XMVectorSplatX(FXMVECTOR a) { return XMVectorReplicate(a.v[0]); }
+inline XMVECTOR XMVectorSplatY(FXMVECTOR a) { return XMVectorReplicate(a.v[1]); }
+inline XMVECTOR XMVectorSplatZ(FXMVECTOR a) { return XMVectorReplicate(a.v[2]); }
+inline XMVECTOR XMVectorSplatW(FXMVECTOR a) { return XMVectorReplicate(a.v[3]); }
+inline float XMVectorGetX(FXMVECTOR a) { return a.v[0]; }
+inline float XMVectorGetY(FXMVECTOR a) { return a.v[1]; }
+inline float XMVectorGetZ(FXMVECTOR a) { return a.v[2]; }
+inline float XMVectorGetW(FXMVECTOR a) { return a.v[3]; }
+inline XMVECTOR XMVectorSetW(FXMVECTOR a, float w) { return XMVectorSet(a.v[0], a.v[1], a.v[2], w); }
+
+#define XM_STUB_COMPONENTWISE(name, expr) \
+    inline XMVECTOR name(FXMVECTOR a, FXMVECTOR b) { \
+        XMVECTOR r; \
+        for (int i = 0; i < 4; i++) { r.v[i] = (expr); } \
+        return r; \
+    }
+XM_STUB_COMPONENTWISE(XMVectorAdd, a.v[i] + b.v[i])
+XM_STUB_COMPONENTWISE(XMVectorSubtract, a.v[i] - b.v[i])
+XM_STUB_COMPONENTWISE(XMVectorMultiply, a.v[i] * b.v[i])
+XM_STUB_COMPONENTWISE(XMVectorDivide, a.v[i] / b.v[i])
+XM_STUB_COMPONENTWISE(XMVectorMin, (std::min)(a.v[i], b.v[i]))
+XM_STUB_COMPONENTWISE(XMVectorMax, (std::max)(a.v[i], b.v[i]))
+#undef XM_STUB_COMPONENTWISE
+
+inline XMVECTOR XMVectorMultiplyAdd(FXMVECTOR a, FXMVECTOR b, FXMVECTOR c) { return XMVectorAdd(XMVectorMultiply(a, b), c); }
+inline XMVECTOR XMVectorScale(FXMVECTOR a, float s) { return XMVectorMultiply(a, XMVectorReplicate(s)); }
+inline XMVECTOR XMVectorNegate(FXMVECTOR a) { return XMVectorScale(a, -1.0f); }
+inline XMVECTOR XMVectorLerp(FXMVECTOR a, FXMVECTOR b, float t) { return XMVectorAdd(a, XMVectorScale(XMVectorSubtract(b, a), t)); }
+inline XMVECTOR XMVectorAbs(FXMVECTOR a) { return XMVectorSet(std::fabs(a.v[0]), std::fabs(a.v[1]), std::fabs(a.v[2]), std::fabs(a.v[3])); }
+
+inline XMVECTOR XMVector3Dot(FXMVECTOR a, FXMVECTOR b) { return XMVectorReplicate(a.v[0] * b.v[0] + a.v[1] * b.v[1] + a.v[2] * b.v[2]); }
+inline XMVECTOR XMVector4Dot(FXMVECTOR a, FXMVECTOR b) { return XMVectorReplicate(a.v[0] * b.v[0] + a.v[1] * b.v[1] + a.v[2] * b.v[2] + a.v[3] * b.v[3]); }
+inline XMVECTOR XMVector3Length(FXMVECTOR a) { return XMVectorReplicate(std::sqrt(XMVector3Dot(a, a).v[0])); }
+inline XMVECTOR XMVector3Normalize(FXMVECTOR a) { return XMVectorScale(a, 1.0f / XMVector3Length(a).v[0]); }
+inline XMVECTOR XMVector4Normalize(FXMVECTOR a) { return XMVectorScale(a, 1.0f / std::sqrt(XMVector4Dot(a, a).v[0])); }
+inline XMVECTOR XMVector3Cross(FXMVECTOR a, FXMVECTOR b) {
+    return XMVectorSet(a.v[1] * b.v[2] - a.v[2] * b.v[1], a.v[2] * b.v[0] - a.v[0] * b.v[2], a.v[0] * b.v[1] - a.v[1] * b.v[0], 0.0f);
+}
+
+// Row vector times matrix, as in DirectXMath
+inline XMVECTOR XMVector4Transform(FXMVECTOR v, FXMMATRIX m) {
+    XMVECTOR r = XMVectorZero();
+    for (int j = 0; j < 4; j++) {
+        for (int i = 0; i < 4; i++) {
+            r.v[j] += v.v[i] * m.r[i].v[j];
+        }
+    }
+    return r;
+}
+inline XMVECTOR XMVector3Transform(FXMVECTOR v, FXMMATRIX m) { return XMVector4Transform(XMVectorSetW(v, 1.0f), m); }
+inline XMVECTOR XMVector3TransformNormal(FXMVECTOR v, FXMMATRIX m) { return XMVector4Transform(XMVectorSetW(v, 0.0f), m); }
+inline XMVECTOR XMVector3TransformCoord(FXMVECTOR v, FXMMATRIX m) {
+    XMVECTOR r = XMVector3Transform(v, m);
+    return XMVectorScale(r, 1.0f / r.v[3]);
+}
+
+inline XMMATRIX XMMatrixIdentity() {
+    XMMATRIX m = {};
+    for (int i = 0; i < 4; i++) {
+        m.r[i].v[i] = 1.0f;
+    }
+    return m;
+}
+inline XMMATRIX XMMatrixMultiply(FXMMATRIX a, CXMMATRIX b) {
+    XMMATRIX r;
+    for (int i = 0; i < 4; i++) {
+        r.r[i] = XMVector4Transform(a.r[i], b);
+    }
+    return r;
+}
+inline XMMATRIX operator*(FXMMATRIX a, CXMMATRIX b) { return XMMatrixMultiply(a, b); }
+inline XMMATRIX XMMatrixTranspose(FXMMATRIX a) {
+    XMMATRIX r;
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            r.r[i].v[j] = a.r[j].v[i];
+        }
+    }
+    return r;
+}
+inline XMMATRIX XMMatrixTranslation(float x, float y, float z) {
+    XMMATRIX m = XMMatrixIdentity();
+    m.r[3] = XMVectorSet(x, y, z, 1.0f);
+    return m;
+}
+inline XMMATRIX XMMatrixScaling(float x, float y, float z) {
+    XMMATRIX m = XMMatrixIdentity();
+    m.r[0].v[0] = x;
+    m.r[1].v[1] = y;
+    m.r[2].v[2] = z;
+    return m;
+}
+inline XMMATRIX XMMatrixRotationX(float angle) {
+    float c = std::cos(angle), s = std::sin(angle);
+    XMMATRIX m = XMMatrixIdentity();
+    m.r[1] = XMVectorSet(0.0f, c, s, 0.0f);
+    m.r[2] = XMVectorSet(0.0f, -s, c, 0.0f);
+    return m;
+}
+inline XMMATRIX XMMatrixRotationY(float angle) {
+    float c = std::cos(angle), s = std::sin(angle);
+    XMMATRIX m = XMMatrixIdentity();
+    m.r[0] = XMVectorSet(c, 0.0f, -s, 0.0f);
+    m.r[2] = XMVectorSet(s, 0.0f, c, 0.0f);
+    return m;
+}
+inline XMMATRIX XMMatrixRotationZ(float angle) {
+    float c = std::cos(angle), s = std::sin(angle);
+    XMMATRIX m = XMMatrixIdentity();
+    m.r[0] = XMVectorSet(c, s, 0.0f, 0.0f);
+    m.r[1] = XMVectorSet(-s, c, 0.0f, 0.0f);
+    return m;
+}
+inline XMMATRIX XMMatrixRotationQuaternion(FXMVECTOR q) {
+    float x = q.v[0], y = q.v[1], z = q.v[2], w = q.v[3];
+    XMMATRIX m = XMMatrixIdentity();
+    m.r[0] = XMVectorSet(1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + z * w), 2.0f * (x * z - y * w), 0.0f);
+    m.r[1] = XMVectorSet(2.0f * (x * y - z * w), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + x * w), 0.0f);
+    m.r[2] = XMVectorSet(2.0f * (x * z + y * w), 2.0f * (y * z - x * w), 1.0f - 2.0f * (x * x + y * y), 0.0f);
+    return m;
+}
+inline XMMATRIX XMMatrixPerspectiveFovLH(float fovAngleY, float aspectRatio, float nearZ, float farZ) {
+    float height = 1.0f / std::tan(fovAngleY * 0.5f);
+    float range = farZ / (farZ - nearZ);
+    XMMATRIX m = {};
+    m.r[0].v[0] = height / aspectRatio;
+    m.r[1].v[1] = height;
+    m.r[2].v[2] = range;
+    m.r[2].v[3] = 1.0f;
+    m.r[3].v[2] = -range * nearZ;
+    return m;
+}
+inline XMMATRIX XMMatrixLookAtLH(FXMVECTOR eye, FXMVECTOR focus, FXMVECTOR up) {
+    XMVECTOR z = XMVector3Normalize(XMVectorSubtract(focus, eye));
+    XMVECTOR x = XMVector3Normalize(XMVector3Cross(up, z));
+    XMVECTOR y = XMVector3Cross(z, x);
+    XMVECTOR negEye = XMVectorNegate(eye);
+    XMMATRIX m;
+    m.r[0] = XMVectorSet(x.v[0], y.v[0], z.v[0], 0.0f);
+    m.r[1] = XMVectorSet(x.v[1], y.v[1], z.v[1], 0.0f);
+    m.r[2] = XMVectorSet(x.v[2], y.v[2], z.v[2], 0.0f);
+    m.r[3] = XMVectorSet(XMVector3Dot(x, negEye).v[0], XMVector3Dot(y, negEye).v[0], XMVector3Dot(z, negEye).v[0], 1.0f);
+    return m;
+}
+
+inline XMVECTOR XMQuaternionNormalize(FXMVECTOR q) { return XMVector4Normalize(q); }
+inline XMVECTOR XMQuaternionRotationRollPitchYaw(float pitch, float yaw, float roll) {
+    float sp = std::sin(pitch * 0.5f), cp = std::cos(pitch * 0.5f);
+    float sy = std::sin(yaw * 0.5f), cy = std::cos(yaw * 0.5f);
+    float sr = std::sin(roll * 0.5f), cr = std::cos(roll * 0.5f);
+    return XMVectorSet(sp * cy * cr + cp * sy * sr, cp * sy * cr - sp * cy * sr, cp * cy * sr - sp * sy * cr, cp * cy * cr + sp * sy * sr);
+}
+inline XMVECTOR XMQuaternionRotationMatrix(FXMMATRIX m) {
+    float trace = m.r[0].v[0] + m.r[1].v[1] + m.r[2].v[2];
+    if (trace > 0.0f) {
+        float s = std::sqrt(trace + 1.0f) * 2.0f;
+        return XMVectorSet((m.r[1].v[2] - m.r[2].v[1]) / s, (m.r[2].v[0] - m.r[0].v[2]) / s, (m.r[0].v[1] - m.r[1].v[0]) / s, 0.25f * s);
+    }
+    if (m.r[0].v[0] > m.r[1].v[1] && m.r[0].v[0] > m.r[2].v[2]) {
+        float s = std::sqrt(1.0f + m.r[0].v[0] - m.r[1].v[1] - m.r[2].v[2]) * 2.0f;
+        return XMVectorSet(0.25f * s, (m.r[0].v[1] + m.r[1].v[0]) / s, (m.r[2].v[0] + m.r[0].v[2]) / s, (m.r[1].v[2] - m.r[2].v[1]) / s);
+    }
+    if (m.r[1].v[1] > m.r[2].v[2]) {
+        float s = std::sqrt(1.0f + m.r[1].v[1] - m.r[0].v[0] - m.r[2].v[2]) * 2.0f;
+        return XMVectorSet((m.r[0].v[1] + m.r[1].v[0]) / s, 0.25f * s, (m.r[1].v[2] + m.r[2].v[1]) / s, (m.r[2].v[0] - m.r[0].v[2]) / s);
+    }
+    float s = std::sqrt(1.0f + m.r[2].v[2] - m.r[0].v[0] - m.r[1].v[1]) * 2.0f;
+    return XMVectorSet((m.r[2].v[0] + m.r[0].v[2]) / s, (m.r[1].v[2] + m.r[2].v[1]) / s, 0.25f * s, (m.r[0].v[1] - m.r[1].v[0]) / s);
+}
+
+inline XMVECTOR XMLoadFloat3(const XMFLOAT3* p) { return XMVectorSet(p->x, p->y, p->z, 0.0f); }
+inline XMVECTOR XMLoadFloat4(const XMFLOAT4* p) { return XMVectorSet(p->x, p->y, p->z, p->w); }
+inline void XMStoreFloat3(XMFLOAT3* p, FXMVECTOR v) { *p = XMFLOAT3(v.v[0], v.v[1], v.v[2]); }
+inline void XMStoreFloat4(XMFLOAT4* p, FXMVECTOR v) { *p = XMFLOAT4(v.v[0], v.v[1], v.v[2], v.v[3]); }
+inline XMMATRIX XMLoadFloat4x4(const XMFLOAT4X4* p) {
+    XMMATRIX m;
+    for (int i = 0; i < 4; i++) {
+        m.r[i] = XMVectorSet(p->m[i][0], p->m[i][1], p->m[i][2], p->m[i][3]);
+    }
+    return m;
+}
+inline void XMStoreFloat4x4(XMFLOAT4X4* p, FXMMATRIX m) {
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            p->m[i][j] = m.r[i].v[j];
+        }
+    }
+}
+// Stores transposed upper 3 columns, as in DirectXMath
+inline void XMStoreFloat3x4(XMFLOAT3X4* p, FXMMATRIX m) {
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 4; j++) {
+            p->m[i][j] = m.r[j].v[i];
+        }
+    }
+}
+
+}
@@ -0,0 +1,60 @@
+// taskGraphBench.cpp - scheduling overhead of task graph and wall against serial time of startup-like graph
+#include <cstdio>
+#include <string>
+#include "benchTimer.h"
+#include "taskGraph.h"
+
+namespace {
+    // Function to spin for given microseconds, stands for CPU part of loading
+    bool Spin(const SystemClock& clock, int64_t microseconds) {
+        int64_t end = clock.GetNanoseconds() + microseconds * 1000;
+        while (clock.GetNanoseconds() < end) {
+        }
+        return true;
+    }
+}
+
+int main() {
+    JobSystem jobSystem;
+    jobSystem.Init();
+    SystemClock clock;
+    TaskGraph graph;
+    bool isValid = true;
+
+    // Empty tasks in layers of 64, every task depends on two of previous layer, measures cost of scheduling
+    const int layers = 64;
+    const int width = 64;
+    for (JobSystem* pJobSystem : { (JobSystem*)nullptr, &jobSystem }) {
+        graph.Init(pJobSystem, &clock);
+        for (int layer = 0; layer < layers; layer++) {
+            for (int i = 0; i < width; i++) {
+                int id = graph.AddTask("empty", []() { return true; });
+                if (layer > 0) {
+                    int previous = id - width - i;
+                    graph.AddDependency(id, previous + i);
+                    graph.AddDependency(id, previous + (i + 1) % width);
+                }
+            }
+        }
+        double run = MeasureBest(20, [&]() { isValid = graph.Run() && isValid; });
+        PrintResult(pJobSystem ? "Empty tasks, job system" : "Empty tasks, caller", run, layers * width);
+    }
+
+    // Startup: shaders and textures prepared on workers, then device objects created on main thread
+    graph.Init(&jobSystem, &clock);
+    std::vector<int> loads;
+    for (int i = 0; i < 12; i++) {
+        loads.push_back(graph.AddTask("load " + std::to_string(i), [&clock, i]() { return Spin(clock, 500 + 250 * (i % 4)); }));
+    }
+    int init = graph.AddTask("init", [&clock]() { return Spin(clock, 1000); }, TaskGraph::QUEUE_MAIN);
+    for (int load : loads) {
+        graph.AddDependency(init, load);
+    }
+    double startup = MeasureBest(10, [&]() { isValid = graph.Run() && isValid; });
+    PrintResult("Startup graph", startup, loads.size() + 1);
+    printf("workers %d, wall %.2f ms, serial %.2f ms, critical path %.2f ms, speedup %.2fx\n", jobSystem.GetWorkersCount(),
+        graph.GetWallTime() / 1e6, graph.GetSerialTime() / 1e6, graph.GetCriticalPathTime() / 1e6, (double)graph.GetSerialTime() / graph.GetWallTime());
+
+    jobSystem.Release();
+    return isValid ? 0 : 1;
+}
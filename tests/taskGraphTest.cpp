@@ -0,0 +1,193 @@
+// taskGraphTest.cpp - dependency order, skipping after failure, main queue and timeline of task graph
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include "taskGraph.h"
+#include "testPath.h"
+
+namespace {
+    // Order in which tasks ran, filled from workers
+    class RunOrder {
+    public:
+        TaskGraph::TaskFunc Record(int task, bool result = true) {
+            return [this, task, result]() {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_tasks.push_back(task);
+                return result;
+            };
+        }
+
+        // Function to get position of task in order, -1 if it didn't run
+        int GetPosition(int task) const {
+            auto it = std::find(m_tasks.begin(), m_tasks.end(), task);
+            return it == m_tasks.end() ? -1 : (int)(it - m_tasks.begin());
+        }
+
+        const std::vector<int>& GetTasks() const { return m_tasks; };
+
+    private:
+        std::mutex m_mutex;
+        std::vector<int> m_tasks;
+    };
+}
+
+TEST(TaskGraph, DependenciesRunBeforeDependents) {
+    JobSystem jobSystem;
+    jobSystem.Init(4);
+    SystemClock clock;
+    TaskGraph graph;
+    graph.Init(&jobSystem, &clock);
+    RunOrder order;
+
+    // Layers of 8 tasks, every task depends on two tasks of previous layer
+    const int layers = 6;
+    const int width = 8;
+    std::vector<std::vector<int>> dependencies;
+    for (int layer = 0; layer < layers; layer++) {
+        for (int i = 0; i < width; i++) {
+            int id = (int)dependencies.size();
+            dependencies.push_back({});
+            if (layer > 0) {
+                int previous = id - width - i;
+                dependencies[id] = { previous + i, previous + (i + 1) % width };
+            }
+            ASSERT_EQ(graph.AddTask("task", order.Record(id)), id);
+            for (int dependency : dependencies[id]) {
+                graph.AddDependency(id, dependency);
+            }
+        }
+    }
+
+    ASSERT_TRUE(graph.Run());
+    ASSERT_EQ(order.GetTasks().size(), (size_t)(layers * width));
+    ASSERT_EQ(graph.GetTimeline().size(), (size_t)(layers * width));
+    for (int id = 0; id < layers * width; id++) {
+        for (int dependency : dependencies[id]) {
+            EXPECT_LT(order.GetPosition(dependency), order.GetPosition(id)) << id << " " << dependency;
+        }
+    }
+    EXPECT_EQ(graph.GetLanesCount(), jobSystem.GetWorkersCount() + 2);
+
+    // Graph can be run again
+    ASSERT_TRUE(graph.Run());
+    EXPECT_EQ(order.GetTasks().size(), (size_t)(2 * layers * width));
+    EXPECT_EQ(graph.GetTimeline().size(), (size_t)(layers * width));
+    jobSystem.Release();
+}
+
+TEST(TaskGraph, FailedTaskSkipsDependents) {
+    JobSystem jobSystem;
+    jobSystem.Init(2);
+    SystemClock clock;
+    TaskGraph graph;
+    graph.Init(&jobSystem, &clock);
+    RunOrder order;
+
+    int failing = graph.AddTask("failing", order.Record(0, false));
+    int child = graph.AddTask("child", order.Record(1), TaskGraph::QUEUE_WORKER, { failing });
+    int grandChild = graph.AddTask("grandChild", order.Record(2), TaskGraph::QUEUE_WORKER, { child });
+    int independent = graph.AddTask("independent", order.Record(3));
+    graph.AddTask("joined", order.Record(4), TaskGraph::QUEUE_WORKER, { independent, grandChild });
+    graph.AddTask("mainSkipped", order.Record(5), TaskGraph::QUEUE_MAIN, { grandChild });
+    graph.AddTask("mainRun", order.Record(6), TaskGraph::QUEUE_MAIN, { independent });
+
+    EXPECT_FALSE(graph.Run());
+    std::vector<int> tasks = order.GetTasks();
+    std::sort(tasks.begin(), tasks.end());
+    EXPECT_EQ(tasks, std::vector<int>({ 0, 3, 6 }));
+    // Skipped tasks are not on timeline
+    EXPECT_EQ(graph.GetTimeline().size(), 3u);
+    jobSystem.Release();
+}
+
+TEST(TaskGraph, MainQueueRunsOnCallerAfterWorkers) {
+    JobSystem jobSystem;
+    jobSystem.Init(4);
+    SystemClock clock;
+    TaskGraph graph;
+    graph.Init(&jobSystem, &clock);
+    RunOrder order;
+
+    std::thread::id caller = std::this_thread::get_id();
+    std::thread::id mainThreads[2];
+    int worker = graph.AddTask("worker", order.Record(0));
+    int first = graph.AddTask("first", [&]() { mainThreads[0] = std::this_thread::get_id(); return order.Record(1)(); }, TaskGraph::QUEUE_MAIN);
+    int second = graph.AddTask("second", [&]() { mainThreads[1] = std::this_thread::get_id(); return order.Record(2)(); }, TaskGraph::QUEUE_MAIN, { worker });
+    for (int i = 0; i < 16; i++) {
+        graph.AddTask("worker", order.Record(3 + i), TaskGraph::QUEUE_WORKER, { worker });
+    }
+
+    ASSERT_TRUE(graph.Run());
+    EXPECT_EQ(mainThreads[0], caller);
+    EXPECT_EQ(mainThreads[1], caller);
+    // Main tasks run in order of adding, after every worker task even without dependencies
+    ASSERT_EQ(order.GetTasks().size(), 19u);
+    EXPECT_EQ(order.GetPosition(first), 17);
+    EXPECT_EQ(order.GetPosition(second), 18);
+    for (const TaskGraph::Event& event : graph.GetTimeline()) {
+        bool isMain = event.task == first || event.task == second;
+        EXPECT_EQ(event.lane == graph.GetLanesCount() - 1, isMain) << graph.GetTaskName(event.task);
+    }
+
+    // Without job system worker tasks run on caller too
+    graph.Init(nullptr, &clock);
+    std::thread::id workerThread;
+    graph.AddTask("worker", [&]() { workerThread = std::this_thread::get_id(); return true; });
+    ASSERT_TRUE(graph.Run());
+    EXPECT_EQ(workerThread, caller);
+    EXPECT_EQ(graph.GetLanesCount(), 2);
+    jobSystem.Release();
+}
+
+TEST(TaskGraph, WallAndSerialTimeOnFakeClock) {
+    // Tasks advance fake clock, so they run on caller only
+    FakeClock clock;
+    TaskGraph graph;
+    graph.Init(nullptr, &clock);
+    auto work = [&clock](int64_t nanoseconds) {
+        return [&clock, nanoseconds]() { clock.Advance(nanoseconds); return true; };
+    };
+
+    int a = graph.AddTask("a", work(10000000));
+    int b = graph.AddTask("b", work(20000000));
+    int c = graph.AddTask("c", work(5000000), TaskGraph::QUEUE_WORKER, { a });
+    graph.AddTask("init", work(1000000), TaskGraph::QUEUE_MAIN, { b, c });
+
+    ASSERT_TRUE(graph.Run());
+    EXPECT_EQ(graph.GetWallTime(), 36000000);
+    EXPECT_EQ(graph.GetSerialTime(), 36000000);
+    // Longest chain is b then main task, a and c could run next to it
+    EXPECT_EQ(graph.GetCriticalPathTime(), 21000000);
+    ASSERT_EQ(graph.GetTimeline().size(), 4u);
+    const TaskGraph::Event& last = graph.GetTimeline().back();
+    EXPECT_EQ(last.start, 35000000);
+    EXPECT_EQ(last.end, 36000000);
+
+    // Time of failed task counts, skipped dependents are not run
+    graph.Reset();
+    int failing = graph.AddTask("failing", [&clock]() { clock.Advance(3000000); return false; });
+    graph.AddTask("skipped", work(10000000), TaskGraph::QUEUE_WORKER, { failing });
+    EXPECT_FALSE(graph.Run());
+    EXPECT_EQ(graph.GetWallTime(), 3000000);
+    EXPECT_EQ(graph.GetSerialTime(), 3000000);
+}
+
+TEST(TaskGraph, WritesChromeTrace) {
+    FakeClock clock;
+    TaskGraph graph;
+    graph.Init(nullptr, &clock);
+    graph.AddTask("Load \"sky\"", [&clock]() { clock.Advance(2000); return true; });
+    ASSERT_TRUE(graph.Run());
+
+    std::string path = GetTestPath("trace.json");
+    ASSERT_TRUE(graph.WriteTrace(path.c_str()));
+    std::ifstream file(path);
+    std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
+    std::remove(path.c_str());
+    EXPECT_NE(text.find("\"name\":\"Load 'sky'\",\"ph\":\"X\",\"pid\":1,\"tid\":0,\"ts\":0,\"dur\":2"), std::string::npos) << text;
+}
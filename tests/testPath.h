@@ -0,0 +1,22 @@
+// testPath.h - paths of files written by tests, unique per test so ctest can run cases in parallel
+#pragma once
+
+#include <gtest/gtest.h>
+#include <string>
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+// Function to get path in working directory unique for running test and process, name tells apart files of one test
+inline std::string GetTestPath(const std::string& name) {
+    const ::testing::TestInfo* info = ::testing::UnitTest::GetInstance()->current_test_info();
+    std::string test = info ? std::string(info->test_suite_name()) + "_" + info->name() : "test";
+#ifdef _WIN32
+    int pid = _getpid();
+#else
+    int pid = (int)getpid();
+#endif
+    return test + "_" + std::to_string(pid) + "_" + name;
+}
@@ -0,0 +1,74 @@
+// textureCompressorBench.cpp - speed and PSNR of BC encoders on one core and on job system
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include "benchTimer.h"
+#include "textureCompressor.h"
+
+int main() {
+    const uint32_t size = 1024;
+    const size_t pixels = (size_t)size * size;
+    // Smooth gradients with slight noise, close to photographed textures
+    std::mt19937 random(23);
+    std::uniform_int_distribution<int> noise(-4, 4);
+    TextureCompressor::Image image;
+    image.width = size;
+    image.height = size;
+    image.pixels.resize(pixels * 4);
+    for (uint32_t y = 0; y < size; y++) {
+        for (uint32_t x = 0; x < size; x++) {
+            int values[4] = {
+                int(128.0f + 100.0f * sinf(x * 0.05f + y * 0.03f)),
+                int(128.0f + 100.0f * sinf(x * 0.07f)),
+                int(128.0f + 100.0f * cosf(y * 0.06f)),
+                255
+            };
+            for (int c = 0; c < 4; c++) {
+                image.pixels[((size_t)y * size + x) * 4 + c] = (unsigned char)(std::min)(255, (std::max)(0, values[c] + noise(random)));
+            }
+        }
+    }
+
+    JobSystem jobSystem;
+    jobSystem.Init();
+    TextureCompressor serial;
+    serial.Init();
+    TextureCompressor parallel;
+    parallel.Init(&jobSystem);
+
+    struct Format {
+        DdsFile::Format format;
+        const char* name;
+        uint32_t channelsMask;
+    };
+    const Format formats[] = {
+        { DdsFile::FORMAT_BC1_UNORM, "BC1", 0x7 },
+        { DdsFile::FORMAT_BC3_UNORM, "BC3", 0xf },
+        { DdsFile::FORMAT_BC4_UNORM, "BC4", 0x1 },
+        { DdsFile::FORMAT_BC5_UNORM, "BC5", 0x3 },
+        { DdsFile::FORMAT_BC7_UNORM, "BC7", 0xf },
+    };
+    bool isValid = true;
+    std::vector<unsigned char> blocks;
+    TextureCompressor::Image decoded;
+    for (const Format& format : formats) {
+        double serialMs = MeasureBest(3, [&]() { isValid = serial.Compress(image, format.format, blocks) && isValid; });
+        double parallelMs = MeasureBest(3, [&]() { isValid = parallel.Compress(image, format.format, blocks) && isValid; });
+        double decodeMs = MeasureBest(3, [&]() {
+            isValid = TextureCompressor::Decompress(blocks.data(), size, size, format.format, decoded) && isValid;
+        });
+
+        char name[64];
+        snprintf(name, sizeof(name), "%s encode, one core", format.name);
+        PrintResult(name, serialMs, pixels);
+        snprintf(name, sizeof(name), "%s encode, job system", format.name);
+        PrintResult(name, parallelMs, pixels);
+        snprintf(name, sizeof(name), "%s decode", format.name);
+        PrintResult(name, decodeMs, pixels);
+        printf("%s %.1f MPix/s, PSNR %.2f dB\n", format.name, pixels / serialMs / 1000.0, TextureCompressor::ComputePSNR(image, decoded, format.channelsMask));
+    }
+
+    parallel.Release();
+    jobSystem.Release();
+    return isValid ? 0 : 1;
+}
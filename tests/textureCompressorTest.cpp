@@ -0,0 +1,254 @@
+// textureCompressorTest.cpp - quality of BC encoders measured by PSNR of decoded images, block edge cases and DDS conversion
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include "textureCompressor.h"
+#include "testPath.h"
+
+namespace {
+    // Function to make image of smooth gradients with slight noise, close to photographed textures
+    TextureCompressor::Image MakeImage(uint32_t width, uint32_t height, unsigned seed) {
+        std::mt19937 random(seed);
+        std::uniform_int_distribution<int> noise(-4, 4);
+        TextureCompressor::Image image;
+        image.width = width;
+        image.height = height;
+        image.pixels.resize((size_t)width * height * 4);
+        for (uint32_t y = 0; y < height; y++) {
+            for (uint32_t x = 0; x < width; x++) {
+                int values[4] = {
+                    int(128.0f + 100.0f * sinf(x * 0.05f + y * 0.03f)),
+                    int(128.0f + 100.0f * sinf(x * 0.07f)),
+                    int(128.0f + 100.0f * cosf(y * 0.06f)),
+                    int(128.0f + 120.0f * cosf(x * 0.02f - y * 0.04f))
+                };
+                for (int c = 0; c < 4; c++) {
+                    image.pixels[((size_t)y * width + x) * 4 + c] = (unsigned char)(std::min)(255, (std::max)(0, values[c] + noise(random)));
+                }
+            }
+        }
+        return image;
+    }
+
+    // Function to compress image and decode it back
+    TextureCompressor::Image RoundTrip(const TextureCompressor& compressor, const TextureCompressor::Image& image, DdsFile::Format format) {
+        std::vector<unsigned char> blocks;
+        TextureCompressor::Image decoded;
+        EXPECT_TRUE(compressor.Compress(image, format, blocks));
+        EXPECT_TRUE(TextureCompressor::Decompress(blocks.data(), image.width, image.height, format, decoded));
+        return decoded;
+    }
+}
+
+TEST(TextureCompressor, PSNRMeasuresChannelsInMask) {
+    TextureCompressor::Image a = MakeImage(8, 8, 1);
+    TextureCompressor::Image b = a;
+    EXPECT_TRUE(std::isinf(TextureCompressor::ComputePSNR(a, b)));
+
+    // Error of 5 in every red value only
+    for (size_t i = 0; i < b.pixels.size(); i += 4) {
+        b.pixels[i] = a.pixels[i] < 128 ? a.pixels[i] + 5 : a.pixels[i] - 5;
+    }
+    EXPECT_NEAR(TextureCompressor::ComputePSNR(a, b, 0x1), 10.0 * log10(255.0 * 255.0 / 25.0), 1e-9);
+    EXPECT_NEAR(TextureCompressor::ComputePSNR(a, b, 0xf), 10.0 * log10(255.0 * 255.0 / 6.25), 1e-9);
+    EXPECT_TRUE(std::isinf(TextureCompressor::ComputePSNR(a, b, 0xe)));
+
+    b.width = 4;
+    EXPECT_EQ(TextureCompressor::ComputePSNR(a, b), 0.0);
+}
+
+TEST(TextureCompressor, FormatsKeepQualityOfSmoothImage) {
+    TextureCompressor compressor;
+    compressor.Init();
+    TextureCompressor::Image image = MakeImage(256, 256, 2);
+
+    // BC1 keeps only cutout alpha, color of pixels with alpha under half is dropped
+    TextureCompressor::Image opaque = image;
+    for (size_t i = 3; i < opaque.pixels.size(); i += 4) {
+        opaque.pixels[i] = 255;
+    }
+
+    struct Case {
+        DdsFile::Format format;
+        bool isOpaque;
+        uint32_t channelsMask;
+        double minPSNR;
+    };
+    // Thresholds are 2 dB under what encoders give now, so quality regressions show up.
+    // Noise of image alone limits PSNR to about 40 dB when it is lost
+    const Case cases[] = {
+        { DdsFile::FORMAT_BC1_UNORM, true, 0x7, 34.5 },
+        { DdsFile::FORMAT_BC3_UNORM, false, 0x7, 34.5 },
+        { DdsFile::FORMAT_BC3_UNORM, false, 0x8, 49.0 },
+        { DdsFile::FORMAT_BC4_UNORM, false, 0x1, 48.0 },
+        { DdsFile::FORMAT_BC5_UNORM, false, 0x3, 48.0 },
+        { DdsFile::FORMAT_BC7_UNORM, false, 0xf, 35.5 },
+        { DdsFile::FORMAT_BC7_UNORM, true, 0x7, 0.0 },
+    };
+    double psnrs[sizeof(cases) / sizeof(cases[0])];
+    for (int i = 0; i < (int)(sizeof(cases) / sizeof(cases[0])); i++) {
+        const Case& test = cases[i];
+        const TextureCompressor::Image& source = test.isOpaque ? opaque : image;
+        TextureCompressor::Image decoded = RoundTrip(compressor, source, test.format);
+        psnrs[i] = TextureCompressor::ComputePSNR(source, decoded, test.channelsMask);
+        EXPECT_GT(psnrs[i], test.minPSNR) << "format " << test.format << " mask " << test.channelsMask;
+    }
+    // BC7 spends twice the bits of BC1 on same opaque colors
+    EXPECT_GT(psnrs[6], psnrs[0] + 1.0);
+
+    // Channels BC4 and BC5 don't store read as zero and opaque
+    TextureCompressor::Image decoded = RoundTrip(compressor, image, DdsFile::FORMAT_BC4_UNORM);
+    for (size_t i = 0; i < decoded.pixels.size(); i += 4) {
+        ASSERT_EQ(decoded.pixels[i + 1], 0);
+        ASSERT_EQ(decoded.pixels[i + 2], 0);
+        ASSERT_EQ(decoded.pixels[i + 3], 255);
+    }
+}
+
+TEST(TextureCompressor, SolidBlocksDecodeClosely) {
+    std::mt19937 random(3);
+    for (int i = 0; i < 200; i++) {
+        unsigned char color[4] = { (unsigned char)random(), (unsigned char)random(), (unsigned char)random(), (unsigned char)random() };
+        unsigned char pixels[64];
+        for (int p = 0; p < 16; p++) {
+            memcpy(pixels + p * 4, color, 4);
+        }
+
+        // Endpoints of BC7 mode 6 share p-bit over channels, so channels of other parity are off by rounding.
+        // BC4 endpoints are 8-bit values
+        unsigned char block[16];
+        unsigned char decoded[64];
+        TextureCompressor::EncodeBC7(pixels, block);
+        ASSERT_TRUE(TextureCompressor::DecodeBC7(block, decoded));
+        for (int c = 0; c < 64; c++) {
+            ASSERT_NEAR(decoded[c], pixels[c], 1);
+        }
+
+        memset(decoded, 0, sizeof(decoded));
+        TextureCompressor::EncodeBC4(pixels, 2, block);
+        TextureCompressor::DecodeBC4(block, 2, decoded);
+        for (int p = 0; p < 16; p++) {
+            ASSERT_EQ(decoded[p * 4 + 2], color[2]);
+        }
+
+        // BC1 palette of 5:6:5 endpoints is off by quantization only
+        TextureCompressor::EncodeBC1(pixels, block, false);
+        TextureCompressor::DecodeBC1(block, decoded, false);
+        for (int p = 0; p < 16; p++) {
+            ASSERT_NEAR(decoded[p * 4 + 0], color[0], 4);
+            ASSERT_NEAR(decoded[p * 4 + 1], color[1], 2);
+            ASSERT_NEAR(decoded[p * 4 + 2], color[2], 4);
+        }
+    }
+}
+
+TEST(TextureCompressor, BC1KeepsCutoutAlpha) {
+    TextureCompressor::Image image = MakeImage(64, 64, 4);
+    for (size_t i = 0; i < image.pixels.size(); i += 4) {
+        image.pixels[i + 3] = (i / 4 + i / 256) % 3 == 0 ? 0 : 255;
+    }
+    TextureCompressor compressor;
+    TextureCompressor::Image decoded = RoundTrip(compressor, image, DdsFile::FORMAT_BC1_UNORM);
+    for (size_t i = 0; i < image.pixels.size(); i += 4) {
+        ASSERT_EQ(decoded.pixels[i + 3], image.pixels[i + 3]) << i / 4;
+        if (!image.pixels[i + 3]) {
+            // Transparent texels are black, so filtering doesn't bleed their color
+            ASSERT_EQ(decoded.pixels[i] | decoded.pixels[i + 1] | decoded.pixels[i + 2], 0);
+        }
+    }
+}
+
+TEST(TextureCompressor, EdgeBlocksOfOddSizes) {
+    TextureCompressor compressor;
+    const uint32_t sizes[][2] = { { 1, 1 }, { 2, 3 }, { 13, 7 }, { 30, 1 } };
+    for (const auto& size : sizes) {
+        TextureCompressor::Image image = MakeImage(size[0], size[1], 5);
+        std::vector<unsigned char> blocks;
+        ASSERT_TRUE(compressor.Compress(image, DdsFile::FORMAT_BC7_UNORM, blocks));
+        EXPECT_EQ(blocks.size(), (size_t)((size[0] + 3) / 4) * ((size[1] + 3) / 4) * 16);
+
+        TextureCompressor::Image decoded;
+        ASSERT_TRUE(TextureCompressor::Decompress(blocks.data(), size[0], size[1], DdsFile::FORMAT_BC7_UNORM, decoded));
+        EXPECT_EQ(decoded.width, size[0]);
+        EXPECT_EQ(decoded.height, size[1]);
+        EXPECT_GT(TextureCompressor::ComputePSNR(image, decoded), 35.0) << size[0] << "x" << size[1];
+    }
+}
+
+TEST(TextureCompressor, RejectsUnsupportedInput) {
+    TextureCompressor compressor;
+    TextureCompressor::Image image = MakeImage(8, 8, 6);
+    std::vector<unsigned char> blocks;
+    EXPECT_FALSE(compressor.Compress(image, DdsFile::FORMAT_R8G8B8A8_UNORM, blocks));
+    EXPECT_FALSE(compressor.Compress(image, DdsFile::FORMAT_BC6H_UF16, blocks));
+    image.pixels.pop_back();
+    EXPECT_FALSE(compressor.Compress(image, DdsFile::FORMAT_BC1_UNORM, blocks));
+
+    // Mode of BC7 block is lowest set bit, zero byte is reserved mode and mode 0 isn't decoded
+    unsigned char block[16] = {};
+    unsigned char pixels[64];
+    EXPECT_FALSE(TextureCompressor::DecodeBC7(block, pixels));
+    block[0] = 1;
+    EXPECT_FALSE(TextureCompressor::DecodeBC7(block, pixels));
+    TextureCompressor::Image decoded;
+    EXPECT_FALSE(TextureCompressor::Decompress(block, 4, 4, DdsFile::FORMAT_BC7_UNORM, decoded));
+    EXPECT_FALSE(TextureCompressor::Decompress(block, 4, 4, DdsFile::FORMAT_R8G8B8A8_UNORM, decoded));
+}
+
+TEST(TextureCompressor, ParallelOutputMatchesSerial) {
+    JobSystem jobSystem;
+    jobSystem.Init(4);
+    TextureCompressor serial;
+    serial.Init();
+    TextureCompressor parallel;
+    parallel.Init(&jobSystem);
+    TextureCompressor::Image image = MakeImage(200, 120, 7);
+
+    const DdsFile::Format formats[] = { DdsFile::FORMAT_BC1_UNORM, DdsFile::FORMAT_BC3_UNORM, DdsFile::FORMAT_BC5_UNORM, DdsFile::FORMAT_BC7_UNORM };
+    for (DdsFile::Format format : formats) {
+        std::vector<unsigned char> serialBlocks;
+        std::vector<unsigned char> parallelBlocks;
+        ASSERT_TRUE(serial.Compress(image, format, serialBlocks));
+        ASSERT_TRUE(parallel.Compress(image, format, parallelBlocks));
+        EXPECT_EQ(serialBlocks, parallelBlocks) << format;
+    }
+    parallel.Release();
+    jobSystem.Release();
+}
+
+TEST(TextureCompressor, ConvertsEveryMipOfFile) {
+    std::string sourceFile = GetTestPath("source.dds");
+    std::string convertedFile = GetTestPath("bc7.dds");
+    std::vector<TextureCompressor::Image> images;
+    std::vector<std::vector<unsigned char>> mips;
+    for (uint32_t size = 64; size >= 1; size /= 2) {
+        images.push_back(MakeImage(size, size, size));
+        mips.push_back(images.back().pixels);
+    }
+    ASSERT_TRUE(DdsFile::Write(sourceFile.c_str(), DdsFile::FORMAT_R8G8B8A8_UNORM, 64, 64, mips));
+
+    DdsFile source;
+    ASSERT_TRUE(source.Open(sourceFile.c_str()));
+    TextureCompressor compressor;
+    ASSERT_TRUE(compressor.Convert(source, DdsFile::FORMAT_BC7_UNORM, convertedFile.c_str()));
+
+    DdsFile converted;
+    ASSERT_TRUE(converted.Open(convertedFile.c_str()));
+    EXPECT_EQ(converted.GetDesc().format, DdsFile::FORMAT_BC7_UNORM);
+    ASSERT_EQ(converted.GetDesc().mipCount, (uint32_t)images.size());
+    for (int mip = 0; mip < (int)images.size(); mip++) {
+        TextureCompressor::Image image;
+        ASSERT_TRUE(TextureCompressor::ReadImage(source, mip, image));
+        EXPECT_EQ(image.pixels, images[mip].pixels);
+        ASSERT_TRUE(TextureCompressor::ReadImage(converted, mip, image));
+        EXPECT_GT(TextureCompressor::ComputePSNR(images[mip], image), 35.0) << mip;
+    }
+
+    source.Release();
+    converted.Release();
+    std::remove(sourceFile.c_str());
+    std::remove(convertedFile.c_str());
+}
@@ -0,0 +1,84 @@
+// textureStreamerBench.cpp - adding textures with their mip tails, per frame update and streaming under budget
+#include <cstdio>
+#include <string>
+#include "benchTimer.h"
+#include "textureStreamer.h"
+
+namespace {
+    // Sink without device, counts bytes it would upload
+    class CountingSink : public TextureStreamer::Sink {
+    public:
+        uint64_t uploadedBytes = 0;
+
+        bool SetResidency(int, const std::vector<const DdsFile*>& files, uint32_t firstMip) override {
+            uploadedBytes += TextureStreamer::GetMipsSize(files[0]->GetDesc(), firstMip, (uint32_t)files.size());
+            return true;
+        }
+
+        void RemoveTexture(int) override {}
+    };
+}
+
+int main() {
+    const int count = 256;
+    const uint32_t size = 256;
+    std::vector<std::vector<unsigned char>> mips;
+    for (uint32_t mipSize = size; mipSize >= 1; mipSize /= 2) {
+        mips.emplace_back(mipSize * mipSize * 4, (unsigned char)mips.size());
+    }
+    std::vector<std::string> paths(count);
+    for (int i = 0; i < count; i++) {
+        paths[i] = "textureStreamerBench_" + std::to_string(i) + ".dds";
+        if (!DdsFile::Write(paths[i].c_str(), DdsFile::FORMAT_R8G8B8A8_UNORM, size, size, mips)) {
+            return 1;
+        }
+    }
+
+    // Budget holds quarter of textures at full resolution
+    CountingSink sink;
+    TextureStreamer streamer;
+    uint64_t fullSize = 0;
+    for (const std::vector<unsigned char>& mip : mips) {
+        fullSize += mip.size();
+    }
+    uint64_t budget = fullSize * count / 4;
+    double add = MeasureBest(3, [&]() {
+        streamer.Init(&sink, budget);
+        for (const std::string& path : paths) {
+            streamer.AddTexture({ path });
+        }
+    });
+
+    // Camera sweeps over textures, quarter of them is close each frame
+    int frames = 0;
+    auto frame = [&]() {
+        int first = (frames / 8 * count / 16) % count;
+        for (int i = 0; i < count / 4; i++) {
+            streamer.UseTexture((first + i) % count, (float)size, 1.0f);
+        }
+        streamer.Update();
+        frames++;
+    };
+    double stream = MeasureBest(1, [&]() {
+        for (int i = 0; i < 256; i++) {
+            frame();
+            streamer.WaitIdle();
+        }
+    });
+    streamer.WaitIdle();
+    double update = MeasureBest(10, [&]() { frame(); });
+
+    TextureStreamer::Stats stats = streamer.GetStats();
+    PrintResult("Add texture with tail", add, count);
+    PrintResult("Frame of sweep, waiting for reads", stream / 256, count);
+    PrintResult("Update", update, count);
+    printf("loaded %d mips, evicted %d, deferred %d, resident %.1f of %.1f MB, uploaded %.1f MB\n", stats.loadedMips, stats.evictedMips,
+        stats.deferredLoads, stats.residentBytes / 1048576.0, stats.budgetBytes / 1048576.0, sink.uploadedBytes / 1048576.0);
+
+    bool isValid = stats.residentBytes <= stats.budgetBytes && stats.loadedMips > 0;
+    streamer.Release();
+    for (const std::string& path : paths) {
+        std::remove(path.c_str());
+    }
+    return isValid ? 0 : 1;
+}
@@ -0,0 +1,268 @@
+// textureStreamerTest.cpp - progressive mip loading, budget and eviction of texture streamer on fake sink
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include "testPath.h"
+#include "textureStreamer.h"
+
+namespace {
+    // Sink keeping first resident mip of every texture and order of residency changes
+    class FakeSink : public TextureStreamer::Sink {
+    public:
+        struct Call {
+            int texture;
+            uint32_t firstMip;
+        };
+        std::vector<Call> calls;
+        std::vector<int> residentMips;
+        std::vector<int> removed;
+        std::vector<const DdsFile*> lastFiles;
+        bool isFailing = false;
+
+        bool SetResidency(int texture, const std::vector<const DdsFile*>& files, uint32_t firstMip) override {
+            if (isFailing || files.empty() || firstMip >= files[0]->GetDesc().mipCount) {
+                return false;
+            }
+            calls.push_back({ texture, firstMip });
+            lastFiles = files;
+            if ((int)residentMips.size() <= texture) {
+                residentMips.resize(texture + 1, -1);
+            }
+            residentMips[texture] = (int)firstMip;
+            return true;
+        }
+
+        void RemoveTexture(int texture) override {
+            removed.push_back(texture);
+        }
+    };
+
+    // Function to write RGBA8 texture with full mip chain
+    std::string WriteTexture(const std::string& name, uint32_t size) {
+        std::vector<std::vector<unsigned char>> mips;
+        for (uint32_t mipSize = size; ; mipSize /= 2) {
+            mips.emplace_back(mipSize * mipSize * 4, (unsigned char)mips.size());
+            if (mipSize == 1)
+                break;
+        }
+        std::string path = GetTestPath(name + ".dds");
+        DdsFile::Write(path.c_str(), DdsFile::FORMAT_R8G8B8A8_UNORM, size, size, mips);
+        return path;
+    }
+
+    class TextureStreamerTest : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            paths.push_back(WriteTexture("a", 512));
+            paths.push_back(WriteTexture("b", 512));
+            paths.push_back(WriteTexture("small", 32));
+        }
+
+        void TearDown() override {
+            streamer.Release();
+            for (const std::string& path : paths) {
+                std::remove(path.c_str());
+            }
+        }
+
+        // Function to run frames in which given textures are used at given screen size
+        void RunFrames(int frames, const std::vector<int>& textures, float screenSize) {
+            for (int i = 0; i < frames; i++) {
+                for (int texture : textures) {
+                    streamer.UseTexture(texture, screenSize, 1.0f);
+                }
+                streamer.Update();
+                streamer.WaitIdle();
+                ASSERT_LE(streamer.GetStats().residentBytes, streamer.GetStats().budgetBytes);
+            }
+        }
+
+        uint64_t GetSize(int texture, uint32_t firstMip) {
+            return TextureStreamer::GetMipsSize(streamer.GetDesc(texture), firstMip, 1);
+        }
+
+        FakeSink sink;
+        TextureStreamer streamer;
+        std::vector<std::string> paths;
+    };
+}
+
+TEST(TextureStreamer, MipForScreenSizeAndTail) {
+    DdsFile::Desc desc;
+    desc.width = 512;
+    desc.height = 256;
+    desc.mipCount = 10;
+    EXPECT_EQ(TextureStreamer::GetMipForScreenSize(desc, 1024.0f), 0u);
+    EXPECT_EQ(TextureStreamer::GetMipForScreenSize(desc, 512.0f), 0u);
+    EXPECT_EQ(TextureStreamer::GetMipForScreenSize(desc, 300.0f), 0u);
+    EXPECT_EQ(TextureStreamer::GetMipForScreenSize(desc, 256.0f), 1u);
+    EXPECT_EQ(TextureStreamer::GetMipForScreenSize(desc, 4.0f), 7u);
+    EXPECT_EQ(TextureStreamer::GetMipForScreenSize(desc, 0.5f), 9u);
+    EXPECT_EQ(TextureStreamer::GetTailMip(desc), 3u);
+
+    desc.mipCount = 2;
+    EXPECT_EQ(TextureStreamer::GetMipForScreenSize(desc, 2.0f), 1u);
+    // Chain which never gets small enough has only its last mip in tail
+    EXPECT_EQ(TextureStreamer::GetTailMip(desc), 1u);
+}
+
+TEST_F(TextureStreamerTest, AddTextureMakesTailResident) {
+    streamer.Init(&sink, 64 * 1024 * 1024);
+    int texture = streamer.AddTexture({ paths[0] });
+    ASSERT_EQ(texture, 0);
+    EXPECT_EQ(streamer.GetTailMip(texture), 3u);
+    EXPECT_EQ(streamer.GetResidentMip(texture), 3u);
+    ASSERT_EQ(sink.calls.size(), 1u);
+    EXPECT_EQ(sink.calls[0].firstMip, 3u);
+    EXPECT_EQ(streamer.GetStats().residentBytes, GetSize(texture, 3));
+
+    // Texture smaller than tail size is whole tail
+    int small = streamer.AddTexture({ paths[2] });
+    ASSERT_GE(small, 0);
+    EXPECT_EQ(streamer.GetResidentMip(small), 0u);
+    EXPECT_EQ(streamer.GetStats().residentBytes, GetSize(texture, 3) + GetSize(small, 0));
+
+    streamer.Release();
+    EXPECT_EQ(sink.removed, std::vector<int>({ 0, 1 }));
+}
+
+TEST_F(TextureStreamerTest, AddTextureRejectsBadFiles) {
+    streamer.Init(&sink, 64 * 1024 * 1024);
+    EXPECT_EQ(streamer.AddTexture({ GetTestPath("missing.dds") }), -1);
+    EXPECT_EQ(streamer.AddTexture({}), -1);
+    // Slices of array must have same size
+    EXPECT_EQ(streamer.AddTexture({ paths[0], paths[2] }), -1);
+    sink.isFailing = true;
+    EXPECT_EQ(streamer.AddTexture({ paths[0] }), -1);
+    EXPECT_TRUE(sink.calls.empty());
+
+    sink.isFailing = false;
+    ASSERT_EQ(streamer.AddTexture({ paths[0], paths[1] }), 0);
+    EXPECT_EQ(streamer.GetStats().residentBytes, 2 * GetSize(0, 3));
+}
+
+TEST_F(TextureStreamerTest, RefinesOneMipAtATimeToScreenSize) {
+    streamer.Init(&sink, 64 * 1024 * 1024);
+    int texture = streamer.AddTexture({ paths[0] });
+    ASSERT_GE(texture, 0);
+    // Screen size of 128 pixels needs mip 2 of 512 texture
+    RunFrames(6, { texture }, 128.0f);
+    EXPECT_EQ(streamer.GetDesiredMip(texture), 2u);
+    EXPECT_EQ(streamer.GetResidentMip(texture), 2u);
+
+    RunFrames(6, { texture }, 600.0f);
+    EXPECT_EQ(streamer.GetResidentMip(texture), 0u);
+    std::vector<uint32_t> mips;
+    for (const FakeSink::Call& call : sink.calls) {
+        mips.push_back(call.firstMip);
+    }
+    EXPECT_EQ(mips, std::vector<uint32_t>({ 3, 2, 1, 0 }));
+    TextureStreamer::Stats stats = streamer.GetStats();
+    EXPECT_EQ(stats.loadedMips, 3);
+    EXPECT_EQ(stats.pendingLoads, 0);
+    EXPECT_EQ(stats.residentBytes, GetSize(texture, 0));
+}
+
+TEST_F(TextureStreamerTest, EvictsLeastRecentlyUsedToFitBudget) {
+    streamer.Init(&sink, 64 * 1024 * 1024);
+    int a = streamer.AddTexture({ paths[0] });
+    ASSERT_GE(a, 0);
+    int b = streamer.AddTexture({ paths[1] });
+    ASSERT_GE(b, 0);
+    // Budget fits tails and one full texture
+    streamer.SetBudget(GetSize(a, 0) + GetSize(b, 3));
+
+    RunFrames(5, { a }, 512.0f);
+    EXPECT_EQ(streamer.GetResidentMip(a), 0u);
+    EXPECT_EQ(streamer.GetResidentMip(b), 3u);
+
+    // Only b is used now, a gives its mips away but keeps tail
+    RunFrames(8, { b }, 512.0f);
+    EXPECT_EQ(streamer.GetResidentMip(b), 0u);
+    EXPECT_EQ(streamer.GetResidentMip(a), 3u);
+    TextureStreamer::Stats stats = streamer.GetStats();
+    EXPECT_EQ(stats.evictedMips, 3);
+    EXPECT_EQ(stats.residentBytes, GetSize(a, 3) + GetSize(b, 0));
+    EXPECT_EQ(sink.residentMips[a], 3);
+}
+
+TEST_F(TextureStreamerTest, DefersLoadsWhenUsedTexturesFillBudget) {
+    streamer.Init(&sink, 64 * 1024 * 1024);
+    int a = streamer.AddTexture({ paths[0] });
+    ASSERT_GE(a, 0);
+    int b = streamer.AddTexture({ paths[1] });
+    ASSERT_GE(b, 0);
+    streamer.SetBudget(GetSize(a, 0) + GetSize(b, 3));
+
+    // Both are needed in full, mips of textures used this frame are never evicted for each other
+    RunFrames(10, { a, b }, 512.0f);
+    TextureStreamer::Stats stats = streamer.GetStats();
+    EXPECT_GT(stats.deferredLoads, 0);
+    EXPECT_EQ(stats.evictedMips, 0);
+    EXPECT_GE(streamer.GetResidentMip(a) + streamer.GetResidentMip(b), 1u);
+    EXPECT_LE(stats.residentBytes, stats.budgetBytes);
+}
+
+TEST_F(TextureStreamerTest, EvictsExcessMipsBeforeUsedOnes) {
+    streamer.Init(&sink, 64 * 1024 * 1024);
+    int a = streamer.AddTexture({ paths[0] });
+    ASSERT_GE(a, 0);
+    int b = streamer.AddTexture({ paths[1] });
+    ASSERT_GE(b, 0);
+    RunFrames(5, { a }, 512.0f);
+    ASSERT_EQ(streamer.GetResidentMip(a), 0u);
+
+    // a moves away and needs only mip 2, b needs all its mips, budget has room for both only without excess of a
+    streamer.SetBudget(GetSize(a, 2) + GetSize(b, 0));
+    for (int i = 0; i < 8; i++) {
+        streamer.UseTexture(a, 128.0f, 10.0f);
+        streamer.UseTexture(b, 512.0f, 1.0f);
+        streamer.Update();
+        streamer.WaitIdle();
+    }
+    EXPECT_EQ(streamer.GetResidentMip(a), 2u);
+    EXPECT_EQ(streamer.GetResidentMip(b), 0u);
+    EXPECT_EQ(streamer.GetStats().evictedMips, 2);
+}
+
+TEST_F(TextureStreamerTest, GeneratesMipsOfFileWithoutThem) {
+    // Half of pixels point along x and half along y, so average normals are shorter without renormalization
+    const uint32_t size = 256;
+    std::vector<unsigned char> pixels((size_t)size * size * 4);
+    for (size_t i = 0; i < pixels.size(); i += 4) {
+        bool isX = (i / 4 + i / 4 / size) % 2 == 0;
+        pixels[i + 0] = isX ? 255 : 128;
+        pixels[i + 1] = isX ? 128 : 255;
+        pixels[i + 2] = 128;
+        pixels[i + 3] = 255;
+    }
+    paths.push_back(GetTestPath("nomips.dds"));
+    ASSERT_TRUE(DdsFile::Write(paths.back().c_str(), DdsFile::FORMAT_B8G8R8A8_UNORM_SRGB, size, size, { pixels }));
+    paths.push_back(GetTestPath("normal.dds"));
+    ASSERT_TRUE(DdsFile::Write(paths.back().c_str(), DdsFile::FORMAT_R8G8B8A8_UNORM, size, size, { pixels }));
+
+    streamer.Init(&sink, 64 * 1024 * 1024);
+    int color = streamer.AddTexture({ paths[3] });
+    ASSERT_GE(color, 0);
+    // Chain is RGBA8 of file's color space, file with mips is kept as it is
+    EXPECT_EQ(streamer.GetDesc(color).mipCount, 9u);
+    EXPECT_EQ(streamer.GetDesc(color).format, DdsFile::FORMAT_R8G8B8A8_UNORM_SRGB);
+    EXPECT_EQ(streamer.GetTailMip(color), 2u);
+    int authored = streamer.AddTexture({ paths[0] });
+    ASSERT_GE(authored, 0);
+    EXPECT_EQ(streamer.GetDesc(authored).mipCount, 10u);
+
+    int normal = streamer.AddTexture({ paths[4] }, true);
+    ASSERT_GE(normal, 0);
+    ASSERT_EQ(sink.lastFiles.size(), 1u);
+    ASSERT_EQ(sink.lastFiles[0]->GetDesc().mipCount, 9u);
+    // Average of x and y normals is renormalized to 45 degrees between them
+    const unsigned char* pixel = sink.lastFiles[0]->GetSubresourceData(4);
+    EXPECT_NEAR(pixel[0], 218, 1);
+    EXPECT_NEAR(pixel[1], 218, 1);
+    EXPECT_NEAR(pixel[2], 128, 1);
+
+    RunFrames(10, { normal }, (float)size);
+    EXPECT_EQ(streamer.GetResidentMip(normal), 0u);
+}
@@ -0,0 +1,46 @@
+// transparentListBench.cpp - radix sort of transparent objects against std::sort of same depths
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include "benchTimer.h"
+#include "transparentList.h"
+
+int main() {
+    const int count = 100000;
+    std::mt19937 random(5);
+    std::uniform_real_distribution<float> coordinate(-100.0f, 100.0f);
+    std::vector<XMFLOAT3> centers(count);
+    TransparentList list;
+    for (XMFLOAT3& center : centers) {
+        center = XMFLOAT3(coordinate(random), coordinate(random), coordinate(random));
+        list.Add(center);
+    }
+
+    // Camera orbits, so order changes between frames
+    float angle = 0.0f;
+    auto getView = [&]() {
+        angle += 0.5f;
+        return XMMatrixLookAtLH(XMVectorSet(150.0f * cosf(angle), 30.0f, 150.0f * sinf(angle), 1.0f), XMVectorZero(), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+    };
+
+    double radix = MeasureBest(10, [&]() { list.Sort(getView()); });
+
+    std::vector<std::pair<float, int>> items(count);
+    double stdSort = MeasureBest(10, [&]() {
+        XMMATRIX view = getView();
+        for (int i = 0; i < count; i++) {
+            items[i] = std::make_pair(XMVectorGetZ(XMVector3TransformCoord(XMLoadFloat3(&centers[i]), view)), i);
+        }
+        std::sort(items.begin(), items.end(), [](const std::pair<float, int>& a, const std::pair<float, int>& b) { return a.first > b.first; });
+    });
+
+    // Same camera as last frame, order check only
+    XMMATRIX view = getView();
+    list.Sort(view);
+    double unchanged = MeasureBest(10, [&]() { list.Sort(view); });
+
+    PrintResult("Radix sort", radix, count);
+    PrintResult("std::sort", stdSort, count);
+    PrintResult("Unchanged order", unchanged, count);
+    return list.GetCount() == count ? 0 : 1;
+}
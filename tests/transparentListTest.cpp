@@ -0,0 +1,85 @@
+// transparentListTest.cpp - back to front order of transparent objects by view depth
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include "transparentList.h"
+
+namespace {
+    // Function to get view space depth of center under view matrix
+    float GetDepth(const XMFLOAT3& center, FXMMATRIX view) {
+        return XMVectorGetZ(XMVector3TransformCoord(XMLoadFloat3(&center), view));
+    }
+
+    // Function to check that order is permutation of ids with non-increasing depths
+    void ExpectBackToFront(const TransparentList& list, const std::vector<XMFLOAT3>& centers, FXMMATRIX view) {
+        const std::vector<int>& order = list.GetOrder();
+        ASSERT_EQ(order.size(), centers.size());
+        std::vector<int> ids = order;
+        std::sort(ids.begin(), ids.end());
+        for (int i = 0; i < (int)ids.size(); i++) {
+            ASSERT_EQ(ids[i], i);
+        }
+        for (size_t i = 1; i < order.size(); i++) {
+            ASSERT_GE(GetDepth(centers[order[i - 1]], view), GetDepth(centers[order[i]], view)) << i;
+        }
+    }
+}
+
+TEST(TransparentList, SortsBackToFront) {
+    std::mt19937 random(3);
+    std::uniform_real_distribution<float> coordinate(-100.0f, 100.0f);
+    std::vector<XMFLOAT3> centers;
+    TransparentList list;
+    for (int i = 0; i < 10000; i++) {
+        centers.push_back(XMFLOAT3(coordinate(random), coordinate(random), coordinate(random)));
+        EXPECT_EQ(list.Add(centers.back()), i);
+    }
+
+    // Objects are behind and in front of camera, so depths of both signs are ordered
+    XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(10.0f, 20.0f, -30.0f, 1.0f), XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+    list.Sort(view);
+    ExpectBackToFront(list, centers, view);
+
+    // Camera turns around, order reverses
+    view = XMMatrixLookAtLH(XMVectorSet(10.0f, 20.0f, -30.0f, 1.0f), XMVectorSet(20.0f, 40.0f, -60.0f, 1.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+    list.Sort(view);
+    ExpectBackToFront(list, centers, view);
+    list.Release();
+}
+
+TEST(TransparentList, FollowsMovedObjects) {
+    TransparentList list;
+    std::vector<XMFLOAT3> centers = { XMFLOAT3(0.0f, 0.0f, 1.0f), XMFLOAT3(0.0f, 0.0f, 2.0f), XMFLOAT3(0.0f, 0.0f, 3.0f) };
+    for (const XMFLOAT3& center : centers) {
+        list.Add(center);
+    }
+    XMMATRIX view = XMMatrixIdentity();
+    list.Sort(view);
+    EXPECT_EQ(list.GetOrder(), std::vector<int>({ 2, 1, 0 }));
+
+    centers[0].z = 5.0f;
+    list.SetCenter(0, centers[0]);
+    list.Sort(view);
+    EXPECT_EQ(list.GetOrder(), std::vector<int>({ 0, 2, 1 }));
+
+    list.Clear();
+    EXPECT_EQ(list.GetCount(), 0);
+    EXPECT_TRUE(list.GetOrder().empty());
+}
+
+TEST(TransparentList, EqualDepthsKeepOrder) {
+    // Stable sort keeps objects at same depth in previous order, so they don't flicker
+    TransparentList list;
+    for (int i = 0; i < 100; i++) {
+        list.Add(XMFLOAT3((float)i, 0.0f, (float)(i % 2)));
+    }
+    XMMATRIX view = XMMatrixIdentity();
+    list.Sort(view);
+    const std::vector<int> first = list.GetOrder();
+    for (int i = 0; i < 50; i++) {
+        EXPECT_EQ(first[i], 2 * i + 1);
+        EXPECT_EQ(first[50 + i], 2 * i);
+    }
+    list.Sort(view);
+    EXPECT_EQ(list.GetOrder(), first);
+}